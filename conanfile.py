@@ -32,9 +32,10 @@ class SkaMidCbfFodmGen(ConanFile):
                  "arch" : [ "x86", "x86_64", "armv8" ]
                 }
     
-    options = {"shared": [True, False], "fPIC": [True, False]}
+    options = {"shared": [True, False], "fPIC": [True, False], "benchmarks": [True, False],
+               "calc_engine": ["multiprecision", "fixed_point", "float128", "double_double"], "metrics": [None, True, False]}
 
-    default_options = {"shared": False, "fPIC": True}
+    default_options = {"shared": False, "fPIC": True, "benchmarks": False, "calc_engine": "multiprecision", "metrics": None}
     
     generators = "cmake"
     
@@ -45,13 +46,21 @@ class SkaMidCbfFodmGen(ConanFile):
         self.requires("boost/1.71.0")
         if ( self.settings.build_type == "Debug" ):
             self.requires("gtest/1.15.0")
+        if ( self.options.benchmarks ):
+            self.requires("benchmark/1.8.3")
 
     def build(self):
         cmake = CMake(self)
+        defs = {"TARGET_ARCH": f"{self.settings.arch}",
+                "BUILD_BENCHMARKS": "ON" if self.options.benchmarks else "OFF",
+                "FODM_DEFAULT_CALC_ENGINE": str(self.options.calc_engine).upper()}
+        # By default CMake records the metrics in Debug builds only
+        if ( self.options.metrics != None ):
+            defs["FODM_METRICS"] = "ON" if self.options.metrics else "OFF"
         if ( self.in_local_cache ):
-            cmake.configure(defs={"TARGET_ARCH": f"{self.settings.arch}"}, source_folder=self.source_folder )
+            cmake.configure(defs=defs, source_folder=self.source_folder )
         else:
-            cmake.configure(defs={"TARGET_ARCH": f"{self.settings.arch}"})
+            cmake.configure(defs=defs)
         cmake.build()
 
     def package(self):
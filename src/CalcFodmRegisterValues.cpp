@@ -1,4 +1,16 @@
 #include "CalcFodmRegisterValues.h"
+#include "CalcFodmRegisterValuesDoubleDouble.h"
+#include "CalcFodmRegisterValuesFixedPoint.h"
+#include "FodmMetrics.h"
+#include "FodmNumericPolicy.h"
+#include "FodmRegisterFormat.h"
+#include "FodmSequence.h"
+#include "ThreadPool.h"
+
+#include <cfloat>
+#include <cstring>
+#include <limits>
+#include <type_traits>
 
 // to support higher precision
 #include <boost/multiprecision/cpp_bin_float.hpp> 
@@ -8,49 +20,105 @@ using namespace boost::multiprecision;
 namespace ska_mid_cbf_fodm_gen
 {
 
-/**
- * Uncomment to not apply the delay_linear_error_samples to delay_constant
- */
-#define DISABLE_DELAY_LINEAR_ERROR
-
 // Uncomment to print values to stdout
 // #define PRINT_INTERMEDIATE_VALUES
 
-cpp_bin_float_50 NS_TO_SECONDS(cpp_bin_float_50 ns) {
-  return ns / cpp_bin_float_50(1000000000);
+// The engine used when FodmCalcEngine::Default is requested.
+// Set with the FODM_DEFAULT_CALC_ENGINE CMake option.
+#if defined(FODM_DEFAULT_CALC_ENGINE_FIXED_POINT)
+const FodmCalcEngine DEFAULT_CALC_ENGINE = FodmCalcEngine::FixedPoint;
+#elif defined(FODM_DEFAULT_CALC_ENGINE_FLOAT128)
+const FodmCalcEngine DEFAULT_CALC_ENGINE = FodmCalcEngine::Float128;
+#elif defined(FODM_DEFAULT_CALC_ENGINE_DOUBLE_DOUBLE)
+const FodmCalcEngine DEFAULT_CALC_ENGINE = FodmCalcEngine::DoubleDouble;
+#else
+const FodmCalcEngine DEFAULT_CALC_ENGINE = FodmCalcEngine::MultiPrecision;
+#endif
+
+inline FodmCalcEngine ResolveCalcEngine(FodmCalcEngine engine)
+{
+  return engine == FodmCalcEngine::Default ? DEFAULT_CALC_ENGINE : engine;
+}
+
+// The quad precision type used by FodmCalcEngine::Float128
+#if LDBL_MANT_DIG == 113
+typedef long double quad_float;
+#elif defined(__SIZEOF_FLOAT128__)
+typedef __float128 quad_float;
+#else
+typedef cpp_bin_float_50 quad_float;
+#endif
+
+// Register scaling factors
+constexpr double TWO_POW_31 = TwoPow(31);
+constexpr double TWO_POW_32 = TwoPow(32);
+constexpr double TWO_POW_63 = TwoPow(63);
+
+#if defined(PRINT_INTERMEDIATE_VALUES) && LDBL_MANT_DIG != 113 && defined(__SIZEOF_FLOAT128__)
+// std::ostream has no operator for __float128
+std::ostream& operator<<(std::ostream& os, __float128 val)
+{
+  char buf[64];
+  quadmath_snprintf(buf, sizeof(buf), "%.*Qg", static_cast<int>(os.precision()), val);
+  return os << buf;
+}
+#endif
+
+template <typename Real>
+Real NS_TO_SECONDS(const Real& ns) {
+  return ns / Real(1000000000);
 }
 
-cpp_bin_float_50 MS_TO_SECONDS(cpp_bin_float_50 ms) {
-  return ms / cpp_bin_float_50(1000);
+template <typename Real>
+Real MS_TO_SECONDS(const Real& ms) {
+  return ms / Real(1000);
 }
 
-cpp_bin_float_50 mod_pmhalf(cpp_bin_float_50 val)
+template <typename Real>
+Real mod_pmhalf(const Real& val)
 {
+  typedef FodmNumericPolicy<Real> Policy;
   // Python version:
   // (((val % Decimal(1)) + Decimal(1.5)) % Decimal(1)) - Decimal(0.5)
-  return fmod((fmod(val,cpp_bin_float_50(1)) + cpp_bin_float_50(1.5)),cpp_bin_float_50(1)) - cpp_bin_float_50(0.5);
+  return Policy::Fmod((Policy::Fmod(val,Real(1)) + Real(1.5)),Real(1)) - Real(0.5);
 }
 
 // The First Order Delay Models register values before
 // scaling to integers. In the future the firmware driver may
-// want to take this as input. The multi-precision type is used in place of 
-// double precision because it is not enough for the 64bit delay and phase 
-// linear registers.
+// want to take this as input. A multi-precision or quad precision type is
+// used in place of double precision because it is not enough for the 64bit
+// delay and phase linear registers.
+template <typename Real>
 struct FirstOrderDelayModelRegisterRawValues
 {
     uint64_t first_input_timestamp;
-    cpp_bin_float_50 delay_constant;
-    cpp_bin_float_50 phase_constant;
-    cpp_bin_float_50 delay_linear;
-    cpp_bin_float_50 phase_linear;
+    Real delay_constant;
+    Real phase_constant;
+    Real delay_linear;
+    Real phase_linear;
     uint32_t validity_period;
     uint32_t output_PPS;
     uint64_t first_output_timestamp;
 };
 
+// The values used by CalcFodmRegisterRawValues that depend only on the 
+// sample rates and frequency shifts, not on the FODM itself. These are 
+// computed once per call to the batch functions instead of once per FODM.
+template <typename Real>
+struct FodmChannelConstants
+{
+    uint32_t output_sample_rate;
+    Real input_sample_rate_f;
+    Real output_sample_rate_f;
+    Real resampling_rate;
+    Real f_wb_ds;
+    Real f_scfo_as;
+};
+
+
 // ---- Forward Declarations ----
-FirstOrderDelayModelRegisterRawValues CalcFodmRegisterRawValues( 
-    const FoPoly &fo_poly,
+template <typename Real>
+FodmChannelConstants<Real> CalcFodmChannelConstants(
     uint32_t input_sample_rate,
     uint32_t output_sample_rate,
     double freq_down_shift,
@@ -58,17 +126,44 @@ FirstOrderDelayModelRegisterRawValues CalcFodmRegisterRawValues(
     double freq_wb_shift,
     double freq_scfo_shift );
 
+template <typename Real>
+FirstOrderDelayModelRegisterRawValues<Real> CalcFodmRegisterRawValues( 
+    const FoPoly &fo_poly,
+    const FodmChannelConstants<Real> &constants );
+
+template <typename Real>
+FirstOrderDelayModelRegisterRawValues<Real> CalcFodmRegisterRawValues( 
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    const FodmChannelConstants<Real> &constants );
+
+template <typename Real>
+FirstOrderDelayModelRegisterRawValues<Real> CalcFodmRegisterRawValues( 
+    const FoPoly &fo_poly,
+    const FodmChannelConstants<Real> &constants,
+    const Real &current_output_timestamp_samples,
+    const Real &next_output_timestamp_samples );
+
+bool CalcFodmOutputTimestamps(
+    const FoPoly &fo_poly,
+    uint32_t output_sample_rate,
+    FodmOutputTimestamps &timestamps );
+
+template <typename Real>
 FirstOrderDelayModelRegisterValues RawToRegisterValues(
-    const FirstOrderDelayModelRegisterRawValues& raw_values);
+    const FirstOrderDelayModelRegisterRawValues<Real>& raw_values);
 
+template <typename Real>
 FirstOrderDelayModelRegisterValuesVer1 RawToRegisterValuesV1(
-    const FirstOrderDelayModelRegisterRawValues& raw_values);
+    const FirstOrderDelayModelRegisterRawValues<Real>& raw_values);
 
 // -----------------------------
 
 /**
  * Calculates the values to be written to the first order delay model
  * registers after accounting for the resampling and frequency shifts.
+ * The engine and its fallback to multi-precision are selected by the
+ * RdtChannelContext version, which all the versions below go through.
  *
  * @param fo_poly a first order delay model
  * @param input_sample_rate Input sample rate in samples/second
@@ -77,6 +172,7 @@ FirstOrderDelayModelRegisterValuesVer1 RawToRegisterValuesV1(
  * @param freq_align_shift Frequency shift applied to align fine channels between FSs [Hz]
  * @param freq_wb_shift Net Wideband (WB) frequency shift [Hz] 
  * @param freq_scfo_shift Frequency shift required due to SCFO sampling [Hz]
+ * @param engine the arithmetic used for the calculation
  * 
  * @return the first order delay model register values
  */
@@ -87,20 +183,13 @@ FirstOrderDelayModelRegisterValues CalcFodmRegisterValues(
     double freq_down_shift,
     double freq_align_shift,
     double freq_wb_shift,
-    double freq_scfo_shift )
+    double freq_scfo_shift,
+    FodmCalcEngine engine )
 {
-  FirstOrderDelayModelRegisterRawValues raw_values = 
-    CalcFodmRegisterRawValues( 
-      fo_poly,
-      input_sample_rate,
-      output_sample_rate,
-      freq_down_shift,
-      freq_align_shift,
-      freq_wb_shift,
-      freq_scfo_shift
-    );
-  
-  return RawToRegisterValues(raw_values);
+  return CalcFodmRegisterValues(
+    RdtChannelContext(input_sample_rate, output_sample_rate,
+      freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift, engine),
+    fo_poly);
 }
 
 /**
@@ -116,6 +205,7 @@ FirstOrderDelayModelRegisterValues CalcFodmRegisterValues(
  * @param freq_align_shift Frequency shift applied to align fine channels between FSs [Hz]
  * @param freq_wb_shift Net Wideband (WB) frequency shift [Hz] 
  * @param freq_scfo_shift Frequency shift required due to SCFO sampling [Hz]
+ * @param engine the arithmetic used for the calculation
  * 
  * @return the first order delay model register values
  */
@@ -126,43 +216,652 @@ FirstOrderDelayModelRegisterValuesVer1 CalcFodmRegisterValuesV1(
     double freq_down_shift,
     double freq_align_shift,
     double freq_wb_shift,
-    double freq_scfo_shift )
+    double freq_scfo_shift,
+    FodmCalcEngine engine )
 {
-  FirstOrderDelayModelRegisterRawValues raw_values = 
-    CalcFodmRegisterRawValues( 
-      fo_poly,
-      input_sample_rate,
-      output_sample_rate,
-      freq_down_shift,
-      freq_align_shift,
-      freq_wb_shift,
-      freq_scfo_shift
-    );
-  
-  return RawToRegisterValuesV1(raw_values);
+  return CalcFodmRegisterValuesV1(
+    RdtChannelContext(input_sample_rate, output_sample_rate,
+      freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift, engine),
+    fo_poly);
 }
 
+/**
+ * Calculates the values to be written to the first order delay model
+ * registers, with the output timestamps of the FODM precomputed.
+ *
+ * @param fo_poly a first order delay model
+ * @param timestamps the output timestamps of fo_poly, see FodmSequence
+ * @param input_sample_rate Input sample rate in samples/second
+ * @param output_sample_rate Output sample rate in samples/second
+ * @param freq_down_shift Frequency down-shift at the VCC-OSPPFB [Hz]
+ * @param freq_align_shift Frequency shift applied to align fine channels between FSs [Hz]
+ * @param freq_wb_shift Net Wideband (WB) frequency shift [Hz] 
+ * @param freq_scfo_shift Frequency shift required due to SCFO sampling [Hz]
+ * @param engine the arithmetic used for the calculation
+ * 
+ * @return the first order delay model register values
+ */
+FirstOrderDelayModelRegisterValues CalcFodmRegisterValues(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FodmCalcEngine engine )
+{
+  return CalcFodmRegisterValues(
+    RdtChannelContext(input_sample_rate, output_sample_rate,
+      freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift, engine),
+    fo_poly, timestamps);
+}
 
 /**
  * Calculates the values to be written to the first order delay model
- * registers.
+ * registers for register version 1, with the output timestamps of the FODM precomputed.
+ *
+ * @param fo_poly a first order delay model
+ * @param timestamps the output timestamps of fo_poly, see FodmSequence
+ * @param input_sample_rate Input sample rate in samples/second
+ * @param output_sample_rate Output sample rate in samples/second
+ * @param freq_down_shift Frequency down-shift at the VCC-OSPPFB [Hz]
+ * @param freq_align_shift Frequency shift applied to align fine channels between FSs [Hz]
+ * @param freq_wb_shift Net Wideband (WB) frequency shift [Hz] 
+ * @param freq_scfo_shift Frequency shift required due to SCFO sampling [Hz]
+ * @param engine the arithmetic used for the calculation
+ * 
+ * @return the first order delay model register values
+ */
+FirstOrderDelayModelRegisterValuesVer1 CalcFodmRegisterValuesV1(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FodmCalcEngine engine )
+{
+  return CalcFodmRegisterValuesV1(
+    RdtChannelContext(input_sample_rate, output_sample_rate,
+      freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift, engine),
+    fo_poly, timestamps);
+}
+
+/**
+ * Calculates the register values for register version 2 and higher for
+ * num_fo_poly FODMs that share the same sample rates and frequency shifts.
+ * The values that only depend on the sample rates and frequency shifts are
+ * computed once for the whole batch, see RdtChannelContext. The results are
+ * identical to calling the single FODM version on each element of fo_poly.
+ *
+ * @param fo_poly array of num_fo_poly first order delay models
+ * @param num_fo_poly number of first order delay models in fo_poly
+ * @param input_sample_rate Input sample rate in samples/second
+ * @param output_sample_rate Output sample rate in samples/second
+ * @param freq_down_shift Frequency down-shift at the VCC-OSPPFB [Hz]
+ * @param freq_align_shift Frequency shift applied to align fine channels between FSs [Hz]
+ * @param freq_wb_shift Net Wideband (WB) frequency shift [Hz]
+ * @param freq_scfo_shift Frequency shift required due to SCFO sampling [Hz]
+ * @param reg_values array of num_fo_poly elements to store the register values
+ * @param engine the arithmetic used for the calculation
+ */
+void CalcFodmRegisterValues(
+    const FoPoly *fo_poly,
+    size_t num_fo_poly,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValues *reg_values,
+    FodmCalcEngine engine )
+{
+  CalcFodmRegisterValues(
+    RdtChannelContext(input_sample_rate, output_sample_rate,
+      freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift, engine),
+    fo_poly, num_fo_poly, reg_values);
+}
+
+/**
+ * Calculates the register values for register version 1 for num_fo_poly
+ * FODMs that share the same sample rates and frequency shifts.
+ * See the version 2 batch function for details.
+ *
+ * @param fo_poly array of num_fo_poly first order delay models
+ * @param num_fo_poly number of first order delay models in fo_poly
+ * @param input_sample_rate Input sample rate in samples/second
+ * @param output_sample_rate Output sample rate in samples/second
+ * @param freq_down_shift Frequency down-shift at the VCC-OSPPFB [Hz]
+ * @param freq_align_shift Frequency shift applied to align fine channels between FSs [Hz]
+ * @param freq_wb_shift Net Wideband (WB) frequency shift [Hz]
+ * @param freq_scfo_shift Frequency shift required due to SCFO sampling [Hz]
+ * @param reg_values array of num_fo_poly elements to store the register values
+ * @param engine the arithmetic used for the calculation
+ */
+void CalcFodmRegisterValuesV1(
+    const FoPoly *fo_poly,
+    size_t num_fo_poly,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValuesVer1 *reg_values,
+    FodmCalcEngine engine )
+{
+  CalcFodmRegisterValuesV1(
+    RdtChannelContext(input_sample_rate, output_sample_rate,
+      freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift, engine),
+    fo_poly, num_fo_poly, reg_values);
+}
+
+// The values precomputed by RdtChannelContext, for each engine that
+// may be used with it
+struct RdtChannelContext::Constants
+{
+  FodmChannelConstants<cpp_bin_float_50> multi_precision;
+  FodmChannelConstants<quad_float> quad;
+};
+
+/**
+ * RdtChannelContext constructor, precomputes the values of the register
+ * calculation that only depend on the sample rates and frequency shifts.
+ *
+ * @param input_sample_rate Input sample rate in samples/second
+ * @param output_sample_rate Output sample rate in samples/second
+ * @param freq_down_shift Frequency down-shift at the VCC-OSPPFB [Hz]
+ * @param freq_align_shift Frequency shift applied to align fine channels between FSs [Hz]
+ * @param freq_wb_shift Net Wideband (WB) frequency shift [Hz]
+ * @param freq_scfo_shift Frequency shift required due to SCFO sampling [Hz]
+ * @param engine the arithmetic used for the calculation
+ */
+RdtChannelContext::RdtChannelContext(
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FodmCalcEngine engine )
+  : input_sample_rate_(input_sample_rate),
+    output_sample_rate_(output_sample_rate),
+    freq_down_shift_(freq_down_shift),
+    freq_align_shift_(freq_align_shift),
+    freq_wb_shift_(freq_wb_shift),
+    freq_scfo_shift_(freq_scfo_shift),
+    engine_(ResolveCalcEngine(engine))
+{
+  std::shared_ptr<Constants> constants = std::make_shared<Constants>();
+  // FixedPoint and DoubleDouble fall back to the multi-precision calculation
+  if (engine_ == FodmCalcEngine::Float128)
+  {
+    constants->quad = CalcFodmChannelConstants<quad_float>(
+      input_sample_rate, output_sample_rate,
+      freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift);
+  }
+  else
+  {
+    constants->multi_precision = CalcFodmChannelConstants<cpp_bin_float_50>(
+      input_sample_rate, output_sample_rate,
+      freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift);
+  }
+  constants_ = constants;
+}
+
+namespace
+{
+
+// Overloads on the register version, used by the functions taking a
+// RdtChannelContext
+template <typename Real>
+void ToRegisterValues(
+    const FirstOrderDelayModelRegisterRawValues<Real>& raw_values,
+    FirstOrderDelayModelRegisterValues& reg_values)
+{
+  reg_values = RawToRegisterValues(raw_values);
+}
+
+template <typename Real>
+void ToRegisterValues(
+    const FirstOrderDelayModelRegisterRawValues<Real>& raw_values,
+    FirstOrderDelayModelRegisterValuesVer1& reg_values)
+{
+  reg_values = RawToRegisterValuesV1(raw_values);
+}
+
+// The register values of CalcFodmRegisterVersions, for each version in the
+// versions mask
+struct RegisterVersions
+{
+  uint32_t versions;
+  FodmRegisterVersionValues &values;
+};
+
+template <typename Real>
+void ToRegisterValues(
+    const FirstOrderDelayModelRegisterRawValues<Real>& raw_values,
+    RegisterVersions& reg_values)
+{
+  if (reg_values.versions & FODM_REGISTER_V1)
+  {
+    reg_values.values.v1 = RawToRegisterValuesV1(raw_values);
+  }
+  if (reg_values.versions & FODM_REGISTER_V2)
+  {
+    reg_values.values.v2 = RawToRegisterValues(raw_values);
+  }
+}
+
+// The register values with the FixedPoint or DoubleDouble engine of ctx.
+// Returns false if the engine can't calculate them, see
+// CalcFodmRegisterValuesFixedPoint and CalcFodmRegisterValuesDoubleDouble.
+bool FastPathRegisterValues(
+    const RdtChannelContext &ctx,
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    FirstOrderDelayModelRegisterValues &reg_values)
+{
+  if (ctx.engine() == FodmCalcEngine::DoubleDouble)
+  {
+    return CalcFodmRegisterValuesDoubleDouble(fo_poly, timestamps, ctx.input_sample_rate(), ctx.output_sample_rate(),
+      ctx.freq_down_shift(), ctx.freq_align_shift(), ctx.freq_wb_shift(), ctx.freq_scfo_shift(), reg_values);
+  }
+  return CalcFodmRegisterValuesFixedPoint(fo_poly, timestamps, ctx.input_sample_rate(), ctx.output_sample_rate(),
+    ctx.freq_down_shift(), ctx.freq_align_shift(), ctx.freq_wb_shift(), ctx.freq_scfo_shift(), reg_values);
+}
+
+bool FastPathRegisterValues(
+    const RdtChannelContext &ctx,
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    FirstOrderDelayModelRegisterValuesVer1 &reg_values)
+{
+  if (ctx.engine() == FodmCalcEngine::DoubleDouble)
+  {
+    return CalcFodmRegisterValuesV1DoubleDouble(fo_poly, timestamps, ctx.input_sample_rate(), ctx.output_sample_rate(),
+      ctx.freq_down_shift(), ctx.freq_align_shift(), ctx.freq_wb_shift(), ctx.freq_scfo_shift(), reg_values);
+  }
+  return CalcFodmRegisterValuesV1FixedPoint(fo_poly, timestamps, ctx.input_sample_rate(), ctx.output_sample_rate(),
+    ctx.freq_down_shift(), ctx.freq_align_shift(), ctx.freq_wb_shift(), ctx.freq_scfo_shift(), reg_values);
+}
+
+bool FastPathRegisterValues(
+    const RdtChannelContext &ctx,
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    RegisterVersions &reg_values)
+{
+  if (ctx.engine() == FodmCalcEngine::DoubleDouble)
+  {
+    return CalcFodmRegisterVersionsDoubleDouble(fo_poly, timestamps, ctx.input_sample_rate(), ctx.output_sample_rate(),
+      ctx.freq_down_shift(), ctx.freq_align_shift(), ctx.freq_wb_shift(), ctx.freq_scfo_shift(),
+      reg_values.versions, reg_values.values);
+  }
+  return CalcFodmRegisterVersionsFixedPoint(fo_poly, timestamps, ctx.input_sample_rate(), ctx.output_sample_rate(),
+    ctx.freq_down_shift(), ctx.freq_align_shift(), ctx.freq_wb_shift(), ctx.freq_scfo_shift(),
+    reg_values.versions, reg_values.values);
+}
+
+/**
+ * Calculates the register values of fo_poly for the channel of ctx. This
+ * is the engine dispatch of all the register value functions: Float128,
+ * or FixedPoint and DoubleDouble with their fallback to multi-precision.
+ *
+ * @param ctx the channel sample rates, frequency shifts and engine
+ * @param fo_poly a first order delay model
+ * @param timestamps the output timestamps of fo_poly, or nullptr to
+ *                   calculate them from the start and stop times
+ * @param reg_values the register values, either version or RegisterVersions
+ */
+template <typename RegisterValues>
+void CalcContextRegisterValues(
+    const RdtChannelContext &ctx,
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps *timestamps,
+    RegisterValues &reg_values)
+{
+  const RdtChannelContext::Constants &constants = ctx.constants();
+
+  // The Float128, FixedPoint and DoubleDouble engines use the exact output timestamps
+  FodmOutputTimestamps exact_timestamps;
+  if (timestamps == nullptr && ctx.engine() != FodmCalcEngine::MultiPrecision &&
+      CalcFodmOutputTimestamps(fo_poly, ctx.output_sample_rate(), exact_timestamps))
+  {
+    timestamps = &exact_timestamps;
+  }
+
+  if (ctx.engine() == FodmCalcEngine::Float128)
+  {
+    if (timestamps != nullptr)
+    {
+      ToRegisterValues(CalcFodmRegisterRawValues(fo_poly, *timestamps, constants.quad), reg_values);
+    }
+    else
+    {
+      ToRegisterValues(CalcFodmRegisterRawValues(fo_poly, constants.quad), reg_values);
+    }
+    return;
+  }
+
+  if (ctx.engine() == FodmCalcEngine::FixedPoint || ctx.engine() == FodmCalcEngine::DoubleDouble)
+  {
+    FODM_METRICS_ADD(FodmCounter::FastPathCalls, 1);
+    if (timestamps != nullptr && FastPathRegisterValues(ctx, fo_poly, *timestamps, reg_values))
+    {
+      return;
+    }
+    // Out of range of the fast path calculation, use multi-precision
+    FODM_METRICS_ADD(FodmCounter::FastPathFallbacks, 1);
+    if (timestamps == &exact_timestamps)
+    {
+      // from the start and stop times, as with the MultiPrecision engine
+      timestamps = nullptr;
+    }
+  }
+  if (timestamps == nullptr)
+  {
+    ToRegisterValues(CalcFodmRegisterRawValues(fo_poly, constants.multi_precision), reg_values);
+    return;
+  }
+  ToRegisterValues(CalcFodmRegisterRawValues(fo_poly, *timestamps, constants.multi_precision), reg_values);
+}
+
+// Number of FODMs calculated by one range of the parallel batch calculation
+const size_t PARALLEL_GRAIN_SIZE = 256;
+
+// The batch calculation for the channel of ctx, advancing the output
+// timestamps of consecutive FODMs with a FodmSequence
+template <typename RegisterValues>
+void CalcContextRegisterValues(
+    const RdtChannelContext &ctx,
+    const FoPoly *fo_poly,
+    size_t num_fo_poly,
+    RegisterValues *reg_values)
+{
+  FodmSequence sequence(ctx.output_sample_rate());
+  FodmOutputTimestamps timestamps;
+  for (size_t ii = 0; ii < num_fo_poly; ii++)
+  {
+    // Timestamps that can't be represented, e.g. negative times, are
+    // calculated from the start and stop times
+    CalcContextRegisterValues(ctx, fo_poly[ii],
+      sequence.Next(fo_poly[ii], timestamps) ? &timestamps : nullptr, reg_values[ii]);
+  }
+}
+
+}; // namespace
+
+/**
+ * Calculates the values to be written to the first order delay model
+ * registers with the per channel values precomputed in ctx. The results
+ * are identical to the version taking the sample rates and frequency shifts.
+ *
+ * @param ctx the channel sample rates, frequency shifts and engine
+ * @param fo_poly a first order delay model
+ *
+ * @return the first order delay model register values
+ */
+FirstOrderDelayModelRegisterValues CalcFodmRegisterValues(
+    const RdtChannelContext &ctx,
+    const FoPoly &fo_poly )
+{
+  FirstOrderDelayModelRegisterValues reg_values;
+  CalcContextRegisterValues(ctx, fo_poly, nullptr, reg_values);
+  return reg_values;
+}
+
+/**
+ * Calculates the values to be written to the first order delay model
+ * registers for register version 1 with the per channel values
+ * precomputed in ctx.
+ *
+ * @param ctx the channel sample rates, frequency shifts and engine
+ * @param fo_poly a first order delay model
+ *
+ * @return the first order delay model register values
+ */
+FirstOrderDelayModelRegisterValuesVer1 CalcFodmRegisterValuesV1(
+    const RdtChannelContext &ctx,
+    const FoPoly &fo_poly )
+{
+  FirstOrderDelayModelRegisterValuesVer1 reg_values;
+  CalcContextRegisterValues(ctx, fo_poly, nullptr, reg_values);
+  return reg_values;
+}
+
+/**
+ * Calculates the values to be written to the first order delay model
+ * registers with the per channel values precomputed in ctx, and the
+ * output timestamps of the FODM precomputed.
+ *
+ * @param ctx the channel sample rates, frequency shifts and engine
+ * @param fo_poly a first order delay model
+ * @param timestamps the output timestamps of fo_poly, see FodmSequence
+ *
+ * @return the first order delay model register values
+ */
+FirstOrderDelayModelRegisterValues CalcFodmRegisterValues(
+    const RdtChannelContext &ctx,
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps )
+{
+  FirstOrderDelayModelRegisterValues reg_values;
+  CalcContextRegisterValues(ctx, fo_poly, &timestamps, reg_values);
+  return reg_values;
+}
+
+/**
+ * Register version 1 of the above.
+ *
+ * @param ctx the channel sample rates, frequency shifts and engine
+ * @param fo_poly a first order delay model
+ * @param timestamps the output timestamps of fo_poly, see FodmSequence
+ *
+ * @return the first order delay model register values
+ */
+FirstOrderDelayModelRegisterValuesVer1 CalcFodmRegisterValuesV1(
+    const RdtChannelContext &ctx,
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps )
+{
+  FirstOrderDelayModelRegisterValuesVer1 reg_values;
+  CalcContextRegisterValues(ctx, fo_poly, &timestamps, reg_values);
+  return reg_values;
+}
+
+/**
+ * Calculates the register values for register version 2 and higher for
+ * num_fo_poly FODMs of the channel of ctx. The output timestamps of
+ * consecutive FODMs are advanced with a FodmSequence. The results are
+ * identical to calling the single FODM version on each element of fo_poly.
+ *
+ * @param ctx the channel sample rates, frequency shifts and engine
+ * @param fo_poly array of num_fo_poly first order delay models
+ * @param num_fo_poly number of first order delay models in fo_poly
+ * @param reg_values array of num_fo_poly elements to store the register values
+ */
+void CalcFodmRegisterValues(
+    const RdtChannelContext &ctx,
+    const FoPoly *fo_poly,
+    size_t num_fo_poly,
+    FirstOrderDelayModelRegisterValues *reg_values )
+{
+  CalcContextRegisterValues(ctx, fo_poly, num_fo_poly, reg_values);
+}
+
+/**
+ * Calculates the register values for register version 1 for num_fo_poly
+ * FODMs of the channel of ctx. See the version 2 batch function.
+ *
+ * @param ctx the channel sample rates, frequency shifts and engine
+ * @param fo_poly array of num_fo_poly first order delay models
+ * @param num_fo_poly number of first order delay models in fo_poly
+ * @param reg_values array of num_fo_poly elements to store the register values
+ */
+void CalcFodmRegisterValuesV1(
+    const RdtChannelContext &ctx,
+    const FoPoly *fo_poly,
+    size_t num_fo_poly,
+    FirstOrderDelayModelRegisterValuesVer1 *reg_values )
+{
+  CalcContextRegisterValues(ctx, fo_poly, num_fo_poly, reg_values);
+}
+
+/**
+ * Calculates the values to be written to the first order delay model
+ * registers of every register version in versions, with the per channel
+ * values precomputed in ctx. The register values are calculated once, and
+ * quantized to each version.
+ *
+ * @param ctx the channel sample rates, frequency shifts and engine
+ * @param fo_poly a first order delay model
+ * @param versions mask of FODM_REGISTER_V1 and FODM_REGISTER_V2
+ * @param values the register values of the versions in versions
+ */
+void CalcFodmRegisterVersions(
+    const RdtChannelContext &ctx,
+    const FoPoly &fo_poly,
+    uint32_t versions,
+    FodmRegisterVersionValues &values )
+{
+  RegisterVersions reg_values = { versions, values };
+  CalcContextRegisterValues(ctx, fo_poly, nullptr, reg_values);
+}
+
+/**
+ * Same as above, with the output timestamps of the FODM precomputed.
+ *
+ * @param ctx the channel sample rates, frequency shifts and engine
+ * @param fo_poly a first order delay model
+ * @param timestamps the output timestamps of fo_poly, see FodmSequence
+ * @param versions mask of FODM_REGISTER_V1 and FODM_REGISTER_V2
+ * @param values the register values of the versions in versions
+ */
+void CalcFodmRegisterVersions(
+    const RdtChannelContext &ctx,
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t versions,
+    FodmRegisterVersionValues &values )
+{
+  RegisterVersions reg_values = { versions, values };
+  CalcContextRegisterValues(ctx, fo_poly, &timestamps, reg_values);
+}
+
+/**
+ * Calculates the register values of every register version in versions
+ * for num_fo_poly FODMs of the channel of ctx. The output timestamps of
+ * consecutive FODMs are advanced with a FodmSequence, as in the batch
+ * CalcFodmRegisterValues.
+ *
+ * @param ctx the channel sample rates, frequency shifts and engine
+ * @param fo_poly array of num_fo_poly first order delay models
+ * @param num_fo_poly number of first order delay models in fo_poly
+ * @param versions mask of FODM_REGISTER_V1 and FODM_REGISTER_V2
+ * @param values array of num_fo_poly elements to store the register values
+ */
+void CalcFodmRegisterVersions(
+    const RdtChannelContext &ctx,
+    const FoPoly *fo_poly,
+    size_t num_fo_poly,
+    uint32_t versions,
+    FodmRegisterVersionValues *values )
+{
+  FodmSequence sequence(ctx.output_sample_rate());
+  FodmOutputTimestamps timestamps;
+  for (size_t ii = 0; ii < num_fo_poly; ii++)
+  {
+    RegisterVersions reg_values = { versions, values[ii] };
+    CalcContextRegisterValues(ctx, fo_poly[ii],
+      sequence.Next(fo_poly[ii], timestamps) ? &timestamps : nullptr, reg_values);
+  }
+}
+
+/**
+ * The version 2 batch function above, with ranges of FODMs calculated in
+ * parallel on the threads of pool. Each range starts its own FodmSequence,
+ * which gives the same timestamps, so the results are identical.
+ *
+ * @param ctx the channel sample rates, frequency shifts and engine
+ * @param fo_poly array of num_fo_poly first order delay models
+ * @param num_fo_poly number of first order delay models in fo_poly
+ * @param reg_values array of num_fo_poly elements to store the register values
+ * @param pool the threads to run on
+ */
+void CalcFodmRegisterValues(
+    const RdtChannelContext &ctx,
+    const FoPoly *fo_poly,
+    size_t num_fo_poly,
+    FirstOrderDelayModelRegisterValues *reg_values,
+    ThreadPool &pool )
+{
+  pool.ParallelFor(num_fo_poly, PARALLEL_GRAIN_SIZE, [&](size_t begin, size_t end)
+  {
+    CalcContextRegisterValues(ctx, fo_poly + begin, end - begin, reg_values + begin);
+  });
+}
+
+/**
+ * The version 1 batch function above, with ranges of FODMs calculated in
+ * parallel on the threads of pool.
+ *
+ * @param ctx the channel sample rates, frequency shifts and engine
+ * @param fo_poly array of num_fo_poly first order delay models
+ * @param num_fo_poly number of first order delay models in fo_poly
+ * @param reg_values array of num_fo_poly elements to store the register values
+ * @param pool the threads to run on
+ */
+void CalcFodmRegisterValuesV1(
+    const RdtChannelContext &ctx,
+    const FoPoly *fo_poly,
+    size_t num_fo_poly,
+    FirstOrderDelayModelRegisterValuesVer1 *reg_values,
+    ThreadPool &pool )
+{
+  pool.ParallelFor(num_fo_poly, PARALLEL_GRAIN_SIZE, [&](size_t begin, size_t end)
+  {
+    CalcContextRegisterValues(ctx, fo_poly + begin, end - begin, reg_values + begin);
+  });
+}
+
+/**
+ * Calculates the output timestamps of fo_poly exactly, with the same
+ * results as the multi-precision calculation.
+ *
+ * fo_poly: FO delay model
+ * output_sample_rate: Output sample rate in samples/second
+ * timestamps: the output timestamps of fo_poly
+ *
+ * Returns false if the timestamps can't be represented, e.g. negative times.
+ */
+bool CalcFodmOutputTimestamps(
+    const FoPoly &fo_poly,
+    uint32_t output_sample_rate,
+    FodmOutputTimestamps &timestamps )
+{
+  return CalcFodmOutputTimestampFixedPoint(fo_poly.start_time_ms, output_sample_rate, timestamps.current) &&
+    CalcFodmOutputTimestampFixedPoint(fo_poly.stop_time_ms, output_sample_rate, timestamps.next);
+}
+
+/**
+ * Calculates the values used by CalcFodmRegisterRawValues that only
+ * depend on the sample rates and the frequency shifts.
  *
- * fo_poly: FO delay model to write
  * input_sample_rate: Input sample rate in samples/second
  * output_sample_rate: Output sample rate in samples/second
- * max_delay_jump_samples: Maximum discontinuity in delay between FO models in samples
  * freq_down_shift: Frequency down-shift at the VCC-OSPPFB [Hz]
  * freq_align_shift: Frequency shift applied to align fine channels between FSs [Hz]
- * freq_wb_shift: Net Wideband (WB) frequency shift [Hz] 
+ * freq_wb_shift: Net Wideband (WB) frequency shift [Hz]
  * freq_scfo_shift: Frequency shift required due to SCFO sampling [Hz]
- * 
- * Description: 
- * Reference [R1]: Derivation of First Order Delay/Phase Polynomials for the
- *                 Mid.CBF ReSampler, by Thushara Gunaratne, Ver.1.0-2021-07-15 
- *
  */
-FirstOrderDelayModelRegisterRawValues CalcFodmRegisterRawValues( 
-    const FoPoly &fo_poly,
+template <typename Real>
+FodmChannelConstants<Real> CalcFodmChannelConstants(
     uint32_t input_sample_rate,
     uint32_t output_sample_rate,
     double freq_down_shift,
@@ -170,6 +869,189 @@ FirstOrderDelayModelRegisterRawValues CalcFodmRegisterRawValues(
     double freq_wb_shift,
     double freq_scfo_shift )
 {
+  FodmChannelConstants<Real> constants;
+  constants.output_sample_rate = output_sample_rate;
+  constants.input_sample_rate_f = Real(input_sample_rate);
+  constants.output_sample_rate_f = Real(output_sample_rate);
+  constants.resampling_rate = constants.input_sample_rate_f / constants.output_sample_rate_f;
+
+  // -------------------------------------------------------------------------
+  // Initialize parameters for First Order Phase Polynomials (FOPP) calculation
+
+  // Mapping between the C++ variable names and the [R1] notations:
+  // fs_index         = FSI
+  // freq_down_shift  = F_DS
+  // freq_wb_shift    = F_WB
+  // freq_align_shift = F_AS
+  // freq_scfo_shift  = F_SCFO
+  // vcc_os_factor    = OS
+
+  // temporary flag; TODO remove when confirmed:
+  bool use_tech_note_formula = false;
+  if (use_tech_note_formula)
+  {
+    // In the HW test notebooks (talon_FSP.py) freq_down_shift has opposite sign
+    // This may have to do with the selected sign convention. in [R1] it was
+    // assumed F_DS is positive when decreased (i.e. down-shift),
+    // whereas Wideband-Shift (F_WB) is positive when increased.
+    freq_down_shift = -freq_down_shift;
+  }
+
+  // -----------------------------------------------------------------------
+
+  // SKB-640: After testing with tones inserted by BITE, it's found that
+  //          the sign of alignment shift needs to be flipped for
+  //          the tones to appear at the expected frequencies.
+  freq_align_shift = -freq_align_shift;
+
+  // Note that the subtraction and addition are done in double precision
+  constants.f_wb_ds = Real(freq_wb_shift - freq_down_shift);
+  constants.f_scfo_as = Real(freq_scfo_shift + freq_align_shift);
+
+  return constants;
+}
+
+/**
+ * Calculates the output_PPS register field from the first output sample of
+ * a FODM, the next whole second in output samples, in integers.
+ *
+ * current_output_timestamp: the first output sample of the FODM
+ * output_sample_rate: Output sample rate in samples/second
+ * output_pps: the lower 32 bits of the next whole second in output samples
+ *
+ * Returns false if the next whole second does not fit in 64 bits.
+ */
+bool CalcFodmOutputPps(
+    uint64_t current_output_timestamp,
+    uint32_t output_sample_rate,
+    uint32_t &output_pps )
+{
+  const uint64_t output_pps_seconds = current_output_timestamp / output_sample_rate +
+    (current_output_timestamp % output_sample_rate != 0);
+  if (output_pps_seconds > std::numeric_limits<uint64_t>::max() / output_sample_rate)
+  {
+    return false;
+  }
+  output_pps = static_cast<uint32_t>((output_pps_seconds * output_sample_rate) & 0xffffffff);
+  return true;
+}
+
+/**
+ * Sets the output_PPS register field from a first output sample that is
+ * only known in Real, e.g. for negative start times.
+ */
+template <typename Real>
+void SetOutputPps(
+    FirstOrderDelayModelRegisterRawValues<Real> &fodm_reg_raw_values,
+    const FodmChannelConstants<Real> &constants,
+    const Real &current_output_timestamp_samples )
+{
+  typedef FodmNumericPolicy<Real> Policy;
+
+  // Note on casting the output_pps_samples:
+  // Needs the 64bit casting intermediate step with calculating output pps as 
+  // there are some issue casting double generated by ceil(start_ts_s) * output_sample_rate)
+  // directly to a uint32_t. It seems to become an unsigned interger max instead of
+  // the lower 32bits of the double.
+  uint64_t output_pps_samples_64bit = 
+    static_cast<uint64_t> (Policy::Ceil(current_output_timestamp_samples / constants.output_sample_rate) * 
+                                  constants.output_sample_rate);
+  
+  fodm_reg_raw_values.output_PPS = static_cast<uint32_t> (output_pps_samples_64bit & 0xffffffff);
+}
+
+/**
+ * Calculates the values to be written to the first order delay model
+ * registers.
+ *
+ * fo_poly: FO delay model to write
+ * constants: the values derived from the sample rates and frequency shifts,
+ *            see CalcFodmChannelConstants
+ */
+template <typename Real>
+FirstOrderDelayModelRegisterRawValues<Real> CalcFodmRegisterRawValues(
+    const FoPoly &fo_poly,
+    const FodmChannelConstants<Real> &constants )
+{
+  typedef FodmNumericPolicy<Real> Policy;
+
+  // FO polynomial start/stop time, measured from the SKA epoch
+  Real start_ts_s  = MS_TO_SECONDS(Real(fo_poly.start_time_ms));
+  Real stop_ts_s   = MS_TO_SECONDS(Real(fo_poly.stop_time_ms));
+
+  // Calculate output_timestamp_samples_f,  used to populate the 
+  // first_output_timestamp FPGA register field:
+  Real output_timestamp_samples_f = constants.output_sample_rate_f * start_ts_s; 
+
+  // the output sample closest to the FO poly start time
+  Real current_output_timestamp_samples = Policy::Floor(output_timestamp_samples_f);
+
+  Real next_output_timestamp_samples = Real(Policy::Floor(stop_ts_s * constants.output_sample_rate_f));
+
+  FirstOrderDelayModelRegisterRawValues<Real> fodm_reg_raw_values = CalcFodmRegisterRawValues(
+    fo_poly, constants, current_output_timestamp_samples, next_output_timestamp_samples);
+
+  SetOutputPps(fodm_reg_raw_values, constants, current_output_timestamp_samples);
+  fodm_reg_raw_values.first_output_timestamp = static_cast<uint64_t>(current_output_timestamp_samples);
+  return fodm_reg_raw_values;
+}
+
+/**
+ * Calculates the values to be written to the first order delay model
+ * registers, with the output timestamps precomputed.
+ *
+ * fo_poly: FO delay model to write
+ * timestamps: the output timestamps of fo_poly, see FodmSequence
+ * constants: the values derived from the sample rates and frequency shifts,
+ *            see CalcFodmChannelConstants
+ */
+template <typename Real>
+FirstOrderDelayModelRegisterRawValues<Real> CalcFodmRegisterRawValues(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    const FodmChannelConstants<Real> &constants )
+{
+  FirstOrderDelayModelRegisterRawValues<Real> fodm_reg_raw_values = CalcFodmRegisterRawValues(
+    fo_poly, constants, Real(timestamps.current), Real(timestamps.next));
+
+  // The fields that only depend on the timestamps, in integers
+  fodm_reg_raw_values.validity_period = static_cast<uint32_t>(timestamps.next - timestamps.current);
+  if (!CalcFodmOutputPps(timestamps.current, constants.output_sample_rate, fodm_reg_raw_values.output_PPS))
+  {
+    SetOutputPps(fodm_reg_raw_values, constants, Real(timestamps.current));
+  }
+  fodm_reg_raw_values.first_output_timestamp = timestamps.current;
+  return fodm_reg_raw_values;
+}
+
+/**
+ * Calculates the values to be written to the first order delay model
+ * registers.
+ *
+ * fo_poly: FO delay model to write
+ * constants: the values derived from the sample rates and frequency shifts,
+ *            see CalcFodmChannelConstants
+ * current_output_timestamp_samples: floor(start time * output sample rate)
+ * next_output_timestamp_samples: floor(stop time * output sample rate)
+ *
+ * The calculation is done in the floating point type Real, e.g.
+ * cpp_bin_float_50 or quad_float, with the functions from FodmNumericPolicy.
+ *
+ * Description:
+ * Reference [R1]: Derivation of First Order Delay/Phase Polynomials for the
+ *                 Mid.CBF ReSampler, by Thushara Gunaratne, Ver.1.0-2021-07-15
+ *
+ */
+template <typename Real>
+FirstOrderDelayModelRegisterRawValues<Real> CalcFodmRegisterRawValues(
+    const FoPoly &fo_poly,
+    const FodmChannelConstants<Real> &constants,
+    const Real &current_output_timestamp_samples,
+    const Real &next_output_timestamp_samples )
+{
+  FODM_METRICS_TIME_STAGE(FodmStage::RawValues);
+  typedef FodmNumericPolicy<Real> Policy;
+
   // Note: fo_poly defines the time delay D(.) to be applied to the signal data 
   // as a linear function of time, D(t) = a * t + b, t in [Tk, Tk+1),  where:
   // fo_poly.poly[0]  = a, units: [ns/s] (a = dD, the rate of change of D(.))  
@@ -193,114 +1075,70 @@ FirstOrderDelayModelRegisterRawValues CalcFodmRegisterRawValues(
   //             to be; however, there might be an implicit assumption that 
   //             T0 = ho_start.
 
-  // FO polynomial start time, measured from the start of the HO poly from which this FO has been derived (in seconds):
-  cpp_bin_float_50 ho_start_ts_s = MS_TO_SECONDS(fo_poly.ho_poly_start_time_ms);
-  
-  // FO polynomial start/stop time, measured from the SKA epoch
-  cpp_bin_float_50 start_ts_s  = MS_TO_SECONDS(fo_poly.start_time_ms);
-  cpp_bin_float_50 stop_ts_s   = MS_TO_SECONDS(fo_poly.stop_time_ms);
-
   // Renaming, for readability:
-  cpp_bin_float_50 fo_delay_linear   = NS_TO_SECONDS(fo_poly.poly[0]); // nondimensional
-  cpp_bin_float_50 fo_delay_constant = NS_TO_SECONDS(fo_poly.poly[1]); // [s]
+  Real fo_delay_linear   = NS_TO_SECONDS(Real(fo_poly.poly[0])); // nondimensional
+  Real fo_delay_constant = NS_TO_SECONDS(Real(fo_poly.poly[1])); // [s]
 
   // Calculate the 'double' version of the FPGA register fields
   // delay_linear and delay_constant (measured in samples):
 
   // Note correction of delay_linear w.r.t. the previous version, to agree with
   // the json file definition:
-  cpp_bin_float_50 input_sample_rate_f(input_sample_rate);
-  cpp_bin_float_50 output_sample_rate_f(output_sample_rate);
-  cpp_bin_float_50 resampling_rate = input_sample_rate_f / output_sample_rate_f;
-  cpp_bin_float_50 delay_linear   = resampling_rate + fo_delay_linear;
-
-  // Calculate delay_linear_scaled here, since it is required in the
-  // delay_linear_error_samples calculation below:
-  // Need to be cast to int before writing to the register
-  // using boost::math::round;
-  cpp_bin_float_50 delay_linear_scaled = round(delay_linear * pow(2, 63));
-
-  // Calculate output_timestamp_samples_f,  used to populate the 
-  // first_output_timestamp FPGA register field:
-  cpp_bin_float_50 output_timestamp_samples_f = output_sample_rate_f * start_ts_s; 
-
-  // the output sample closest to the FO poly start time
-  cpp_bin_float_50 current_output_timestamp_samples = floor(output_timestamp_samples_f);
-
-  cpp_bin_float_50 next_output_timestamp_samples = cpp_bin_float_50(floor(stop_ts_s * output_sample_rate_f));
+  const Real& input_sample_rate_f = constants.input_sample_rate_f;
+  const Real& output_sample_rate_f = constants.output_sample_rate_f;
+  const Real& resampling_rate = constants.resampling_rate;
+  Real delay_linear   = resampling_rate + fo_delay_linear;
 
   // FO validity interval (measured in output samples)
   // Note: implicit assumption that the FO polynomial validity intervals do
   //       not overlap; currently this assumption holds true. (Otherwise, the 
   //       definition of the validity interval FPGA register would imply that 
   //       samples in the overlap would be output twice.)
-  cpp_bin_float_50  validity_interval_samples = 
+  Real validity_interval_samples = 
     next_output_timestamp_samples - current_output_timestamp_samples;
 
   // As an extra refinement, remove a v. small amount of delay, so that to hit 
   // zero resampling error in the middle of the FODM instead of only at the end
   // giving an overall positive delay error.
- 
-  // Apply  /2 to fo_delay_constant (in samps):
-  cpp_bin_float_50 delay_linear_unscaled = delay_linear_scaled * cpp_bin_float_50(pow(2,-63));
-  cpp_bin_float_50 delay_linear_error_samples = 
-    delay_linear_unscaled * validity_interval_samples - delay_linear * validity_interval_samples;
-    
   #ifdef DISABLE_DELAY_LINEAR_ERROR
-    delay_linear_error_samples = 0;
+    Real delay_linear_error_samples = 0;
+  #else
+    // Calculate delay_linear_scaled here, since it is required in the
+    // delay_linear_error_samples calculation below:
+    // Need to be cast to int before writing to the register
+    // using boost::math::round;
+    Real delay_linear_scaled = Policy::Round(delay_linear * Real(TWO_POW_63));
+
+    // Apply  /2 to fo_delay_constant (in samps):
+    Real delay_linear_unscaled = delay_linear_scaled / Real(TWO_POW_63);
+    Real delay_linear_error_samples = 
+      delay_linear_unscaled * validity_interval_samples - delay_linear * validity_interval_samples;
   #endif
 
-  cpp_bin_float_50 delay_constant_input_samps = 
+  Real delay_constant_input_samps = 
     fo_delay_constant * input_sample_rate_f - delay_linear_error_samples / 2;
 
   // Calculate the integer and fractional part of first_input_timestamp_fractional_samples;
   // (See the definitions of the first_input_timestamp and delay_constant fields 
   // in the FPGA JSON interface file first_order_delay_models.json.) 
   // This calculation was updated to align with talon_FSP.py in the HW notebooks. 
-  cpp_bin_float_50 current_input_timestamp_samples = resampling_rate * current_output_timestamp_samples;
-  cpp_bin_float_50 first_input_timestamp_fractional_samples = current_input_timestamp_samples + delay_constant_input_samps;
+  Real current_input_timestamp_samples = resampling_rate * current_output_timestamp_samples;
+  Real first_input_timestamp_fractional_samples = current_input_timestamp_samples + delay_constant_input_samps;
 
   uint64_t first_input_timestamp_samples_int  = static_cast<uint64_t>(first_input_timestamp_fractional_samples);
-  cpp_bin_float_50 delay_constant = first_input_timestamp_fractional_samples - first_input_timestamp_samples_int;
-
-  cpp_bin_float_50 delay_constant_scaled = round(delay_constant * cpp_bin_float_50(pow(2, 32)));
+  Real delay_constant = first_input_timestamp_fractional_samples - first_input_timestamp_samples_int;
 
   // -------------------------------------------------------------------------
-  // Initialize parameters for First Order Phase Polynomials (FOPP) calculation
+  // First Order Phase Polynomials (FOPP) calculation. The sign conventions 
+  // of the frequency shifts are applied in CalcFodmChannelConstants.
 
-  // Mapping between the C++ variable names and the [R1] notations: 
-  // fs_index         = FSI
-  // freq_down_shift  = F_DS
-  // freq_wb_shift    = F_WB
-  // freq_align_shift = F_AS
-  // freq_scfo_shift  = F_SCFO
-  // vcc_os_factor    = OS
-
-  // temporary flag; TODO remove when confirmed:
-  bool use_tech_note_formula = false; 
-  if (use_tech_note_formula)
-  {
-    // In the HW test notebooks (talon_FSP.py) freq_down_shift has opposite sign
-    // This may have to do with the selected sign convention. in [R1] it was 
-    // assumed F_DS is positive when decreased (i.e. down-shift), 
-    // whereas Wideband-Shift (F_WB) is positive when increased. 
-    freq_down_shift = -freq_down_shift;
-  }
-
-  // -----------------------------------------------------------------------
-
-  // SKB-640: After testing with tones inserted by BITE, it's found that
-  //          the sign of alignment shift needs to be flipped for
-  //          the tones to appear at the expected frequencies.
-  freq_align_shift = -freq_align_shift;
-  
   // Calculate phase_linear_temp and phase_constant_temp of the FOPP 
   // ([R1] eq. 4, 5);
   // Note that the 2*PI factor from R1 eq. 4, 5 is not applied here, nor the 
   // mod(*, 2*PI) for phase_constant:
-  cpp_bin_float_50 f_wb_ds = cpp_bin_float_50(freq_wb_shift - freq_down_shift);
-  cpp_bin_float_50 f_scfo_as = cpp_bin_float_50(freq_scfo_shift + freq_align_shift);
-  cpp_bin_float_50 phase_linear_temp = 
+  const Real& f_wb_ds = constants.f_wb_ds;
+  const Real& f_scfo_as = constants.f_scfo_as;
+  Real phase_linear_temp = 
     (f_scfo_as + f_wb_ds * fo_delay_linear) / output_sample_rate_f;
 
   // Calculate the time_factor, as per  [R1] eq. 5:
@@ -318,14 +1156,16 @@ FirstOrderDelayModelRegisterRawValues CalcFodmRegisterRawValues(
   // TODO: it is unclear why time factor should be relative to the SKA epoch, further 
   // investigation may be needed. 
   //
-  cpp_bin_float_50 time_factor =  start_ts_s; 
+  // floor(start_ts_s * output_sample_rate_f) is the current output timestamp
+  Real time_factor = current_output_timestamp_samples; 
 
   bool use_tech_note_kT1_defn = false;
   if (use_tech_note_kT1_defn) {
-    time_factor = start_ts_s - ho_start_ts_s;
+    // FO polynomial start time, measured from the start of the HO poly from which this FO has been derived (in seconds):
+    Real ho_start_ts_s = MS_TO_SECONDS(Real(fo_poly.ho_poly_start_time_ms));
+    Real start_ts_s = MS_TO_SECONDS(Real(fo_poly.start_time_ms));
+    time_factor = Policy::Floor((start_ts_s - ho_start_ts_s) * output_sample_rate_f);
   }
-
-  time_factor = floor(time_factor * output_sample_rate_f);
   
   // Calculate phase_constant_temp (see [R1] eq. 5):
   // Note: in [R1] the FODMs have a common start time. But the generated FODMs are evaluated
@@ -339,17 +1179,17 @@ FirstOrderDelayModelRegisterRawValues CalcFodmRegisterRawValues(
   // 
   // phase_constant = kT1Pv * (F_SCFO + F_AS) / output_sample_rate + (F_WB - F_DS) * fo_delay_const
   //
-  cpp_bin_float_50 phase_constant_temp = 
+  Real phase_constant_temp = 
     time_factor * f_scfo_as / output_sample_rate_f + f_wb_ds * fo_delay_constant;
   
   // Take mod of phase_linear_temp and phase_constant_temp to get to the final value
-  cpp_bin_float_50 phase_linear   = mod_pmhalf(phase_linear_temp);
-  cpp_bin_float_50 phase_constant = mod_pmhalf(phase_constant_temp); 
+  Real phase_linear   = mod_pmhalf(phase_linear_temp);
+  Real phase_constant = mod_pmhalf(phase_constant_temp); 
    
 #ifdef PRINT_INTERMEDIATE_VALUES
   std::cout << std::setprecision(26) 
-    << "start_ts_s = " << start_ts_s << std::endl
-    << "stop_ts_s = " << stop_ts_s << std::endl
+    << "start_time_ms = " << fo_poly.start_time_ms << std::endl
+    << "stop_time_ms = " << fo_poly.stop_time_ms << std::endl
     << "fo_delay_linear = " << fo_delay_linear << std::endl
     << "fo_delay_constant = " << fo_delay_constant << std::endl
     << "delay_linear = " << delay_linear << std::endl
@@ -357,7 +1197,9 @@ FirstOrderDelayModelRegisterRawValues CalcFodmRegisterRawValues(
     << "current_output_timestamp_samples = " << current_output_timestamp_samples << std::endl
     << "next_output_timestamp_samples = " << next_output_timestamp_samples << std::endl
     << "validity_interval_samples = " << validity_interval_samples << std::endl
+#ifndef DISABLE_DELAY_LINEAR_ERROR
     << "delay_linear_scaled = " << delay_linear_scaled << std::endl
+#endif
     << "phase_linear_temp = " << phase_linear_temp << std::endl
     << "phase_constant_temp = " << phase_constant_temp << std::endl 
     << "phase_linear_mod = " << phase_linear << std::endl
@@ -367,7 +1209,7 @@ FirstOrderDelayModelRegisterRawValues CalcFodmRegisterRawValues(
 
   // -------------------------------------------------------------------------
 
-  FirstOrderDelayModelRegisterRawValues fodm_reg_raw_values;
+  FirstOrderDelayModelRegisterRawValues<Real> fodm_reg_raw_values;
 
   // First input timestamp. Need to add back the offset in input samples.
   //   buf.last_fo_timestamp_in_buffer = first_input_timestamp_samples_int;
@@ -388,58 +1230,87 @@ FirstOrderDelayModelRegisterRawValues CalcFodmRegisterRawValues(
 
   fodm_reg_raw_values.validity_period = static_cast<uint32_t>(validity_interval_samples);
 
-  // PPS
-  // Note on casting the output_pps_samples:
-  // Needs the 64bit casting intermediate step with calculating output pps as 
-  // there are some issue casting double generated by ceil(start_ts_s) * output_sample_rate)
-  // directly to a uint32_t. It seems to become an unsigned interger max instead of
-  // the lower 32bits of the double.
-  uint64_t output_pps_samples_64bit = 
-    static_cast<uint64_t> (ceil(current_output_timestamp_samples / output_sample_rate) * 
-                                  output_sample_rate);
-  
-  fodm_reg_raw_values.output_PPS = static_cast<uint32_t> (output_pps_samples_64bit & 0xffffffff);
-
-  // First output timestamp
-  fodm_reg_raw_values.first_output_timestamp = static_cast<uint64_t>(current_output_timestamp_samples);
+  // output_PPS and first_output_timestamp only depend on the timestamps and
+  // are set by the callers
 
   return fodm_reg_raw_values;
 }
 
 
-FirstOrderDelayModelRegisterValues RawToRegisterValues(
-    const FirstOrderDelayModelRegisterRawValues& raw_values)
+// The raw value of a fixed point register field
+template <typename Real>
+const Real& ScaledRawValue(
+    const FirstOrderDelayModelRegisterRawValues<Real>& raw_values,
+    FodmScaledValue value)
 {
-  FirstOrderDelayModelRegisterValues values;
+  switch (value)
+  {
+  case FodmScaledValue::DelayConstant: return raw_values.delay_constant;
+  case FodmScaledValue::DelayLinear: return raw_values.delay_linear;
+  case FodmScaledValue::PhaseConstant: return raw_values.phase_constant;
+  default: return raw_values.phase_linear;
+  }
+}
+
+// Quantizes the raw values to the fixed point fields kField and after of
+// the FodmRegisterFormat of RegisterValues. The field widths and scales are
+// template arguments of the conversion, so each field compiles to its own
+// scaling and rounding.
+template <typename Real, typename RegisterValues, int kField = 0>
+struct FodmRegisterQuantizer
+{
+  static void Quantize(
+      const FirstOrderDelayModelRegisterRawValues<Real>& raw_values,
+      RegisterValues& values)
+  {
+    typedef FodmNumericPolicy<Real> Policy;
+    constexpr FodmRegisterField field = FodmRegisterFormatOf<RegisterValues>::format().fields[kField];
+    typedef typename FodmRegisterFieldInt<field.width, field.is_signed>::type Int;
+    Int value = Policy::template ToInt<Int, field.scale_exponent>(ScaledRawValue(raw_values, field.value));
+    std::memcpy(reinterpret_cast<unsigned char*>(&values) + field.offset, &value, sizeof(value));
+    FodmRegisterQuantizer<Real, RegisterValues, kField + 1>::Quantize(raw_values, values);
+  }
+};
+
+template <typename Real, typename RegisterValues>
+struct FodmRegisterQuantizer<Real, RegisterValues, FODM_NUM_SCALED_VALUES>
+{
+  static void Quantize(
+      const FirstOrderDelayModelRegisterRawValues<Real>&,
+      RegisterValues&)
+  {
+  }
+};
+
+// Converts the raw values to the register values of any register version
+template <typename RegisterValues, typename Real>
+RegisterValues QuantizeRegisterValues(
+    const FirstOrderDelayModelRegisterRawValues<Real>& raw_values)
+{
+  FODM_METRICS_TIME_STAGE(FodmStage::RegisterValues);
+  RegisterValues values;
   values.first_input_timestamp = raw_values.first_input_timestamp;
-  values.delay_constant = ToInt<uint32_t, cpp_bin_float_50>(raw_values.delay_constant, cpp_bin_float_50(pow(2,32)));
-  values.delay_linear = ToInt<uint64_t, cpp_bin_float_50>(raw_values.delay_linear, cpp_bin_float_50(pow(2,63)));
-  values.phase_constant = ToInt<int32_t, cpp_bin_float_50>(raw_values.phase_constant, cpp_bin_float_50(pow(2,31)));
-  values.phase_linear = ToInt<int64_t, cpp_bin_float_50>(raw_values.phase_linear, cpp_bin_float_50(pow(2,63)));
+  FodmRegisterQuantizer<Real, RegisterValues>::Quantize(raw_values, values);
   // Fill in as per FPGA register definition: "The number of output samples 
   // that should be output for this FODM less 1"
   values.validity_period = raw_values.validity_period - 1;
   values.output_PPS = raw_values.output_PPS;
   values.first_output_timestamp = raw_values.first_output_timestamp;
   return values;
+}
 
+template <typename Real>
+FirstOrderDelayModelRegisterValues RawToRegisterValues(
+    const FirstOrderDelayModelRegisterRawValues<Real>& raw_values)
+{
+  return QuantizeRegisterValues<FirstOrderDelayModelRegisterValues>(raw_values);
 }
 
+template <typename Real>
 FirstOrderDelayModelRegisterValuesVer1 RawToRegisterValuesV1(
-    const FirstOrderDelayModelRegisterRawValues& raw_values)
+    const FirstOrderDelayModelRegisterRawValues<Real>& raw_values)
 {
-  FirstOrderDelayModelRegisterValuesVer1 values;
-  values.first_input_timestamp = raw_values.first_input_timestamp;
-  values.delay_constant = ToInt<uint32_t, cpp_bin_float_50>(raw_values.delay_constant, cpp_bin_float_50(pow(2,32)));
-  values.delay_linear = ToInt<uint32_t, cpp_bin_float_50>(raw_values.delay_linear, cpp_bin_float_50(pow(2,31)));
-  values.phase_constant = ToInt<int32_t, cpp_bin_float_50>(raw_values.phase_constant, cpp_bin_float_50(pow(2,31)));
-  values.phase_linear = ToInt<int32_t, cpp_bin_float_50>(raw_values.phase_linear, cpp_bin_float_50(pow(2,31)));
-  // Fill in as per FPGA register definition: "The number of output samples 
-  // that should be output for this FODM less 1"
-  values.validity_period = raw_values.validity_period - 1;
-  values.output_PPS = raw_values.output_PPS;
-  values.first_output_timestamp = raw_values.first_output_timestamp;
-  return values;
+  return QuantizeRegisterValues<FirstOrderDelayModelRegisterValuesVer1>(raw_values);
 }
 
 }; // namespace ska_mid_cbf_fodm_gen
\ No newline at end of file
@@ -1,14 +1,18 @@
 #ifndef CALC_FODM_REG_VALUES_H
 #define CALC_FODM_REG_VALUES_H
 
+#include <cstddef>
 #include <cstdint>
 #include <cmath>
+#include <memory>
 
 #include "DelayModelStore.h"
 
 namespace ska_mid_cbf_fodm_gen
 {
 
+class ThreadPool;
+
 // The version 2+ First Order Delay Models register
 struct FirstOrderDelayModelRegisterValues
 {
@@ -36,6 +40,86 @@ struct FirstOrderDelayModelRegisterValuesVer1
     uint64_t first_output_timestamp;
 };
 
+// The first output sample of a FODM and of the FODM after it, i.e.
+// floor(start_time_ms / 1000 * output_sample_rate) and the same for
+// stop_time_ms. See FodmSequence.
+struct FodmOutputTimestamps
+{
+    uint64_t current;
+    uint64_t next;
+};
+
+// The output_PPS register field of a FODM whose first output sample is
+// current_output_timestamp: the next whole second in output samples,
+// modulo 2^32. Returns false if that sample does not fit in 64 bits.
+bool CalcFodmOutputPps(
+    uint64_t current_output_timestamp,
+    uint32_t output_sample_rate,
+    uint32_t &output_pps );
+
+// The arithmetic used to calculate the register values
+enum class FodmCalcEngine
+{
+    // The engine selected at build time with FODM_DEFAULT_CALC_ENGINE
+    Default,
+    // cpp_bin_float_50 multi-precision floating point
+    MultiPrecision,
+    // Exact integer arithmetic, see CalcFodmRegisterValuesFixedPoint.h.
+    // Falls back to MultiPrecision for inputs outside of its range.
+    FixedPoint,
+    // IEEE quad precision (113 bit significand) floating point: __float128
+    // with libquadmath, or long double where it is quad precision (armv8).
+    // Uses MultiPrecision if neither is available.
+    Float128,
+    // Double-double floating point with a rigorous error bound, see
+    // CalcFodmRegisterValuesDoubleDouble.h. Falls back to MultiPrecision
+    // for the values too close to a rounding boundary to certify.
+    DoubleDouble
+};
+
+// The sample rates and frequency shifts of a RDT channel, which are fixed
+// for a scan, with the values of the register calculation that only depend
+// on them precomputed for the selected engine. See the CalcFodmRegisterValues
+// overloads taking a RdtChannelContext.
+//
+// The precomputed values are immutable and shared between copies, so the
+// context is cheap to copy and can be used by several threads at once.
+class RdtChannelContext
+{
+public:
+    RdtChannelContext(
+        uint32_t input_sample_rate,
+        uint32_t output_sample_rate,
+        double freq_down_shift,
+        double freq_align_shift,
+        double freq_wb_shift,
+        double freq_scfo_shift,
+        FodmCalcEngine engine = FodmCalcEngine::Default );
+
+    uint32_t input_sample_rate() const { return input_sample_rate_; }
+    uint32_t output_sample_rate() const { return output_sample_rate_; }
+    double freq_down_shift() const { return freq_down_shift_; }
+    double freq_align_shift() const { return freq_align_shift_; }
+    double freq_wb_shift() const { return freq_wb_shift_; }
+    double freq_scfo_shift() const { return freq_scfo_shift_; }
+    // The engine used, FodmCalcEngine::Default resolved to the build default
+    FodmCalcEngine engine() const { return engine_; }
+
+    // Precomputed values, defined in CalcFodmRegisterValues.cpp
+    struct Constants;
+    const Constants &constants() const { return *constants_; }
+
+private:
+    uint32_t input_sample_rate_;
+    uint32_t output_sample_rate_;
+    double freq_down_shift_;
+    double freq_align_shift_;
+    double freq_wb_shift_;
+    double freq_scfo_shift_;
+    FodmCalcEngine engine_;
+    std::shared_ptr<const Constants> constants_;
+};
+
 // Calculates the FODM register values for
 // register version 2 and higher.
 FirstOrderDelayModelRegisterValues CalcFodmRegisterValues( 
@@ -45,7 +129,8 @@ FirstOrderDelayModelRegisterValues CalcFodmRegisterValues(
     double freq_down_shift,
     double freq_align_shift,
     double freq_wb_shift,
-    double freq_scfo_shift );
+    double freq_scfo_shift,
+    FodmCalcEngine engine = FodmCalcEngine::Default );
 
 // Calculates the FODM register values for
 // register version 1.
@@ -56,7 +141,163 @@ FirstOrderDelayModelRegisterValuesVer1 CalcFodmRegisterValuesV1(
     double freq_down_shift,
     double freq_align_shift,
     double freq_wb_shift,
-    double freq_scfo_shift );
+    double freq_scfo_shift,
+    FodmCalcEngine engine = FodmCalcEngine::Default );
+
+// Same as above, with the output timestamps of fo_poly precomputed,
+// e.g. by FodmSequence. The results are identical when the timestamps
+// are the ones calculated from the FODM start and stop times.
+FirstOrderDelayModelRegisterValues CalcFodmRegisterValues( 
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FodmCalcEngine engine = FodmCalcEngine::Default );
+
+FirstOrderDelayModelRegisterValuesVer1 CalcFodmRegisterValuesV1(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FodmCalcEngine engine = FodmCalcEngine::Default );
+
+// Calculates the FODM register values for register version 2 and 
+// higher for num_fo_poly FODMs sharing the same sample rates and 
+// frequency shifts. The results are written to reg_values, which must 
+// have room for num_fo_poly elements. The output timestamps of
+// consecutive FODMs are advanced with a FodmSequence.
+void CalcFodmRegisterValues(
+    const FoPoly *fo_poly,
+    size_t num_fo_poly,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValues *reg_values,
+    FodmCalcEngine engine = FodmCalcEngine::Default );
+
+// Calculates the FODM register values for register version 1
+// for num_fo_poly FODMs sharing the same sample rates and 
+// frequency shifts. The results are written to reg_values, which must 
+// have room for num_fo_poly elements.
+void CalcFodmRegisterValuesV1(
+    const FoPoly *fo_poly,
+    size_t num_fo_poly,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValuesVer1 *reg_values,
+    FodmCalcEngine engine = FodmCalcEngine::Default );
+
+// Calculates the FODM register values for register version 2 and higher
+// with the per channel values precomputed in ctx.
+FirstOrderDelayModelRegisterValues CalcFodmRegisterValues(
+    const RdtChannelContext &ctx,
+    const FoPoly &fo_poly );
+
+// Calculates the FODM register values for register version 1
+// with the per channel values precomputed in ctx.
+FirstOrderDelayModelRegisterValuesVer1 CalcFodmRegisterValuesV1(
+    const RdtChannelContext &ctx,
+    const FoPoly &fo_poly );
+
+// Same as above, with the output timestamps of fo_poly precomputed.
+FirstOrderDelayModelRegisterValues CalcFodmRegisterValues(
+    const RdtChannelContext &ctx,
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps );
+
+FirstOrderDelayModelRegisterValuesVer1 CalcFodmRegisterValuesV1(
+    const RdtChannelContext &ctx,
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps );
+
+// The batch functions above, for the channel of ctx.
+void CalcFodmRegisterValues(
+    const RdtChannelContext &ctx,
+    const FoPoly *fo_poly,
+    size_t num_fo_poly,
+    FirstOrderDelayModelRegisterValues *reg_values );
+
+void CalcFodmRegisterValuesV1(
+    const RdtChannelContext &ctx,
+    const FoPoly *fo_poly,
+    size_t num_fo_poly,
+    FirstOrderDelayModelRegisterValuesVer1 *reg_values );
+
+// The batch functions above, with ranges of FODMs calculated in parallel
+// on the threads of pool. The results are identical.
+void CalcFodmRegisterValues(
+    const RdtChannelContext &ctx,
+    const FoPoly *fo_poly,
+    size_t num_fo_poly,
+    FirstOrderDelayModelRegisterValues *reg_values,
+    ThreadPool &pool );
+
+void CalcFodmRegisterValuesV1(
+    const RdtChannelContext &ctx,
+    const FoPoly *fo_poly,
+    size_t num_fo_poly,
+    FirstOrderDelayModelRegisterValuesVer1 *reg_values,
+    ThreadPool &pool );
+
+// The register versions of CalcFodmRegisterVersions, bit n of the mask for
+// register version n
+const uint32_t FODM_REGISTER_V1 = 1u << 1;
+const uint32_t FODM_REGISTER_V2 = 1u << 2;
+
+// The register values of a FODM for several register versions. Only the
+// versions requested from CalcFodmRegisterVersions are set.
+struct FodmRegisterVersionValues
+{
+    FirstOrderDelayModelRegisterValuesVer1 v1;
+    FirstOrderDelayModelRegisterValues v2;
+};
+
+// Calculates the FODM register values of every register version in the
+// versions mask with the per channel values precomputed in ctx, e.g. for a
+// fleet with both versions of the firmware. The register values are
+// calculated once and quantized to each version, see FodmRegisterFormat.h,
+// and are identical to those of CalcFodmRegisterValuesV1 and
+// CalcFodmRegisterValues.
+//
+// Example:
+//   FodmRegisterVersionValues values;
+//   CalcFodmRegisterVersions(ctx, fo_poly, FODM_REGISTER_V1 | FODM_REGISTER_V2, values);
+void CalcFodmRegisterVersions(
+    const RdtChannelContext &ctx,
+    const FoPoly &fo_poly,
+    uint32_t versions,
+    FodmRegisterVersionValues &values );
+
+// Same as above, with the output timestamps of fo_poly precomputed.
+void CalcFodmRegisterVersions(
+    const RdtChannelContext &ctx,
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t versions,
+    FodmRegisterVersionValues &values );
+
+// The batch version of the above, see the batch CalcFodmRegisterValues.
+void CalcFodmRegisterVersions(
+    const RdtChannelContext &ctx,
+    const FoPoly *fo_poly,
+    size_t num_fo_poly,
+    uint32_t versions,
+    FodmRegisterVersionValues *values );
 
 // Used to convert floating point values to integer values.
 template <typename T, typename U>
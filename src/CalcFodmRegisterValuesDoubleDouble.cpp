@@ -0,0 +1,567 @@
+#include "CalcFodmRegisterValuesDoubleDouble.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "CalcFodmRegisterValuesFixedPoint.h"
+#include "DoubleDouble.h"
+#include "FodmRegisterFormat.h"
+
+#ifndef DISABLE_DELAY_LINEAR_ERROR
+#error "The DoubleDouble engine does not apply the delay_linear_error_samples, see FodmRegisterFormat.h"
+#endif
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+namespace
+{
+
+const double NS_PER_SECOND = 1.0e9;
+
+// Bound on the relative error of the double-double value of each
+// quantity. The few operators of DoubleDouble.h used for each one have a
+// relative error of ~2^-104 each, and the long double delays have at most
+// 64 or 113 bits, so 2^-96 leaves a wide margin.
+const double DD_ERROR = 1.0 / (uint64_t(1) << 48) / (uint64_t(1) << 48);
+
+// Bound on the relative error of the multi-precision calculation, whose
+// values are rounded to 168 bits a few times.
+const double MP_ERROR = DD_ERROR / (uint64_t(1) << 54);
+
+// Largest magnitude accepted for the delays and frequency shifts, so that
+// the products below stay far from overflow
+const double MAX_INPUT = static_cast<double>(uint64_t(1) << 62);
+
+// A value calculated in double-double, with a bound on its difference from
+// the exact value and from the value of the multi-precision calculation
+struct BoundedValue
+{
+    DoubleDouble value;
+    double error;
+};
+
+// The double-double counterpart of FirstOrderDelayModelRegisterRawValues
+struct FirstOrderDelayModelRegisterBoundedValues
+{
+    uint64_t first_input_timestamp;
+    BoundedValue delay_constant;
+    BoundedValue phase_constant;
+    BoundedValue delay_linear;
+    BoundedValue phase_linear;
+    uint32_t validity_period;
+    uint32_t output_PPS;
+    uint64_t first_output_timestamp;
+};
+
+double Magnitude(const DoubleDouble& val)
+{
+    return std::fabs(val.hi);
+}
+
+// val as a double-double, to within a relative error of 2^-106 when long
+// double has more than 106 bits. Returns false for inf, nan and values
+// out of range.
+bool ToDoubleDouble(long double val, DoubleDouble& res)
+{
+    if (!(std::fabs(val) < MAX_INPUT))
+    {
+        return false;
+    }
+    double hi = static_cast<double>(val);
+    res = FastTwoSum(hi, static_cast<double>(val - hi));
+    return true;
+}
+
+// val as a double-double, exactly. Both 32 bit halves are exact doubles.
+DoubleDouble ToDoubleDouble(uint64_t val)
+{
+    return TwoSum(static_cast<double>(val & ~uint64_t(0xffffffff)), static_cast<double>(val & 0xffffffff));
+}
+
+// Splits the double val into sign * mant * 2^exp, mant odd or 0.
+// Returns false for inf and nan.
+bool Decompose(double val, bool& negative, uint64_t& mant, int& exp)
+{
+    if (!std::isfinite(val))
+    {
+        return false;
+    }
+    int val_exp;
+    double frac = std::frexp(std::fabs(val), &val_exp);
+    negative = val < 0;
+    mant = static_cast<uint64_t>(std::ldexp(frac, 53));
+    exp = val_exp - 53;
+    if (mant != 0)
+    {
+        int zeros = __builtin_ctzll(mant);
+        mant >>= zeros;
+        exp += zeros;
+    }
+    return true;
+}
+
+// floor(val), as the integer valued double-double whole, and the fraction
+// val - whole in [0, 1) with its error. Returns false if val is within its
+// error of an integer, where the floor of the exact or the multi-precision
+// value may be on the other side.
+bool CertifiedFloor(const BoundedValue& val, DoubleDouble& whole, BoundedValue& frac)
+{
+    double whole_hi = std::floor(val.value.hi);
+    double whole_lo = whole_hi == val.value.hi ? std::floor(val.value.lo) : 0.0;
+    frac.value = val.value + DoubleDouble{-whole_hi, -whole_lo};
+    if (frac.value.hi < 0)
+    {
+        frac.value = frac.value + DoubleDouble{1.0, 0.0};
+        whole_lo -= 1.0;
+    }
+    else if (frac.value.hi >= 1.0)
+    {
+        frac.value = frac.value + DoubleDouble{-1.0, 0.0};
+        whole_lo += 1.0;
+    }
+    whole = TwoSum(whole_hi, whole_lo);
+    frac.error = val.error + DD_ERROR * (Magnitude(val.value) + 1.0);
+
+    double margin = frac.error + std::fabs(frac.value.lo);
+    return frac.value.hi > margin && frac.value.hi < 1.0 - margin;
+}
+
+// The mod_pmhalf of the multi-precision calculation, val wrapped to
+// [-0.5, 0.5). Returns false if val is too close to the wrap boundary.
+bool CertifiedModPmHalf(BoundedValue& val)
+{
+    BoundedValue shifted = { val.value + DoubleDouble{0.5, 0.0}, val.error + DD_ERROR * (Magnitude(val.value) + 0.5) };
+    DoubleDouble whole;
+    BoundedValue frac;
+    if (!CertifiedFloor(shifted, whole, frac))
+    {
+        return false;
+    }
+    val.value = frac.value + DoubleDouble{-0.5, 0.0};
+    val.error = frac.error + DD_ERROR;
+    return true;
+}
+
+// Equivalent of ToInt, round(val * 2^scale_bits) rounding half away from
+// zero, converted to T. Returns false if the scaled value is too close to
+// a rounding boundary, or the result does not fit in T.
+template <typename T>
+bool ToIntCertified(const BoundedValue& val, int scale_bits, T& res)
+{
+    // The scaling is exact. |val| + 0.5 is floored, which is symmetric
+    // around 0 like the rounding.
+    const double scale = static_cast<double>(uint64_t(1) << scale_bits);
+    const bool negative = val.value.hi < 0;
+    DoubleDouble magnitude = negative ? -val.value : val.value;
+    BoundedValue scaled = { scale * magnitude + DoubleDouble{0.5, 0.0}, scale * val.error };
+    scaled.error += DD_ERROR * Magnitude(scaled.value);
+
+    DoubleDouble whole;
+    BoundedValue frac;
+    if (!CertifiedFloor(scaled, whole, frac) || !(whole.hi < static_cast<double>(uint64_t(1) << 63) * 2.0))
+    {
+        return false;
+    }
+    // 0 <= whole < 2^64, and |whole.lo| is at most half an ulp of whole.hi,
+    // so both parts convert exactly and their sum fits in 64 bits.
+    const uint64_t rounded = static_cast<uint64_t>(whole.hi) + static_cast<uint64_t>(static_cast<int64_t>(whole.lo));
+    const uint64_t limit = negative ? uint64_t(0) - static_cast<uint64_t>(std::numeric_limits<T>::min()) :
+        static_cast<uint64_t>(std::numeric_limits<T>::max());
+    if (rounded > limit)
+    {
+        return false;
+    }
+    res = static_cast<T>(negative ? uint64_t(0) - rounded : rounded);
+    return true;
+}
+
+/**
+ * Calculates the first order delay model register values in double-double
+ * with an error bound on each fractional value. Follows the same steps as
+ * the multi-precision CalcFodmRegisterRawValues, see the comments there
+ * for the meaning of each value. The output timestamps are given in
+ * timestamps, see CalcFodmOutputTimestamps.
+ *
+ * Returns false if a floor or wrap can't be certified, or the values are
+ * out of the supported range.
+ */
+bool CalcFodmRegisterBoundedValues(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterBoundedValues &bounded_values )
+{
+  if (input_sample_rate == 0 || output_sample_rate == 0)
+  {
+    return false;
+  }
+  const double input_sample_rate_f = input_sample_rate;
+  const double output_sample_rate_f = output_sample_rate;
+
+  // Timestamps in output samples
+  const uint64_t current_output_timestamp_samples = timestamps.current;
+  const uint64_t next_output_timestamp_samples = timestamps.next;
+  if (next_output_timestamp_samples < current_output_timestamp_samples ||
+      next_output_timestamp_samples - current_output_timestamp_samples > std::numeric_limits<uint32_t>::max())
+  {
+    return false;
+  }
+
+  DoubleDouble poly_linear, poly_const;
+  if (!ToDoubleDouble(fo_poly.poly[0], poly_linear) ||
+      !ToDoubleDouble(fo_poly.poly[1], poly_const))
+  {
+    return false;
+  }
+  const DoubleDouble fo_delay_linear = poly_linear / NS_PER_SECOND;
+  const DoubleDouble fo_delay_constant = poly_const / NS_PER_SECOND;
+
+  // delay_linear = input_sample_rate / output_sample_rate + poly[0] / 1e9
+  const DoubleDouble resampling_rate = DoubleDouble{input_sample_rate_f, 0.0} / output_sample_rate_f;
+  BoundedValue delay_linear;
+  delay_linear.value = resampling_rate + fo_delay_linear;
+  delay_linear.error = DD_ERROR * (Magnitude(resampling_rate) + Magnitude(fo_delay_linear));
+
+  // first_input_timestamp_fractional_samples =
+  //   resampling_rate * current_output_timestamp_samples + poly[1] / 1e9 * input_sample_rate
+  // The first term is split exactly into the whole samples and a remainder.
+  unsigned __int128 current_input_samples =
+    static_cast<unsigned __int128>(input_sample_rate) * current_output_timestamp_samples;
+  unsigned __int128 current_input_int = current_input_samples / output_sample_rate;
+  double current_input_rem =
+    static_cast<double>(static_cast<uint64_t>(current_input_samples - current_input_int * output_sample_rate));
+  DoubleDouble delay_constant_input_samps = input_sample_rate_f * fo_delay_constant;
+
+  BoundedValue first_input_frac;
+  first_input_frac.value = DoubleDouble{current_input_rem, 0.0} / output_sample_rate_f + delay_constant_input_samps;
+  first_input_frac.error = DD_ERROR * (1.0 + Magnitude(delay_constant_input_samps)) +
+    MP_ERROR * (static_cast<double>(current_input_int) + Magnitude(delay_constant_input_samps));
+
+  // delay_constant = the fractional part of first_input_timestamp_fractional_samples
+  DoubleDouble first_input_whole;
+  BoundedValue delay_constant;
+  if (!CertifiedFloor(first_input_frac, first_input_whole, delay_constant) ||
+      !(std::fabs(first_input_whole.hi) < static_cast<double>(uint64_t(1) << 63)))
+  {
+    return false;
+  }
+  __int128 first_input_int = static_cast<__int128>(current_input_int) +
+    static_cast<int64_t>(first_input_whole.hi) + static_cast<int64_t>(first_input_whole.lo);
+  if (first_input_int < 0 || first_input_int > std::numeric_limits<uint64_t>::max())
+  {
+    return false;
+  }
+
+  // The frequency shifts are combined in double precision, in the same way
+  // as the multi-precision calculation.
+  freq_align_shift = -freq_align_shift;
+  double f_wb_ds = freq_wb_shift - freq_down_shift;
+  double f_scfo_as = freq_scfo_shift + freq_align_shift;
+  if (!(std::fabs(f_wb_ds) < MAX_INPUT) || !(std::fabs(f_scfo_as) < MAX_INPUT))
+  {
+    return false;
+  }
+
+  // phase_linear = (f_scfo_as + f_wb_ds * poly[0] / 1e9) / output_sample_rate
+  DoubleDouble wb_ds_linear = f_wb_ds * fo_delay_linear;
+  BoundedValue phase_linear;
+  phase_linear.value = (DoubleDouble{f_scfo_as, 0.0} + wb_ds_linear) / output_sample_rate_f;
+  phase_linear.error = DD_ERROR * (std::fabs(f_scfo_as) + Magnitude(wb_ds_linear)) / output_sample_rate_f;
+  if (!CertifiedModPmHalf(phase_linear))
+  {
+    return false;
+  }
+
+  // time_factor = current_output_timestamp_samples
+  // phase_constant = time_factor * f_scfo_as / output_sample_rate + f_wb_ds * poly[1] / 1e9
+  // Only the first term modulo 1 matters, which is calculated exactly
+  // from f_scfo_as = mant_scfo_as * 2^exp_scfo_as.
+  bool scfo_as_negative;
+  uint64_t mant_scfo_as;
+  int exp_scfo_as;
+  if (!Decompose(f_scfo_as, scfo_as_negative, mant_scfo_as, exp_scfo_as) ||
+      exp_scfo_as >= 64 || exp_scfo_as < -64)
+  {
+    return false;
+  }
+  unsigned __int128 scfo_as_time =
+    static_cast<unsigned __int128>(current_output_timestamp_samples) * mant_scfo_as;
+  DoubleDouble scfo_as_turns;
+  if (exp_scfo_as >= 0)
+  {
+    // frac(scfo_as_time * 2^exp / output_sample_rate)
+    unsigned __int128 rem = scfo_as_time % output_sample_rate;
+    rem = (rem << exp_scfo_as) % output_sample_rate;
+    scfo_as_turns = DoubleDouble{static_cast<double>(static_cast<uint64_t>(rem)), 0.0} / output_sample_rate_f;
+  }
+  else
+  {
+    // frac((quot + rem / output_sample_rate) / 2^-exp), only the low -exp
+    // bits of quot are below the binary point
+    unsigned __int128 quot = scfo_as_time / output_sample_rate;
+    double rem = static_cast<double>(static_cast<uint64_t>(scfo_as_time - quot * output_sample_rate));
+    unsigned __int128 quot_frac = exp_scfo_as == -64 ? quot & ~uint64_t(0) :
+      quot & ((static_cast<unsigned __int128>(1) << -exp_scfo_as) - 1);
+    const double scale = 1.0 / static_cast<double>(uint64_t(1) << (-exp_scfo_as - 1)) / 2.0;
+    scfo_as_turns = scale * (ToDoubleDouble(static_cast<uint64_t>(quot_frac)) + DoubleDouble{rem, 0.0} / output_sample_rate_f);
+  }
+  if (scfo_as_negative)
+  {
+    scfo_as_turns = -scfo_as_turns;
+  }
+
+  DoubleDouble wb_ds_const = f_wb_ds * fo_delay_constant;
+  BoundedValue phase_constant;
+  phase_constant.value = scfo_as_turns + wb_ds_const;
+  phase_constant.error = DD_ERROR * (1.0 + Magnitude(wb_ds_const)) +
+    MP_ERROR * (static_cast<double>(current_output_timestamp_samples) * std::fabs(f_scfo_as) / output_sample_rate_f +
+      Magnitude(wb_ds_const));
+  if (!CertifiedModPmHalf(phase_constant))
+  {
+    return false;
+  }
+
+  uint32_t output_pps;
+  if (!CalcFodmOutputPps(current_output_timestamp_samples, output_sample_rate, output_pps))
+  {
+    return false;
+  }
+
+  bounded_values.first_input_timestamp = static_cast<uint64_t>(first_input_int);
+  bounded_values.delay_constant = delay_constant;
+  bounded_values.delay_linear = delay_linear;
+  bounded_values.phase_constant = phase_constant;
+  bounded_values.phase_linear = phase_linear;
+  bounded_values.validity_period =
+    static_cast<uint32_t>(next_output_timestamp_samples - current_output_timestamp_samples);
+  bounded_values.output_PPS = output_pps;
+  bounded_values.first_output_timestamp = current_output_timestamp_samples;
+  return true;
+}
+
+// The bounded value of a fixed point register field
+const BoundedValue& ScaledValue(const FirstOrderDelayModelRegisterBoundedValues& bounded_values, FodmScaledValue value)
+{
+    switch (value)
+    {
+    case FodmScaledValue::DelayConstant: return bounded_values.delay_constant;
+    case FodmScaledValue::DelayLinear: return bounded_values.delay_linear;
+    case FodmScaledValue::PhaseConstant: return bounded_values.phase_constant;
+    default: return bounded_values.phase_linear;
+    }
+}
+
+// ToIntCertified of a field, stored at its offset of the register values
+template <typename T>
+bool ToFieldCertified(const BoundedValue& val, const FodmRegisterField& field, unsigned char* reg_values)
+{
+    T res;
+    if (!ToIntCertified(val, field.scale_exponent, res))
+    {
+        return false;
+    }
+    std::memcpy(reg_values + field.offset, &res, sizeof(res));
+    return true;
+}
+
+// Converts the bounded values to the register values of the version of
+// RegisterValues, with the fixed point fields of its FodmRegisterFormat.
+// Returns false, and leaves reg_values unchanged, if a field can't be
+// certified or does not fit.
+template <typename RegisterValues>
+bool ToRegisterValuesCertified(const FirstOrderDelayModelRegisterBoundedValues& bounded_values, RegisterValues& reg_values)
+{
+    RegisterValues values;
+    unsigned char* bytes = reinterpret_cast<unsigned char*>(&values);
+    for (const FodmRegisterField& field : FodmRegisterFormatOf<RegisterValues>::format().fields)
+    {
+        const BoundedValue& val = ScaledValue(bounded_values, field.value);
+        bool certified;
+        if (field.width == 32)
+        {
+            certified = field.is_signed ? ToFieldCertified<int32_t>(val, field, bytes) : ToFieldCertified<uint32_t>(val, field, bytes);
+        }
+        else
+        {
+            certified = field.is_signed ? ToFieldCertified<int64_t>(val, field, bytes) : ToFieldCertified<uint64_t>(val, field, bytes);
+        }
+        if (!certified)
+        {
+            return false;
+        }
+    }
+    values.first_input_timestamp = bounded_values.first_input_timestamp;
+    values.validity_period = bounded_values.validity_period - 1;
+    values.output_PPS = bounded_values.output_PPS;
+    values.first_output_timestamp = bounded_values.first_output_timestamp;
+    reg_values = values;
+    return true;
+}
+
+// The output timestamps of fo_poly, with the same results as the
+// multi-precision calculation
+bool OutputTimestamps(const FoPoly &fo_poly, uint32_t output_sample_rate, FodmOutputTimestamps &timestamps)
+{
+    return CalcFodmOutputTimestampFixedPoint(fo_poly.start_time_ms, output_sample_rate, timestamps.current) &&
+        CalcFodmOutputTimestampFixedPoint(fo_poly.stop_time_ms, output_sample_rate, timestamps.next);
+}
+
+}; // namespace
+
+/**
+ * Calculates the values to be written to the first order delay model
+ * registers in double-double arithmetic with certified rounding.
+ *
+ * @param fo_poly a first order delay model
+ * @param input_sample_rate Input sample rate in samples/second
+ * @param output_sample_rate Output sample rate in samples/second
+ * @param freq_down_shift Frequency down-shift at the VCC-OSPPFB [Hz]
+ * @param freq_align_shift Frequency shift applied to align fine channels between FSs [Hz]
+ * @param freq_wb_shift Net Wideband (WB) frequency shift [Hz]
+ * @param freq_scfo_shift Frequency shift required due to SCFO sampling [Hz]
+ * @param reg_values the first order delay model register values
+ *
+ * @return false if a value can't be certified or is out of range
+ */
+bool CalcFodmRegisterValuesDoubleDouble(
+    const FoPoly &fo_poly,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValues &reg_values )
+{
+  FodmOutputTimestamps timestamps;
+  return OutputTimestamps(fo_poly, output_sample_rate, timestamps) &&
+    CalcFodmRegisterValuesDoubleDouble(fo_poly, timestamps, input_sample_rate, output_sample_rate,
+      freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift, reg_values);
+}
+
+/**
+ * Same as above, with the output timestamps of the FODM given in timestamps.
+ *
+ * @return false if a value can't be certified or is out of range
+ */
+bool CalcFodmRegisterValuesDoubleDouble(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValues &reg_values )
+{
+  FirstOrderDelayModelRegisterBoundedValues bounded_values;
+  return CalcFodmRegisterBoundedValues(fo_poly, timestamps, input_sample_rate, output_sample_rate,
+      freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift, bounded_values) &&
+    ToRegisterValuesCertified(bounded_values, reg_values);
+}
+
+/**
+ * Calculates the values to be written to the version 1 first order delay
+ * model registers in double-double arithmetic with certified rounding.
+ *
+ * @param fo_poly a first order delay model
+ * @param input_sample_rate Input sample rate in samples/second
+ * @param output_sample_rate Output sample rate in samples/second
+ * @param freq_down_shift Frequency down-shift at the VCC-OSPPFB [Hz]
+ * @param freq_align_shift Frequency shift applied to align fine channels between FSs [Hz]
+ * @param freq_wb_shift Net Wideband (WB) frequency shift [Hz]
+ * @param freq_scfo_shift Frequency shift required due to SCFO sampling [Hz]
+ * @param reg_values the first order delay model register values
+ *
+ * @return false if a value can't be certified or is out of range
+ */
+bool CalcFodmRegisterValuesV1DoubleDouble(
+    const FoPoly &fo_poly,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValuesVer1 &reg_values )
+{
+  FodmOutputTimestamps timestamps;
+  return OutputTimestamps(fo_poly, output_sample_rate, timestamps) &&
+    CalcFodmRegisterValuesV1DoubleDouble(fo_poly, timestamps, input_sample_rate, output_sample_rate,
+      freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift, reg_values);
+}
+
+/**
+ * Same as above, with the output timestamps of the FODM given in timestamps.
+ *
+ * @return false if a value can't be certified or is out of range
+ */
+bool CalcFodmRegisterValuesV1DoubleDouble(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValuesVer1 &reg_values )
+{
+  FirstOrderDelayModelRegisterBoundedValues bounded_values;
+  return CalcFodmRegisterBoundedValues(fo_poly, timestamps, input_sample_rate, output_sample_rate,
+      freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift, bounded_values) &&
+    ToRegisterValuesCertified(bounded_values, reg_values);
+}
+
+/**
+ * Calculates the values to be written to the first order delay model
+ * registers of each register version in versions in double-double
+ * arithmetic, with the bounded values calculated once for all versions.
+ *
+ * @param fo_poly a first order delay model
+ * @param timestamps the output timestamps of fo_poly
+ * @param input_sample_rate Input sample rate in samples/second
+ * @param output_sample_rate Output sample rate in samples/second
+ * @param freq_down_shift Frequency down-shift at the VCC-OSPPFB [Hz]
+ * @param freq_align_shift Frequency shift applied to align fine channels between FSs [Hz]
+ * @param freq_wb_shift Net Wideband (WB) frequency shift [Hz]
+ * @param freq_scfo_shift Frequency shift required due to SCFO sampling [Hz]
+ * @param versions mask of FODM_REGISTER_V1 and FODM_REGISTER_V2
+ * @param values the register values of the versions
+ *
+ * @return false if a value can't be certified or is out of range
+ */
+bool CalcFodmRegisterVersionsDoubleDouble(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    uint32_t versions,
+    FodmRegisterVersionValues &values )
+{
+  FirstOrderDelayModelRegisterBoundedValues bounded_values;
+  FodmRegisterVersionValues version_values = values;
+  if (!CalcFodmRegisterBoundedValues(fo_poly, timestamps, input_sample_rate, output_sample_rate,
+        freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift, bounded_values) ||
+      ((versions & FODM_REGISTER_V1) && !ToRegisterValuesCertified(bounded_values, version_values.v1)) ||
+      ((versions & FODM_REGISTER_V2) && !ToRegisterValuesCertified(bounded_values, version_values.v2)))
+  {
+    return false;
+  }
+  values = version_values;
+  return true;
+}
+
+}; // namespace ska_mid_cbf_fodm_gen
@@ -0,0 +1,92 @@
+#ifndef CALC_FODM_REG_VALUES_DOUBLE_DOUBLE_H
+#define CALC_FODM_REG_VALUES_DOUBLE_DOUBLE_H
+
+#include <cstdint>
+
+#include "CalcFodmRegisterValues.h"
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// Calculates the FODM register values for register version 2 and higher
+// in double-double arithmetic instead of cpp_bin_float_50. The inputs are
+// the same as CalcFodmRegisterValues.
+//
+// The whole number of input samples and of phase turns are calculated
+// exactly with 128 bit integers, and the fractional values in double-double
+// with a bound on their error, which also covers the rounding of the
+// multi-precision calculation. Each floor, wrap to [-0.5, 0.5) and
+// rounding to a register field is only taken if every value within the
+// bound gives the same result, so the register values are the same as
+// those of the multi-precision calculation.
+//
+// Returns false, and leaves reg_values unchanged, if a value is too close
+// to a floor or rounding boundary to be certified (rare for random delays,
+// more common for delays on whole samples such as 0), or the
+// inputs or results are out of range. CalcFodmRegisterValues falls back to
+// the multi-precision calculation in that case.
+bool CalcFodmRegisterValuesDoubleDouble(
+    const FoPoly &fo_poly,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValues &reg_values );
+
+// Calculates the FODM register values for register version 1 in
+// double-double arithmetic. See CalcFodmRegisterValuesDoubleDouble.
+bool CalcFodmRegisterValuesV1DoubleDouble(
+    const FoPoly &fo_poly,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValuesVer1 &reg_values );
+
+// Same as above, with the output timestamps of fo_poly precomputed,
+// e.g. by FodmSequence.
+bool CalcFodmRegisterValuesDoubleDouble(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValues &reg_values );
+
+bool CalcFodmRegisterValuesV1DoubleDouble(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValuesVer1 &reg_values );
+
+// Calculates the FODM register values of every register version in the
+// versions mask in double-double arithmetic, see CalcFodmRegisterVersions.
+// Returns false, and leaves values unchanged, if any version can't be
+// certified.
+bool CalcFodmRegisterVersionsDoubleDouble(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    uint32_t versions,
+    FodmRegisterVersionValues &values );
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
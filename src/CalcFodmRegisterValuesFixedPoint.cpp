@@ -0,0 +1,787 @@
+#include "CalcFodmRegisterValuesFixedPoint.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "FodmRegisterFormat.h"
+#include "Int256.h"
+
+#ifndef DISABLE_DELAY_LINEAR_ERROR
+#error "The FixedPoint engine does not apply the delay_linear_error_samples, see FodmRegisterFormat.h"
+#endif
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+namespace
+{
+
+const uint64_t MS_PER_SECOND = 1000;
+const uint64_t NS_PER_SECOND = 1000000000;
+
+// Largest number of bits allowed for an intermediate value. This leaves
+// headroom for the additions and the rounding below within 256 bits.
+const int MAX_BITS = 250;
+
+// Number of bits in the significand of cpp_bin_float_50
+const int MP_DIGITS = 168;
+
+// Bound on the relative error of the multi-precision calculation, whose
+// values are rounded to MP_DIGITS bits a few times
+const double MP_ERROR = 1.0 / (uint64_t(1) << 50) / (uint64_t(1) << 50) / (uint64_t(1) << 50);
+
+// A real value, num * 2^exp / den, held exactly. The value of the
+// multi-precision calculation is within 2^margin_exp of it.
+struct ExactValue
+{
+    Int256 num;
+    int exp;
+    uint64_t den;
+    int margin_exp;
+};
+
+// The fixed point counterpart of FirstOrderDelayModelRegisterRawValues.
+// The fractional fields are kept exact until they are scaled to the
+// register resolution.
+struct FirstOrderDelayModelRegisterExactValues
+{
+    uint64_t first_input_timestamp;
+    ExactValue delay_constant;
+    ExactValue phase_constant;
+    ExactValue delay_linear;
+    ExactValue phase_linear;
+    uint32_t validity_period;
+    uint32_t output_PPS;
+    uint64_t first_output_timestamp;
+};
+
+// Splits a floating point value into mant * 2^exp exactly.
+// Returns false for inf and nan.
+template <typename T>
+bool Decompose(T val, Int256& mant, int& exp)
+{
+    if (!std::isfinite(val))
+    {
+        return false;
+    }
+    const int digits = std::numeric_limits<T>::digits;
+    int val_exp;
+    T frac = std::frexp(val, &val_exp);
+    __int128 m = static_cast<__int128>(std::ldexp(frac, digits));
+    exp = (m == 0) ? 0 : val_exp - digits;
+    // Remove the trailing zeros to keep the shifts below small
+    while (m != 0 && (m & 1) == 0)
+    {
+        m >>= 1;
+        exp++;
+    }
+    mant = Int256::FromInt128(m);
+    return true;
+}
+
+// res = val * 2^n, n >= 0. Returns false if the result would be too large.
+bool ShiftLeft(const Int256& val, int n, Int256& res)
+{
+    if (val.is_zero())
+    {
+        res = val;
+        return true;
+    }
+    if (n < 0 || val.bit_length() + n > MAX_BITS)
+    {
+        return false;
+    }
+    res = val << n;
+    return true;
+}
+
+// floor(val / 2^n), n >= 0
+Int256 ShiftRight(const Int256& val, int n)
+{
+    if (n > 255)
+    {
+        return val.is_negative() ? Int256(-1) : Int256(0);
+    }
+    return val >> n;
+}
+
+// res = a * b. Returns false if the result would be too large.
+bool Multiply(const Int256& a, const Int256& b, Int256& res)
+{
+    if (a.bit_length() + b.bit_length() > MAX_BITS)
+    {
+        return false;
+    }
+    res = a * b;
+    return true;
+}
+
+// sum * 2^exp = a * 2^a_exp + b * 2^b_exp, with exp <= 0.
+// Returns false if the sum would be too large.
+bool AddScaled(const Int256& a, int a_exp, const Int256& b, int b_exp, Int256& sum, int& exp)
+{
+    exp = 0;
+    if (!a.is_zero() && a_exp < exp) { exp = a_exp; }
+    if (!b.is_zero() && b_exp < exp) { exp = b_exp; }
+
+    Int256 a_shifted, b_shifted;
+    if (!ShiftLeft(a, a.is_zero() ? 0 : a_exp - exp, a_shifted) ||
+        !ShiftLeft(b, b.is_zero() ? 0 : b_exp - exp, b_shifted))
+    {
+        return false;
+    }
+    sum = a_shifted + b_shifted;
+    return true;
+}
+
+// The margin_exp of a value calculated from terms with magnitudes adding up
+// to at most magnitude. Returns false if magnitude is not finite.
+bool MarginExponent(double magnitude, int& margin_exp)
+{
+    if (!std::isfinite(magnitude))
+    {
+        return false;
+    }
+    std::frexp(MP_ERROR * (magnitude + 1.0), &margin_exp);
+    return true;
+}
+
+// true if dist / one > 2^margin_exp, i.e. a value dist / one away from a
+// floor, wrap or rounding boundary is on the same side of it in the
+// multi-precision calculation. May return false when it is just over.
+bool BeyondMargin(const Int256& dist, const Int256& one, int margin_exp)
+{
+    return margin_exp < 0 && dist > ShiftRight(one, -margin_exp);
+}
+
+// floor(num * 2^exp / den)
+bool FloorScaled(const Int256& num, int exp, uint64_t den, Int256& res)
+{
+    if (exp >= 0)
+    {
+        Int256 scaled;
+        if (!ShiftLeft(num, exp, scaled))
+        {
+            return false;
+        }
+        res = scaled.floor_div(den);
+    }
+    else
+    {
+        // floor(floor(x / 2^n) / den) == floor(x / (2^n * den))
+        res = ShiftRight(num, -exp).floor_div(den);
+    }
+    return true;
+}
+
+// round(num * 2^exp / den), rounding half away from zero like
+// boost::multiprecision::round. den must be less than 2^63.
+// Returns false if the value is within 2^margin_exp of half way between
+// two integers, since the multi-precision calculation may have rounded
+// the value to the other side before getting there.
+bool RoundScaled(const Int256& num, int exp, uint64_t den, int margin_exp, Int256& res)
+{
+    if (margin_exp >= -2)
+    {
+        return false;
+    }
+    // The fractional part of |value| + 0.5 is rem / (2 * den) below, to
+    // within 1 / (2 * den). It must be more than 2^margin_exp from 0 and 1.
+    const uint64_t two_den = 2 * den;
+    const uint64_t min_rem = (margin_exp <= -64 ? 0 : two_den >> -margin_exp) + 1;
+
+    bool neg = num.is_negative();
+    Int256 mag = neg ? -num : num;
+    Int256 rounded;
+    uint64_t rem;
+    if (exp >= 0)
+    {
+        // floor((mag * 2^(exp+1) + den) / (2 * den))
+        Int256 scaled;
+        if (!ShiftLeft(mag, exp + 1, scaled))
+        {
+            return false;
+        }
+        rounded = (scaled + Int256::FromUInt64(den)).floor_div(two_den, rem);
+        if (rem < min_rem || two_den - 1 - rem < min_rem)
+        {
+            return false;
+        }
+    }
+    else if (64 - __builtin_clzll(den) - exp > mag.bit_length() + 2)
+    {
+        // den * 2^-exp > 4 * mag, so the value is less than 1/4, more than
+        // the margin from 1/2
+        rounded = Int256(0);
+    }
+    else
+    {
+        // floor((2 * mag + den * 2^-exp) / (2^-exp * 2 * den)), the bits
+        // shifted out are the part of the remainder under 1 / (2 * den)
+        Int256 half = Int256::FromUInt64(den) << -exp;
+        Int256 scaled = (mag << 1) + half;
+        Int256 shifted = scaled >> -exp;
+        rounded = shifted.floor_div(two_den, rem);
+        if (rem < min_rem || two_den - 1 - rem < min_rem)
+        {
+            return false;
+        }
+    }
+    res = neg ? -rounded : rounded;
+    return true;
+}
+
+// Rounds num * 2^exp / den, num > 0, to the MP_DIGITS bit significand of
+// cpp_bin_float_50 (round to nearest, ties to even), giving mant * 2^res_exp.
+bool RoundToMultiPrecision(const Int256& num, int exp, uint64_t den, Int256& mant, int& res_exp)
+{
+    // Scale num by 2^shift so that the quotient has MP_DIGITS+1 or MP_DIGITS+2 bits
+    int shift = MP_DIGITS + 1 + (64 - __builtin_clzll(den)) - num.bit_length();
+    Int256 quot;
+    uint64_t rem;
+    bool sticky;
+    if (shift >= 0)
+    {
+        Int256 scaled;
+        if (!ShiftLeft(num, shift, scaled))
+        {
+            return false;
+        }
+        quot = scaled.floor_div(den, rem);
+        sticky = rem != 0;
+    }
+    else
+    {
+        Int256 truncated = num >> -shift;
+        sticky = (truncated << -shift) != num;
+        quot = truncated.floor_div(den, rem);
+        sticky = sticky || rem != 0;
+    }
+
+    int extra = quot.bit_length() - MP_DIGITS;
+    mant = quot >> extra;
+    Int256 dropped = quot - (mant << extra);
+    Int256 half = Int256(1) << (extra - 1);
+    bool mant_odd = (mant.low_uint64() & 1) != 0;
+    if (dropped > half || (dropped == half && (sticky || mant_odd)))
+    {
+        mant = mant + Int256(1);
+        if (mant.bit_length() > MP_DIGITS)
+        {
+            mant = mant >> 1;
+            extra++;
+        }
+    }
+    res_exp = exp - shift + extra;
+    return true;
+}
+
+// The mod_pmhalf of the multi-precision calculation, i.e. val wrapped
+// to [-0.5, 0.5). val.exp must be <= 0. Returns false if val is within
+// val.margin_exp of the wrap boundary.
+bool ModPmHalf(ExactValue& val)
+{
+    Int256 one, whole, whole_scaled;
+    if (!ShiftLeft(Int256::FromUInt64(val.den), -val.exp, one) ||
+        !FloorScaled(val.num, val.exp, val.den, whole) ||
+        !Multiply(whole, one, whole_scaled))
+    {
+        return false;
+    }
+    // 0 <= frac < one
+    Int256 frac = val.num - whole_scaled;
+    Int256 dist = (frac << 1) - one;
+    if (!BeyondMargin(dist.is_negative() ? -dist : dist, one, val.margin_exp + 1))
+    {
+        // Close enough to 0.5 to end up on either side of the wrap
+        return false;
+    }
+    if ((frac << 1) > one)
+    {
+        frac = frac - one;
+    }
+    val.num = frac;
+    return true;
+}
+
+// Equivalent of ToInt, round(val * 2^scale_bits) converted to T.
+// Returns false if the scaled value is too close to a rounding boundary,
+// or the result does not fit in T.
+template <typename T>
+bool ToIntExact(const ExactValue& val, int scale_bits, T& res)
+{
+    Int256 rounded;
+    if (!RoundScaled(val.num, val.exp + scale_bits, val.den, val.margin_exp + scale_bits, rounded))
+    {
+        return false;
+    }
+    if (std::numeric_limits<T>::is_signed)
+    {
+        if (!rounded.fits_int64())
+        {
+            return false;
+        }
+        int64_t rounded_int = static_cast<int64_t>(rounded.low_uint64());
+        if (rounded_int < static_cast<int64_t>(std::numeric_limits<T>::min()) ||
+            rounded_int > static_cast<int64_t>(std::numeric_limits<T>::max()))
+        {
+            return false;
+        }
+        res = static_cast<T>(rounded_int);
+    }
+    else
+    {
+        if (rounded.is_negative() || !rounded.fits_uint64() ||
+            rounded.low_uint64() > static_cast<uint64_t>(std::numeric_limits<T>::max()))
+        {
+            return false;
+        }
+        res = static_cast<T>(rounded.low_uint64());
+    }
+    return true;
+}
+
+// floor(time_ms / 1000 * sample_rate), the timestamp in samples.
+// Timestamps often fall exactly on a sample, so the two roundings of the
+// multi-precision calculation, MS_TO_SECONDS and the multiplication by
+// the sample rate, are reproduced to get the same result when they do.
+// Returns false for negative timestamps or if the result does not fit
+// in 64 bits.
+bool MsToSamples(double time_ms, uint32_t sample_rate, uint64_t& samples)
+{
+    Int256 mant, res;
+    int exp;
+    if (!Decompose(time_ms, mant, exp) || mant.is_negative() || sample_rate == 0)
+    {
+        return false;
+    }
+    if (mant.is_zero())
+    {
+        samples = 0;
+        return true;
+    }
+
+    // time_s = MS_TO_SECONDS(time_ms), then time_s * sample_rate
+    Int256 time_s_mant, samples_mant;
+    int time_s_exp, samples_exp;
+    if (!RoundToMultiPrecision(mant, exp, MS_PER_SECOND, time_s_mant, time_s_exp) ||
+        !RoundToMultiPrecision(time_s_mant * Int256::FromUInt64(sample_rate), time_s_exp, 1,
+          samples_mant, samples_exp) ||
+        !FloorScaled(samples_mant, samples_exp, 1, res) ||
+        !res.fits_uint64())
+    {
+        return false;
+    }
+    samples = res.low_uint64();
+    return true;
+}
+
+/**
+ * Calculates the first order delay model register values exactly. Follows
+ * the same steps as the multi-precision CalcFodmRegisterRawValues, see the
+ * comments there for the meaning of each value. The output timestamps are
+ * given in timestamps, see CalcFodmOutputTimestamps.
+ *
+ * Returns false if the values are out of the supported range.
+ */
+bool CalcFodmRegisterExactValues(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterExactValues &exact_values )
+{
+  if (input_sample_rate == 0 || output_sample_rate == 0)
+  {
+    return false;
+  }
+
+  const Int256 input_sample_rate_i = Int256::FromUInt64(input_sample_rate);
+  const Int256 output_sample_rate_i = Int256::FromUInt64(output_sample_rate);
+  const Int256 ns_per_second_i = Int256::FromUInt64(NS_PER_SECOND);
+
+  // Common denominator of the fractional values
+  const uint64_t den = static_cast<uint64_t>(output_sample_rate) * NS_PER_SECOND;
+
+  // Timestamps in output samples
+  const uint64_t current_output_timestamp_samples = timestamps.current;
+  const uint64_t next_output_timestamp_samples = timestamps.next;
+  if (next_output_timestamp_samples < current_output_timestamp_samples ||
+      next_output_timestamp_samples - current_output_timestamp_samples > std::numeric_limits<uint32_t>::max())
+  {
+    return false;
+  }
+
+  // fo_poly.poly[0] = mant_linear * 2^exp_linear [ns/s]
+  // fo_poly.poly[1] = mant_const * 2^exp_const [ns]
+  Int256 mant_linear, mant_const;
+  int exp_linear, exp_const;
+  if (!Decompose(fo_poly.poly[0], mant_linear, exp_linear) ||
+      !Decompose(fo_poly.poly[1], mant_const, exp_const))
+  {
+    return false;
+  }
+
+  // Magnitudes of the terms of the values below, for the margins of the
+  // multi-precision rounding errors
+  const double input_sample_rate_f = input_sample_rate;
+  const double output_sample_rate_f = output_sample_rate;
+  const double current_output_timestamp_f = static_cast<double>(current_output_timestamp_samples);
+  const double fo_delay_linear_mag = std::fabs(static_cast<double>(fo_poly.poly[0])) / NS_PER_SECOND;
+  const double fo_delay_constant_mag = std::fabs(static_cast<double>(fo_poly.poly[1])) / NS_PER_SECOND;
+
+  // delay_linear = input_sample_rate / output_sample_rate + poly[0] / 1e9
+  ExactValue delay_linear;
+  delay_linear.den = den;
+  if (!AddScaled(
+        input_sample_rate_i * ns_per_second_i, 0,
+        mant_linear * output_sample_rate_i, exp_linear,
+        delay_linear.num, delay_linear.exp) ||
+      !MarginExponent(input_sample_rate_f / output_sample_rate_f + fo_delay_linear_mag, delay_linear.margin_exp))
+  {
+    return false;
+  }
+
+  // first_input_timestamp_fractional_samples =
+  //   resampling_rate * current_output_timestamp_samples + poly[1] / 1e9 * input_sample_rate
+  Int256 first_input_num;
+  int first_input_exp;
+  Int256 first_input_int;
+  if (!AddScaled(
+        Int256::FromUInt128(static_cast<unsigned __int128>(input_sample_rate) * current_output_timestamp_samples) * ns_per_second_i, 0,
+        mant_const * Int256::FromUInt64(static_cast<uint64_t>(input_sample_rate) * output_sample_rate), exp_const,
+        first_input_num, first_input_exp) ||
+      !FloorScaled(first_input_num, first_input_exp, den, first_input_int) ||
+      first_input_int.is_negative() || !first_input_int.fits_uint64())
+  {
+    return false;
+  }
+
+  // delay_constant = the fractional part of first_input_timestamp_fractional_samples
+  ExactValue delay_constant;
+  Int256 one, first_input_int_scaled;
+  if (!ShiftLeft(Int256::FromUInt64(den), -first_input_exp, one) ||
+      !Multiply(first_input_int, one, first_input_int_scaled) ||
+      !MarginExponent(input_sample_rate_f * current_output_timestamp_f / output_sample_rate_f +
+        input_sample_rate_f * fo_delay_constant_mag, delay_constant.margin_exp))
+  {
+    return false;
+  }
+  delay_constant.num = first_input_num - first_input_int_scaled;
+  delay_constant.exp = first_input_exp;
+  delay_constant.den = den;
+  if (!BeyondMargin(delay_constant.num, one, delay_constant.margin_exp) ||
+      !BeyondMargin(one - delay_constant.num, one, delay_constant.margin_exp))
+  {
+    // Close enough to a whole number of input samples for the
+    // multi-precision calculation to be on the other side of it
+    return false;
+  }
+
+  // The frequency shifts are combined in double precision, in the same way
+  // as the multi-precision calculation.
+  freq_align_shift = -freq_align_shift;
+  double f_wb_ds = freq_wb_shift - freq_down_shift;
+  double f_scfo_as = freq_scfo_shift + freq_align_shift;
+
+  Int256 mant_wb_ds, mant_scfo_as;
+  int exp_wb_ds, exp_scfo_as;
+  if (!Decompose(f_wb_ds, mant_wb_ds, exp_wb_ds) ||
+      !Decompose(f_scfo_as, mant_scfo_as, exp_scfo_as))
+  {
+    return false;
+  }
+
+  // phase_linear = (f_scfo_as + f_wb_ds * poly[0] / 1e9) / output_sample_rate
+  ExactValue phase_linear;
+  phase_linear.den = den;
+  Int256 wb_ds_linear;
+  if (!Multiply(mant_wb_ds, mant_linear, wb_ds_linear) ||
+      !AddScaled(
+        mant_scfo_as * ns_per_second_i, exp_scfo_as,
+        wb_ds_linear, exp_wb_ds + exp_linear,
+        phase_linear.num, phase_linear.exp) ||
+      !MarginExponent((std::fabs(f_scfo_as) + std::fabs(f_wb_ds) * fo_delay_linear_mag) / output_sample_rate_f,
+        phase_linear.margin_exp) ||
+      !ModPmHalf(phase_linear))
+  {
+    return false;
+  }
+
+  // time_factor = current_output_timestamp_samples
+  // phase_constant = time_factor * f_scfo_as / output_sample_rate + f_wb_ds * poly[1] / 1e9
+  ExactValue phase_constant;
+  phase_constant.den = den;
+  Int256 scfo_as_time, wb_ds_const;
+  if (!Multiply(Int256::FromUInt64(current_output_timestamp_samples) * ns_per_second_i, mant_scfo_as, scfo_as_time) ||
+      !Multiply(mant_wb_ds * output_sample_rate_i, mant_const, wb_ds_const) ||
+      !AddScaled(
+        scfo_as_time, exp_scfo_as,
+        wb_ds_const, exp_wb_ds + exp_const,
+        phase_constant.num, phase_constant.exp) ||
+      !MarginExponent(current_output_timestamp_f * std::fabs(f_scfo_as) / output_sample_rate_f +
+        std::fabs(f_wb_ds) * fo_delay_constant_mag, phase_constant.margin_exp) ||
+      !ModPmHalf(phase_constant))
+  {
+    return false;
+  }
+
+  uint32_t output_pps;
+  if (!CalcFodmOutputPps(current_output_timestamp_samples, output_sample_rate, output_pps))
+  {
+    return false;
+  }
+
+  exact_values.first_input_timestamp = first_input_int.low_uint64();
+  exact_values.delay_constant = delay_constant;
+  exact_values.delay_linear = delay_linear;
+  exact_values.phase_constant = phase_constant;
+  exact_values.phase_linear = phase_linear;
+  exact_values.validity_period =
+    static_cast<uint32_t>(next_output_timestamp_samples - current_output_timestamp_samples);
+  exact_values.output_PPS = output_pps;
+  exact_values.first_output_timestamp = current_output_timestamp_samples;
+  return true;
+}
+
+// The exact value of a fixed point register field
+const ExactValue& ScaledValue(const FirstOrderDelayModelRegisterExactValues& exact_values, FodmScaledValue value)
+{
+    switch (value)
+    {
+    case FodmScaledValue::DelayConstant: return exact_values.delay_constant;
+    case FodmScaledValue::DelayLinear: return exact_values.delay_linear;
+    case FodmScaledValue::PhaseConstant: return exact_values.phase_constant;
+    default: return exact_values.phase_linear;
+    }
+}
+
+// ToIntExact of a field, stored at its offset of the register values
+template <typename T>
+bool ToFieldExact(const ExactValue& val, const FodmRegisterField& field, unsigned char* reg_values)
+{
+    T res;
+    if (!ToIntExact(val, field.scale_exponent, res))
+    {
+        return false;
+    }
+    std::memcpy(reg_values + field.offset, &res, sizeof(res));
+    return true;
+}
+
+// Converts the exact values to the register values of the version of
+// RegisterValues, with the fixed point fields of its FodmRegisterFormat.
+// Returns false, and leaves reg_values unchanged, if a field does not fit.
+template <typename RegisterValues>
+bool ToRegisterValuesExact(const FirstOrderDelayModelRegisterExactValues& exact_values, RegisterValues& reg_values)
+{
+    RegisterValues values;
+    unsigned char* bytes = reinterpret_cast<unsigned char*>(&values);
+    for (const FodmRegisterField& field : FodmRegisterFormatOf<RegisterValues>::format().fields)
+    {
+        const ExactValue& val = ScaledValue(exact_values, field.value);
+        bool fits;
+        if (field.width == 32)
+        {
+            fits = field.is_signed ? ToFieldExact<int32_t>(val, field, bytes) : ToFieldExact<uint32_t>(val, field, bytes);
+        }
+        else
+        {
+            fits = field.is_signed ? ToFieldExact<int64_t>(val, field, bytes) : ToFieldExact<uint64_t>(val, field, bytes);
+        }
+        if (!fits)
+        {
+            return false;
+        }
+    }
+    values.first_input_timestamp = exact_values.first_input_timestamp;
+    values.validity_period = exact_values.validity_period - 1;
+    values.output_PPS = exact_values.output_PPS;
+    values.first_output_timestamp = exact_values.first_output_timestamp;
+    reg_values = values;
+    return true;
+}
+
+}; // namespace
+
+/**
+ * Calculates the values to be written to the first order delay model
+ * registers using exact integer arithmetic.
+ *
+ * @param fo_poly a first order delay model
+ * @param input_sample_rate Input sample rate in samples/second
+ * @param output_sample_rate Output sample rate in samples/second
+ * @param freq_down_shift Frequency down-shift at the VCC-OSPPFB [Hz]
+ * @param freq_align_shift Frequency shift applied to align fine channels between FSs [Hz]
+ * @param freq_wb_shift Net Wideband (WB) frequency shift [Hz]
+ * @param freq_scfo_shift Frequency shift required due to SCFO sampling [Hz]
+ * @param reg_values the first order delay model register values
+ *
+ * @return false if the inputs are outside of the supported range
+ */
+bool CalcFodmRegisterValuesFixedPoint(
+    const FoPoly &fo_poly,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValues &reg_values )
+{
+  FodmOutputTimestamps timestamps;
+  if (!MsToSamples(fo_poly.start_time_ms, output_sample_rate, timestamps.current) ||
+      !MsToSamples(fo_poly.stop_time_ms, output_sample_rate, timestamps.next))
+  {
+    return false;
+  }
+  return CalcFodmRegisterValuesFixedPoint(fo_poly, timestamps, input_sample_rate, output_sample_rate,
+    freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift, reg_values);
+}
+
+/**
+ * Same as above, with the output timestamps of the FODM given in timestamps.
+ *
+ * @return false if the inputs are outside of the supported range
+ */
+bool CalcFodmRegisterValuesFixedPoint(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValues &reg_values )
+{
+  FirstOrderDelayModelRegisterExactValues exact_values;
+  return CalcFodmRegisterExactValues(fo_poly, timestamps, input_sample_rate, output_sample_rate,
+      freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift, exact_values) &&
+    ToRegisterValuesExact(exact_values, reg_values);
+}
+
+/**
+ * Calculates the values to be written to the version 1 first order delay
+ * model registers using exact integer arithmetic.
+ *
+ * @param fo_poly a first order delay model
+ * @param input_sample_rate Input sample rate in samples/second
+ * @param output_sample_rate Output sample rate in samples/second
+ * @param freq_down_shift Frequency down-shift at the VCC-OSPPFB [Hz]
+ * @param freq_align_shift Frequency shift applied to align fine channels between FSs [Hz]
+ * @param freq_wb_shift Net Wideband (WB) frequency shift [Hz]
+ * @param freq_scfo_shift Frequency shift required due to SCFO sampling [Hz]
+ * @param reg_values the first order delay model register values
+ *
+ * @return false if the inputs are outside of the supported range
+ */
+bool CalcFodmRegisterValuesV1FixedPoint(
+    const FoPoly &fo_poly,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValuesVer1 &reg_values )
+{
+  FodmOutputTimestamps timestamps;
+  if (!MsToSamples(fo_poly.start_time_ms, output_sample_rate, timestamps.current) ||
+      !MsToSamples(fo_poly.stop_time_ms, output_sample_rate, timestamps.next))
+  {
+    return false;
+  }
+  return CalcFodmRegisterValuesV1FixedPoint(fo_poly, timestamps, input_sample_rate, output_sample_rate,
+    freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift, reg_values);
+}
+
+/**
+ * Same as above, with the output timestamps of the FODM given in timestamps.
+ *
+ * @return false if the inputs are outside of the supported range
+ */
+bool CalcFodmRegisterValuesV1FixedPoint(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValuesVer1 &reg_values )
+{
+  FirstOrderDelayModelRegisterExactValues exact_values;
+  return CalcFodmRegisterExactValues(fo_poly, timestamps, input_sample_rate, output_sample_rate,
+      freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift, exact_values) &&
+    ToRegisterValuesExact(exact_values, reg_values);
+}
+
+/**
+ * Calculates the values to be written to the first order delay model
+ * registers of each register version in versions using exact integer
+ * arithmetic, with the exact values calculated once for all versions.
+ *
+ * @param fo_poly a first order delay model
+ * @param timestamps the output timestamps of fo_poly
+ * @param input_sample_rate Input sample rate in samples/second
+ * @param output_sample_rate Output sample rate in samples/second
+ * @param freq_down_shift Frequency down-shift at the VCC-OSPPFB [Hz]
+ * @param freq_align_shift Frequency shift applied to align fine channels between FSs [Hz]
+ * @param freq_wb_shift Net Wideband (WB) frequency shift [Hz]
+ * @param freq_scfo_shift Frequency shift required due to SCFO sampling [Hz]
+ * @param versions mask of FODM_REGISTER_V1 and FODM_REGISTER_V2
+ * @param values the register values of the versions
+ *
+ * @return false if the inputs are outside of the supported range
+ */
+bool CalcFodmRegisterVersionsFixedPoint(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    uint32_t versions,
+    FodmRegisterVersionValues &values )
+{
+  FirstOrderDelayModelRegisterExactValues exact_values;
+  FodmRegisterVersionValues version_values = values;
+  if (!CalcFodmRegisterExactValues(fo_poly, timestamps, input_sample_rate, output_sample_rate,
+        freq_down_shift, freq_align_shift, freq_wb_shift, freq_scfo_shift, exact_values) ||
+      ((versions & FODM_REGISTER_V1) && !ToRegisterValuesExact(exact_values, version_values.v1)) ||
+      ((versions & FODM_REGISTER_V2) && !ToRegisterValuesExact(exact_values, version_values.v2)))
+  {
+    return false;
+  }
+  values = version_values;
+  return true;
+}
+
+/**
+ * Calculates floor(time_ms / 1000 * output_sample_rate) with the same
+ * result as the multi-precision calculation.
+ *
+ * @param time_ms time in milliseconds since the SKA epoch
+ * @param output_sample_rate Output sample rate in samples/second
+ * @param samples the timestamp in output samples
+ *
+ * @return false if the time is negative or the result does not fit
+ */
+bool CalcFodmOutputTimestampFixedPoint(
+    double time_ms,
+    uint32_t output_sample_rate,
+    uint64_t &samples )
+{
+  return MsToSamples(time_ms, output_sample_rate, samples);
+}
+
+}; // namespace ska_mid_cbf_fodm_gen
@@ -0,0 +1,103 @@
+#ifndef CALC_FODM_REG_VALUES_FIXED_POINT_H
+#define CALC_FODM_REG_VALUES_FIXED_POINT_H
+
+#include <cstdint>
+
+#include "CalcFodmRegisterValues.h"
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// Calculates the FODM register values for register version 2 and higher
+// with exact integer arithmetic instead of cpp_bin_float_50. The inputs
+// are the same as CalcFodmRegisterValues.
+//
+// Every input is a binary floating point value, so all the intermediate
+// quantities are rationals with a power of two times the sample rates and
+// the ns/ms unit conversions in the denominator. They are kept exactly in
+// 256 bit integers and only rounded once, when converted to the register
+// fields. The multi-precision calculation rounds to ~168 bits on the way,
+// so the two only agree when the exact value is not within that rounding
+// error of a floor, wrap or rounding boundary. Values that close to a
+// boundary are left to the multi-precision calculation.
+//
+// Returns false, and leaves reg_values unchanged, if the inputs or the
+// results are outside the range handled by the fixed point calculation
+// (e.g. negative timestamps, delays with more than ~120 fractional bits,
+// or a register field that would overflow), or if a value is too close to
+// a boundary. CalcFodmRegisterValues falls back to the multi-precision
+// calculation in that case.
+bool CalcFodmRegisterValuesFixedPoint(
+    const FoPoly &fo_poly,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValues &reg_values );
+
+// Calculates the FODM register values for register version 1 with
+// exact integer arithmetic. See CalcFodmRegisterValuesFixedPoint.
+bool CalcFodmRegisterValuesV1FixedPoint(
+    const FoPoly &fo_poly,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValuesVer1 &reg_values );
+
+// Same as above, with the output timestamps of fo_poly precomputed,
+// e.g. by FodmSequence.
+bool CalcFodmRegisterValuesFixedPoint(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValues &reg_values );
+
+bool CalcFodmRegisterValuesV1FixedPoint(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    FirstOrderDelayModelRegisterValuesVer1 &reg_values );
+
+// Calculates the FODM register values of every register version in the
+// versions mask with exact integer arithmetic, see CalcFodmRegisterVersions.
+// Returns false, and leaves values unchanged, if any version is out of
+// range.
+bool CalcFodmRegisterVersionsFixedPoint(
+    const FoPoly &fo_poly,
+    const FodmOutputTimestamps &timestamps,
+    uint32_t input_sample_rate,
+    uint32_t output_sample_rate,
+    double freq_down_shift,
+    double freq_align_shift,
+    double freq_wb_shift,
+    double freq_scfo_shift,
+    uint32_t versions,
+    FodmRegisterVersionValues &values );
+
+// Calculates floor(time_ms / 1000 * output_sample_rate), the timestamp in
+// output samples, with the same result as the multi-precision calculation,
+// including when the exact value is a whole sample. Returns false if
+// time_ms is negative or the result does not fit in 64 bits.
+bool CalcFodmOutputTimestampFixedPoint(
+    double time_ms,
+    uint32_t output_sample_rate,
+    uint64_t &samples );
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
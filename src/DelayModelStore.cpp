@@ -0,0 +1,338 @@
+#include "DelayModelStore.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+/** DelayModelStore CONSTRUCTOR
+*
+* Input params:
+*       num_receptors: number of receptors, numbered from 0
+*/
+DelayModelStore::DelayModelStore(int num_receptors)
+    : num_receptors_(num_receptors),
+      snapshots_(new std::atomic<const Snapshot*>[num_receptors]),
+      hazards_(nullptr)
+{
+    for (int rr = 0; rr < num_receptors_; rr++)
+    {
+        snapshots_[rr].store(nullptr);
+    }
+}
+
+/** DelayModelStore DESTRUCTOR
+*
+* All Readers of the store must have been destroyed.
+*/
+DelayModelStore::~DelayModelStore()
+{
+    for (int rr = 0; rr < num_receptors_; rr++)
+    {
+        delete snapshots_[rr].load();
+    }
+    for (const Snapshot* snapshot : retired_)
+    {
+        delete snapshot;
+    }
+    Hazard* hazard = hazards_.load();
+    while (hazard != nullptr)
+    {
+        assert (!hazard->in_use.load());
+        Hazard* next = hazard->next;
+        delete hazard;
+        hazard = next;
+    }
+}
+
+/**
+* Publishes a new snapshot of the receptor with the entries starting before
+* the new entry, and the new entry.
+*
+* Input params:
+*       receptor: the receptor of the entry
+*       entry: the HODM and its FODMs
+*
+* Returns :
+*       false if the entry has no FODMs, true otherwise.
+*/
+bool DelayModelStore::Publish(int receptor, DelayModelEntry entry)
+{
+    assert (receptor >= 0 && receptor < num_receptors_);
+    if (entry.fo_polys.empty())
+    {
+        return false;
+    }
+    const double start_time_ms = entry.fo_polys.front().start_time_ms;
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Snapshot* snapshot = new Snapshot();
+    const Snapshot* current = snapshots_[receptor].load(std::memory_order_relaxed);
+    if (current != nullptr)
+    {
+        for (const std::shared_ptr<const DelayModelEntry>& old_entry : current->entries)
+        {
+            if (old_entry->fo_polys.front().start_time_ms < start_time_ms)
+            {
+                snapshot->entries.push_back(old_entry);
+            }
+        }
+    }
+    snapshot->entries.push_back(std::make_shared<const DelayModelEntry>(std::move(entry)));
+    Replace(receptor, snapshot);
+    Reclaim();
+    return true;
+}
+
+/**
+* Publishes new snapshots without the entries ending at or before time_ms.
+* An entry ends at its last FODM or at the start of the next entry.
+*
+* Input params:
+*       time_ms: the time before which the delay models are not needed anymore
+*/
+void DelayModelStore::RemoveBefore(double time_ms)
+{
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    for (int rr = 0; rr < num_receptors_; rr++)
+    {
+        const Snapshot* current = snapshots_[rr].load(std::memory_order_relaxed);
+        if (current == nullptr)
+        {
+            continue;
+        }
+        const std::vector<std::shared_ptr<const DelayModelEntry>>& entries = current->entries;
+        size_t first_kept = 0;
+        while (first_kept < entries.size())
+        {
+            double stop_time_ms = entries[first_kept]->fo_polys.back().stop_time_ms;
+            if (first_kept + 1 < entries.size())
+            {
+                stop_time_ms = std::min(stop_time_ms, entries[first_kept + 1]->fo_polys.front().start_time_ms);
+            }
+            if (stop_time_ms > time_ms)
+            {
+                break;
+            }
+            first_kept++;
+        }
+        if (first_kept == 0)
+        {
+            continue;
+        }
+        Snapshot* snapshot = nullptr;
+        if (first_kept < entries.size())
+        {
+            snapshot = new Snapshot();
+            snapshot->entries.assign(entries.begin() + first_kept, entries.end());
+        }
+        Replace(rr, snapshot);
+    }
+    Reclaim();
+}
+
+size_t DelayModelStore::num_retired() const
+{
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return retired_.size();
+}
+
+void DelayModelStore::Replace(int receptor, const Snapshot* snapshot)
+{
+    const Snapshot* old_snapshot = snapshots_[receptor].exchange(snapshot);
+    if (old_snapshot != nullptr)
+    {
+        retired_.push_back(old_snapshot);
+    }
+}
+
+void DelayModelStore::Reclaim()
+{
+    std::vector<const Snapshot*> marked;
+    for (Hazard* hazard = hazards_.load(); hazard != nullptr; hazard = hazard->next)
+    {
+        const Snapshot* snapshot = hazard->snapshot.load();
+        if (snapshot != nullptr)
+        {
+            marked.push_back(snapshot);
+        }
+    }
+    std::sort(marked.begin(), marked.end());
+
+    size_t num_kept = 0;
+    for (const Snapshot* snapshot : retired_)
+    {
+        if (std::binary_search(marked.begin(), marked.end(), snapshot))
+        {
+            retired_[num_kept++] = snapshot;
+        }
+        else
+        {
+            delete snapshot;
+        }
+    }
+    retired_.resize(num_kept);
+}
+
+/**
+* Takes a hazard pointer no Reader is using, or adds one to the list.
+*/
+DelayModelStore::Hazard* DelayModelStore::AcquireHazard() const
+{
+    for (Hazard* hazard = hazards_.load(); hazard != nullptr; hazard = hazard->next)
+    {
+        bool in_use = false;
+        if (hazard->in_use.compare_exchange_strong(in_use, true))
+        {
+            return hazard;
+        }
+    }
+    Hazard* hazard = new Hazard();
+    hazard->in_use.store(true);
+    hazard->snapshot.store(nullptr);
+    hazard->next = hazards_.load();
+    while (!hazards_.compare_exchange_weak(hazard->next, hazard))
+    {
+    }
+    return hazard;
+}
+
+/**
+* The FODM covering time_ms: the last entry starting at or before time_ms,
+* and its last FODM starting at or before time_ms, if time_ms is before
+* the end of that FODM.
+*
+* Output params :
+*       entry: the entry of the FODM
+*
+* Returns :
+*       the FODM, or nullptr if there is none covering time_ms.
+*/
+const FoPoly* DelayModelStore::Snapshot::Find(double time_ms, const DelayModelEntry** entry) const
+{
+    auto entry_it = std::upper_bound(entries.begin(), entries.end(), time_ms,
+        [](double t, const std::shared_ptr<const DelayModelEntry>& e) { return t < e->fo_polys.front().start_time_ms; });
+    if (entry_it == entries.begin())
+    {
+        return nullptr;
+    }
+    const std::vector<FoPoly>& fo_polys = (*(entry_it - 1))->fo_polys;
+    auto fo_it = std::upper_bound(fo_polys.begin(), fo_polys.end(), time_ms,
+        [](double t, const FoPoly& fo_poly) { return t < fo_poly.start_time_ms; });
+    const FoPoly* fo_poly = &*(fo_it - 1);
+    if (!(time_ms < fo_poly->stop_time_ms))
+    {
+        return nullptr;
+    }
+    *entry = (entry_it - 1)->get();
+    return fo_poly;
+}
+
+/** DelayModelStore::Reader CONSTRUCTOR
+*
+* Input params:
+*       store: the store to read, which must outlive the Reader
+*/
+DelayModelStore::Reader::Reader(const DelayModelStore& store)
+    : store_(store),
+      hazard_(store.AcquireHazard())
+{
+}
+
+/** DelayModelStore::Reader DESTRUCTOR
+*
+* Leaves the hazard pointer to the next Reader.
+*/
+DelayModelStore::Reader::~Reader()
+{
+    hazard_->snapshot.store(nullptr);
+    hazard_->in_use.store(false);
+}
+
+/**
+* Marks the current snapshot of receptor. The snapshot is read again after
+* marking it, as the writer may have retired it, and checked the marks,
+* in between. Once it is marked and still current, the writer will not
+* delete it.
+*/
+const DelayModelStore::Snapshot* DelayModelStore::Reader::Acquire(int receptor) const
+{
+    assert (receptor >= 0 && receptor < store_.num_receptors_);
+    const std::atomic<const Snapshot*>& current = store_.snapshots_[receptor];
+    const Snapshot* snapshot = current.load();
+    while (true)
+    {
+        hazard_->snapshot.store(snapshot);
+        const Snapshot* check = current.load();
+        if (check == snapshot)
+        {
+            return snapshot;
+        }
+        snapshot = check;
+    }
+}
+
+void DelayModelStore::Reader::Release() const
+{
+    hazard_->snapshot.store(nullptr, std::memory_order_release);
+}
+
+/**
+* Finds the FODM of a receptor covering a timestamp.
+*
+* Input params:
+*       receptor: the receptor
+*       time_ms: the timestamp [ms]
+*
+* Output params :
+*       fo_poly: the FODM covering time_ms
+*
+* Returns :
+*       false if there is no FODM covering time_ms, true otherwise.
+*/
+bool DelayModelStore::Reader::FindFodm(int receptor, double time_ms, FoPoly& fo_poly) const
+{
+    const Snapshot* snapshot = Acquire(receptor);
+    const DelayModelEntry* entry;
+    const FoPoly* found = snapshot != nullptr ? snapshot->Find(time_ms, &entry) : nullptr;
+    if (found != nullptr)
+    {
+        fo_poly = *found;
+    }
+    Release();
+    return found != nullptr;
+}
+
+/**
+* Finds the HODM of a receptor the FODM covering a timestamp was derived from.
+*
+* Input params:
+*       receptor: the receptor
+*       time_ms: the timestamp [ms]
+*
+* Output params :
+*       ho_start_time_ms: the start time of the HODM [ms]
+*       ho_poly: the coefficients of the HODM, highest degree first
+*
+* Returns :
+*       false if there is no FODM covering time_ms, true otherwise.
+*/
+bool DelayModelStore::Reader::FindHodm(int receptor,
+                                       double time_ms,
+                                       double& ho_start_time_ms,
+                                       std::vector<double>& ho_poly) const
+{
+    const Snapshot* snapshot = Acquire(receptor);
+    const DelayModelEntry* entry = nullptr;
+    bool found = snapshot != nullptr && snapshot->Find(time_ms, &entry) != nullptr;
+    if (found)
+    {
+        ho_start_time_ms = entry->ho_start_time_ms;
+        ho_poly.assign(entry->ho_poly.begin(), entry->ho_poly.end());
+    }
+    Release();
+    return found;
+}
+
+}; // namespace ska_mid_cbf_fodm_gen
@@ -1,6 +1,12 @@
 #ifndef DELAY_MODEL_STORE_H
 #define DELAY_MODEL_STORE_H
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace ska_mid_cbf_fodm_gen
 {
 
@@ -15,6 +21,137 @@ struct FoPoly
     inline long double delay_linear() { return poly[0]; }
 };
 
+// A HODM of one receptor and the FODMs derived from it. The HODM is
+// highest degree first, with the time in s relative to ho_start_time_ms,
+// and fo_polys are consecutive and sorted by start time.
+struct DelayModelEntry
+{
+    double ho_start_time_ms;
+    double ho_stop_time_ms;
+    std::vector<double> ho_poly;
+    std::vector<FoPoly> fo_polys;
+};
+
+// The delay models of a set of receptors, indexed by validity time. One
+// thread at a time publishes the delay models as they arrive, and any
+// number of threads look up the FODM or HODM covering a timestamp without
+// blocking.
+//
+// Each receptor has an immutable snapshot of its entries sorted by start
+// time, which Publish() replaces with a new snapshot by an atomic pointer
+// swap, so a lookup sees either the old or the new entries. A new entry
+// supersedes the entries starting at or after its first FODM, and ends the
+// ones before it there. Lookups are a binary search over the entries and
+// over the FODMs of the entry, O(log n).
+//
+// A lookup goes through a Reader, which marks the snapshot in use with a
+// hazard pointer while reading it. A replaced snapshot is deleted by the
+// next Publish() or RemoveBefore() once no Reader is marking it. Readers
+// are cheap to keep, e.g. one per thread, and reuse the marks of destroyed
+// Readers.
+//
+// Example:
+//   DelayModelStore store(num_receptors);
+//   // writer thread
+//   store.Publish(receptor, entry);
+//   // reader thread
+//   DelayModelStore::Reader reader(store);
+//   FoPoly fo_poly;
+//   if (reader.FindFodm(receptor, time_ms, fo_poly)) { ... }
+class DelayModelStore
+{
+    struct Snapshot;
+    struct Hazard;
+
+public:
+    explicit DelayModelStore(int num_receptors);
+
+    ~DelayModelStore();
+
+    DelayModelStore(const DelayModelStore&) = delete;
+    DelayModelStore& operator=(const DelayModelStore&) = delete;
+
+    int num_receptors() const { return num_receptors_; }
+
+    // Adds the entry of receptor. Returns false, leaving the store as it
+    // is, if the entry has no FODMs.
+    bool Publish(int receptor, DelayModelEntry entry);
+
+    // Removes the entries of all receptors whose last FODM stops at or
+    // before time_ms
+    void RemoveBefore(double time_ms);
+
+    // Number of replaced snapshots not deleted yet, as a Reader is still
+    // marking them
+    size_t num_retired() const;
+
+    class Reader
+    {
+    public:
+        explicit Reader(const DelayModelStore& store);
+
+        ~Reader();
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        // The FODM of receptor covering time_ms, start_time_ms <= time_ms <
+        // stop_time_ms. Returns false if there is none.
+        bool FindFodm(int receptor, double time_ms, FoPoly& fo_poly) const;
+
+        // The HODM of receptor the FODM covering time_ms was derived from.
+        // ho_poly is only reallocated when it is too short. Returns false if
+        // there is no FODM covering time_ms.
+        bool FindHodm(int receptor, double time_ms, double& ho_start_time_ms, std::vector<double>& ho_poly) const;
+
+    private:
+        // Marks and returns the current snapshot of receptor
+        const Snapshot* Acquire(int receptor) const;
+
+        void Release() const;
+
+        const DelayModelStore& store_;
+        Hazard* hazard_;
+    };
+
+private:
+    // The entries of one receptor, sorted by start time. The entries are
+    // shared between the snapshots of a receptor.
+    struct Snapshot
+    {
+        std::vector<std::shared_ptr<const DelayModelEntry>> entries;
+
+        // The FODM covering time_ms and its entry, or nullptr
+        const FoPoly* Find(double time_ms, const DelayModelEntry** entry) const;
+    };
+
+    // A hazard pointer, in a list that only grows until the store is
+    // destroyed
+    struct Hazard
+    {
+        std::atomic<bool> in_use;
+        std::atomic<const Snapshot*> snapshot;
+        Hazard* next;
+    };
+
+    // Swaps in the new snapshot of receptor, with write_mutex_ held
+    void Replace(int receptor, const Snapshot* snapshot);
+
+    // Deletes the retired snapshots no Reader is marking, with write_mutex_ held
+    void Reclaim();
+
+    Hazard* AcquireHazard() const;
+
+    const int num_receptors_;
+    std::unique_ptr<std::atomic<const Snapshot*>[]> snapshots_;
+
+    mutable std::atomic<Hazard*> hazards_;
+
+    // Serializes the writers, the readers do not take it
+    mutable std::mutex write_mutex_;
+    std::vector<const Snapshot*> retired_;
+};
+
 
 }; // namespace ska_mid_cbf_fodm_gen
 
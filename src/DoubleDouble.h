@@ -0,0 +1,118 @@
+#ifndef DOUBLE_DOUBLE_H
+#define DOUBLE_DOUBLE_H
+
+#include <cmath>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// An unevaluated sum hi + lo of two doubles, giving ~106 bits of significand.
+struct DoubleDouble
+{
+    double hi;
+    double lo;
+};
+
+// Error free transformation of a + b: hi = fl(a + b), hi + lo = a + b exactly
+inline DoubleDouble TwoSum(double a, double b)
+{
+    double hi = a + b;
+    double b_virtual = hi - a;
+    double a_virtual = hi - b_virtual;
+    double lo = (a - a_virtual) + (b - b_virtual);
+    return DoubleDouble{hi, lo};
+}
+
+// Error free transformation of a * b: hi = fl(a * b), hi + lo = a * b exactly
+inline DoubleDouble TwoProd(double a, double b)
+{
+    double hi = a * b;
+    double lo = std::fma(a, b, -hi);
+    return DoubleDouble{hi, lo};
+}
+
+// Error free transformation of a + b for |a| >= |b|
+inline DoubleDouble FastTwoSum(double a, double b)
+{
+    double hi = a + b;
+    double lo = b - (hi - a);
+    return DoubleDouble{hi, lo};
+}
+
+// a + b in double-double, with a relative error of ~2^-104
+inline DoubleDouble operator+(const DoubleDouble& a, const DoubleDouble& b)
+{
+    DoubleDouble s = TwoSum(a.hi, b.hi);
+    DoubleDouble t = TwoSum(a.lo, b.lo);
+    s = FastTwoSum(s.hi, s.lo + t.hi);
+    return FastTwoSum(s.hi, s.lo + t.lo);
+}
+
+inline DoubleDouble& operator+=(DoubleDouble& a, const DoubleDouble& b)
+{
+    a = a + b;
+    return a;
+}
+
+// x * a in double-double, with a relative error of ~2^-104
+inline DoubleDouble operator*(double x, const DoubleDouble& a)
+{
+    DoubleDouble p = TwoProd(a.hi, x);
+    return FastTwoSum(p.hi, p.lo + a.lo * x);
+}
+
+inline DoubleDouble operator-(const DoubleDouble& a)
+{
+    return DoubleDouble{-a.hi, -a.lo};
+}
+
+// a / x in double-double, with a relative error of ~2^-104. The remainder
+// of the first quotient is exact with TwoProd, and divided again.
+inline DoubleDouble operator/(const DoubleDouble& a, double x)
+{
+    double q = a.hi / x;
+    DoubleDouble p = TwoProd(q, x);
+    double r = ((a.hi - p.hi) - p.lo + a.lo) / x;
+    return FastTwoSum(q, r);
+}
+
+/**
+ * Evaluates the polynomial at x with the compensated Horner scheme
+ * (Graillat, Langlois and Louvet, 2005). Horner's method is run in double,
+ * and the rounding errors of every multiplication and addition, which are
+ * exact with TwoProd and TwoSum, are accumulated in a second Horner
+ * recurrence. The result is returned unrounded as hi + lo.
+ *
+ * Error bound: with u = 2^-53, n = num_coeff - 1 the degree, and
+ * gamma(k) = k u / (1 - k u),
+ *
+ *   |hi + lo - p(x)| <= gamma(2n)^2 * sum(|poly[i]| * |x|^(n - i))
+ *
+ * i.e. the result is as accurate as Horner's method in ~106 bit arithmetic.
+ * Converting hi + lo to long double adds the usual half ulp of long double.
+ *
+ * Input Params:
+ *   poly - polynomial to evaluate. Highest degree coefficient first.
+ *   num_coeff - number of coefficients in the polynomial
+ *   x - evaluate the polynomial at this point
+ *
+ * Returns:
+ *   the evaluated value as hi + lo
+ */
+inline DoubleDouble CompensatedHorner(const double* poly, int num_coeff, double x)
+{
+    double s = poly[0];
+    double c = 0.0;
+    for (int ii = 1; ii < num_coeff; ii++)
+    {
+        DoubleDouble prod = TwoProd(s, x);
+        DoubleDouble sum = TwoSum(prod.hi, poly[ii]);
+        s = sum.hi;
+        c = c * x + (prod.lo + sum.lo);
+    }
+    return DoubleDouble{s, c};
+}
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
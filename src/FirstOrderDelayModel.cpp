@@ -1,21 +1,99 @@
 #include "FirstOrderDelayModel.h"
+#include "DoubleDouble.h"
+#include "FodmMetrics.h"
+#include "FodmWorkspace.h"
+#include "MultiPointHorner.h"
+#include "TaylorShift.h"
+#include "ThreadPool.h"
 
 #include <math.h>
+#include <cmath>
 #include <fstream>
 #include <iomanip>
 #include <cassert> 
+#include <limits>
+#include <algorithm>
+#include <atomic>
 #include <boost/multiprecision/cpp_bin_float.hpp> 
 using namespace boost::multiprecision;
 
 namespace ska_mid_cbf_fodm_gen
 {
 
+namespace
+{
+
+// Size of the stack buffer of the workspace of the vector process(), which
+// holds the scratch buffers of a few hundred FOs without allocating [bytes]
+const size_t WORKSPACE_BUFFER_SIZE = 4096;
+
+// The multi-point Horner evaluations of MultiPointHorner.h, unrolled for
+// kNumCoeffs coefficients, or the loops over num_coeff for 0
+template <int kNumCoeffs>
+void HodmHorner(const double* poly, int /* num_coeff */, const double* x, size_t num_points, double* y)
+{
+    HornerMultiPoint<kNumCoeffs>(poly, x, num_points, y);
+}
+
+template <>
+void HodmHorner<0>(const double* poly, int num_coeff, const double* x, size_t num_points, double* y)
+{
+    HornerMultiPoint(poly, num_coeff, x, num_points, y);
+}
+
+template <int kNumCoeffs>
+void HodmCompensatedHorner(const double* poly, int /* num_coeff */, const double* x, size_t num_points,
+                           double* y_hi, double* y_lo)
+{
+    CompensatedHornerMultiPoint<kNumCoeffs>(poly, x, num_points, y_hi, y_lo);
+}
+
+template <>
+void HodmCompensatedHorner<0>(const double* poly, int num_coeff, const double* x, size_t num_points,
+                              double* y_hi, double* y_lo)
+{
+    CompensatedHornerMultiPoint(poly, num_coeff, x, num_points, y_hi, y_lo);
+}
+
+}; // namespace
+
 /** FirstOrderDelayModel CONSTRUCTOR
 *
 * Method: FirstOrderDelayModel
 *
 */
 FirstOrderDelayModel::FirstOrderDelayModel() 
+    : precision_(PolyvalPrecision::Default),
+      lsq_fit_method_(LsqFitMethod::Sampled)
+{
+    // no-op
+}
+
+/** FirstOrderDelayModel CONSTRUCTOR
+*
+* Method: FirstOrderDelayModel
+*
+* Input params:
+*       precision: arithmetic used to evaluate the high order polynomial
+*/
+FirstOrderDelayModel::FirstOrderDelayModel(PolyvalPrecision precision)
+    : precision_(precision),
+      lsq_fit_method_(LsqFitMethod::Sampled)
+{
+    // no-op
+}
+
+/** FirstOrderDelayModel CONSTRUCTOR
+*
+* Method: FirstOrderDelayModel
+*
+* Input params:
+*       precision: arithmetic used to evaluate the high order polynomial
+*       lsq_fit_method: how process() with least squares fitting fits the FOs
+*/
+FirstOrderDelayModel::FirstOrderDelayModel(PolyvalPrecision precision, LsqFitMethod lsq_fit_method)
+    : precision_(precision),
+      lsq_fit_method_(lsq_fit_method)
 {
     // no-op
 }
@@ -46,10 +124,155 @@ bool FirstOrderDelayModel::process( double ho_t_start,
                                     const double* ho_poly,
                                     int num_fo_poly,
                                     const std::vector<double>& fo_t_start,
-                                    std::vector<long double>& fo_poly)
+                                    std::vector<long double>& fo_poly) const
+{
+    fo_poly.resize(num_fo_poly * 2); // 2 coefficients for each FO poly. 
+    char buffer[WORKSPACE_BUFFER_SIZE];
+    FodmWorkspace workspace(buffer, sizeof(buffer));
+    return process(ho_t_start, ho_t_stop, num_ho_coeff, ho_poly, num_fo_poly, fo_t_start.data(), fo_poly.data(), nullptr, workspace);
+}
+
+/** 
+* Same as above, and also returns the HO polynomial evaluated at the FO
+* boundaries. The end time of a FO is the start time of the next one, so
+* each of the num_fo_poly + 1 boundaries is evaluated once, and the slope
+* and intercept of the FOs are derived from the evaluated delays.
+*
+* Input params:    
+*       ho_t_start: high order poly start time [s]
+*       ho_t_stop: high order poly start time [s]
+*       num_ho_coeff: number of coeffecients in the high order poly
+*       ho_poly: high order polynomial
+*       num_fo_poly: number of first order delay models
+*       fo_t_start: pointer to an array of length num_fo_poly + 1, containing the start time stamps of the FOs
+*                   to be derived AND the end time of the last FO as the last element. 
+*
+* Output params :
+*       fo_poly: pointer to store first order polynomials (array length = num_fo_poly and unit = [ns/s , ns])
+*       fo_t_delay: the delay at each time of fo_t_start (array length = num_fo_poly + 1 and unit = [ns]).
+*                   Its storage is reused when the same vector is passed to every call.
+*
+* Returns :
+*       false if there is any unexpected HO and FO polynomial time parameter, true otherwise.
+*/
+bool FirstOrderDelayModel::process( double ho_t_start,
+                                    double ho_t_stop,
+                                    int num_ho_coeff,
+                                    const double* ho_poly,
+                                    int num_fo_poly,
+                                    const std::vector<double>& fo_t_start,
+                                    std::vector<long double>& fo_poly,
+                                    std::vector<long double>& fo_t_delay) const
 {
     fo_poly.resize(num_fo_poly * 2); // 2 coefficients for each FO poly. 
+    fo_t_delay.resize(num_fo_poly + 1);
+    char buffer[WORKSPACE_BUFFER_SIZE];
+    FodmWorkspace workspace(buffer, sizeof(buffer));
+    return process(ho_t_start, ho_t_stop, num_ho_coeff, ho_poly, num_fo_poly, fo_t_start.data(), fo_poly.data(), fo_t_delay.data(), workspace);
+}
+
+/** 
+* The two point process() on caller-owned buffers, with the scratch buffers
+* taken from workspace.
+*
+* Input params:    
+*       see the two point process()
+*       fo_t_start: array of length num_fo_poly + 1, containing the start time stamps of the FOs
+*                   AND the end time of the last FO as the last element.
+*
+* Output params :
+*       fo_poly: array of length num_fo_poly * 2 to store first order polynomials (unit = [ns/s , ns])
+*       fo_t_delay: array of length num_fo_poly + 1 for the delay at each time of fo_t_start [ns],
+*                   or nullptr if it is not needed
+*       workspace: the scratch buffers are allocated from it
+*
+* Returns :
+*       false if there is any unexpected HO and FO polynomial time parameter, true otherwise.
+*/
+bool FirstOrderDelayModel::process( double ho_t_start,
+                                    double ho_t_stop,
+                                    int num_ho_coeff,
+                                    const double* ho_poly,
+                                    int num_fo_poly,
+                                    const double* fo_t_start,
+                                    long double* fo_poly,
+                                    long double* fo_t_delay,
+                                    FodmWorkspace& workspace) const
+{
+    FODM_METRICS_TIME_STAGE(FodmStage::Process);
+    bool time_inputs_ok = DispatchNumCoeff(num_ho_coeff, [&](auto num_coeffs)
+    {
+        return this->template process_two_point<decltype(num_coeffs)::value>(ho_t_start, ho_t_stop, num_ho_coeff,
+            ho_poly, num_fo_poly, fo_t_start, fo_poly, fo_t_delay, workspace);
+    });
+    FODM_METRICS_ADD(FodmCounter::FodmsProduced, num_fo_poly);
+    FODM_METRICS_ADD(FodmCounter::TimeInputFailures, time_inputs_ok ? 0 : 1);
+    return time_inputs_ok;
+}
+
+/** process
+*  Description:
+*       process() on caller-owned buffers for a HO polynomial of NumCoeffs
+*       coefficients, with the HO polynomial evaluation unrolled for them.
+*
+* Input params:    
+*       see process() on caller-owned buffers, with num_ho_coeff = NumCoeffs
+*
+* Output params :
+*       see process() on caller-owned buffers
+*
+* Returns :
+*       false if there is any unexpected HO and FO polynomial time parameter, true otherwise.
+*/
+template <int NumCoeffs>
+bool FirstOrderDelayModel::process( double ho_t_start,
+                                    double ho_t_stop,
+                                    const double* ho_poly,
+                                    int num_fo_poly,
+                                    const double* fo_t_start,
+                                    long double* fo_poly,
+                                    long double* fo_t_delay,
+                                    FodmWorkspace& workspace) const
+{
+    static_assert(NumCoeffs >= 2 && NumCoeffs <= MAX_UNROLLED_NUM_COEFF, "NumCoeffs out of the unrolled range");
+    FODM_METRICS_TIME_STAGE(FodmStage::Process);
+    bool time_inputs_ok = process_two_point<NumCoeffs>(ho_t_start, ho_t_stop, NumCoeffs, ho_poly, num_fo_poly,
+        fo_t_start, fo_poly, fo_t_delay, workspace);
+    FODM_METRICS_ADD(FodmCounter::FodmsProduced, num_fo_poly);
+    FODM_METRICS_ADD(FodmCounter::TimeInputFailures, time_inputs_ok ? 0 : 1);
+    return time_inputs_ok;
+}
+
+template <int kNumCoeffs>
+bool FirstOrderDelayModel::process_two_point( double ho_t_start,
+                                              double ho_t_stop,
+                                              int num_ho_coeff,
+                                              const double* ho_poly,
+                                              int num_fo_poly,
+                                              const double* fo_t_start,
+                                              long double* fo_poly,
+                                              long double* fo_t_delay,
+                                              FodmWorkspace& workspace) const
+{
+    if (precision_ == PolyvalPrecision::TaylorShift)
+    {
+        return process_taylor_shift(ho_t_start, ho_t_stop, num_ho_coeff, ho_poly, num_fo_poly, fo_t_start, fo_poly, fo_t_delay, workspace);
+    }
+
     bool time_inputs_ok = true;
+    if (fo_t_delay == nullptr)
+    {
+        fo_t_delay = workspace.Allocate<long double>(num_fo_poly + 1);
+    }
+
+    // Evaluate the HO polynomial at every FO boundary at once, so that the
+    // evaluation can be vectorized
+    double* t = workspace.Allocate<double>(num_fo_poly + 1);
+    for (int ii = 0; ii <= num_fo_poly; ii++)
+    {
+        t[ii] = fo_t_start[ii] - ho_t_start;
+    }
+    polyval<kNumCoeffs>(ho_poly, num_ho_coeff, t, num_fo_poly + 1, fo_t_delay, workspace);
 
     for (int ii = 0; ii < num_fo_poly; ii++)
     {
@@ -57,10 +280,10 @@ bool FirstOrderDelayModel::process( double ho_t_start,
         {
             time_inputs_ok = false;
         }
-        double t1 = fo_t_start[ii] - ho_t_start;
-        double t2 = fo_t_start[ii+1] - ho_t_start;
-        long double y1 = polyval(ho_poly, num_ho_coeff, t1);
-        long double y2 = polyval(ho_poly, num_ho_coeff, t2);
+        double t1 = t[ii];
+        double t2 = t[ii+1];
+        long double y1 = fo_t_delay[ii];
+        long double y2 = fo_t_delay[ii+1];
         long double m = (y2 - y1) / (t2 - t1);
         fo_poly[ii*2] = m;
         fo_poly[ii*2 + 1] = y1;
@@ -70,7 +293,8 @@ bool FirstOrderDelayModel::process( double ho_t_start,
 }
 
 /**
- * Evaluate the polynomial at x using Horner's method
+ * Evaluate the polynomial at x using Horner's method, in cpp_bin_float_50
+ * or with the compensated Horner scheme depending on the precision policy
  * 
  * Input Params:
  *   ho_poly - polynomial to evaluate. Highest degree coefficient first.
@@ -80,8 +304,16 @@ bool FirstOrderDelayModel::process( double ho_t_start,
  * Returns:
  *   the evaluated value
  */
-long double FirstOrderDelayModel::polyval(const double* ho_poly, int num_ho_coeff, double x)
+template <int kNumCoeffs>
+long double FirstOrderDelayModel::polyval(const double* ho_poly, int num_ho_coeff, double x) const
 {
+    num_ho_coeff = kNumCoeffs > 0 ? kNumCoeffs : num_ho_coeff;
+    if (precision_ == PolyvalPrecision::DoubleDouble)
+    {
+        DoubleDouble y = CompensatedHorner(ho_poly, num_ho_coeff, x);
+        return static_cast<long double>(y.hi) + y.lo;
+    }
+
     cpp_bin_float_50 y = ho_poly[0];
     for (int ii = 1; ii < num_ho_coeff; ii++) 
     {
@@ -91,6 +323,43 @@ long double FirstOrderDelayModel::polyval(const double* ho_poly, int num_ho_coef
     return static_cast<long double>(y);
 }
 
+/**
+ * Evaluate the polynomial at num_points points, with the SIMD kernels of
+ * MultiPointHorner.h for the compensated Horner scheme. The results are
+ * the same as polyval at each point.
+ * 
+ * Input Params:
+ *   ho_poly - polynomial to evaluate. Highest degree coefficient first.
+ *   num_ho_coeff - number of coefficients in the polynomial
+ *   x - the num_points points to evaluate the polynomial at
+ *   num_points - number of points
+ * 
+ * Output Params:
+ *   y - the num_points evaluated values
+ *   workspace - the scratch buffers are allocated from it
+ */
+template <int kNumCoeffs>
+void FirstOrderDelayModel::polyval(const double* ho_poly, int num_ho_coeff, const double* x, size_t num_points, long double* y,
+                                   FodmWorkspace& workspace) const
+{
+    if (precision_ == PolyvalPrecision::DoubleDouble)
+    {
+        double* y_hi = workspace.Allocate<double>(num_points);
+        double* y_lo = workspace.Allocate<double>(num_points);
+        HodmCompensatedHorner<kNumCoeffs>(ho_poly, num_ho_coeff, x, num_points, y_hi, y_lo);
+        for (size_t ii = 0; ii < num_points; ii++)
+        {
+            y[ii] = static_cast<long double>(y_hi[ii]) + y_lo[ii];
+        }
+        return;
+    }
+
+    for (size_t ii = 0; ii < num_points; ii++)
+    {
+        y[ii] = polyval<kNumCoeffs>(ho_poly, num_ho_coeff, x[ii]);
+    }
+}
+
 
 /** process
 *  Description:
@@ -123,7 +392,45 @@ bool FirstOrderDelayModel::process(double ho_t_start,
                                    int num_lsq_points, 
                                    int num_fo_poly, 
                                    const std::vector<double>& fo_t_start, 
-                                   std::vector<long double>& fo_poly)
+                                   std::vector<long double>& fo_poly) const
+{
+    assert (ho_poly!=NULL);
+    assert (num_lsq_points>=1);
+    assert (num_ho_coeff>=2);
+    assert (num_fo_poly>=1);
+
+    fo_poly.resize(num_fo_poly * 2); // 2 coefficients for each FO poly. 
+    char buffer[WORKSPACE_BUFFER_SIZE];
+    FodmWorkspace workspace(buffer, sizeof(buffer));
+    return process(ho_t_start, ho_t_stop, num_ho_coeff, ho_poly, num_lsq_points, num_fo_poly,
+        fo_t_start.data(), fo_poly.data(), nullptr, workspace);
+}
+
+/** process_sampled
+*  Description:
+*       The least squares fit of process() over the num_lsq_points + 1
+*       fitting points of each FO, with the normal equations summed up.
+*
+* Input params:    
+*       see process() with least squares fitting
+*
+* Output params :
+*       fo_poly: array of length num_fo_poly * 2 to store first order polynomials (unit = [ns/s , ns])
+*       workspace: the scratch buffers are allocated from it
+*
+* Returns :
+*       false if there is any unexpected HO and FO polynomial time parameter, true otherwise.
+*/
+template <int kNumCoeffs>
+bool FirstOrderDelayModel::process_sampled(double ho_t_start, 
+                                           double ho_t_stop, 
+                                           int num_ho_coeff, 
+                                           const double* ho_poly,
+                                           int num_lsq_points, 
+                                           int num_fo_poly, 
+                                           const double* fo_t_start, 
+                                           long double* fo_poly,
+                                           FodmWorkspace& workspace) const
 {
     double t_s;
     double y_t;  
@@ -132,16 +439,14 @@ bool FirstOrderDelayModel::process(double ho_t_start,
     long double xty[2] = {0};
     long double det;
     double t_fitting_incr;
-    int time_elapsed  = 0;
-        
-    assert (ho_poly!=NULL);
-    assert (num_lsq_points>=1);
-    assert (num_ho_coeff>=2);
-    assert (num_fo_poly>=1);
 
     bool time_inputs_ok = true;
 
-    fo_poly.resize(num_fo_poly * 2); // 2 coefficients for each FO poly. 
+    // The fitting points of a FO, and the HO polynomial evaluated at them
+    double* t_lsq = workspace.Allocate<double>(num_lsq_points + 1);
+    double* y_lsq = workspace.Allocate<double>(num_lsq_points + 1);
+    long double* y_lsq_ld = workspace.Allocate<long double>(num_lsq_points + 1);
+    DoubleDouble* shifted = workspace.Allocate<DoubleDouble>(num_ho_coeff);
 
     for (int i = 0; i < num_fo_poly; i++)
     {   
@@ -158,17 +463,50 @@ bool FirstOrderDelayModel::process(double ho_t_start,
         t_fitting_incr = (fo_t_start[i+1] -  fo_t_start[i])/num_lsq_points;
         for (int j = 0; j <= num_lsq_points; j++) 
         {           
-            t_s = fo_t_start[i] + j*t_fitting_incr - ho_t_start;
-            //evaluate the y value at the corresponding time sample
-            y_t = ho_poly[0];
-            for	(int k = 1; k < num_ho_coeff; k++){
-                y_t = y_t*t_s + ho_poly[k];
+            t_lsq[j] = fo_t_start[i] + j*t_fitting_incr - ho_t_start;
+        }
+        //evaluate the y values at the corresponding time samples
+        if (precision_ == PolyvalPrecision::Default)
+        {
+            HodmHorner<kNumCoeffs>(ho_poly, num_ho_coeff, t_lsq, num_lsq_points + 1, y_lsq);
+        }
+        else if (precision_ == PolyvalPrecision::TaylorShift)
+        {
+            // HO poly re-centered on the FO start, evaluated at j*t_fitting_incr
+            TaylorShift(ho_poly, num_ho_coeff, t_lsq[0], shifted);
+            for (int j = 0; j <= num_lsq_points; j++) 
+            {           
+                DoubleDouble y = shifted[num_ho_coeff - 1];
+                for (int k = num_ho_coeff - 2; k >= 0; k--)
+                {
+                    y = (j*t_fitting_incr) * y + shifted[k];
+                }
+                y_lsq_ld[j] = static_cast<long double>(y.hi) + y.lo;
+            }
+        }
+        else
+        {
+            polyval<kNumCoeffs>(ho_poly, num_ho_coeff, t_lsq, num_lsq_points + 1, y_lsq_ld, workspace);
+        }
+
+        for (int j = 0; j <= num_lsq_points; j++) 
+        {           
+            if (precision_ == PolyvalPrecision::Default)
+            {
+                y_t = y_lsq[j];
+                t_s = j*t_fitting_incr;
+                xty[0] += y_t;
+                xty[1] += t_s * y_t;
+            }
+            else
+            {
+                long double y_t_ld = y_lsq_ld[j];
+                t_s = j*t_fitting_incr;
+                xty[0] += y_t_ld;
+                xty[1] += t_s * y_t_ld;
             }
-            t_s = j*t_fitting_incr;
             xtx[1] += t_s;
             xtx[3] += t_s * t_s;
-            xty[0] += y_t;
-            xty[1] += t_s * y_t;
         }
         xtx[0] = num_lsq_points+1;
         xtx[2] = xtx[1];       
@@ -185,4 +523,1047 @@ bool FirstOrderDelayModel::process(double ho_t_start,
     return time_inputs_ok;
 }
 
+
+namespace
+{
+
+/**
+* The per FO part of process_closed_form, in arithmetic T.
+*
+* Input params:    
+*       num_ho_coeff: number of coeffecients in the high order poly
+*       ho_poly: high order polynomial
+*       moments: C_0 .. C_num_ho_coeff, the moments of the fitting points
+*       t_start: the FO start time relative to the high order poly start time [s]
+*       t_stop: the FO stop time relative to the high order poly start time [s]
+*
+* Output params :
+*       shifted: scratch buffer of num_ho_coeff elements
+*       delay_linear: the FO slope [ns/s]
+*       delay_const: the FO delay at t_start [ns]
+*/
+template <typename T>
+void ClosedFormLsqFit(int num_ho_coeff,
+                      const double* ho_poly,
+                      const long double* moments,
+                      T t_start,
+                      T t_stop,
+                      T* shifted,
+                      long double& delay_linear,
+                      long double& delay_const)
+{
+    T half_interval = (t_stop - t_start) / 2;
+    TaylorShift(ho_poly, num_ho_coeff, t_start + half_interval, shifted);
+
+    // r_k = shifted[k] * half_interval^k, even k for alpha and odd k for beta
+    T alpha = shifted[0];
+    T beta = shifted[1] * half_interval * static_cast<T>(moments[2]);
+    T scale = half_interval;
+    for (int k = 2; k < num_ho_coeff; k += 2)
+    {
+        scale *= half_interval;
+        alpha += shifted[k] * scale * static_cast<T>(moments[k]);
+        if (k + 1 < num_ho_coeff)
+        {
+            beta += shifted[k+1] * (scale * half_interval) * static_cast<T>(moments[k+2]);
+        }
+    }
+    beta /= static_cast<T>(moments[2]);
+
+    // slope, and the delay at the FO start time (u = -1)
+    delay_linear = half_interval > 0 ? beta / half_interval : shifted[1];
+    delay_const = alpha - beta;
+}
+
+}; // namespace
+
+/** process_closed_form
+*  Description:
+*       The least squares fit of process() in closed form. With u in [-1, 1]
+*       the time relative to the FO center in units of half the FO interval,
+*       and the HO poly re-centered on the FO, y(u) = sum(r_k * u^k), the
+*       least squares line y = alpha + beta * u over a set of points
+*       symmetric about the center only depends on the point moments
+*       C_k = mean(u^k), which vanish for odd k:
+*           alpha = sum(r_k * C_k) over even k
+*           beta  = sum(r_k * C_(k+1)) / C_2 over odd k
+*       The moments of the num_lsq_points + 1 points used by the sampled fit
+*       are the same for every FO and are computed once. For the continuous
+*       interval C_k = 1 / (k + 1).
+*
+*       The re-centering and the fit are done in double with the Default
+*       precision, like the sampled fit, and in long double otherwise.
+*
+* Input params:    
+*       see process() with least squares fitting
+*
+* Output params :
+*       fo_poly: array of length num_fo_poly * 2 to store first order polynomials (unit = [ns/s , ns])
+*       workspace: the scratch buffers are allocated from it
+*
+* Returns :
+*       false if there is any unexpected HO and FO polynomial time parameter, true otherwise.
+*/
+bool FirstOrderDelayModel::process_closed_form(double ho_t_start, 
+                                               double ho_t_stop, 
+                                               int num_ho_coeff, 
+                                               const double* ho_poly,
+                                               int num_lsq_points, 
+                                               int num_fo_poly, 
+                                               const double* fo_t_start, 
+                                               long double* fo_poly,
+                                               FodmWorkspace& workspace) const
+{
+    bool time_inputs_ok = true;
+
+    // Moments of the fitting points, C_0 .. C_(num_ho_coeff + 1)
+    long double* moments = workspace.Allocate<long double>(num_ho_coeff + 2);
+    std::fill(moments, moments + num_ho_coeff + 2, 0.0L);
+    for (int k = 0; k < num_ho_coeff + 2; k += 2)
+    {
+        if (lsq_fit_method_ == LsqFitMethod::Continuous)
+        {
+            moments[k] = 1.0L / (k + 1);
+            continue;
+        }
+        for (int j = 0; j <= num_lsq_points; j++)
+        {
+            long double u = static_cast<long double>(2 * j - num_lsq_points) / num_lsq_points;
+            moments[k] += std::pow(u, k);
+        }
+        moments[k] /= num_lsq_points + 1;
+    }
+
+    double* shifted = workspace.Allocate<double>(num_ho_coeff);
+    long double* shifted_ld = workspace.Allocate<long double>(num_ho_coeff);
+    for (int i = 0; i < num_fo_poly; i++)
+    {
+        if (fo_t_start[i+1] > ho_t_stop || fo_t_start[i] < ho_t_start || fo_t_start[i+1] < fo_t_start[i])
+        {            
+            time_inputs_ok = false;
+        }
+
+        if (precision_ == PolyvalPrecision::Default)
+        {
+            ClosedFormLsqFit<double>(num_ho_coeff, ho_poly, moments,
+                fo_t_start[i] - ho_t_start, fo_t_start[i+1] - ho_t_start,
+                shifted, fo_poly[2*i], fo_poly[2*i+1]);
+        }
+        else
+        {
+            ClosedFormLsqFit<long double>(num_ho_coeff, ho_poly, moments,
+                static_cast<long double>(fo_t_start[i]) - ho_t_start, static_cast<long double>(fo_t_start[i+1]) - ho_t_start,
+                shifted_ld, fo_poly[2*i], fo_poly[2*i+1]);
+        }
+    }
+
+    return time_inputs_ok;
+}
+
+
+/** process_taylor_shift
+*  Description:
+*       The two point process() with the HO poly re-centered on each FO
+*       start time in double-double, q(x) = p(t1 + x) = sum(b_k * x^k).
+*       The delay constant is b_0 = p(t1), and the slope between the two
+*       points is (q(L) - q(0)) / L = sum(b_k * L^(k-1)) for k >= 1, with
+*       L the FO interval, so there is no cancellation between the delays
+*       at the start and stop times.
+*
+* Input params:    
+*       see the two point process()
+*
+* Output params :
+*       fo_poly: array of length num_fo_poly * 2 to store first order polynomials (unit = [ns/s , ns])
+*       fo_t_delay: the delay at each time of fo_t_start (array length = num_fo_poly + 1 and unit = [ns]),
+*                   or nullptr if it is not needed
+*       workspace: the scratch buffers are allocated from it
+*
+* Returns :
+*       false if there is any unexpected HO and FO polynomial time parameter, true otherwise.
+*/
+bool FirstOrderDelayModel::process_taylor_shift( double ho_t_start,
+                                                 double ho_t_stop,
+                                                 int num_ho_coeff,
+                                                 const double* ho_poly,
+                                                 int num_fo_poly,
+                                                 const double* fo_t_start,
+                                                 long double* fo_poly,
+                                                 long double* fo_t_delay,
+                                                 FodmWorkspace& workspace) const
+{
+    bool time_inputs_ok = true;
+
+    DoubleDouble* shifted = workspace.Allocate<DoubleDouble>(num_ho_coeff);
+    DoubleDouble stop_delay = {0.0, 0.0};
+    for (int ii = 0; ii < num_fo_poly; ii++)
+    {
+        if (fo_t_start[ii+1] > ho_t_stop || fo_t_start[ii] < ho_t_start || fo_t_start[ii+1] < fo_t_start[ii]) 
+        {
+            time_inputs_ok = false;
+        }
+        double t1 = fo_t_start[ii] - ho_t_start;
+        double t2 = fo_t_start[ii+1] - ho_t_start;
+        double interval = t2 - t1;
+        TaylorShift(ho_poly, num_ho_coeff, t1, shifted);
+
+        DoubleDouble m = shifted[num_ho_coeff - 1];
+        for (int k = num_ho_coeff - 2; k >= 1; k--)
+        {
+            m = interval * m + shifted[k];
+        }
+        fo_poly[ii*2] = static_cast<long double>(m.hi) + m.lo;
+        fo_poly[ii*2 + 1] = static_cast<long double>(shifted[0].hi) + shifted[0].lo;
+        if (fo_t_delay != nullptr)
+        {
+            fo_t_delay[ii] = fo_poly[ii*2 + 1];
+        }
+        stop_delay = interval * m + shifted[0];
+    }
+    if (fo_t_delay != nullptr)
+    {
+        fo_t_delay[num_fo_poly] = static_cast<long double>(stop_delay.hi) + stop_delay.lo;
+    }
+
+    return time_inputs_ok;
+}
+
+namespace
+{
+
+/**
+* Re-centers the HO poly on the FO center and scales it to u in [-1, 1],
+* the time relative to the FO center in units of half the FO interval, so
+* that the FO is y(u) = sum(r_k * u^k).
+*
+* Input params:    
+*       num_ho_coeff: number of coeffecients in the high order poly
+*       ho_poly: high order polynomial
+*       t_start: the FO start time relative to the high order poly start time [s]
+*       t_stop: the FO stop time relative to the high order poly start time [s]
+*
+* Output params :
+*       r: the num_ho_coeff coefficients r_k, lowest degree first
+*
+* Returns :
+*       half the FO interval [s]. When it is 0, r holds the delay and the
+*       slope at t_start instead and the other coefficients are not scaled.
+*/
+template <typename T>
+T CenterOnUnitInterval(int num_ho_coeff, const double* ho_poly, T t_start, T t_stop, T* r)
+{
+    T half_interval = (t_stop - t_start) / 2;
+    TaylorShift(ho_poly, num_ho_coeff, t_start + half_interval, r);
+    if (half_interval > 0)
+    {
+        T scale = 1;
+        for (int k = 1; k < num_ho_coeff; k++)
+        {
+            scale *= half_interval;
+            r[k] *= scale;
+        }
+    }
+    return half_interval;
+}
+
+/**
+* Whether y''(u) does not change sign on [-1, 1], from |2 * r_2| reaching
+* the largest possible contribution of the higher degree terms, up to
+* rounding so that an inflection point at a FO end does not depend on it.
+* y - line is then convex or concave for any line, with a single extremum
+* inside the interval.
+*/
+template <typename T>
+bool ConstantCurvature(int num_ho_coeff, const T* r)
+{
+    if (num_ho_coeff < 3)
+    {
+        return false;
+    }
+    T higher_terms = 0;
+    for (int k = 3; k < num_ho_coeff; k++)
+    {
+        higher_terms += static_cast<T>(k * (k - 1)) * std::abs(r[k]);
+    }
+    return std::abs(2 * r[2]) >= higher_terms * (1 - 16 * std::numeric_limits<T>::epsilon());
+}
+
+/**
+* Solves sum(k * r_k * u^(k-1)) over k >= 2 equal to slope_excess, i.e.
+* y'(u) = r_1 + slope_excess, for u in [-1, 1] with Newton's method kept
+* inside the bracket. The left hand side must be monotonic, see
+* ConstantCurvature(). When there is no solution the closest end is
+* returned.
+*/
+template <typename T>
+T FindSlopePoint(int num_ho_coeff, const T* r, T slope_excess)
+{
+    // g(u) = y'(u) - r_1 - slope_excess = u * h(u) - slope_excess, and g'(u)
+    auto eval = [&](T u, T& dg)
+    {
+        T h = static_cast<T>(num_ho_coeff - 1) * r[num_ho_coeff - 1];
+        T dh = 0;
+        for (int k = num_ho_coeff - 2; k >= 2; k--)
+        {
+            dh = dh * u + h;
+            h = h * u + static_cast<T>(k) * r[k];
+        }
+        dg = h + u * dh;
+        return u * h - slope_excess;
+    };
+
+    T lo = -1;
+    T hi = 1;
+    T dg;
+    T g_lo = eval(lo, dg);
+    T g_hi = eval(hi, dg);
+    if ((g_lo < 0) == (g_hi < 0))
+    {
+        return std::abs(g_lo) < std::abs(g_hi) ? lo : hi;
+    }
+
+    // start from the solution for a parabola
+    T u = slope_excess / (2 * r[2]);
+    for (int iter = 0; iter < 64; iter++)
+    {
+        if (!(u > lo && u < hi))
+        {
+            u = (lo + hi) / 2;
+        }
+        T g = eval(u, dg);
+        if (g == 0)
+        {
+            break;
+        }
+        if ((g < 0) == (g_lo < 0))
+        {
+            lo = u;
+        }
+        else
+        {
+            hi = u;
+        }
+        T next = u - g / dg;
+        if (std::abs(next - u) <= std::numeric_limits<T>::epsilon())
+        {
+            u = next;
+            break;
+        }
+        u = next;
+    }
+    return std::min(std::max(u, T(-1)), T(1));
+}
+
+/**
+* Evaluates the degree 2 and higher terms of y(u), sum(r_k * u^k) over k >= 2.
+*/
+template <typename T>
+T NonLinearTerms(int num_ho_coeff, const T* r, T u)
+{
+    T y = 0;
+    for (int k = num_ho_coeff - 1; k >= 2; k--)
+    {
+        y = (y + r[k]) * u;
+    }
+    return y * u;
+}
+
+/**
+* Converts the degree 2 and higher terms of y(u) to a Chebyshev series,
+* sum(c_j * T_j(u)), with Horner's method in the Chebyshev basis:
+* u * T_0 = T_1 and u * T_j = (T_(j+1) + T_(j-1)) / 2.
+*
+* Output params :
+*       c: the num_ho_coeff coefficients c_j
+*/
+template <typename T>
+void NonLinearChebyshev(int num_ho_coeff, const T* r, T* c)
+{
+    std::fill(c, c + num_ho_coeff, T(0));
+    int degree = 0;
+    for (int k = num_ho_coeff - 1; k >= 0; k--)
+    {
+        if (k < num_ho_coeff - 1)
+        {
+            // c *= u
+            T below = c[0];
+            c[0] = degree >= 1 ? c[1] / 2 : 0;
+            for (int j = 1; j <= degree + 1; j++)
+            {
+                T current = j <= degree ? c[j] : 0;
+                T above = j + 1 <= degree ? c[j+1] : 0;
+                c[j] = (j == 1 ? below : below / 2) + above / 2;
+                below = current;
+            }
+            degree++;
+        }
+        c[0] += k >= 2 ? r[k] : 0;
+    }
+}
+
+/**
+* The per FO part of process_minimax, in arithmetic T.
+*
+* When the curvature does not change sign, the minimax line is parallel to
+* the chord between the FO ends and halfway between the chord and the
+* tangent of the same slope, at u = xi. The error is then +E at the ends
+* and -E at xi (or the other way round), which makes the line the unique
+* minimax line, with E = |sum(r_k * (1 - xi^k)) over even k >= 2 +
+* sum(r_k * (xi - xi^k)) over odd k >= 3| / 2.
+*
+* Otherwise the line is the Chebyshev series of y(u) truncated after the
+* linear term, and E is bounded by the sum of the absolute values of the
+* dropped Chebyshev coefficients.
+*
+* Input params:    
+*       num_ho_coeff: number of coeffecients in the high order poly
+*       ho_poly: high order polynomial
+*       t_start: the FO start time relative to the high order poly start time [s]
+*       t_stop: the FO stop time relative to the high order poly start time [s]
+*
+* Output params :
+*       r, c: scratch buffers of num_ho_coeff elements
+*       delay_linear: the FO slope [ns/s]
+*       delay_const: the FO delay at t_start [ns]
+*       max_error: the maximum absolute error of the FO [ns]
+*/
+template <typename T>
+void MinimaxLinearFit(int num_ho_coeff,
+                      const double* ho_poly,
+                      T t_start,
+                      T t_stop,
+                      T* r,
+                      T* c,
+                      long double& delay_linear,
+                      long double& delay_const,
+                      long double& max_error)
+{
+    T half_interval = CenterOnUnitInterval(num_ho_coeff, ho_poly, t_start, t_stop, r);
+    if (!(half_interval > 0))
+    {
+        delay_linear = r[1];
+        delay_const = r[0];
+        max_error = 0;
+        return;
+    }
+
+    // the line alpha + beta * u, relative to r_0 + r_1 * u
+    T alpha = 0;
+    T beta = 0;
+    if (ConstantCurvature(num_ho_coeff, r))
+    {
+        for (int k = 3; k < num_ho_coeff; k += 2)
+        {
+            beta += r[k];
+        }
+        T xi = FindSlopePoint(num_ho_coeff, r, beta);
+        T chord_gap = 0;
+        T xi_k = xi;
+        for (int k = 2; k < num_ho_coeff; k++)
+        {
+            xi_k *= xi;
+            T end_k = k % 2 == 0 ? T(1) : xi;
+            chord_gap += r[k] * (end_k - xi_k);
+            alpha += r[k] * (k % 2 == 0 ? T(1) + xi_k : xi_k - xi);
+        }
+        alpha /= 2;
+        max_error = std::abs(chord_gap) / 2;
+    }
+    else
+    {
+        NonLinearChebyshev(num_ho_coeff, r, c);
+        alpha = c[0];
+        beta = c[1];
+        T dropped = 0;
+        for (int j = 2; j < num_ho_coeff; j++)
+        {
+            dropped += std::abs(c[j]);
+        }
+        max_error = dropped;
+    }
+
+    // slope, and the delay at the FO start time (u = -1)
+    delay_linear = (r[1] + beta) / half_interval;
+    delay_const = (r[0] - r[1]) + (alpha - beta);
+}
+
+/**
+* The maximum absolute error of the FO delay_const + delay_linear * t over
+* the FO interval, the same way as MinimaxLinearFit: the largest error at
+* the FO ends and at the extremum inside the interval when the curvature
+* does not change sign, a Chebyshev bound otherwise.
+*
+* Input params:    
+*       see MinimaxLinearFit, and the FO to check
+*
+* Returns :
+*       the maximum absolute error [ns]
+*/
+template <typename T>
+long double LinearFitMaxError(int num_ho_coeff,
+                              const double* ho_poly,
+                              T t_start,
+                              T t_stop,
+                              long double delay_linear,
+                              long double delay_const,
+                              T* r,
+                              T* c)
+{
+    T half_interval = CenterOnUnitInterval(num_ho_coeff, ho_poly, t_start, t_stop, r);
+    if (!(half_interval > 0))
+    {
+        return std::abs(r[0] - delay_const);
+    }
+
+    // e(u) = e_0 + e_1 * u + NonLinearTerms(u)
+    T slope = delay_linear * half_interval;
+    T e_0 = (r[0] - delay_const) - slope;
+    T e_1 = r[1] - slope;
+    if (ConstantCurvature(num_ho_coeff, r))
+    {
+        T xi = FindSlopePoint(num_ho_coeff, r, -e_1);
+        T error = std::abs(e_0 - e_1 + NonLinearTerms(num_ho_coeff, r, T(-1)));
+        error = std::max(error, std::abs(e_0 + e_1 + NonLinearTerms(num_ho_coeff, r, T(1))));
+        error = std::max(error, std::abs(e_0 + e_1 * xi + NonLinearTerms(num_ho_coeff, r, xi)));
+        return error;
+    }
+
+    NonLinearChebyshev(num_ho_coeff, r, c);
+    T error = std::abs(e_0 + c[0]) + std::abs(e_1 + c[1]);
+    for (int j = 2; j < num_ho_coeff; j++)
+    {
+        error += std::abs(c[j]);
+    }
+    return error;
+}
+
+}; // namespace
+
+/** process
+*  Description:
+*       The least squares process() that also returns the maximum error of
+*       each FO over its interval, see LinearFitMaxError. With the Minimax
+*       fit method the error comes from the fit itself.
+*
+* Input params:    
+*       see process() with least squares fitting
+*
+* Output params :
+*       fo_poly: pointer to store first order polynomials (array length = num_fo_poly and unit = [ns/s , ns])
+*       fo_max_error: the maximum absolute error of each FO (array length = num_fo_poly and unit = [ns])
+*
+* Returns :
+*       false if there is any unexpected HO and FO polynomial time parameter, true otherwise.
+*/
+bool FirstOrderDelayModel::process(double ho_t_start, 
+                                   double ho_t_stop, 
+                                   int num_ho_coeff, 
+                                   const double* ho_poly,
+                                   int num_lsq_points, 
+                                   int num_fo_poly, 
+                                   const std::vector<double>& fo_t_start, 
+                                   std::vector<long double>& fo_poly,
+                                   std::vector<long double>& fo_max_error) const
+{
+    fo_poly.resize(num_fo_poly * 2); // 2 coefficients for each FO poly. 
+    fo_max_error.resize(num_fo_poly);
+    char buffer[WORKSPACE_BUFFER_SIZE];
+    FodmWorkspace workspace(buffer, sizeof(buffer));
+    return process(ho_t_start, ho_t_stop, num_ho_coeff, ho_poly, num_lsq_points, num_fo_poly,
+        fo_t_start.data(), fo_poly.data(), fo_max_error.data(), workspace);
+}
+
+/** process
+*  Description:
+*       The least squares process() on caller-owned buffers, with the
+*       scratch buffers taken from workspace.
+*
+* Input params:    
+*       see process() with least squares fitting
+*       fo_t_start: array of length num_fo_poly + 1, containing the start time stamps of the FOs
+*                   AND the end time of the last FO as the last element.
+*
+* Output params :
+*       fo_poly: array of length num_fo_poly * 2 to store first order polynomials (unit = [ns/s , ns])
+*       fo_max_error: array of length num_fo_poly for the maximum absolute error of each FO [ns],
+*                     or nullptr if it is not needed
+*       workspace: the scratch buffers are allocated from it
+*
+* Returns :
+*       false if there is any unexpected HO and FO polynomial time parameter, true otherwise.
+*/
+bool FirstOrderDelayModel::process(double ho_t_start, 
+                                   double ho_t_stop, 
+                                   int num_ho_coeff, 
+                                   const double* ho_poly,
+                                   int num_lsq_points, 
+                                   int num_fo_poly, 
+                                   const double* fo_t_start, 
+                                   long double* fo_poly,
+                                   long double* fo_max_error,
+                                   FodmWorkspace& workspace) const
+{
+    FODM_METRICS_TIME_STAGE(FodmStage::Process);
+    bool time_inputs_ok = DispatchNumCoeff(num_ho_coeff, [&](auto num_coeffs)
+    {
+        return this->template process_lsq<decltype(num_coeffs)::value>(ho_t_start, ho_t_stop, num_ho_coeff,
+            ho_poly, num_lsq_points, num_fo_poly, fo_t_start, fo_poly, fo_max_error, workspace);
+    });
+    FODM_METRICS_ADD(FodmCounter::FodmsProduced, num_fo_poly);
+    FODM_METRICS_ADD(FodmCounter::TimeInputFailures, time_inputs_ok ? 0 : 1);
+    return time_inputs_ok;
+}
+
+/** process
+*  Description:
+*       process() with least squares fitting on caller-owned buffers for a
+*       HO polynomial of NumCoeffs coefficients, with the HO polynomial
+*       evaluation unrolled for them.
+*
+* Input params:    
+*       see process() with least squares fitting, with num_ho_coeff = NumCoeffs
+*
+* Output params :
+*       see process() with least squares fitting
+*
+* Returns :
+*       false if there is any unexpected HO and FO polynomial time parameter, true otherwise.
+*/
+template <int NumCoeffs>
+bool FirstOrderDelayModel::process(double ho_t_start, 
+                                   double ho_t_stop, 
+                                   const double* ho_poly,
+                                   int num_lsq_points, 
+                                   int num_fo_poly, 
+                                   const double* fo_t_start, 
+                                   long double* fo_poly,
+                                   long double* fo_max_error,
+                                   FodmWorkspace& workspace) const
+{
+    static_assert(NumCoeffs >= 2 && NumCoeffs <= MAX_UNROLLED_NUM_COEFF, "NumCoeffs out of the unrolled range");
+    FODM_METRICS_TIME_STAGE(FodmStage::Process);
+    bool time_inputs_ok = process_lsq<NumCoeffs>(ho_t_start, ho_t_stop, NumCoeffs, ho_poly, num_lsq_points,
+        num_fo_poly, fo_t_start, fo_poly, fo_max_error, workspace);
+    FODM_METRICS_ADD(FodmCounter::FodmsProduced, num_fo_poly);
+    FODM_METRICS_ADD(FodmCounter::TimeInputFailures, time_inputs_ok ? 0 : 1);
+    return time_inputs_ok;
+}
+
+template <int kNumCoeffs>
+bool FirstOrderDelayModel::process_lsq(double ho_t_start, 
+                                       double ho_t_stop, 
+                                       int num_ho_coeff, 
+                                       const double* ho_poly,
+                                       int num_lsq_points, 
+                                       int num_fo_poly, 
+                                       const double* fo_t_start, 
+                                       long double* fo_poly,
+                                       long double* fo_max_error,
+                                       FodmWorkspace& workspace) const
+{
+    if (lsq_fit_method_ == LsqFitMethod::Minimax)
+    {
+        return process_minimax(ho_t_start, ho_t_stop, num_ho_coeff, ho_poly, num_fo_poly, fo_t_start, fo_poly, fo_max_error, workspace);
+    }
+
+    assert (ho_poly!=NULL);
+    assert (num_lsq_points>=1);
+    assert (num_ho_coeff>=2);
+    assert (num_fo_poly>=1);
+
+    bool time_inputs_ok;
+    if (lsq_fit_method_ == LsqFitMethod::Sampled)
+    {
+        time_inputs_ok = process_sampled<kNumCoeffs>(ho_t_start, ho_t_stop, num_ho_coeff, ho_poly, num_lsq_points, num_fo_poly, fo_t_start, fo_poly, workspace);
+    }
+    else
+    {
+        time_inputs_ok = process_closed_form(ho_t_start, ho_t_stop, num_ho_coeff, ho_poly, num_lsq_points, num_fo_poly, fo_t_start, fo_poly, workspace);
+    }
+
+    if (fo_max_error == nullptr)
+    {
+        return time_inputs_ok;
+    }
+    long double* r = workspace.Allocate<long double>(num_ho_coeff);
+    long double* c = workspace.Allocate<long double>(num_ho_coeff);
+    for (int i = 0; i < num_fo_poly; i++)
+    {
+        fo_max_error[i] = LinearFitMaxError<long double>(num_ho_coeff, ho_poly,
+            static_cast<long double>(fo_t_start[i]) - ho_t_start, static_cast<long double>(fo_t_start[i+1]) - ho_t_start,
+            fo_poly[2*i], fo_poly[2*i+1], r, c);
+    }
+
+    return time_inputs_ok;
+}
+
+/** process_minimax
+*  Description:
+*       Fits each FO with the line that minimizes the maximum absolute
+*       error against the HO poly over the continuous FO interval, see
+*       MinimaxLinearFit. For a quadratic delay the maximum error is half
+*       of the two point fit and 3/4 of the continuous least squares fit,
+*       so the FO interval can be longer for the same accuracy.
+*
+*       The fit is done in double with the Default precision, and in long
+*       double otherwise.
+*
+* Input params:    
+*       see process() with least squares fitting
+*
+* Output params :
+*       fo_poly: array of length num_fo_poly * 2 to store first order polynomials (unit = [ns/s , ns])
+*       fo_max_error: the maximum absolute error of each FO (array length = num_fo_poly and unit = [ns]),
+*                     or nullptr if it is not needed
+*       workspace: the scratch buffers are allocated from it
+*
+* Returns :
+*       false if there is any unexpected HO and FO polynomial time parameter, true otherwise.
+*/
+bool FirstOrderDelayModel::process_minimax(double ho_t_start, 
+                                           double ho_t_stop, 
+                                           int num_ho_coeff, 
+                                           const double* ho_poly,
+                                           int num_fo_poly, 
+                                           const double* fo_t_start, 
+                                           long double* fo_poly,
+                                           long double* fo_max_error,
+                                           FodmWorkspace& workspace) const
+{
+    bool time_inputs_ok = true;
+
+    double* r = workspace.Allocate<double>(num_ho_coeff);
+    double* c = workspace.Allocate<double>(num_ho_coeff);
+    long double* r_ld = workspace.Allocate<long double>(num_ho_coeff);
+    long double* c_ld = workspace.Allocate<long double>(num_ho_coeff);
+    long double error;
+    for (int i = 0; i < num_fo_poly; i++)
+    {
+        if (fo_t_start[i+1] > ho_t_stop || fo_t_start[i] < ho_t_start || fo_t_start[i+1] < fo_t_start[i])
+        {            
+            time_inputs_ok = false;
+        }
+
+        if (precision_ == PolyvalPrecision::Default)
+        {
+            MinimaxLinearFit<double>(num_ho_coeff, ho_poly,
+                fo_t_start[i] - ho_t_start, fo_t_start[i+1] - ho_t_start,
+                r, c, fo_poly[2*i], fo_poly[2*i+1], error);
+        }
+        else
+        {
+            MinimaxLinearFit<long double>(num_ho_coeff, ho_poly,
+                static_cast<long double>(fo_t_start[i]) - ho_t_start, static_cast<long double>(fo_t_start[i+1]) - ho_t_start,
+                r_ld, c_ld, fo_poly[2*i], fo_poly[2*i+1], error);
+        }
+        if (fo_max_error != nullptr)
+        {
+            fo_max_error[i] = error;
+        }
+    }
+
+    return time_inputs_ok;
+}
+
+
+/** process_adaptive
+*  Description:
+*       Greedy segmentation: each FO starts at the end of the previous one
+*       and is made as long as max_error and max_length allow. The maximum
+*       error of a FO does not decrease when the FO is extended. The longest
+*       length is bracketed between min_length and the first length over
+*       max_error, and searched with the error scaling as the square of the
+*       length, as for the curvature term, falling back to bisection, to a
+*       relative resolution of 1e-6.
+*
+*       The FO is then shortened, if needed, so that the rest of the span
+*       can be split into k FOs between min_length and max_length, i.e. so
+*       that the rest is in [k min_length, k max_length] for some k. When
+*       no such split exists the FOs go past the limits: the last FO takes
+*       the rest of the span once it is less than two min_length FOs.
+*
+* Input params:    
+*       ho_t_start: high order poly start time [s]
+*       ho_t_stop: high order poly start time [s]
+*       num_ho_coeff: number of coeffecients in the high order poly
+*       ho_poly: high order polynomial
+*       num_lsq_points: number of points used for first order approximation
+*       t_start: start time of the first FO [s]
+*       t_stop: stop time of the last FO [s]
+*       max_error: the maximum absolute error of each FO [ns]
+*       min_length: the minimum length of a FO [s]
+*       max_length: the maximum length of a FO [s]
+*
+* Output params :
+*       fo_t_start: the start time stamps of the FOs AND the end time of the last FO as the last element
+*       fo_poly: pointer to store first order polynomials (array length = num_fo_poly and unit = [ns/s , ns])
+*       fo_max_error: the maximum absolute error of each FO (array length = num_fo_poly and unit = [ns])
+*
+* Returns :
+*       false if there is any unexpected HO and FO polynomial time parameter, if a FO
+*       exceeds max_error, or if the span can't be split into FOs between min_length
+*       and max_length, true otherwise.
+*/
+bool FirstOrderDelayModel::process_adaptive(double ho_t_start,
+                                            double ho_t_stop,
+                                            int num_ho_coeff,
+                                            const double* ho_poly,
+                                            int num_lsq_points,
+                                            double t_start,
+                                            double t_stop,
+                                            double max_error,
+                                            double min_length,
+                                            double max_length,
+                                            std::vector<double>& fo_t_start,
+                                            std::vector<long double>& fo_poly,
+                                            std::vector<long double>& fo_max_error) const
+{
+    assert (t_stop > t_start);
+    assert (min_length > 0);
+    assert (max_length >= min_length);
+
+    // the maximum error of a single FO, with the buffers reused
+    std::vector<double> t_fo(2);
+    std::vector<long double> poly_fo;
+    std::vector<long double> error_fo;
+    auto fo_error = [&](double t_a, double t_b)
+    {
+        t_fo[0] = t_a;
+        t_fo[1] = t_b;
+        process(ho_t_start, ho_t_stop, num_ho_coeff, ho_poly, num_lsq_points, 1, t_fo, poly_fo, error_fo);
+        return error_fo[0];
+    };
+
+    // a span shorter than min_length is a single FO shorter than min_length
+    bool within_limits = t_stop - t_start >= min_length;
+    fo_t_start.assign(1, t_start);
+    double t = t_start;
+    while (t < t_stop)
+    {
+        double remaining = t_stop - t;
+        double length = std::min(max_length, remaining);
+        long double error_hi = length > min_length ? fo_error(t, t + length) : 0;
+        if (error_hi > max_error)
+        {
+            double lo = min_length;
+            double hi = length;
+            double guess = hi * std::sqrt(max_error / error_hi);
+            for (int iter = 0; iter < 64 && hi - lo > hi * 1.0e-6; iter++)
+            {
+                if (!(guess > lo && guess < hi))
+                {
+                    guess = (lo + hi) / 2;
+                }
+                long double error = fo_error(t, t + guess);
+                if (error <= max_error)
+                {
+                    lo = guess;
+                }
+                else
+                {
+                    hi = guess;
+                    error_hi = error;
+                }
+                guess = hi * std::sqrt(max_error / error_hi);
+            }
+            length = lo;
+        }
+
+        // shorten the FO so that the rest of the span can be split into FOs
+        // between min_length and max_length, i.e. into the first interval
+        // [k min_length, k max_length] that reaches the rest
+        double rest = remaining - length;
+        double split_rest = rest > 0 ? std::ceil(rest / max_length) * min_length : 0;
+        if (split_rest > rest)
+        {
+            if (remaining - split_rest >= min_length)
+            {
+                length = remaining - split_rest;
+            }
+            else
+            {
+                // no such split, the last FO takes the rest of the span
+                within_limits = false;
+                if (remaining < 2 * min_length)
+                {
+                    length = remaining;
+                }
+            }
+        }
+
+        if (length >= remaining)
+        {
+            t = t_stop;
+        }
+        else
+        {
+            t += length;
+        }
+        fo_t_start.push_back(t);
+    }
+
+    int num_fo_poly = fo_t_start.size() - 1;
+    bool time_inputs_ok = process(ho_t_start, ho_t_stop, num_ho_coeff, ho_poly, num_lsq_points,
+        num_fo_poly, fo_t_start, fo_poly, fo_max_error);
+    for (int i = 0; i < num_fo_poly; i++)
+    {
+        if (fo_max_error[i] > max_error)
+        {
+            time_inputs_ok = false;
+        }
+    }
+
+    return time_inputs_ok && within_limits;
+}
+
+namespace
+{
+
+// Number of FOs processed by one call of the serial process() in the
+// parallel process()
+const size_t PARALLEL_GRAIN_SIZE = 64;
+
+/**
+* Runs the serial process on ranges of the FOs on the threads of pool. The
+* FOs only depend on their own start and stop times, so each range is
+* processed on its own part of fo_t_start and fo_poly, with its own
+* workspace, and the results are the same as processing all FOs at once.
+*
+* Input params:    
+*       num_fo_poly: number of first order delay models
+*       fo_t_start: array of length num_fo_poly + 1, containing the start time stamps of the FOs
+*                   AND the end time of the last FO as the last element.
+*       pool: the threads to run on
+*       process_range: the serial process(), called with a part of fo_t_start, its FOs and a workspace
+*
+* Output params :
+*       fo_poly: pointer to store first order polynomials (array length = num_fo_poly and unit = [ns/s , ns])
+*
+* Returns :
+*       true if process_range returned true for all ranges.
+*/
+template <typename ProcessRange>
+bool ParallelProcess(int num_fo_poly,
+                     const std::vector<double>& fo_t_start,
+                     std::vector<long double>& fo_poly,
+                     ThreadPool& pool,
+                     const ProcessRange& process_range)
+{
+    fo_poly.resize(num_fo_poly * 2); // 2 coefficients for each FO poly. 
+    std::atomic<bool> time_inputs_ok(true);
+    pool.ParallelFor(num_fo_poly, PARALLEL_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        char buffer[WORKSPACE_BUFFER_SIZE];
+        FodmWorkspace workspace(buffer, sizeof(buffer));
+        if (!process_range(static_cast<int>(end - begin), fo_t_start.data() + begin, fo_poly.data() + begin * 2, workspace))
+        {
+            time_inputs_ok = false;
+        }
+    });
+    return time_inputs_ok;
+}
+
+}; // namespace
+
+/** process
+*  Description:
+*       The two point process(), with ranges of the FOs processed in
+*       parallel on the threads of pool.
+*
+* Input params:    
+*       see the two point process()
+*       pool: the threads to run on
+*
+* Output params :
+*       fo_poly: pointer to store first order polynomials (array length = num_fo_poly and unit = [ns/s , ns])
+*
+* Returns :
+*       false if there is any unexpected HO and FO polynomial time parameter, true otherwise.
+*/
+bool FirstOrderDelayModel::process( double ho_t_start,
+                                    double ho_t_stop,
+                                    int num_ho_coeff,
+                                    const double* ho_poly,
+                                    int num_fo_poly,
+                                    const std::vector<double>& fo_t_start,
+                                    std::vector<long double>& fo_poly,
+                                    ThreadPool& pool) const
+{
+    return ParallelProcess(num_fo_poly, fo_t_start, fo_poly, pool,
+        [&](int range_num_fo_poly, const double* range_t_start, long double* range_fo_poly, FodmWorkspace& workspace)
+        {
+            return process(ho_t_start, ho_t_stop, num_ho_coeff, ho_poly, range_num_fo_poly, range_t_start, range_fo_poly,
+                nullptr, workspace);
+        });
+}
+
+/** process
+*  Description:
+*       The least squares process(), with ranges of the FOs processed in
+*       parallel on the threads of pool.
+*
+* Input params:    
+*       see process() with least squares fitting
+*       pool: the threads to run on
+*
+* Output params :
+*       fo_poly: pointer to store first order polynomials (array length = num_fo_poly and unit = [ns/s , ns])
+*
+* Returns :
+*       false if there is any unexpected HO and FO polynomial time parameter, true otherwise.
+*/
+bool FirstOrderDelayModel::process(double ho_t_start, 
+                                   double ho_t_stop, 
+                                   int num_ho_coeff, 
+                                   const double* ho_poly,
+                                   int num_lsq_points, 
+                                   int num_fo_poly, 
+                                   const std::vector<double>& fo_t_start, 
+                                   std::vector<long double>& fo_poly,
+                                   ThreadPool& pool) const
+{
+    return ParallelProcess(num_fo_poly, fo_t_start, fo_poly, pool,
+        [&](int range_num_fo_poly, const double* range_t_start, long double* range_fo_poly, FodmWorkspace& workspace)
+        {
+            return process(ho_t_start, ho_t_stop, num_ho_coeff, ho_poly, num_lsq_points, range_num_fo_poly, range_t_start, range_fo_poly,
+                nullptr, workspace);
+        });
+}
+
+// The process() methods unrolled for the number of HO coefficients, see
+// MAX_UNROLLED_NUM_COEFF
+template bool FirstOrderDelayModel::process<2>(double, double, const double*, int, const double*, long double*,
+    long double*, FodmWorkspace&) const;
+template bool FirstOrderDelayModel::process<3>(double, double, const double*, int, const double*, long double*,
+    long double*, FodmWorkspace&) const;
+template bool FirstOrderDelayModel::process<4>(double, double, const double*, int, const double*, long double*,
+    long double*, FodmWorkspace&) const;
+template bool FirstOrderDelayModel::process<5>(double, double, const double*, int, const double*, long double*,
+    long double*, FodmWorkspace&) const;
+template bool FirstOrderDelayModel::process<6>(double, double, const double*, int, const double*, long double*,
+    long double*, FodmWorkspace&) const;
+template bool FirstOrderDelayModel::process<7>(double, double, const double*, int, const double*, long double*,
+    long double*, FodmWorkspace&) const;
+template bool FirstOrderDelayModel::process<8>(double, double, const double*, int, const double*, long double*,
+    long double*, FodmWorkspace&) const;
+template bool FirstOrderDelayModel::process<9>(double, double, const double*, int, const double*, long double*,
+    long double*, FodmWorkspace&) const;
+
+template bool FirstOrderDelayModel::process<2>(double, double, const double*, int, int, const double*, long double*,
+    long double*, FodmWorkspace&) const;
+template bool FirstOrderDelayModel::process<3>(double, double, const double*, int, int, const double*, long double*,
+    long double*, FodmWorkspace&) const;
+template bool FirstOrderDelayModel::process<4>(double, double, const double*, int, int, const double*, long double*,
+    long double*, FodmWorkspace&) const;
+template bool FirstOrderDelayModel::process<5>(double, double, const double*, int, int, const double*, long double*,
+    long double*, FodmWorkspace&) const;
+template bool FirstOrderDelayModel::process<6>(double, double, const double*, int, int, const double*, long double*,
+    long double*, FodmWorkspace&) const;
+template bool FirstOrderDelayModel::process<7>(double, double, const double*, int, int, const double*, long double*,
+    long double*, FodmWorkspace&) const;
+template bool FirstOrderDelayModel::process<8>(double, double, const double*, int, int, const double*, long double*,
+    long double*, FodmWorkspace&) const;
+template bool FirstOrderDelayModel::process<9>(double, double, const double*, int, int, const double*, long double*,
+    long double*, FodmWorkspace&) const;
+
 };
\ No newline at end of file
@@ -9,18 +9,165 @@
 namespace ska_mid_cbf_fodm_gen
 {
 
+class FodmWorkspace;
+class ThreadPool;
+
+// Arithmetic used to evaluate the high order polynomial
+enum class PolyvalPrecision
+{
+    // cpp_bin_float_50 for process() with two points per FODM,
+    // double for process() with least squares fitting
+    Default,
+    // cpp_bin_float_50 for both process() methods
+    MultiPrecision,
+    // compensated Horner in double-double for both process() methods,
+    // see CompensatedHorner() in DoubleDouble.h for the error bound
+    DoubleDouble,
+    // the high order polynomial re-centered on each FODM start time in
+    // double-double with a Taylor shift, see TaylorShift.h. The FODM slope
+    // and intercept come from the shifted coefficients, and the least
+    // squares points are evaluated relative to the FODM start.
+    TaylorShift
+};
+
+// How process() with least squares fitting fits the FODMs
+enum class LsqFitMethod
+{
+    // evaluate the high order polynomial at the num_lsq_points + 1 fitting
+    // points and sum up the normal equations
+    Sampled,
+    // the same least squares line over the same points, in closed form
+    // from the moments of the points and the high order polynomial
+    // re-centered on each FODM, in O(num_ho_coeff^2) per FODM
+    ClosedForm,
+    // the least squares line over the continuous FODM interval, in closed
+    // form. num_lsq_points is not used.
+    Continuous,
+    // the minimax line over the continuous FODM interval, which minimizes
+    // the maximum delay error, in closed form. num_lsq_points is not used.
+    Minimax
+};
+
+// Derives first order delay models (FODMs) from a high order delay model
+// (HODM). The methods are const and keep no state between calls, so one
+// instance can be shared by several threads.
 class FirstOrderDelayModel
 {
 public:
     FirstOrderDelayModel();
 
+    explicit FirstOrderDelayModel(PolyvalPrecision precision);
+
+    FirstOrderDelayModel(PolyvalPrecision precision, LsqFitMethod lsq_fit_method);
+
+    bool process( double ho_t_start,
+                  double ho_t_stop,
+                  int num_ho_coeff,
+                  const double* ho_poly,
+                  int num_fo_poly,
+                  const std::vector<double>& fo_t_start,
+                  std::vector<long double>& fo_poly) const;
+
+    // Same as above, also returning the HO polynomial evaluated at each
+    // of the num_fo_poly + 1 times of fo_t_start [ns]
+    bool process( double ho_t_start,
+                  double ho_t_stop,
+                  int num_ho_coeff,
+                  const double* ho_poly,
+                  int num_fo_poly,
+                  const std::vector<double>& fo_t_start,
+                  std::vector<long double>& fo_poly,
+                  std::vector<long double>& fo_t_delay) const;
+
+    bool process(double ho_t_start, 
+                 double ho_t_stop, 
+                 int num_ho_coeff, 
+                 const double* ho_poly,                                    
+                 int num_lsq_points, 
+                 int num_fo_poly, 
+                 const std::vector<double>& fo_t_start, 
+                 std::vector<long double>& fo_poly) const;
+
+    // Same as above, also returning the maximum absolute difference between
+    // each FO and the HO polynomial over the FO interval [ns]. It is exact
+    // when the curvature of the HO polynomial does not change sign over the
+    // FO interval, and an upper bound otherwise.
+    bool process(double ho_t_start, 
+                 double ho_t_stop, 
+                 int num_ho_coeff, 
+                 const double* ho_poly,                                    
+                 int num_lsq_points, 
+                 int num_fo_poly, 
+                 const std::vector<double>& fo_t_start, 
+                 std::vector<long double>& fo_poly,
+                 std::vector<long double>& fo_max_error) const;
+
+    // The two point and the least squares process() above, on caller-owned
+    // buffers: fo_t_start holds num_fo_poly + 1 times, fo_poly 2 * num_fo_poly
+    // coefficients and fo_t_delay and fo_max_error, which may be nullptr,
+    // num_fo_poly + 1 and num_fo_poly values. The scratch buffers come from
+    // workspace, so with a workspace that has seen the largest call these
+    // do not allocate. The results are identical to the vector process().
+    bool process( double ho_t_start,
+                  double ho_t_stop,
+                  int num_ho_coeff,
+                  const double* ho_poly,
+                  int num_fo_poly,
+                  const double* fo_t_start,
+                  long double* fo_poly,
+                  long double* fo_t_delay,
+                  FodmWorkspace& workspace) const;
+
+    bool process(double ho_t_start, 
+                 double ho_t_stop, 
+                 int num_ho_coeff, 
+                 const double* ho_poly,                                    
+                 int num_lsq_points, 
+                 int num_fo_poly, 
+                 const double* fo_t_start, 
+                 long double* fo_poly,
+                 long double* fo_max_error,
+                 FodmWorkspace& workspace) const;
+
+    // The two point and the least squares process() on caller-owned buffers
+    // above, for a HO polynomial of NumCoeffs coefficients, from 2 to
+    // MAX_UNROLLED_NUM_COEFF (degree 1 to 8, see MultiPointHorner.h), with
+    // the evaluation of the HO polynomial unrolled for the degree. The
+    // process() methods dispatch to the same code for these degrees, so the
+    // results are identical. For a degree fixed per deployment, this skips
+    // the dispatch.
+    template <int NumCoeffs>
+    bool process( double ho_t_start,
+                  double ho_t_stop,
+                  const double* ho_poly,
+                  int num_fo_poly,
+                  const double* fo_t_start,
+                  long double* fo_poly,
+                  long double* fo_t_delay,
+                  FodmWorkspace& workspace) const;
+
+    template <int NumCoeffs>
+    bool process(double ho_t_start, 
+                 double ho_t_stop, 
+                 const double* ho_poly,                                    
+                 int num_lsq_points, 
+                 int num_fo_poly, 
+                 const double* fo_t_start, 
+                 long double* fo_poly,
+                 long double* fo_max_error,
+                 FodmWorkspace& workspace) const;
+
+    // The two point and the least squares process() above, with the FOs
+    // split into ranges processed in parallel on the threads of pool. The
+    // results are identical to the serial process().
     bool process( double ho_t_start,
                   double ho_t_stop,
                   int num_ho_coeff,
                   const double* ho_poly,
                   int num_fo_poly,
                   const std::vector<double>& fo_t_start,
-                  std::vector<long double>& fo_poly);
+                  std::vector<long double>& fo_poly,
+                  ThreadPool& pool) const;
 
     bool process(double ho_t_start, 
                  double ho_t_stop, 
@@ -29,11 +176,112 @@ public:
                  int num_lsq_points, 
                  int num_fo_poly, 
                  const std::vector<double>& fo_t_start, 
-                 std::vector<long double>& fo_poly);
+                 std::vector<long double>& fo_poly,
+                 ThreadPool& pool) const;
+
+    // Segments [t_start, t_stop] into FOs whose maximum error against the
+    // HO polynomial, as returned by the process() above, is at most
+    // max_error [ns], with FO lengths between min_length and max_length [s].
+    // Each FO is made as long as the tolerance allows, starting from
+    // t_start, and shortened where needed so that the rest of the span can
+    // still be split within the length limits. fo_t_start receives the
+    // num_fo_poly + 1 FO boundaries, and fo_poly and fo_max_error the FOs
+    // and their errors. Returns false if any FO time is outside the HO
+    // polynomial, if max_error cannot be met with min_length, or if the
+    // span can't be split within the length limits, in which case the last
+    // FO takes the rest of the span.
+    bool process_adaptive(double ho_t_start,
+                          double ho_t_stop,
+                          int num_ho_coeff,
+                          const double* ho_poly,
+                          int num_lsq_points,
+                          double t_start,
+                          double t_stop,
+                          double max_error,
+                          double min_length,
+                          double max_length,
+                          std::vector<double>& fo_t_start,
+                          std::vector<long double>& fo_poly,
+                          std::vector<long double>& fo_max_error) const;
 
   private:
 
-    long double  polyval(const double* ho_poly, int num_ho_coeff, double x);
+    // kNumCoeffs is num_ho_coeff, for the code unrolled for the degree, or 0
+    // for the loops over num_ho_coeff
+    template <int kNumCoeffs>
+    long double  polyval(const double* ho_poly, int num_ho_coeff, double x) const;
+
+    template <int kNumCoeffs>
+    void polyval(const double* ho_poly, int num_ho_coeff, const double* x, size_t num_points, long double* y,
+                 FodmWorkspace& workspace) const;
+
+    // The pointer process() methods without the metrics, see FodmMetrics.h
+    template <int kNumCoeffs>
+    bool process_two_point( double ho_t_start,
+                            double ho_t_stop,
+                            int num_ho_coeff,
+                            const double* ho_poly,
+                            int num_fo_poly,
+                            const double* fo_t_start,
+                            long double* fo_poly,
+                            long double* fo_t_delay,
+                            FodmWorkspace& workspace) const;
+
+    template <int kNumCoeffs>
+    bool process_lsq(double ho_t_start, 
+                     double ho_t_stop, 
+                     int num_ho_coeff, 
+                     const double* ho_poly,                                    
+                     int num_lsq_points, 
+                     int num_fo_poly, 
+                     const double* fo_t_start, 
+                     long double* fo_poly,
+                     long double* fo_max_error,
+                     FodmWorkspace& workspace) const;
+
+    bool process_taylor_shift( double ho_t_start,
+                               double ho_t_stop,
+                               int num_ho_coeff,
+                               const double* ho_poly,
+                               int num_fo_poly,
+                               const double* fo_t_start,
+                               long double* fo_poly,
+                               long double* fo_t_delay,
+                               FodmWorkspace& workspace) const;
+
+    template <int kNumCoeffs>
+    bool process_sampled(double ho_t_start, 
+                         double ho_t_stop, 
+                         int num_ho_coeff, 
+                         const double* ho_poly,                                    
+                         int num_lsq_points, 
+                         int num_fo_poly, 
+                         const double* fo_t_start, 
+                         long double* fo_poly,
+                         FodmWorkspace& workspace) const;
+
+    bool process_closed_form(double ho_t_start, 
+                             double ho_t_stop, 
+                             int num_ho_coeff, 
+                             const double* ho_poly,                                    
+                             int num_lsq_points, 
+                             int num_fo_poly, 
+                             const double* fo_t_start, 
+                             long double* fo_poly,
+                             FodmWorkspace& workspace) const;
+
+    bool process_minimax(double ho_t_start, 
+                         double ho_t_stop, 
+                         int num_ho_coeff, 
+                         const double* ho_poly,                                    
+                         int num_fo_poly, 
+                         const double* fo_t_start, 
+                         long double* fo_poly,
+                         long double* fo_max_error,
+                         FodmWorkspace& workspace) const;
+
+    PolyvalPrecision precision_;
+    LsqFitMethod lsq_fit_method_;
 };
 
 };
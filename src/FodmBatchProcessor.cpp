@@ -0,0 +1,212 @@
+#include "FodmBatchProcessor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+namespace
+{
+
+// Receptors evaluated together, a multiple of the SIMD widths. The working
+// buffers of a block fit on the stack and in L1 cache.
+const size_t BLOCK_SIZE = 64;
+
+// Parallel work items per thread, so that threads that finish early can
+// take more of the work
+const size_t ITEMS_PER_THREAD = 4;
+
+}; // namespace
+
+/** FodmBatchProcessor CONSTRUCTOR
+*
+* Input params:
+*       num_receptors: number of receptors of each batch
+*       kernel: the SIMD kernel used to evaluate the HODMs
+*/
+FodmBatchProcessor::FodmBatchProcessor(int num_receptors, HornerKernel kernel)
+    : num_receptors_(num_receptors),
+      kernel_(kernel)
+{
+}
+
+/**
+* Generates the FODMs of all receptors, one block of receptors at a time.
+* Each FO boundary is evaluated once per receptor, and the slope and
+* intercept of the FOs are derived from the delays at the boundaries, like
+* the two point FirstOrderDelayModel::process.
+*
+* Input params:
+*       hodms: the HODMs of num_receptors receptors
+*       num_fo_poly: number of first order delay models of each receptor
+*       fo_t_start: array of length num_fo_poly + 1, containing the start time stamps of the FOs
+*                   AND the end time of the last FO as the last element [s].
+*
+* Output params :
+*       fodms: the num_fo_poly FODMs of each receptor
+*
+* Returns :
+*       false if there is any unexpected HO and FO polynomial time parameter, true otherwise.
+*/
+bool FodmBatchProcessor::process(const HodmBatch& hodms,
+                                 int num_fo_poly,
+                                 const std::vector<double>& fo_t_start,
+                                 FodmBatch& fodms) const
+{
+    bool time_inputs_ok = prepare(hodms, num_fo_poly, fo_t_start, fodms);
+    const size_t num_receptors = num_receptors_;
+    for (size_t rr = 0; rr < num_receptors; rr += BLOCK_SIZE)
+    {
+        process_block(hodms, rr, std::min(rr + BLOCK_SIZE, num_receptors), 0, num_fo_poly, fo_t_start, fodms);
+    }
+    return time_inputs_ok;
+}
+
+/**
+* Same as above, in parallel. The work is split into blocks of receptors,
+* and the FOs into as many ranges as needed to have ITEMS_PER_THREAD work
+* items per thread. Each range evaluates the boundary before its first FO
+* again, with the same result, so the results do not depend on the split.
+*
+* Input params:
+*       see above
+*       pool: the threads to run on
+*
+* Output params :
+*       fodms: the num_fo_poly FODMs of each receptor
+*
+* Returns :
+*       false if there is any unexpected HO and FO polynomial time parameter, true otherwise.
+*/
+bool FodmBatchProcessor::process(const HodmBatch& hodms,
+                                 int num_fo_poly,
+                                 const std::vector<double>& fo_t_start,
+                                 FodmBatch& fodms,
+                                 ThreadPool& pool) const
+{
+    bool time_inputs_ok = prepare(hodms, num_fo_poly, fo_t_start, fodms);
+    const size_t num_receptors = num_receptors_;
+    const size_t num_blocks = (num_receptors + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const size_t num_items_wanted = pool.num_threads() * ITEMS_PER_THREAD;
+    const size_t num_ranges = std::min<size_t>(num_fo_poly, (num_items_wanted + num_blocks - 1) / num_blocks);
+    const size_t range_size = (num_fo_poly + num_ranges - 1) / num_ranges;
+
+    pool.ParallelFor(num_blocks * num_ranges, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t item = begin; item < end; item++)
+        {
+            size_t rr = (item % num_blocks) * BLOCK_SIZE;
+            int fo_begin = (item / num_blocks) * range_size;
+            int fo_end = std::min<size_t>(fo_begin + range_size, num_fo_poly);
+            process_block(hodms, rr, std::min(rr + BLOCK_SIZE, num_receptors), fo_begin, fo_end, fo_t_start, fodms);
+        }
+    });
+    return time_inputs_ok;
+}
+
+/**
+* Sizes the output and checks the FO times. The grid is shared, so only its
+* ends need checking against each HODM.
+*
+* Returns :
+*       false if there is any unexpected HO and FO polynomial time parameter, true otherwise.
+*/
+bool FodmBatchProcessor::prepare(const HodmBatch& hodms,
+                                 int num_fo_poly,
+                                 const std::vector<double>& fo_t_start,
+                                 FodmBatch& fodms) const
+{
+    assert (hodms.num_receptors == num_receptors_);
+    assert (hodms.num_ho_coeff >= 2);
+    assert (num_fo_poly >= 1);
+
+    const size_t num_receptors = num_receptors_;
+    fodms.num_receptors = num_receptors_;
+    fodms.num_fo_poly = num_fo_poly;
+    fodms.delay_linear.resize(num_fo_poly * num_receptors);
+    fodms.delay_const.resize(num_fo_poly * num_receptors);
+
+    bool time_inputs_ok = true;
+    for (int ii = 0; ii < num_fo_poly; ii++)
+    {
+        if (fo_t_start[ii+1] < fo_t_start[ii])
+        {
+            time_inputs_ok = false;
+        }
+    }
+    for (size_t rr = 0; rr < num_receptors; rr++)
+    {
+        if (fo_t_start[0] < hodms.t_start[rr] || fo_t_start[num_fo_poly] > hodms.t_stop[rr])
+        {
+            time_inputs_ok = false;
+        }
+    }
+    return time_inputs_ok;
+}
+
+/**
+* Generates the FOs of a block of receptors over a range of the FO grid.
+*
+* Input params:
+*       hodms: the HODMs of num_receptors receptors
+*       r_begin, r_end: the receptors of the block, at most BLOCK_SIZE
+*       fo_begin, fo_end: the range of FOs
+*       fo_t_start: the FO boundaries [s]
+*
+* Output params :
+*       fodms: FOs fo_begin to fo_end - 1 of the receptors of the block
+*/
+void FodmBatchProcessor::process_block(const HodmBatch& hodms,
+                                       size_t r_begin,
+                                       size_t r_end,
+                                       int fo_begin,
+                                       int fo_end,
+                                       const std::vector<double>& fo_t_start,
+                                       FodmBatch& fodms) const
+{
+    const size_t num_receptors = num_receptors_;
+    const size_t block_size = r_end - r_begin;
+    // FO boundary times relative to each HODM start, for the current and
+    // the previous boundary, and the HODM at the previous boundary
+    double t[BLOCK_SIZE];
+    double t_prev[BLOCK_SIZE];
+    double y_hi[BLOCK_SIZE];
+    double y_lo[BLOCK_SIZE];
+    long double y_prev[BLOCK_SIZE];
+
+    for (int ii = fo_begin; ii <= fo_end; ii++)
+    {
+        for (size_t rr = 0; rr < block_size; rr++)
+        {
+            t[rr] = fo_t_start[ii] - hodms.t_start[r_begin + rr];
+        }
+        CompensatedHornerSoA(hodms.coeff.data() + r_begin, hodms.num_ho_coeff, block_size, num_receptors,
+            t, y_hi, y_lo, kernel_);
+
+        if (ii > fo_begin)
+        {
+            long double* delay_linear = fodms.delay_linear.data() + (ii - 1) * num_receptors + r_begin;
+            long double* delay_const = fodms.delay_const.data() + (ii - 1) * num_receptors + r_begin;
+            for (size_t rr = 0; rr < block_size; rr++)
+            {
+                long double y = static_cast<long double>(y_hi[rr]) + y_lo[rr];
+                double interval = t[rr] - t_prev[rr];
+                delay_linear[rr] = (y - y_prev[rr]) / interval;
+                delay_const[rr] = y_prev[rr];
+                y_prev[rr] = y;
+            }
+        }
+        else
+        {
+            for (size_t rr = 0; rr < block_size; rr++)
+            {
+                y_prev[rr] = static_cast<long double>(y_hi[rr]) + y_lo[rr];
+            }
+        }
+        std::copy(t, t + block_size, t_prev);
+    }
+}
+
+}; // namespace ska_mid_cbf_fodm_gen
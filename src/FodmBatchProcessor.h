@@ -0,0 +1,99 @@
+#ifndef FODM_BATCH_PROCESSOR_H
+#define FODM_BATCH_PROCESSOR_H
+
+#include <vector>
+
+#include "MultiPointHorner.h"
+#include "ThreadPool.h"
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// The HODMs of several receptors in structure-of-arrays layout: coefficient
+// k of receptor r is coeff[k * num_receptors + r], highest degree first,
+// and the HODM of receptor r is valid from t_start[r] to t_stop[r] [s].
+struct HodmBatch
+{
+    int num_receptors;
+    int num_ho_coeff;
+    std::vector<double> coeff;
+    std::vector<double> t_start;
+    std::vector<double> t_stop;
+};
+
+// The FODMs of several receptors over a shared FO time grid, in
+// structure-of-arrays layout: FO i of receptor r is at index
+// i * num_receptors + r of delay_linear [ns/s] and delay_const [ns].
+struct FodmBatch
+{
+    int num_receptors;
+    int num_fo_poly;
+    std::vector<long double> delay_linear;
+    std::vector<long double> delay_const;
+};
+
+// Generates the two point FODMs of all receptors at once. For each FO
+// boundary of the shared grid, the HODMs of a block of receptors are
+// evaluated with CompensatedHornerSoA, so the SIMD lanes run over the
+// receptors and the coefficients are read in order.
+//
+// The results are the same as FirstOrderDelayModel::process with two
+// points per FODM and PolyvalPrecision::DoubleDouble for each receptor.
+//
+// The processor keeps no state between calls, so one instance can be
+// shared by several threads. The working buffers are on the stack, and the
+// output is only reallocated when its size changes, so processing the same
+// number of receptors and FOs again does not allocate.
+//
+// Example:
+//   FodmBatchProcessor processor(num_receptors);
+//   FodmBatch fodms;
+//   processor.process(hodms, num_fo_poly, fo_t_start, fodms);
+//   long double delay_const = fodms.delay_const[fo * num_receptors + receptor];
+class FodmBatchProcessor
+{
+public:
+    explicit FodmBatchProcessor(int num_receptors, HornerKernel kernel = HornerKernel::Auto);
+
+    int num_receptors() const { return num_receptors_; }
+
+    // fo_t_start holds the num_fo_poly + 1 FO boundaries [s], shared by all
+    // receptors. Returns false if any FO time is outside the HODM of any
+    // receptor.
+    bool process(const HodmBatch& hodms,
+                 int num_fo_poly,
+                 const std::vector<double>& fo_t_start,
+                 FodmBatch& fodms) const;
+
+    // Same as above, with blocks of receptors and ranges of FOs processed in
+    // parallel on the threads of pool. The results are identical.
+    bool process(const HodmBatch& hodms,
+                 int num_fo_poly,
+                 const std::vector<double>& fo_t_start,
+                 FodmBatch& fodms,
+                 ThreadPool& pool) const;
+
+private:
+    // Sizes fodms and checks the FO times against the HODMs
+    bool prepare(const HodmBatch& hodms,
+                 int num_fo_poly,
+                 const std::vector<double>& fo_t_start,
+                 FodmBatch& fodms) const;
+
+    // Generates FOs fo_begin to fo_end - 1 of receptors r_begin to r_end - 1,
+    // at most BLOCK_SIZE receptors
+    void process_block(const HodmBatch& hodms,
+                       size_t r_begin,
+                       size_t r_end,
+                       int fo_begin,
+                       int fo_end,
+                       const std::vector<double>& fo_t_start,
+                       FodmBatch& fodms) const;
+
+    int num_receptors_;
+    HornerKernel kernel_;
+};
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
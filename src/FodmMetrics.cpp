@@ -0,0 +1,237 @@
+#include "FodmMetrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+namespace
+{
+
+const char* STAGE_NAMES[FODM_NUM_STAGES] = { "process", "raw_values", "register_values" };
+
+const char* COUNTER_NAMES[FODM_NUM_COUNTERS] = {
+    "fodms_produced", "time_input_failures", "fast_path_fallbacks", "fast_path_calls" };
+
+const char* COUNTER_HELP[FODM_NUM_COUNTERS] = {
+    "FODMs derived by FirstOrderDelayModel::process",
+    "Calls of FirstOrderDelayModel::process with unexpected time inputs",
+    "FODMs of the fixed point and double-double engines calculated in multi-precision",
+    "FODMs requested from the fixed point and double-double engines" };
+
+#if defined(FODM_METRICS_ENABLED)
+
+// The metrics of one thread. Only the thread writes them, with a relaxed
+// load and store instead of an atomic read-modify-write, and
+// GetFodmMetrics() reads them from any thread.
+struct ThreadMetrics
+{
+    std::atomic<uint64_t> calls[FODM_NUM_STAGES];
+    std::atomic<uint64_t> total_ns[FODM_NUM_STAGES];
+    std::atomic<uint64_t> latency_buckets[FODM_NUM_STAGES][FODM_NUM_LATENCY_BUCKETS];
+    std::atomic<uint64_t> counters[FODM_NUM_COUNTERS];
+};
+
+void Add(std::atomic<uint64_t>& metric, uint64_t value)
+{
+    metric.store(metric.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void AddTo(const ThreadMetrics& metrics, FodmMetricsSnapshot& snapshot)
+{
+    for (int ss = 0; ss < FODM_NUM_STAGES; ss++)
+    {
+        snapshot.stages[ss].calls += metrics.calls[ss].load(std::memory_order_relaxed);
+        snapshot.stages[ss].total_ns += metrics.total_ns[ss].load(std::memory_order_relaxed);
+        for (int bb = 0; bb < FODM_NUM_LATENCY_BUCKETS; bb++)
+        {
+            snapshot.stages[ss].latency_buckets[bb] += metrics.latency_buckets[ss][bb].load(std::memory_order_relaxed);
+        }
+    }
+    for (int cc = 0; cc < FODM_NUM_COUNTERS; cc++)
+    {
+        snapshot.counters[cc] += metrics.counters[cc].load(std::memory_order_relaxed);
+    }
+}
+
+void AddTo(const FodmMetricsSnapshot& metrics, FodmMetricsSnapshot& snapshot)
+{
+    for (int ss = 0; ss < FODM_NUM_STAGES; ss++)
+    {
+        snapshot.stages[ss].calls += metrics.stages[ss].calls;
+        snapshot.stages[ss].total_ns += metrics.stages[ss].total_ns;
+        for (int bb = 0; bb < FODM_NUM_LATENCY_BUCKETS; bb++)
+        {
+            snapshot.stages[ss].latency_buckets[bb] += metrics.stages[ss].latency_buckets[bb];
+        }
+    }
+    for (int cc = 0; cc < FODM_NUM_COUNTERS; cc++)
+    {
+        snapshot.counters[cc] += metrics.counters[cc];
+    }
+}
+
+// The metrics of the running threads, and the sum of those of the threads
+// that have exited
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<const ThreadMetrics*> threads;
+    FodmMetricsSnapshot exited;
+};
+
+Registry& GetRegistry()
+{
+    // Never destroyed, as threads may exit after the static destructors
+    // ran. Value-initialized, so the exited metrics are 0.
+    static Registry* registry = new Registry();
+    return *registry;
+}
+
+// Registers the metrics of a thread on its first use, and adds them to
+// the exited threads when it exits
+class ThreadMetricsHolder
+{
+public:
+    ThreadMetricsHolder()
+    {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.threads.push_back(&metrics);
+    }
+
+    ~ThreadMetricsHolder()
+    {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        AddTo(metrics, registry.exited);
+        registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), &metrics));
+    }
+
+    // Zero-initialized, as it has thread storage duration
+    ThreadMetrics metrics;
+};
+
+ThreadMetrics& GetThreadMetrics()
+{
+    thread_local ThreadMetricsHolder holder;
+    return holder.metrics;
+}
+
+#endif
+
+}; // namespace
+
+#if defined(FODM_METRICS_ENABLED)
+
+void RecordFodmCounter(FodmCounter counter, uint64_t value)
+{
+    Add(GetThreadMetrics().counters[static_cast<int>(counter)], value);
+}
+
+void RecordFodmStage(FodmStage stage, uint64_t latency_ns)
+{
+    ThreadMetrics& metrics = GetThreadMetrics();
+    int ss = static_cast<int>(stage);
+    Add(metrics.calls[ss], 1);
+    Add(metrics.total_ns[ss], latency_ns);
+    Add(metrics.latency_buckets[ss][FodmLatencyBucket(latency_ns)], 1);
+}
+
+#endif
+
+/**
+* Adds up the metrics of all threads.
+*
+* Returns :
+*       the metrics since the start of the process, all 0 and enabled false
+*       if the library is built without FODM_METRICS.
+*/
+FodmMetricsSnapshot GetFodmMetrics()
+{
+    FodmMetricsSnapshot snapshot;
+    std::memset(&snapshot, 0, sizeof(snapshot));
+#if defined(FODM_METRICS_ENABLED)
+    snapshot.enabled = true;
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    AddTo(registry.exited, snapshot);
+    for (const ThreadMetrics* metrics : registry.threads)
+    {
+        AddTo(*metrics, snapshot);
+    }
+#endif
+    return snapshot;
+}
+
+/**
+* The histogram bucket of a latency, the number of bits of latency_ns - 1,
+* so that bucket b holds the latencies in (2^(b-1), 2^b] ns and its
+* Prometheus "le" bound of 2^b ns is inclusive.
+*
+* Input params:
+*       latency_ns: the latency [ns]
+*
+* Returns :
+*       the bucket, from 0 to FODM_NUM_LATENCY_BUCKETS - 1
+*/
+int FodmLatencyBucket(uint64_t latency_ns)
+{
+    int bucket = latency_ns <= 1 ? 0 : 64 - __builtin_clzll(latency_ns - 1);
+    return bucket < FODM_NUM_LATENCY_BUCKETS ? bucket : FODM_NUM_LATENCY_BUCKETS - 1;
+}
+
+/**
+* Formats a snapshot in the Prometheus text exposition format. The bucket
+* upper bounds are the powers of 2 from 1 ns, in seconds.
+*
+* Input params:
+*       snapshot: the metrics, see GetFodmMetrics()
+*
+* Returns :
+*       the metrics, one sample per line
+*/
+std::string FodmMetricsToPrometheus(const FodmMetricsSnapshot& snapshot)
+{
+    std::ostringstream text;
+    text.precision(10);
+
+    text << "# HELP fodm_stage_latency_seconds Latency of the FODM generation stages\n";
+    text << "# TYPE fodm_stage_latency_seconds histogram\n";
+    for (int ss = 0; ss < FODM_NUM_STAGES; ss++)
+    {
+        const FodmStageMetrics& stage = snapshot.stages[ss];
+        uint64_t cumulative = 0;
+        for (int bb = 0; bb < FODM_NUM_LATENCY_BUCKETS; bb++)
+        {
+            cumulative += stage.latency_buckets[bb];
+            text << "fodm_stage_latency_seconds_bucket{stage=\"" << STAGE_NAMES[ss] << "\",le=\"";
+            if (bb < FODM_NUM_LATENCY_BUCKETS - 1)
+            {
+                text << static_cast<double>(uint64_t(1) << bb) * 1.0e-9;
+            }
+            else
+            {
+                text << "+Inf";
+            }
+            text << "\"} " << cumulative << "\n";
+        }
+        text << "fodm_stage_latency_seconds_sum{stage=\"" << STAGE_NAMES[ss] << "\"} " << stage.total_ns * 1.0e-9 << "\n";
+        text << "fodm_stage_latency_seconds_count{stage=\"" << STAGE_NAMES[ss] << "\"} " << stage.calls << "\n";
+    }
+
+    for (int cc = 0; cc < FODM_NUM_COUNTERS; cc++)
+    {
+        text << "# HELP fodm_" << COUNTER_NAMES[cc] << "_total " << COUNTER_HELP[cc] << "\n";
+        text << "# TYPE fodm_" << COUNTER_NAMES[cc] << "_total counter\n";
+        text << "fodm_" << COUNTER_NAMES[cc] << "_total " << snapshot.counters[cc] << "\n";
+    }
+    return text.str();
+}
+
+}; // namespace ska_mid_cbf_fodm_gen
@@ -0,0 +1,141 @@
+#ifndef FODM_METRICS_H
+#define FODM_METRICS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// The instrumented stages of the FODM generation
+enum class FodmStage
+{
+    // FirstOrderDelayModel::process, both methods
+    Process,
+    // CalcFodmRegisterRawValues
+    RawValues,
+    // RawToRegisterValues and RawToRegisterValuesV1
+    RegisterValues,
+    NumStages
+};
+
+// The counters besides the calls of each stage
+enum class FodmCounter
+{
+    // FODMs derived by FirstOrderDelayModel::process
+    FodmsProduced,
+    // Calls of FirstOrderDelayModel::process that returned false, i.e. with
+    // a FO outside of the HO or the FO times out of order
+    TimeInputFailures,
+    // FODMs of the fixed point and double-double engines calculated in
+    // multi-precision, as they are out of range of the fixed point
+    // calculation or too close to a rounding boundary to certify
+    FastPathFallbacks,
+    // FODMs requested from the fixed point and double-double engines, the
+    // fallback rate is FastPathFallbacks / FastPathCalls
+    FastPathCalls,
+    NumCounters
+};
+
+const int FODM_NUM_STAGES = static_cast<int>(FodmStage::NumStages);
+const int FODM_NUM_COUNTERS = static_cast<int>(FodmCounter::NumCounters);
+
+// Number of latency histogram buckets. Bucket 0 counts latencies up to
+// 1 ns, bucket b latencies in (2^(b-1), 2^b] ns, so that 2^b is the
+// Prometheus "le" bound of the bucket, and the last bucket all latencies
+// over 2^(FODM_NUM_LATENCY_BUCKETS-2) ns, about 1 s.
+const int FODM_NUM_LATENCY_BUCKETS = 32;
+
+struct FodmStageMetrics
+{
+    uint64_t calls;
+    // Sum of the latencies [ns]
+    uint64_t total_ns;
+    uint64_t latency_buckets[FODM_NUM_LATENCY_BUCKETS];
+};
+
+// The metrics of all threads since the start of the process
+struct FodmMetricsSnapshot
+{
+    // false if the library is built without FODM_METRICS, then all the
+    // metrics are 0
+    bool enabled;
+    FodmStageMetrics stages[FODM_NUM_STAGES];
+    uint64_t counters[FODM_NUM_COUNTERS];
+
+    const FodmStageMetrics& stage(FodmStage s) const { return stages[static_cast<int>(s)]; }
+    uint64_t counter(FodmCounter c) const { return counters[static_cast<int>(c)]; }
+};
+
+// Latency histograms and counters of the FODM generation, to see where
+// the time of each FODM interval goes in production.
+//
+// The library records them only when built with the FODM_METRICS CMake
+// option, otherwise the recording compiles to nothing. Each thread
+// records to its own counters, so recording never waits or contends,
+// and GetFodmMetrics() adds up the counters of all threads, including
+// those that have exited. The metrics only grow, so rates and
+// per-interval histograms are the difference of two snapshots.
+//
+// Example:
+//   FodmMetricsSnapshot before = GetFodmMetrics();
+//   ...
+//   FodmMetricsSnapshot after = GetFodmMetrics();
+//   uint64_t calls = after.stage(FodmStage::Process).calls - before.stage(FodmStage::Process).calls;
+//   std::string text = FodmMetricsToPrometheus(after);
+FodmMetricsSnapshot GetFodmMetrics();
+
+// The snapshot in the Prometheus text exposition format, with the stage
+// latencies as the histogram fodm_stage_latency_seconds labelled by stage
+// and the counters as fodm_<counter>_total
+std::string FodmMetricsToPrometheus(const FodmMetricsSnapshot& snapshot);
+
+// The histogram bucket of a latency, see FODM_NUM_LATENCY_BUCKETS
+int FodmLatencyBucket(uint64_t latency_ns);
+
+#if defined(FODM_METRICS_ENABLED)
+
+// Adds to a counter of the calling thread
+void RecordFodmCounter(FodmCounter counter, uint64_t value);
+
+// Adds a call and its latency to a stage of the calling thread
+void RecordFodmStage(FodmStage stage, uint64_t latency_ns);
+
+// Records the latency of a stage from its construction to the end of the scope
+class FodmStageTimer
+{
+public:
+    explicit FodmStageTimer(FodmStage stage)
+        : stage_(stage),
+          start_(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~FodmStageTimer()
+    {
+        auto latency = std::chrono::steady_clock::now() - start_;
+        RecordFodmStage(stage_, std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+    }
+
+    FodmStageTimer(const FodmStageTimer&) = delete;
+    FodmStageTimer& operator=(const FodmStageTimer&) = delete;
+
+private:
+    FodmStage stage_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define FODM_METRICS_TIME_STAGE(stage) FodmStageTimer fodm_stage_timer_(stage)
+#define FODM_METRICS_ADD(counter, value) RecordFodmCounter(counter, value)
+
+#else
+
+#define FODM_METRICS_TIME_STAGE(stage) do {} while (0)
+#define FODM_METRICS_ADD(counter, value) do {} while (0)
+
+#endif
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
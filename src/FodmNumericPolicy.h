@@ -0,0 +1,99 @@
+#ifndef FODM_NUMERIC_POLICY_H
+#define FODM_NUMERIC_POLICY_H
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if LDBL_MANT_DIG != 113 && defined(__SIZEOF_FLOAT128__)
+#include <quadmath.h>
+#endif
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// 2^n, evaluated at compile time for the register scaling factors
+constexpr double TwoPow(int n)
+{
+    return n == 0 ? 1.0 : 2.0 * TwoPow(n - 1);
+}
+
+template <typename Real>
+struct FodmNumericPolicy;
+
+// Converts a rounded register value to the integer type T of its field in
+// the same way as the cpp_bin_float_50 conversion, so that every Real gives
+// the same register values: unsigned values wrap around, e.g. a delay
+// constant rounded up to 2^32 is stored as 0, and signed values saturate.
+// The conversion goes through 64 bit integers, as a direct conversion of an
+// out of range value to a 32 bit integer is undefined.
+template <typename T, typename Real>
+T RoundedToInt(const Real& rounded)
+{
+    if (std::is_signed<T>::value)
+    {
+        const Real limit = Real(TwoPow(8 * static_cast<int>(sizeof(T)) - 1));
+        if (rounded >= limit)
+        {
+            return std::numeric_limits<T>::max();
+        }
+        if (rounded < -limit)
+        {
+            return std::numeric_limits<T>::min();
+        }
+        return static_cast<T>(static_cast<int64_t>(rounded));
+    }
+    // cpp_bin_float_50 converts the magnitude of negative values, modulo 2^64
+    Real magnitude = rounded < 0 ? Real(-rounded) : rounded;
+    if (magnitude >= Real(TwoPow(64)))
+    {
+        magnitude = FodmNumericPolicy<Real>::Fmod(magnitude, Real(TwoPow(64)));
+    }
+    return static_cast<T>(static_cast<uint64_t>(magnitude));
+}
+
+// The numeric policy of the floating point type used by
+// CalcFodmRegisterRawValues, i.e. the functions needed besides the
+// arithmetic operators. By default the std:: functions, or the functions
+// found by argument dependent lookup such as the boost::multiprecision ones.
+template <typename Real>
+struct FodmNumericPolicy
+{
+    static Real Floor(const Real& val) { using std::floor; return floor(val); }
+    static Real Ceil(const Real& val) { using std::ceil; return ceil(val); }
+    static Real Fmod(const Real& val, const Real& div) { using std::fmod; return fmod(val, div); }
+    static Real Round(const Real& val) { using std::round; return round(val); }
+
+    // Used to convert floating point values to integer register values,
+    // scaled by 2^kScaleExponent. The scaling is exact, so ldexp gives the
+    // same value as multiplying by the factor, without converting it to Real.
+    template <typename T, int kScaleExponent>
+    static T ToInt(const Real& val)
+    {
+        using std::ldexp;
+        return RoundedToInt<T>(Round(ldexp(val, kScaleExponent)));
+    }
+};
+
+#if LDBL_MANT_DIG != 113 && defined(__SIZEOF_FLOAT128__)
+template <>
+struct FodmNumericPolicy<__float128>
+{
+    static __float128 Floor(__float128 val) { return floorq(val); }
+    static __float128 Ceil(__float128 val) { return ceilq(val); }
+    static __float128 Fmod(__float128 val, __float128 div) { return fmodq(val, div); }
+    static __float128 Round(__float128 val) { return roundq(val); }
+
+    template <typename T, int kScaleExponent>
+    static T ToInt(__float128 val)
+    {
+        return RoundedToInt<T>(Round(val * static_cast<__float128>(TwoPow(kScaleExponent))));
+    }
+};
+#endif
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
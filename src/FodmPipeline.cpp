@@ -0,0 +1,264 @@
+#include "FodmPipeline.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+const size_t FodmPipeline::BATCH_SIZE;
+
+namespace
+{
+
+// Waiting for a ring: yields for the first SPIN_COUNT tries, so that a
+// stage picks up new records quickly, then sleeps for SLEEP_US so that an
+// idle pipeline does not keep the CPUs busy
+const int SPIN_COUNT = 1000;
+const int SLEEP_US = 50;
+
+class Backoff
+{
+public:
+    Backoff() : count_(0) {}
+
+    void Wait()
+    {
+        if (count_ < SPIN_COUNT)
+        {
+            count_++;
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(SLEEP_US));
+        }
+    }
+
+    void Reset() { count_ = 0; }
+
+private:
+    int count_;
+};
+
+// Pushes all num_items items, waiting while the ring is full
+template <typename T>
+void PushAll(SpscRing<T>& ring, const T* items, size_t num_items)
+{
+    Backoff backoff;
+    while (num_items > 0)
+    {
+        size_t num_pushed = ring.TryPushBatch(items, num_items);
+        if (num_pushed == 0)
+        {
+            backoff.Wait();
+            continue;
+        }
+        backoff.Reset();
+        items += num_pushed;
+        num_items -= num_pushed;
+    }
+}
+
+// Pops up to max_items items, waiting while the ring is empty. Returns 0
+// once the ring is empty and done is set, i.e. its producer has finished.
+template <typename T>
+size_t PopBatch(SpscRing<T>& ring, const std::atomic<bool>& done, T* items, size_t max_items)
+{
+    Backoff backoff;
+    while (true)
+    {
+        size_t num_popped = ring.TryPopBatch(items, max_items);
+        if (num_popped > 0)
+        {
+            return num_popped;
+        }
+        if (done.load(std::memory_order_acquire))
+        {
+            // everything pushed before done was set is visible now
+            return ring.TryPopBatch(items, max_items);
+        }
+        backoff.Wait();
+    }
+}
+
+}; // namespace
+
+/** FodmPipeline CONSTRUCTOR
+*
+* Starts the fit, calc and writer threads.
+*
+* Input params:
+*       ctx: the channel of the register calculation
+*       writer: called on the writer thread with batches of register values
+*       model: derives the FODMs of the HODMs
+*       num_lsq_points: number of least squares points per FODM, 0 for two points
+*       ring_capacity: number of records of each ring
+*/
+FodmPipeline::FodmPipeline(const RdtChannelContext& ctx,
+                           Writer writer,
+                           const FirstOrderDelayModel& model,
+                           int num_lsq_points,
+                           size_t ring_capacity)
+    : ctx_(ctx),
+      writer_(writer),
+      model_(model),
+      num_lsq_points_(num_lsq_points),
+      hodm_ring_(ring_capacity),
+      fodm_ring_(ring_capacity),
+      register_ring_(ring_capacity),
+      hodms_done_(false),
+      fodms_done_(false),
+      registers_done_(false),
+      num_hodms_(0),
+      num_fodms_(0),
+      num_registers_(0)
+{
+    fit_thread_ = std::thread(&FodmPipeline::FitLoop, this);
+    calc_thread_ = std::thread(&FodmPipeline::CalcLoop, this);
+    write_thread_ = std::thread(&FodmPipeline::WriteLoop, this);
+}
+
+/** FodmPipeline DESTRUCTOR
+*
+* Writes the queued HODMs and stops the threads, see Close().
+*/
+FodmPipeline::~FodmPipeline()
+{
+    Close();
+}
+
+bool FodmPipeline::TryPush(const HodmRecord& hodm)
+{
+    return hodm_ring_.TryPush(hodm);
+}
+
+void FodmPipeline::Push(const HodmRecord& hodm)
+{
+    PushAll(hodm_ring_, &hodm, 1);
+}
+
+void FodmPipeline::Close()
+{
+    hodms_done_.store(true, std::memory_order_release);
+    for (std::thread* thread : { &fit_thread_, &calc_thread_, &write_thread_ })
+    {
+        if (thread->joinable())
+        {
+            thread->join();
+        }
+    }
+}
+
+/**
+* The fit stage: derives the FODMs of each HODM and passes them on in
+* batches of BATCH_SIZE. The FO times are relative to the HODM start, so
+* that they keep their precision.
+*/
+void FodmPipeline::FitLoop()
+{
+    HodmRecord hodms[BATCH_SIZE];
+    FodmRecord fodms[BATCH_SIZE];
+    // Reused for every HODM, so they only allocate when a HODM has more FOs
+    // than the ones before
+    std::vector<double> fo_t_start;
+    std::vector<long double> fo_poly;
+
+    size_t num_hodms;
+    while ((num_hodms = PopBatch(hodm_ring_, hodms_done_, hodms, BATCH_SIZE)) > 0)
+    {
+        for (size_t hh = 0; hh < num_hodms; hh++)
+        {
+            const HodmRecord& hodm = hodms[hh];
+            assert (hodm.num_ho_coeff <= PIPELINE_MAX_HO_COEFF);
+            const int num_fo_poly = hodm.num_fo_poly;
+            const double fo_offset_ms = hodm.fo_start_time_ms - hodm.ho_start_time_ms;
+            fo_t_start.resize(num_fo_poly + 1);
+            for (int ii = 0; ii <= num_fo_poly; ii++)
+            {
+                fo_t_start[ii] = (fo_offset_ms + ii * hodm.fo_interval_ms) / 1000.0;
+            }
+            const double ho_t_stop = (hodm.ho_stop_time_ms - hodm.ho_start_time_ms) / 1000.0;
+
+            bool time_inputs_ok;
+            if (num_lsq_points_ > 0)
+            {
+                time_inputs_ok = model_.process(0.0, ho_t_stop, hodm.num_ho_coeff, hodm.ho_poly,
+                    num_lsq_points_, num_fo_poly, fo_t_start, fo_poly);
+            }
+            else
+            {
+                time_inputs_ok = model_.process(0.0, ho_t_stop, hodm.num_ho_coeff, hodm.ho_poly,
+                    num_fo_poly, fo_t_start, fo_poly);
+            }
+
+            for (int ii = 0; ii < num_fo_poly; ii += BATCH_SIZE)
+            {
+                const size_t num_fodms = std::min<size_t>(BATCH_SIZE, num_fo_poly - ii);
+                for (size_t ff = 0; ff < num_fodms; ff++)
+                {
+                    FodmRecord& fodm = fodms[ff];
+                    fodm.receptor = hodm.receptor;
+                    fodm.time_inputs_ok = time_inputs_ok;
+                    fodm.fo_poly.ho_poly_start_time_ms = hodm.ho_start_time_ms;
+                    fodm.fo_poly.start_time_ms = hodm.fo_start_time_ms + (ii + ff) * hodm.fo_interval_ms;
+                    fodm.fo_poly.stop_time_ms = hodm.fo_start_time_ms + (ii + ff + 1) * hodm.fo_interval_ms;
+                    fodm.fo_poly.poly[0] = fo_poly[(ii + ff) * 2];
+                    fodm.fo_poly.poly[1] = fo_poly[(ii + ff) * 2 + 1];
+                }
+                PushAll(fodm_ring_, fodms, num_fodms);
+            }
+            num_hodms_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    fodms_done_.store(true, std::memory_order_release);
+}
+
+/**
+* The calc stage: calculates the register values of each batch of FODMs
+* with the batch CalcFodmRegisterValues.
+*/
+void FodmPipeline::CalcLoop()
+{
+    FodmRecord fodms[BATCH_SIZE];
+    FoPoly fo_polys[BATCH_SIZE];
+    FirstOrderDelayModelRegisterValues reg_values[BATCH_SIZE];
+    RegisterRecord registers[BATCH_SIZE];
+
+    size_t num_fodms;
+    while ((num_fodms = PopBatch(fodm_ring_, fodms_done_, fodms, BATCH_SIZE)) > 0)
+    {
+        for (size_t ii = 0; ii < num_fodms; ii++)
+        {
+            fo_polys[ii] = fodms[ii].fo_poly;
+        }
+        CalcFodmRegisterValues(ctx_, fo_polys, num_fodms, reg_values);
+        for (size_t ii = 0; ii < num_fodms; ii++)
+        {
+            registers[ii].receptor = fodms[ii].receptor;
+            registers[ii].time_inputs_ok = fodms[ii].time_inputs_ok;
+            registers[ii].reg_values = reg_values[ii];
+        }
+        PushAll(register_ring_, registers, num_fodms);
+        num_fodms_.fetch_add(num_fodms, std::memory_order_relaxed);
+    }
+    registers_done_.store(true, std::memory_order_release);
+}
+
+/**
+* The writer stage: passes each batch of register values to the writer.
+*/
+void FodmPipeline::WriteLoop()
+{
+    RegisterRecord registers[BATCH_SIZE];
+
+    size_t num_registers;
+    while ((num_registers = PopBatch(register_ring_, registers_done_, registers, BATCH_SIZE)) > 0)
+    {
+        writer_(registers, num_registers);
+        num_registers_.fetch_add(num_registers, std::memory_order_relaxed);
+    }
+}
+
+}; // namespace ska_mid_cbf_fodm_gen
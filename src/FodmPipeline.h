@@ -0,0 +1,151 @@
+#ifndef FODM_PIPELINE_H
+#define FODM_PIPELINE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "CalcFodmRegisterValues.h"
+#include "DelayModelStore.h"
+#include "FirstOrderDelayModel.h"
+#include "SpscRing.h"
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// Maximum number of HODM coefficients of a HodmRecord
+const int PIPELINE_MAX_HO_COEFF = 16;
+
+// A HODM of one receptor and the FODM grid to derive from it: num_fo_poly
+// FODMs of fo_interval_ms, the first starting at fo_start_time_ms. The
+// times are in ms, like FoPoly, and ho_poly is highest degree first with
+// the time in s relative to ho_start_time_ms.
+struct HodmRecord
+{
+    uint32_t receptor;
+    double ho_start_time_ms;
+    double ho_stop_time_ms;
+    int num_ho_coeff;
+    double ho_poly[PIPELINE_MAX_HO_COEFF];
+    double fo_start_time_ms;
+    double fo_interval_ms;
+    int num_fo_poly;
+};
+
+// A FODM derived from a HodmRecord. time_inputs_ok is the result of
+// FirstOrderDelayModel::process for its HODM.
+struct FodmRecord
+{
+    uint32_t receptor;
+    bool time_inputs_ok;
+    FoPoly fo_poly;
+};
+
+// The register values of a FodmRecord
+struct RegisterRecord
+{
+    uint32_t receptor;
+    bool time_inputs_ok;
+    FirstOrderDelayModelRegisterValues reg_values;
+};
+
+// A streaming HODM -> FODM -> register values pipeline for one channel,
+// with a thread per stage after the caller's:
+//
+//   Push() -> ring -> fit -> ring -> calc -> ring -> writer
+//
+// The fit stage derives the FODMs of each HODM with FirstOrderDelayModel,
+// the calc stage their register values with CalcFodmRegisterValues and the
+// RdtChannelContext, and the writer stage passes them in batches to the
+// writer function, e.g. to write them to the FPGA. The stages are connected
+// by SpscRings, so fitting the next HODM overlaps with calculating and
+// writing the registers of the current one. When a stage falls behind, the
+// rings in front of it fill up and the stages before it wait, up to
+// Push() waiting or TryPush() returning false.
+//
+// The registers reach the writer in the order of the HODMs and their FODMs.
+// The writer thread takes no locks and does not allocate, apart from what
+// the writer function does.
+//
+// Push() and TryPush() must be called from one thread at a time.
+//
+// Example:
+//   FodmPipeline pipeline(ctx, [&](const RegisterRecord* records, size_t num_records)
+//   {
+//       for (size_t ii = 0; ii < num_records; ii++) { write(records[ii]); }
+//   });
+//   pipeline.Push(hodm);
+//   pipeline.Close();
+class FodmPipeline
+{
+public:
+    // Called on the writer thread with up to BATCH_SIZE registers at a time
+    typedef std::function<void(const RegisterRecord* records, size_t num_records)> Writer;
+
+    // Maximum number of records a stage takes from its ring at once
+    static const size_t BATCH_SIZE = 64;
+
+    // num_lsq_points is passed to the least squares FirstOrderDelayModel::process,
+    // or 0 for the two point process. ring_capacity is the number of records
+    // of each ring, rounded up to a power of two.
+    FodmPipeline(const RdtChannelContext& ctx,
+                 Writer writer,
+                 const FirstOrderDelayModel& model = FirstOrderDelayModel(),
+                 int num_lsq_points = 0,
+                 size_t ring_capacity = 1024);
+
+    // Closes the pipeline
+    ~FodmPipeline();
+
+    FodmPipeline(const FodmPipeline&) = delete;
+    FodmPipeline& operator=(const FodmPipeline&) = delete;
+
+    // Queues a HODM, returns false if the HODM ring is full
+    bool TryPush(const HodmRecord& hodm);
+
+    // Queues a HODM, waiting while the HODM ring is full
+    void Push(const HodmRecord& hodm);
+
+    // Processes the queued HODMs, returns when their registers have been
+    // written and stops the threads. Push() must not be called afterwards.
+    void Close();
+
+    // Number of HODMs, FODMs and registers that have passed each stage
+    uint64_t num_hodms() const { return num_hodms_.load(std::memory_order_relaxed); }
+    uint64_t num_fodms() const { return num_fodms_.load(std::memory_order_relaxed); }
+    uint64_t num_registers() const { return num_registers_.load(std::memory_order_relaxed); }
+
+private:
+    void FitLoop();
+    void CalcLoop();
+    void WriteLoop();
+
+    const RdtChannelContext ctx_;
+    const Writer writer_;
+    const FirstOrderDelayModel model_;
+    const int num_lsq_points_;
+
+    SpscRing<HodmRecord> hodm_ring_;
+    SpscRing<FodmRecord> fodm_ring_;
+    SpscRing<RegisterRecord> register_ring_;
+
+    // Set when a stage has nothing more to put in its output ring
+    std::atomic<bool> hodms_done_;
+    std::atomic<bool> fodms_done_;
+    std::atomic<bool> registers_done_;
+
+    std::atomic<uint64_t> num_hodms_;
+    std::atomic<uint64_t> num_fodms_;
+    std::atomic<uint64_t> num_registers_;
+
+    std::thread fit_thread_;
+    std::thread calc_thread_;
+    std::thread write_thread_;
+};
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
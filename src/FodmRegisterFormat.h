@@ -0,0 +1,148 @@
+#ifndef FODM_REGISTER_FORMAT_H
+#define FODM_REGISTER_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "CalcFodmRegisterValues.h"
+
+// Comment out to apply the delay_linear_error_samples to delay_constant.
+// Shared by all the engines: FixedPoint and DoubleDouble only implement the
+// calculation without delay_linear_error_samples and do not build without it.
+#define DISABLE_DELAY_LINEAR_ERROR
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// The values of the FODM register calculation that are quantized to fixed
+// point register fields
+enum class FodmScaledValue
+{
+    DelayConstant,
+    DelayLinear,
+    PhaseConstant,
+    PhaseLinear,
+    NumValues
+};
+
+const int FODM_NUM_SCALED_VALUES = static_cast<int>(FodmScaledValue::NumValues);
+
+// A field of a register values struct, stored as an integer of width bits
+// at byte offset of the struct and at byte image_offset of the packed FPGA
+// register image of the FODM, see FodmRegisterImage.h. A fixed point field
+// holds value scaled by 2^scale_exponent and rounded to the nearest integer.
+// Out of range results wrap around, e.g. a delay constant rounded up to 2^32
+// is stored as 0. The integer fields have value FodmScaledValue::NumValues.
+// The image offsets are provisional, see FodmRegisterImage.h.
+struct FodmRegisterField
+{
+    FodmScaledValue value;
+    size_t offset;
+    size_t image_offset;
+    int width;
+    bool is_signed;
+    int scale_exponent;
+};
+
+// The fields that are not scaled: first_input_timestamp, validity_period,
+// output_PPS and first_output_timestamp
+const int FODM_NUM_INTEGER_FIELDS = 4;
+
+// The fields of a register version and the size of the packed register
+// image of one FODM. A new register version only needs a new format and
+// its FodmRegisterFormatOf below.
+struct FodmRegisterFormat
+{
+    // The fixed point fields, one per FodmScaledValue
+    FodmRegisterField fields[FODM_NUM_SCALED_VALUES];
+    FodmRegisterField integer_fields[FODM_NUM_INTEGER_FIELDS];
+    size_t image_size;
+};
+
+// FirstOrderDelayModelRegisterValuesVer1, register version 1, with 32 bit
+// delay and phase linear fields
+constexpr FodmRegisterFormat FODM_REGISTER_FORMAT_V1 = {
+  { { FodmScaledValue::DelayConstant, offsetof(FirstOrderDelayModelRegisterValuesVer1, delay_constant), 8, 32, false, 32 },
+    { FodmScaledValue::DelayLinear, offsetof(FirstOrderDelayModelRegisterValuesVer1, delay_linear), 16, 32, false, 31 },
+    { FodmScaledValue::PhaseConstant, offsetof(FirstOrderDelayModelRegisterValuesVer1, phase_constant), 12, 32, true, 31 },
+    { FodmScaledValue::PhaseLinear, offsetof(FirstOrderDelayModelRegisterValuesVer1, phase_linear), 20, 32, true, 31 } },
+  { { FodmScaledValue::NumValues, offsetof(FirstOrderDelayModelRegisterValuesVer1, first_input_timestamp), 0, 64, false, 0 },
+    { FodmScaledValue::NumValues, offsetof(FirstOrderDelayModelRegisterValuesVer1, validity_period), 24, 32, false, 0 },
+    { FodmScaledValue::NumValues, offsetof(FirstOrderDelayModelRegisterValuesVer1, output_PPS), 28, 32, false, 0 },
+    { FodmScaledValue::NumValues, offsetof(FirstOrderDelayModelRegisterValuesVer1, first_output_timestamp), 32, 64, false, 0 } },
+  40 };
+
+// FirstOrderDelayModelRegisterValues, register version 2+
+constexpr FodmRegisterFormat FODM_REGISTER_FORMAT = {
+  { { FodmScaledValue::DelayConstant, offsetof(FirstOrderDelayModelRegisterValues, delay_constant), 8, 32, false, 32 },
+    { FodmScaledValue::DelayLinear, offsetof(FirstOrderDelayModelRegisterValues, delay_linear), 16, 64, false, 63 },
+    { FodmScaledValue::PhaseConstant, offsetof(FirstOrderDelayModelRegisterValues, phase_constant), 12, 32, true, 31 },
+    { FodmScaledValue::PhaseLinear, offsetof(FirstOrderDelayModelRegisterValues, phase_linear), 24, 64, true, 63 } },
+  { { FodmScaledValue::NumValues, offsetof(FirstOrderDelayModelRegisterValues, first_input_timestamp), 0, 64, false, 0 },
+    { FodmScaledValue::NumValues, offsetof(FirstOrderDelayModelRegisterValues, validity_period), 32, 32, false, 0 },
+    { FodmScaledValue::NumValues, offsetof(FirstOrderDelayModelRegisterValues, output_PPS), 36, 32, false, 0 },
+    { FodmScaledValue::NumValues, offsetof(FirstOrderDelayModelRegisterValues, first_output_timestamp), 40, 64, false, 0 } },
+  48 };
+
+// The integer type of a field of kWidth bits
+template <int kWidth, bool kSigned>
+struct FodmRegisterFieldInt;
+
+template <> struct FodmRegisterFieldInt<32, false> { typedef uint32_t type; };
+template <> struct FodmRegisterFieldInt<32, true> { typedef int32_t type; };
+template <> struct FodmRegisterFieldInt<64, false> { typedef uint64_t type; };
+template <> struct FodmRegisterFieldInt<64, true> { typedef int64_t type; };
+
+// The format of a register values struct, so that the quantization can be
+// written once for all versions.
+//
+// Example:
+//   constexpr FodmRegisterField field = FodmRegisterFormatOf<RegisterValues>::format().fields[0];
+//   typedef FodmRegisterFieldInt<field.width, field.is_signed>::type Int;
+template <typename RegisterValues>
+struct FodmRegisterFormatOf;
+
+template <>
+struct FodmRegisterFormatOf<FirstOrderDelayModelRegisterValuesVer1>
+{
+    static constexpr const FodmRegisterFormat& format() { return FODM_REGISTER_FORMAT_V1; }
+};
+
+template <>
+struct FodmRegisterFormatOf<FirstOrderDelayModelRegisterValues>
+{
+    static constexpr const FodmRegisterFormat& format() { return FODM_REGISTER_FORMAT; }
+};
+
+// true if the fields of format are in the order of FodmScaledValue and
+// have the size and signedness of the members of RegisterValues
+template <typename RegisterValues>
+constexpr bool CheckFodmRegisterFormat(const FodmRegisterFormat& format)
+{
+    return format.fields[0].value == FodmScaledValue::DelayConstant &&
+        format.fields[1].value == FodmScaledValue::DelayLinear &&
+        format.fields[2].value == FodmScaledValue::PhaseConstant &&
+        format.fields[3].value == FodmScaledValue::PhaseLinear &&
+        format.fields[0].width == 8 * sizeof(RegisterValues::delay_constant) &&
+        format.fields[1].width == 8 * sizeof(RegisterValues::delay_linear) &&
+        format.fields[2].width == 8 * sizeof(RegisterValues::phase_constant) &&
+        format.fields[3].width == 8 * sizeof(RegisterValues::phase_linear) &&
+        format.fields[0].is_signed == std::is_signed<decltype(RegisterValues::delay_constant)>::value &&
+        format.fields[1].is_signed == std::is_signed<decltype(RegisterValues::delay_linear)>::value &&
+        format.fields[2].is_signed == std::is_signed<decltype(RegisterValues::phase_constant)>::value &&
+        format.fields[3].is_signed == std::is_signed<decltype(RegisterValues::phase_linear)>::value &&
+        format.integer_fields[0].width == 8 * sizeof(RegisterValues::first_input_timestamp) &&
+        format.integer_fields[1].width == 8 * sizeof(RegisterValues::validity_period) &&
+        format.integer_fields[2].width == 8 * sizeof(RegisterValues::output_PPS) &&
+        format.integer_fields[3].width == 8 * sizeof(RegisterValues::first_output_timestamp);
+}
+
+static_assert(CheckFodmRegisterFormat<FirstOrderDelayModelRegisterValuesVer1>(FODM_REGISTER_FORMAT_V1),
+    "FODM_REGISTER_FORMAT_V1 does not match FirstOrderDelayModelRegisterValuesVer1");
+static_assert(CheckFodmRegisterFormat<FirstOrderDelayModelRegisterValues>(FODM_REGISTER_FORMAT),
+    "FODM_REGISTER_FORMAT does not match FirstOrderDelayModelRegisterValues");
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
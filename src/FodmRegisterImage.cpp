@@ -0,0 +1,186 @@
+#include "FodmRegisterImage.h"
+
+#include <cstring>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+namespace
+{
+
+// Byte stores and loads, which the compiler merges into single stores and
+// loads on little-endian hosts, and which need no alignment
+void StoreLe32(uint8_t* p, uint32_t value)
+{
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+void StoreLe64(uint8_t* p, uint64_t value)
+{
+    StoreLe32(p, static_cast<uint32_t>(value));
+    StoreLe32(p + 4, static_cast<uint32_t>(value >> 32));
+}
+
+uint32_t LoadLe32(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) |
+           static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 |
+           static_cast<uint32_t>(p[3]) << 24;
+}
+
+uint64_t LoadLe64(const uint8_t* p)
+{
+    return static_cast<uint64_t>(LoadLe32(p)) | static_cast<uint64_t>(LoadLe32(p + 4)) << 32;
+}
+
+// Stores a field of the register values at its image offset, the bits of
+// signed fields as they are in two's complement
+void StoreField(uint8_t* p, const FodmRegisterField& field, const uint8_t* values)
+{
+    if (field.width == 64)
+    {
+        uint64_t value;
+        std::memcpy(&value, values + field.offset, sizeof(value));
+        StoreLe64(p + field.image_offset, value);
+    }
+    else
+    {
+        uint32_t value;
+        std::memcpy(&value, values + field.offset, sizeof(value));
+        StoreLe32(p + field.image_offset, value);
+    }
+}
+
+void LoadField(const uint8_t* p, const FodmRegisterField& field, uint8_t* values)
+{
+    if (field.width == 64)
+    {
+        uint64_t value = LoadLe64(p + field.image_offset);
+        std::memcpy(values + field.offset, &value, sizeof(value));
+    }
+    else
+    {
+        uint32_t value = LoadLe32(p + field.image_offset);
+        std::memcpy(values + field.offset, &value, sizeof(value));
+    }
+}
+
+// The images of the register values of the version of RegisterValues,
+// with the fields of its FodmRegisterFormat
+template <typename RegisterValues>
+void Encode(const RegisterValues* reg_values, size_t num_reg_values, void* image)
+{
+    const FodmRegisterFormat& format = FodmRegisterFormatOf<RegisterValues>::format();
+    uint8_t* p = static_cast<uint8_t*>(image);
+    for (size_t ii = 0; ii < num_reg_values; ii++, p += format.image_size)
+    {
+        const uint8_t* values = reinterpret_cast<const uint8_t*>(&reg_values[ii]);
+        for (const FodmRegisterField& field : format.fields)
+        {
+            StoreField(p, field, values);
+        }
+        for (const FodmRegisterField& field : format.integer_fields)
+        {
+            StoreField(p, field, values);
+        }
+    }
+}
+
+template <typename RegisterValues>
+void Decode(const void* image, size_t num_reg_values, RegisterValues* reg_values)
+{
+    const FodmRegisterFormat& format = FodmRegisterFormatOf<RegisterValues>::format();
+    const uint8_t* p = static_cast<const uint8_t*>(image);
+    for (size_t ii = 0; ii < num_reg_values; ii++, p += format.image_size)
+    {
+        uint8_t* values = reinterpret_cast<uint8_t*>(&reg_values[ii]);
+        for (const FodmRegisterField& field : format.fields)
+        {
+            LoadField(p, field, values);
+        }
+        for (const FodmRegisterField& field : format.integer_fields)
+        {
+            LoadField(p, field, values);
+        }
+    }
+}
+
+}; // namespace
+
+/**
+* Writes the packed register image of FODMs, register version 2+.
+*
+* Input params:
+*       reg_values: the register values of num_reg_values FODMs
+*       num_reg_values: number of FODMs
+*
+* Output params :
+*       image: num_reg_values * FODM_REGISTER_FORMAT.image_size bytes
+*/
+void EncodeFodmRegisterImage(
+    const FirstOrderDelayModelRegisterValues *reg_values,
+    size_t num_reg_values,
+    void *image )
+{
+    Encode(reg_values, num_reg_values, image);
+}
+
+/**
+* Writes the packed register image of FODMs, register version 1.
+*
+* Input params:
+*       reg_values: the register values of num_reg_values FODMs
+*       num_reg_values: number of FODMs
+*
+* Output params :
+*       image: num_reg_values * FODM_REGISTER_FORMAT_V1.image_size bytes
+*/
+void EncodeFodmRegisterImageV1(
+    const FirstOrderDelayModelRegisterValuesVer1 *reg_values,
+    size_t num_reg_values,
+    void *image )
+{
+    Encode(reg_values, num_reg_values, image);
+}
+
+/**
+* Reads FODMs from a packed register image, register version 2+.
+*
+* Input params:
+*       image: num_reg_values * FODM_REGISTER_FORMAT.image_size bytes
+*       num_reg_values: number of FODMs
+*
+* Output params :
+*       reg_values: the register values of the num_reg_values FODMs
+*/
+void DecodeFodmRegisterImage(
+    const void *image,
+    size_t num_reg_values,
+    FirstOrderDelayModelRegisterValues *reg_values )
+{
+    Decode(image, num_reg_values, reg_values);
+}
+
+/**
+* Reads FODMs from a packed register image, register version 1.
+*
+* Input params:
+*       image: num_reg_values * FODM_REGISTER_FORMAT_V1.image_size bytes
+*       num_reg_values: number of FODMs
+*
+* Output params :
+*       reg_values: the register values of the num_reg_values FODMs
+*/
+void DecodeFodmRegisterImageV1(
+    const void *image,
+    size_t num_reg_values,
+    FirstOrderDelayModelRegisterValuesVer1 *reg_values )
+{
+    Decode(image, num_reg_values, reg_values);
+}
+
+}; // namespace ska_mid_cbf_fodm_gen
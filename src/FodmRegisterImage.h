@@ -0,0 +1,63 @@
+#ifndef FODM_REGISTER_IMAGE_H
+#define FODM_REGISTER_IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "CalcFodmRegisterValues.h"
+#include "FodmRegisterFormat.h"
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// The packed FPGA register image of the FODMs. The FODM registers are 32
+// bit registers at the image_offset of each field of the FodmRegisterFormat
+// of the register version, FODM_REGISTER_FORMAT or FODM_REGISTER_FORMAT_V1,
+// see FodmRegisterFormat.h. A 64 bit field takes two registers, the low word
+// first, and every register is little-endian, with signed fields in two's
+// complement. The image of one FODM is image_size bytes, and the images of
+// consecutive FODMs are contiguous.
+//
+// PROVISIONAL: the image offsets and the register order are assumed from
+// the order of the fields of the register value structs. They are not yet
+// taken from the FPGA register map, the FPGA JSON interface file
+// first_order_delay_models.json, and must be checked against it before
+// the image is written to hardware.
+
+// Writes the packed register image of num_reg_values FODMs to image, which
+// must have room for num_reg_values * FODM_REGISTER_FORMAT.image_size bytes
+// and needs no alignment. The image can then be copied to the register window
+// of the FPGA in one transfer, by DMA or with aligned 32 bit stores as
+// RegisterBankWriter does, as Device memory faults on unaligned accesses.
+//
+// Example:
+//   FirstOrderDelayModelRegisterValues reg_values[64];
+//   std::vector<uint8_t> image(64 * FODM_REGISTER_FORMAT.image_size);
+//   CalcFodmRegisterValues(ctx, fo_polys, 64, reg_values);
+//   EncodeFodmRegisterImage(reg_values, 64, image.data());
+void EncodeFodmRegisterImage(
+    const FirstOrderDelayModelRegisterValues *reg_values,
+    size_t num_reg_values,
+    void *image );
+
+// Same as above for register version 1, with FODM_REGISTER_FORMAT_V1
+void EncodeFodmRegisterImageV1(
+    const FirstOrderDelayModelRegisterValuesVer1 *reg_values,
+    size_t num_reg_values,
+    void *image );
+
+// Reads num_reg_values FODMs back from a packed register image, e.g. to
+// check what was written to the FPGA
+void DecodeFodmRegisterImage(
+    const void *image,
+    size_t num_reg_values,
+    FirstOrderDelayModelRegisterValues *reg_values );
+
+void DecodeFodmRegisterImageV1(
+    const void *image,
+    size_t num_reg_values,
+    FirstOrderDelayModelRegisterValuesVer1 *reg_values );
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
@@ -0,0 +1,145 @@
+#include "FodmSequence.h"
+#include "CalcFodmRegisterValuesFixedPoint.h"
+
+#include <cmath>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+namespace
+{
+
+// Time units per ms, and output timestamp denominator per output sample
+// rate, i.e. output samples = time units * output_sample_rate / TIMESTAMP_DEN
+const double UNITS_PER_MS = 65536.0;
+const uint64_t TIMESTAMP_DEN = 1000 * 65536;
+const double MAX_UNITS = 9223372036854775808.0; // 2^63
+
+// Converts time_ms to a whole number of time units. Returns false if it
+// is not a whole number of units or is out of range.
+bool ToTimeUnits(double time_ms, uint64_t &units)
+{
+    double units_f = time_ms * UNITS_PER_MS;
+    if (!(units_f >= 0.0 && units_f < MAX_UNITS) || std::floor(units_f) != units_f)
+    {
+        return false;
+    }
+    units = static_cast<uint64_t>(units_f);
+    return true;
+}
+
+}; // namespace
+
+/** FodmSequence CONSTRUCTOR
+*
+* Input params:
+*       output_sample_rate: output sample rate in samples/second
+*/
+FodmSequence::FodmSequence(uint32_t output_sample_rate)
+    : output_sample_rate_(output_sample_rate),
+      anchored_(false),
+      stop_time_ms_(0.0),
+      next_timestamp_(0),
+      whole_units_(false),
+      stop_time_units_(0),
+      next_exact_(0),
+      next_remainder_(0),
+      num_anchors_(0)
+{
+}
+
+/**
+* Calculates the output timestamps of the next FODM.
+*
+* Input params:
+*       fo_poly: the next FODM
+*
+* Output params:
+*       timestamps: the output timestamps of fo_poly
+*
+* Returns:
+*       false if the timestamps can not be represented, true otherwise.
+*/
+bool FodmSequence::Next(const FoPoly &fo_poly, FodmOutputTimestamps &timestamps)
+{
+    if (!anchored_ || fo_poly.start_time_ms != stop_time_ms_ || !(fo_poly.stop_time_ms >= fo_poly.start_time_ms))
+    {
+        return Anchor(fo_poly, timestamps);
+    }
+
+    timestamps.current = next_timestamp_;
+
+    uint64_t stop_time_units;
+    if (whole_units_ && ToTimeUnits(fo_poly.stop_time_ms, stop_time_units))
+    {
+        // Advance by the FODM duration in integers
+        unsigned __int128 step =
+            static_cast<unsigned __int128>(stop_time_units - stop_time_units_) * output_sample_rate_ + next_remainder_;
+        unsigned __int128 next_exact = next_exact_ + step / TIMESTAMP_DEN;
+        uint64_t next_remainder = static_cast<uint64_t>(step % TIMESTAMP_DEN);
+        if (next_exact <= UINT64_MAX)
+        {
+            timestamps.next = static_cast<uint64_t>(next_exact);
+            // Exactly on an output sample, which the multi-precision
+            // calculation may round to the sample before
+            if (next_remainder == 0 &&
+                !CalcFodmOutputTimestampFixedPoint(fo_poly.stop_time_ms, output_sample_rate_, timestamps.next))
+            {
+                Reset();
+                return false;
+            }
+            stop_time_ms_ = fo_poly.stop_time_ms;
+            next_timestamp_ = timestamps.next;
+            stop_time_units_ = stop_time_units;
+            next_exact_ = static_cast<uint64_t>(next_exact);
+            next_remainder_ = next_remainder;
+            return true;
+        }
+    }
+
+    if (!CalcFodmOutputTimestampFixedPoint(fo_poly.stop_time_ms, output_sample_rate_, timestamps.next))
+    {
+        Reset();
+        return false;
+    }
+    SetStopTime(fo_poly.stop_time_ms, timestamps.next);
+    return true;
+}
+
+/**
+* Forgets the previous FODM, so that the next FODM anchors the sequence.
+*/
+void FodmSequence::Reset()
+{
+    anchored_ = false;
+}
+
+bool FodmSequence::Anchor(const FoPoly &fo_poly, FodmOutputTimestamps &timestamps)
+{
+    if (!CalcFodmOutputTimestampFixedPoint(fo_poly.start_time_ms, output_sample_rate_, timestamps.current) ||
+        !CalcFodmOutputTimestampFixedPoint(fo_poly.stop_time_ms, output_sample_rate_, timestamps.next))
+    {
+        Reset();
+        return false;
+    }
+    num_anchors_++;
+    anchored_ = true;
+    SetStopTime(fo_poly.stop_time_ms, timestamps.next);
+    return true;
+}
+
+void FodmSequence::SetStopTime(double stop_time_ms, uint64_t next_timestamp)
+{
+    stop_time_ms_ = stop_time_ms;
+    next_timestamp_ = next_timestamp;
+    whole_units_ = ToTimeUnits(stop_time_ms, stop_time_units_);
+    if (whole_units_)
+    {
+        unsigned __int128 scaled = static_cast<unsigned __int128>(stop_time_units_) * output_sample_rate_;
+        whole_units_ = scaled / TIMESTAMP_DEN <= UINT64_MAX;
+        next_exact_ = static_cast<uint64_t>(scaled / TIMESTAMP_DEN);
+        next_remainder_ = static_cast<uint64_t>(scaled % TIMESTAMP_DEN);
+    }
+}
+
+}; // namespace ska_mid_cbf_fodm_gen
@@ -0,0 +1,78 @@
+#ifndef FODM_SEQUENCE_H
+#define FODM_SEQUENCE_H
+
+#include <cstdint>
+
+#include "CalcFodmRegisterValues.h"
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// Generates the output timestamps of consecutive FODMs, i.e.
+// floor(time_ms / 1000 * output_sample_rate) of their start and stop
+// times, with the same results as the multi-precision calculation.
+//
+// When a FODM starts where the previous one stopped, its current timestamp
+// is the previous next timestamp, and the next timestamp is advanced from
+// the previous one in integers. The time is kept in units of 2^-16 ms, so
+// any interval that is a multiple of that (e.g. 10 ms or 1/128 s) is
+// advanced exactly. The sequence re-anchors, calculating both timestamps
+// from the start and stop times, when a FODM does not start where the
+// previous one stopped. An exact whole output sample is also recalculated,
+// since the multi-precision result depends on how ms / 1000 was rounded.
+//
+// The register fields derived from the timestamps (first_output_timestamp,
+// validity_period, output_PPS and the phase time factor) then only need
+// integer arithmetic, see CalcFodmRegisterValues with FodmOutputTimestamps.
+//
+// Example:
+//   FodmSequence sequence(output_sample_rate);
+//   FodmOutputTimestamps timestamps;
+//   for (const FoPoly& fo_poly : fo_polys)
+//   {
+//       if (sequence.Next(fo_poly, timestamps))
+//       {
+//           reg_values = CalcFodmRegisterValues(fo_poly, timestamps, ...);
+//       }
+//   }
+class FodmSequence
+{
+public:
+    explicit FodmSequence(uint32_t output_sample_rate);
+
+    // Calculates the output timestamps of fo_poly and advances the sequence.
+    // Returns false, and resets the sequence, if the timestamps can not be
+    // represented, e.g. for negative times.
+    bool Next(const FoPoly &fo_poly, FodmOutputTimestamps &timestamps);
+
+    // Forgets the previous FODM, the next one re-anchors the sequence
+    void Reset();
+
+    // Number of times the sequence was anchored, including the first FODM
+    uint64_t num_anchors() const { return num_anchors_; }
+
+private:
+    bool Anchor(const FoPoly &fo_poly, FodmOutputTimestamps &timestamps);
+
+    // Sets the stop time of the previous FODM and its timestamp
+    void SetStopTime(double stop_time_ms, uint64_t next_timestamp);
+
+    uint32_t output_sample_rate_;
+    bool anchored_;
+    // Stop time of the previous FODM and its timestamp
+    double stop_time_ms_;
+    uint64_t next_timestamp_;
+    // If the stop time is a whole number of 2^-16 ms units: the stop time
+    // in units, and the quotient and remainder of
+    // stop_time_units_ * output_sample_rate_ / (1000 * 2^16). The quotient
+    // is the exact timestamp, which next_timestamp_ may be one less than.
+    bool whole_units_;
+    uint64_t stop_time_units_;
+    uint64_t next_exact_;
+    uint64_t next_remainder_;
+    uint64_t num_anchors_;
+};
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
@@ -0,0 +1,130 @@
+#include "FodmWorkspace.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+namespace
+{
+
+// Size of the first heap block [bytes]
+const size_t MIN_BLOCK_SIZE = 4096;
+
+// Largest alignment the blocks allow for, per block when they are merged
+const size_t MAX_ALIGNMENT = alignof(std::max_align_t);
+
+}; // namespace
+
+/** FodmWorkspace CONSTRUCTOR
+*
+* Takes all memory from the heap.
+*/
+FodmWorkspace::FodmWorkspace()
+    : FodmWorkspace(nullptr, 0)
+{
+}
+
+/** FodmWorkspace CONSTRUCTOR
+*
+* Input params:
+*       buffer: memory used before the heap, which must outlive the workspace
+*       size: size of buffer [bytes]
+*/
+FodmWorkspace::FodmWorkspace(void* buffer, size_t size)
+    : buffer_(static_cast<char*>(buffer)),
+      buffer_size_(buffer != nullptr ? size : 0),
+      block_(-1),
+      offset_(0),
+      size_(0),
+      num_heap_allocations_(0)
+{
+}
+
+/**
+* Releases everything allocated. The heap blocks of the last round are
+* merged into one, so that the same round fits without allocating.
+*/
+void FodmWorkspace::Reset()
+{
+    if (blocks_.size() > 1)
+    {
+        size_t total_size = 0;
+        for (const Block& block : blocks_)
+        {
+            total_size += block.size + MAX_ALIGNMENT;
+        }
+        blocks_.clear();
+        Block block = { std::unique_ptr<char[]>(new char[total_size]), total_size };
+        blocks_.push_back(std::move(block));
+        num_heap_allocations_++;
+    }
+    block_ = -1;
+    offset_ = 0;
+    size_ = 0;
+}
+
+size_t FodmWorkspace::capacity() const
+{
+    size_t capacity = buffer_size_;
+    for (const Block& block : blocks_)
+    {
+        capacity += block.size;
+    }
+    return capacity;
+}
+
+/**
+* Takes size bytes aligned to alignment from the current block, moving on to
+* the next block, or allocating one, when they do not fit.
+*
+* Input params:
+*       size: number of bytes
+*       alignment: alignment of the bytes, a power of two up to max_align_t
+*
+* Returns :
+*       the bytes, or nullptr if size is 0.
+*/
+void* FodmWorkspace::AllocateBytes(size_t size, size_t alignment)
+{
+    assert (alignment <= MAX_ALIGNMENT && (alignment & (alignment - 1)) == 0);
+    if (size == 0)
+    {
+        return nullptr;
+    }
+
+    while (true)
+    {
+        char* data = block_ < 0 ? buffer_ : blocks_[block_].data.get();
+        size_t data_size = block_ < 0 ? buffer_size_ : blocks_[block_].size;
+        if (data != nullptr)
+        {
+            uintptr_t address = reinterpret_cast<uintptr_t>(data) + offset_;
+            size_t start = offset_ + ((alignment - address % alignment) % alignment);
+            if (start <= data_size && size <= data_size - start)
+            {
+                offset_ = start + size;
+                size_ += size;
+                return data + start;
+            }
+        }
+
+        if (static_cast<size_t>(block_ + 1) == blocks_.size())
+        {
+            size_t block_size = std::max(size + MAX_ALIGNMENT, MIN_BLOCK_SIZE);
+            if (!blocks_.empty())
+            {
+                block_size = std::max(block_size, 2 * blocks_.back().size);
+            }
+            Block block = { std::unique_ptr<char[]>(new char[block_size]), block_size };
+            blocks_.push_back(std::move(block));
+            num_heap_allocations_++;
+        }
+        block_++;
+        offset_ = 0;
+    }
+}
+
+}; // namespace ska_mid_cbf_fodm_gen
@@ -0,0 +1,131 @@
+#ifndef FODM_WORKSPACE_H
+#define FODM_WORKSPACE_H
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// A monotonic arena for the scratch buffers of FirstOrderDelayModel, so
+// that deriving FODMs on a real-time thread does not touch the heap.
+//
+// Allocate() takes memory from the caller's buffer, if any, then from heap
+// blocks the workspace allocates when the buffer is full. Nothing is freed
+// until Reset(), which makes all the memory available again. When the
+// previous round needed more than one heap block, Reset() replaces them
+// with a single block of their total size, so that once a workspace has
+// seen the largest round, the following rounds do not allocate.
+//
+// A workspace is used by one thread at a time.
+//
+// Example:
+//   char buffer[16384];
+//   FodmWorkspace workspace(buffer, sizeof(buffer));
+//   while (...)
+//   {
+//       workspace.Reset();
+//       model.process(ho_t_start, ho_t_stop, num_ho_coeff, ho_poly, num_fo_poly,
+//                     fo_t_start, fo_poly, nullptr, workspace);
+//   }
+class FodmWorkspace
+{
+public:
+    // Takes all memory from the heap
+    FodmWorkspace();
+
+    // Takes memory from buffer, which must outlive the workspace, before
+    // the heap
+    FodmWorkspace(void* buffer, size_t size);
+
+    FodmWorkspace(const FodmWorkspace&) = delete;
+    FodmWorkspace& operator=(const FodmWorkspace&) = delete;
+
+    // Uninitialized memory for num_items items of T, valid until Reset()
+    template <typename T>
+    T* Allocate(size_t num_items)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "FodmWorkspace items are never destroyed");
+        return static_cast<T*>(AllocateBytes(num_items * sizeof(T), alignof(T)));
+    }
+
+    // Releases everything allocated, keeping the memory
+    void Reset();
+
+    // Bytes handed out since the last Reset(), and bytes of memory held,
+    // including the caller's buffer
+    size_t size() const { return size_; }
+    size_t capacity() const;
+
+    // Number of heap blocks allocated since construction
+    size_t num_heap_allocations() const { return num_heap_allocations_; }
+
+private:
+    struct Block
+    {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    void* AllocateBytes(size_t size, size_t alignment);
+
+    char* const buffer_;
+    const size_t buffer_size_;
+    std::vector<Block> blocks_;
+    // The block allocations come from, -1 for the caller's buffer, and the
+    // offset of the free memory in it
+    int block_;
+    size_t offset_;
+    size_t size_;
+    size_t num_heap_allocations_;
+};
+
+// A standard allocator taking its memory from a FodmWorkspace, for output
+// buffers the library allocates in the caller's arena. deallocate() does
+// nothing: the memory is released by FodmWorkspace::Reset(), which must not
+// be called while a container using it is still in use.
+//
+// Example:
+//   FodmArenaVector<long double> fo_poly(FodmArenaAllocator<long double>(workspace));
+//   fo_poly.resize(num_fo_poly * 2);
+template <typename T>
+class FodmArenaAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit FodmArenaAllocator(FodmWorkspace& workspace) : workspace_(&workspace) {}
+
+    template <typename U>
+    FodmArenaAllocator(const FodmArenaAllocator<U>& other) : workspace_(other.workspace()) {}
+
+    T* allocate(size_t num_items) { return workspace_->Allocate<T>(num_items); }
+
+    void deallocate(T*, size_t) {}
+
+    FodmWorkspace* workspace() const { return workspace_; }
+
+private:
+    FodmWorkspace* workspace_;
+};
+
+template <typename T, typename U>
+bool operator==(const FodmArenaAllocator<T>& a, const FodmArenaAllocator<U>& b)
+{
+    return a.workspace() == b.workspace();
+}
+
+template <typename T, typename U>
+bool operator!=(const FodmArenaAllocator<T>& a, const FodmArenaAllocator<U>& b)
+{
+    return !(a == b);
+}
+
+template <typename T>
+using FodmArenaVector = std::vector<T, FodmArenaAllocator<T>>;
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
@@ -0,0 +1,230 @@
+#ifndef INT256_H
+#define INT256_H
+
+#include <cstdint>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// A minimal signed 256 bit integer in two's complement, stored as four
+// 64 bit limbs with the least significant limb first. Only the operations
+// needed by the fixed point FODM register calculation are provided. The
+// arithmetic wraps on overflow, callers are expected to keep the values
+// within range by checking bit_length() beforehand.
+class Int256
+{
+public:
+    Int256() : w_{0, 0, 0, 0} {}
+
+    Int256(int64_t val)
+    {
+        uint64_t ext = val < 0 ? ~uint64_t(0) : 0;
+        w_[0] = static_cast<uint64_t>(val);
+        w_[1] = ext;
+        w_[2] = ext;
+        w_[3] = ext;
+    }
+
+    static Int256 FromInt128(__int128 val)
+    {
+        Int256 res;
+        uint64_t ext = val < 0 ? ~uint64_t(0) : 0;
+        res.w_[0] = static_cast<uint64_t>(val);
+        res.w_[1] = static_cast<uint64_t>(static_cast<unsigned __int128>(val) >> 64);
+        res.w_[2] = ext;
+        res.w_[3] = ext;
+        return res;
+    }
+
+    static Int256 FromUInt128(unsigned __int128 val)
+    {
+        Int256 res;
+        res.w_[0] = static_cast<uint64_t>(val);
+        res.w_[1] = static_cast<uint64_t>(val >> 64);
+        return res;
+    }
+
+    static Int256 FromUInt64(uint64_t val)
+    {
+        Int256 res;
+        res.w_[0] = val;
+        return res;
+    }
+
+    bool is_negative() const { return (w_[3] >> 63) != 0; }
+
+    bool is_zero() const { return (w_[0] | w_[1] | w_[2] | w_[3]) == 0; }
+
+    // Number of bits needed to represent the magnitude
+    int bit_length() const
+    {
+        Int256 mag = is_negative() ? -*this : *this;
+        for (int ii = 3; ii >= 0; ii--)
+        {
+            if (mag.w_[ii] != 0)
+            {
+                return ii * 64 + 64 - __builtin_clzll(mag.w_[ii]);
+            }
+        }
+        return 0;
+    }
+
+    Int256 operator-() const
+    {
+        Int256 res;
+        unsigned __int128 carry = 1;
+        for (int ii = 0; ii < 4; ii++)
+        {
+            carry += ~w_[ii];
+            res.w_[ii] = static_cast<uint64_t>(carry);
+            carry >>= 64;
+        }
+        return res;
+    }
+
+    Int256 operator+(const Int256& rhs) const
+    {
+        Int256 res;
+        unsigned __int128 carry = 0;
+        for (int ii = 0; ii < 4; ii++)
+        {
+            carry += static_cast<unsigned __int128>(w_[ii]) + rhs.w_[ii];
+            res.w_[ii] = static_cast<uint64_t>(carry);
+            carry >>= 64;
+        }
+        return res;
+    }
+
+    Int256 operator-(const Int256& rhs) const { return *this + (-rhs); }
+
+    Int256 operator*(const Int256& rhs) const
+    {
+        bool neg = is_negative() != rhs.is_negative();
+        Int256 a = is_negative() ? -*this : *this;
+        Int256 b = rhs.is_negative() ? -rhs : rhs;
+        Int256 res;
+        for (int ii = 0; ii < 4; ii++)
+        {
+            unsigned __int128 carry = 0;
+            for (int jj = 0; ii + jj < 4; jj++)
+            {
+                carry += static_cast<unsigned __int128>(a.w_[ii]) * b.w_[jj] + res.w_[ii + jj];
+                res.w_[ii + jj] = static_cast<uint64_t>(carry);
+                carry >>= 64;
+            }
+        }
+        return neg ? -res : res;
+    }
+
+    // Shift left by 0 <= n < 256 bits
+    Int256 operator<<(int n) const
+    {
+        Int256 res;
+        int limbs = n / 64;
+        int bits = n % 64;
+        for (int ii = 3; ii >= limbs; ii--)
+        {
+            uint64_t val = w_[ii - limbs] << bits;
+            if (bits != 0 && ii - limbs - 1 >= 0)
+            {
+                val |= w_[ii - limbs - 1] >> (64 - bits);
+            }
+            res.w_[ii] = val;
+        }
+        return res;
+    }
+
+    // Arithmetic shift right by 0 <= n < 256 bits, i.e. floor(x / 2^n)
+    Int256 operator>>(int n) const
+    {
+        uint64_t ext = is_negative() ? ~uint64_t(0) : 0;
+        Int256 res;
+        int limbs = n / 64;
+        int bits = n % 64;
+        for (int ii = 0; ii < 4; ii++)
+        {
+            int src = ii + limbs;
+            uint64_t lo = src < 4 ? w_[src] : ext;
+            uint64_t hi = src + 1 < 4 ? w_[src + 1] : ext;
+            res.w_[ii] = bits == 0 ? lo : (lo >> bits) | (hi << (64 - bits));
+        }
+        return res;
+    }
+
+    bool operator==(const Int256& rhs) const
+    {
+        return w_[0] == rhs.w_[0] && w_[1] == rhs.w_[1] && w_[2] == rhs.w_[2] && w_[3] == rhs.w_[3];
+    }
+
+    bool operator!=(const Int256& rhs) const { return !(*this == rhs); }
+
+    bool operator<(const Int256& rhs) const
+    {
+        if (is_negative() != rhs.is_negative())
+        {
+            return is_negative();
+        }
+        for (int ii = 3; ii >= 0; ii--)
+        {
+            if (w_[ii] != rhs.w_[ii])
+            {
+                return w_[ii] < rhs.w_[ii];
+            }
+        }
+        return false;
+    }
+
+    bool operator>(const Int256& rhs) const { return rhs < *this; }
+    bool operator<=(const Int256& rhs) const { return !(rhs < *this); }
+    bool operator>=(const Int256& rhs) const { return !(*this < rhs); }
+
+    // floor(x / den) for den > 0. The remainder, 0 <= rem < den, is
+    // returned in rem.
+    Int256 floor_div(uint64_t den, uint64_t& rem) const
+    {
+        bool neg = is_negative();
+        Int256 mag = neg ? -*this : *this;
+        Int256 quot;
+        unsigned __int128 r = 0;
+        for (int ii = 3; ii >= 0; ii--)
+        {
+            unsigned __int128 cur = (r << 64) | mag.w_[ii];
+            quot.w_[ii] = static_cast<uint64_t>(cur / den);
+            r = cur % den;
+        }
+        rem = static_cast<uint64_t>(r);
+        if (neg)
+        {
+            quot = -quot;
+            if (rem != 0)
+            {
+                quot = quot - Int256(1);
+                rem = den - rem;
+            }
+        }
+        return quot;
+    }
+
+    Int256 floor_div(uint64_t den) const
+    {
+        uint64_t rem;
+        return floor_div(den, rem);
+    }
+
+    bool fits_uint64() const { return (w_[1] | w_[2] | w_[3]) == 0; }
+
+    bool fits_int64() const
+    {
+        uint64_t ext = is_negative() ? ~uint64_t(0) : 0;
+        return w_[1] == ext && w_[2] == ext && w_[3] == ext && ((w_[0] >> 63) == (ext & 1));
+    }
+
+    uint64_t low_uint64() const { return w_[0]; }
+
+private:
+    uint64_t w_[4];
+};
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
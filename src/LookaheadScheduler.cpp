@@ -0,0 +1,278 @@
+#include "LookaheadScheduler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+namespace
+{
+
+// FODMs calculated at once with the batch CalcFodmRegisterValues, so that
+// the lock of a receptor is not held for long and Publish() and Advance()
+// are picked up soon
+const size_t BATCH_SIZE = 16;
+
+bool SameFoPoly(const FoPoly& a, const FoPoly& b)
+{
+    return a.ho_poly_start_time_ms == b.ho_poly_start_time_ms &&
+           a.start_time_ms == b.start_time_ms &&
+           a.stop_time_ms == b.stop_time_ms &&
+           a.poly[0] == b.poly[0] &&
+           a.poly[1] == b.poly[1];
+}
+
+}; // namespace
+
+/** LookaheadScheduler CONSTRUCTOR
+*
+* Starts the background thread. Nothing is calculated before the first
+* Advance().
+*
+* Input params:
+*       ctx: the channel of the register calculation
+*       num_receptors: number of receptors, numbered from 0
+*       lookahead: number of FODMs per receptor calculated ahead
+*/
+LookaheadScheduler::LookaheadScheduler(const RdtChannelContext& ctx, int num_receptors, size_t lookahead)
+    : ctx_(ctx),
+      lookahead_(lookahead),
+      store_(num_receptors),
+      receptors_(new Receptor[num_receptors]),
+      time_ms_(std::numeric_limits<double>::quiet_NaN()),
+      num_calculated_(0),
+      num_invalidated_(0),
+      num_misses_(0),
+      stop_(false),
+      work_generation_(0),
+      idle_generation_(0)
+{
+    worker_ = std::thread(&LookaheadScheduler::WorkerLoop, this);
+}
+
+LookaheadScheduler::~LookaheadScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    idle_cv_.notify_all();
+    worker_.join();
+}
+
+/**
+* Adds an entry to the store. The register values of the FODMs from the
+* start of the entry that are not in the entry, or differ from it, are
+* dropped, as is the register value of a FODM overlapping the start.
+*
+* Input params:
+*       receptor: the receptor of the entry
+*       entry: the HODM and its FODMs
+*
+* Returns :
+*       false if the entry has no FODMs, true otherwise.
+*/
+bool LookaheadScheduler::Publish(int receptor, DelayModelEntry entry)
+{
+    assert (receptor >= 0 && receptor < store_.num_receptors());
+    if (entry.fo_polys.empty())
+    {
+        return false;
+    }
+    const std::vector<FoPoly>& fo_polys = entry.fo_polys;
+    const double start_time_ms = fo_polys.front().start_time_ms;
+
+    Receptor& state = receptors_[receptor];
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        auto it = state.ready.lower_bound(start_time_ms);
+        if (it != state.ready.begin() && std::prev(it)->second.fo_poly.stop_time_ms > start_time_ms)
+        {
+            it--;
+        }
+        while (it != state.ready.end())
+        {
+            auto fo_it = std::lower_bound(fo_polys.begin(), fo_polys.end(), it->first,
+                [](const FoPoly& fo_poly, double t) { return fo_poly.start_time_ms < t; });
+            if (fo_it != fo_polys.end() && SameFoPoly(*fo_it, it->second.fo_poly))
+            {
+                it++;
+            }
+            else
+            {
+                it = state.ready.erase(it);
+                num_invalidated_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        state.version++;
+        store_.Publish(receptor, std::move(entry));
+    }
+    Notify();
+    return true;
+}
+
+void LookaheadScheduler::Advance(double time_ms)
+{
+    time_ms_.store(time_ms);
+    store_.RemoveBefore(time_ms);
+    for (int rr = 0; rr < store_.num_receptors(); rr++)
+    {
+        Receptor& state = receptors_[rr];
+        std::lock_guard<std::mutex> lock(state.mutex);
+        auto it = state.ready.begin();
+        while (it != state.ready.end() && it->second.fo_poly.stop_time_ms <= time_ms)
+        {
+            it = state.ready.erase(it);
+        }
+    }
+    Notify();
+}
+
+/**
+* Looks up the register values of the FODM covering a timestamp.
+*
+* Input params:
+*       receptor: the receptor
+*       time_ms: the timestamp [ms]
+*
+* Output params :
+*       reg_values: the register values of the FODM covering time_ms
+*
+* Returns :
+*       false if they have not been calculated, true otherwise.
+*/
+bool LookaheadScheduler::Lookup(int receptor, double time_ms, FirstOrderDelayModelRegisterValues& reg_values) const
+{
+    assert (receptor >= 0 && receptor < store_.num_receptors());
+    const Receptor& state = receptors_[receptor];
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        auto it = state.ready.upper_bound(time_ms);
+        if (it != state.ready.begin() && time_ms < std::prev(it)->second.fo_poly.stop_time_ms)
+        {
+            reg_values = std::prev(it)->second.reg_values;
+            return true;
+        }
+    }
+    num_misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void LookaheadScheduler::WaitIdle() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return stop_ || idle_generation_ == work_generation_; });
+}
+
+void LookaheadScheduler::Notify()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        work_generation_++;
+    }
+    work_cv_.notify_one();
+}
+
+/**
+* The background thread: fills the windows of the receptors in turn, one
+* batch each, until they are all complete, then waits for Publish() or
+* Advance().
+*/
+void LookaheadScheduler::WorkerLoop()
+{
+    DelayModelStore::Reader reader(store_);
+    while (true)
+    {
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_)
+            {
+                return;
+            }
+            generation = work_generation_;
+        }
+
+        bool has_work = false;
+        for (int rr = 0; rr < store_.num_receptors(); rr++)
+        {
+            has_work |= FillWindow(rr, reader);
+        }
+
+        if (!has_work)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_generation_ = generation;
+            idle_cv_.notify_all();
+            work_cv_.wait(lock, [&] { return stop_ || work_generation_ != generation; });
+        }
+    }
+}
+
+/**
+* Walks the window of a receptor and calculates the register values of up
+* to BATCH_SIZE FODMs without them. The FODMs are read with the lock of
+* the receptor held, and the register values are only added if Publish()
+* has not changed the receptor while they were calculated.
+*
+* Returns :
+*       false if the window is complete, true otherwise.
+*/
+bool LookaheadScheduler::FillWindow(int receptor, DelayModelStore::Reader& reader)
+{
+    Receptor& state = receptors_[receptor];
+    FoPoly fo_polys[BATCH_SIZE];
+    FirstOrderDelayModelRegisterValues reg_values[BATCH_SIZE];
+    size_t num_fo_poly = 0;
+    uint64_t version;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        version = state.version;
+        double time_ms = time_ms_.load();
+        if (std::isnan(time_ms))
+        {
+            return false;
+        }
+        FoPoly fo_poly;
+        for (size_t ii = 0; ii < lookahead_ && num_fo_poly < BATCH_SIZE; ii++)
+        {
+            if (!reader.FindFodm(receptor, time_ms, fo_poly))
+            {
+                break;
+            }
+            if (state.ready.find(fo_poly.start_time_ms) == state.ready.end())
+            {
+                fo_polys[num_fo_poly++] = fo_poly;
+            }
+            time_ms = fo_poly.stop_time_ms;
+        }
+    }
+    if (num_fo_poly == 0)
+    {
+        return false;
+    }
+
+    CalcFodmRegisterValues(ctx_, fo_polys, num_fo_poly, reg_values);
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.version == version)
+    {
+        const double time_ms = time_ms_.load();
+        for (size_t ii = 0; ii < num_fo_poly; ii++)
+        {
+            if (fo_polys[ii].stop_time_ms > time_ms)
+            {
+                state.ready[fo_polys[ii].start_time_ms] = ReadyFodm{ fo_polys[ii], reg_values[ii] };
+            }
+        }
+        num_calculated_.fetch_add(num_fo_poly, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+}; // namespace ska_mid_cbf_fodm_gen
@@ -0,0 +1,134 @@
+#ifndef LOOKAHEAD_SCHEDULER_H
+#define LOOKAHEAD_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "CalcFodmRegisterValues.h"
+#include "DelayModelStore.h"
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// Calculates the register values of the FODMs of each receptor ahead of
+// time on a background thread, so that writing the registers of a FODM is
+// a lookup instead of a CalcFodmRegisterValues call.
+//
+// The FODMs are kept in a DelayModelStore. For each receptor, the window is
+// the lookahead consecutive FODMs from the one covering the time of the
+// last Advance(), up to the first gap. The background thread calculates
+// the register values of the FODMs in the windows that do not have them,
+// a few consecutive FODMs at a time with the batch CalcFodmRegisterValues.
+//
+// When Publish() adds a new entry, it supersedes the FODMs from its start
+// as in DelayModelStore::Publish, and only the register values of FODMs
+// that changed are dropped and calculated again.
+//
+// Lookup() only takes a per receptor lock, which the background thread
+// holds to add or drop register values but not while calculating them.
+//
+// Example:
+//   LookaheadScheduler scheduler(ctx, num_receptors, 100);
+//   scheduler.Publish(receptor, entry);
+//   scheduler.Advance(time_ms);
+//   ...
+//   if (!scheduler.Lookup(receptor, time_ms, reg_values))
+//   {
+//       // not ready yet, calculate it on the spot
+//   }
+class LookaheadScheduler
+{
+public:
+    // lookahead is the number of FODMs per receptor calculated ahead
+    LookaheadScheduler(const RdtChannelContext& ctx, int num_receptors, size_t lookahead);
+
+    // Stops the background thread
+    ~LookaheadScheduler();
+
+    LookaheadScheduler(const LookaheadScheduler&) = delete;
+    LookaheadScheduler& operator=(const LookaheadScheduler&) = delete;
+
+    // Adds the entry of receptor, see DelayModelStore::Publish. The
+    // register values of the FODMs it changes are calculated again.
+    bool Publish(int receptor, DelayModelEntry entry);
+
+    // Moves the windows to start at the FODMs covering time_ms, and drops
+    // the FODMs and register values stopping at or before it
+    void Advance(double time_ms);
+
+    // The register values of the FODM of receptor covering time_ms. Returns
+    // false if they have not been calculated.
+    bool Lookup(int receptor, double time_ms, FirstOrderDelayModelRegisterValues& reg_values) const;
+
+    // Returns once the register values of all windows are calculated
+    void WaitIdle() const;
+
+    size_t lookahead() const { return lookahead_; }
+
+    // Number of FODMs whose register values were calculated, of register
+    // values dropped because Publish() changed their FODM, and of Lookup()
+    // calls that found no register values
+    uint64_t num_calculated() const { return num_calculated_.load(std::memory_order_relaxed); }
+    uint64_t num_invalidated() const { return num_invalidated_.load(std::memory_order_relaxed); }
+    uint64_t num_misses() const { return num_misses_.load(std::memory_order_relaxed); }
+
+private:
+    // The register values of a FODM, and the FODM they were calculated from
+    struct ReadyFodm
+    {
+        FoPoly fo_poly;
+        FirstOrderDelayModelRegisterValues reg_values;
+    };
+
+    struct Receptor
+    {
+        // Guards ready and version
+        mutable std::mutex mutex;
+        // Keyed by the FODM start time
+        std::map<double, ReadyFodm> ready;
+        // Incremented by Publish(), so that register values calculated from
+        // the FODMs it replaced are not added
+        uint64_t version = 0;
+    };
+
+    void WorkerLoop();
+
+    // Calculates the register values of up to BATCH_SIZE FODMs of the window
+    // of receptor. Returns false if the window is complete.
+    bool FillWindow(int receptor, DelayModelStore::Reader& reader);
+
+    // Tells the background thread that there is new work
+    void Notify();
+
+    const RdtChannelContext ctx_;
+    const size_t lookahead_;
+    DelayModelStore store_;
+    std::unique_ptr<Receptor[]> receptors_;
+    std::atomic<double> time_ms_;
+
+    std::atomic<uint64_t> num_calculated_;
+    std::atomic<uint64_t> num_invalidated_;
+    mutable std::atomic<uint64_t> num_misses_;
+
+    // Guards the fields below
+    mutable std::mutex mutex_;
+    mutable std::condition_variable work_cv_;
+    mutable std::condition_variable idle_cv_;
+    bool stop_;
+    // Incremented by Notify(), and set to it by the background thread after
+    // a pass over the windows found no work
+    uint64_t work_generation_;
+    uint64_t idle_generation_;
+
+    std::thread worker_;
+};
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
@@ -0,0 +1,112 @@
+#include "MappedRegisterWindow.h"
+
+#include <cassert>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+MappedRegisterWindow::MappedRegisterWindow()
+    : data_(nullptr),
+      size_(0),
+      fd_(-1)
+{
+}
+
+MappedRegisterWindow::~MappedRegisterWindow()
+{
+    Close();
+}
+
+/**
+* Maps a window of a file or device.
+*
+* Input params:
+*       path: the file or device, e.g. /dev/uio0, or a regular file as a stand-in
+*       size: size of the window [bytes]
+*       offset: offset of the window in path, a multiple of the page size [bytes]
+*
+* Returns :
+*       false if path cannot be opened, extended or mapped, true otherwise.
+*/
+bool MappedRegisterWindow::Open(const std::string& path, size_t size, uint64_t offset)
+{
+    Close();
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    return Map(fd, path, size, offset);
+}
+
+/**
+* Maps a new anonymous memfd, the contents of which are zero.
+*
+* Input params:
+*       name: the name of the memfd, only used for debugging
+*       size: size of the window [bytes]
+*
+* Returns :
+*       false if the memfd cannot be created or mapped, true otherwise.
+*/
+bool MappedRegisterWindow::OpenMemfd(const std::string& name, size_t size)
+{
+    Close();
+    int fd = memfd_create(name.c_str(), MFD_CLOEXEC);
+    return Map(fd, "/proc/self/fd/" + std::to_string(fd), size, 0);
+}
+
+bool MappedRegisterWindow::Map(int fd, const std::string& path, size_t size, uint64_t offset)
+{
+    assert (size > 0);
+    assert (offset % static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) == 0);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0;
+    if (ok && S_ISREG(st.st_mode) && static_cast<uint64_t>(st.st_size) < offset + size)
+    {
+        ok = ftruncate(fd, static_cast<off_t>(offset + size)) == 0;
+    }
+
+    void* data = MAP_FAILED;
+    if (ok)
+    {
+        data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, static_cast<off_t>(offset));
+    }
+    if (data == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+
+    data_ = static_cast<uint8_t*>(data);
+    size_ = size;
+    fd_ = fd;
+    path_ = path;
+    return true;
+}
+
+void MappedRegisterWindow::Close()
+{
+    if (data_ != nullptr)
+    {
+        munmap(data_, size_);
+        close(fd_);
+        data_ = nullptr;
+        size_ = 0;
+        fd_ = -1;
+        path_.clear();
+    }
+}
+
+bool MappedRegisterWindow::Sync()
+{
+    assert (is_open());
+    return msync(data_, size_, MS_SYNC) == 0;
+}
+
+}; // namespace ska_mid_cbf_fodm_gen
@@ -0,0 +1,76 @@
+#ifndef MAPPED_REGISTER_WINDOW_H
+#define MAPPED_REGISTER_WINDOW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// A memory-mapped register window: size bytes of a file or device from
+// offset, mapped shared, so that stores to data() reach the file or the
+// device. With a UIO device or /dev/mem this is the FPGA register window;
+// with a regular file it stands in for the window without hardware, and
+// what was written can be read back from the file.
+//
+// Open() creates a regular file that does not exist and extends one that
+// is too short. OpenMemfd() maps an anonymous memfd instead, which leaves
+// nothing behind; path() opens a second view of it, e.g. the FPGA side in
+// a test. Both return false if the file cannot be created or mapped.
+//
+// Example:
+//   MappedRegisterWindow window;
+//   if (!window.Open("/tmp/fodm_registers.bin", num_fodms * FODM_REGISTER_FORMAT.image_size))
+//   {
+//       ...
+//   }
+//   EncodeFodmRegisterImage(reg_values, num_fodms, window.at(0));
+//   window.Sync();
+class MappedRegisterWindow
+{
+public:
+    MappedRegisterWindow();
+
+    // Unmaps the window
+    ~MappedRegisterWindow();
+
+    MappedRegisterWindow(const MappedRegisterWindow&) = delete;
+    MappedRegisterWindow& operator=(const MappedRegisterWindow&) = delete;
+
+    // Maps size bytes of path from offset, which must be a multiple of the
+    // page size, closing the current window first
+    bool Open(const std::string& path, size_t size, uint64_t offset = 0);
+
+    // Maps size bytes of a new memfd named name
+    bool OpenMemfd(const std::string& name, size_t size);
+
+    void Close();
+
+    // Flushes the window to a regular file, a no-op for devices. Returns
+    // false if msync fails.
+    bool Sync();
+
+    bool is_open() const { return data_ != nullptr; }
+    // The path that maps the same file, /proc/self/fd/N for a memfd
+    const std::string& path() const { return path_; }
+    size_t size() const { return size_; }
+
+    // The byte at offset of the window
+    uint8_t* at(size_t offset) { return data_ + offset; }
+    const uint8_t* at(size_t offset) const { return data_ + offset; }
+
+private:
+    // Maps size bytes of fd from offset, taking ownership of fd
+    bool Map(int fd, const std::string& path, size_t size, uint64_t offset);
+
+    uint8_t* data_;
+    size_t size_;
+    // Kept open while mapped, so that path() of a memfd stays valid
+    int fd_;
+    std::string path_;
+};
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
@@ -0,0 +1,572 @@
+#include "MultiPointHorner.h"
+#include "DoubleDouble.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define MULTI_POINT_HORNER_X86
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define MULTI_POINT_HORNER_NEON
+#include <arm_neon.h>
+#endif
+
+// This file is compiled with -ffp-contract=off, so that a * b + c is never
+// fused and every kernel rounds the same way as the scalar loop.
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+namespace
+{
+
+// kNumCoeffs is the number of coefficients, or 0 for num_coeff. With the
+// number a compile time constant, the compiler fully unrolls the loops over
+// the coefficients, as for the other kernels.
+template <int kNumCoeffs>
+void HornerScalar(const double* poly, int num_coeff, const double* x, size_t num_points, double* y)
+{
+    num_coeff = kNumCoeffs > 0 ? kNumCoeffs : num_coeff;
+    for (size_t ii = 0; ii < num_points; ii++)
+    {
+        double y_i = poly[0];
+        for (int kk = 1; kk < num_coeff; kk++)
+        {
+            y_i = y_i * x[ii] + poly[kk];
+        }
+        y[ii] = y_i;
+    }
+}
+
+template <int kNumCoeffs>
+void CompensatedHornerScalar(
+    const double* poly, int num_coeff, const double* x, size_t num_points, double* y_hi, double* y_lo)
+{
+    num_coeff = kNumCoeffs > 0 ? kNumCoeffs : num_coeff;
+    for (size_t ii = 0; ii < num_points; ii++)
+    {
+        DoubleDouble y_i = CompensatedHorner(poly, num_coeff, x[ii]);
+        y_hi[ii] = y_i.hi;
+        y_lo[ii] = y_i.lo;
+    }
+}
+
+// The polynomials in structure-of-arrays layout, coefficient kk of
+// polynomial ii at poly[kk * stride + ii]. Same steps as CompensatedHorner.
+void CompensatedHornerSoAScalar(
+    const double* poly, size_t stride, int num_coeff, const double* x, size_t num_polys, double* y_hi, double* y_lo)
+{
+    for (size_t ii = 0; ii < num_polys; ii++)
+    {
+        double s = poly[ii];
+        double c = 0.0;
+        for (int kk = 1; kk < num_coeff; kk++)
+        {
+            DoubleDouble prod = TwoProd(s, x[ii]);
+            DoubleDouble sum = TwoSum(prod.hi, poly[kk * stride + ii]);
+            s = sum.hi;
+            c = c * x[ii] + (prod.lo + sum.lo);
+        }
+        y_hi[ii] = s;
+        y_lo[ii] = c;
+    }
+}
+
+// The points from first_point on, after the SIMD loop
+template <bool kSoA, int kNumCoeffs>
+void CompensatedHornerTail(
+    const double* poly, size_t stride, int num_coeff, const double* x, size_t first_point, size_t num_points,
+    double* y_hi, double* y_lo)
+{
+    if (kSoA)
+    {
+        CompensatedHornerSoAScalar(poly + first_point, stride, num_coeff, x + first_point,
+            num_points - first_point, y_hi + first_point, y_lo + first_point);
+    }
+    else
+    {
+        CompensatedHornerScalar<kNumCoeffs>(poly, num_coeff, x + first_point,
+            num_points - first_point, y_hi + first_point, y_lo + first_point);
+    }
+}
+
+#ifdef MULTI_POINT_HORNER_X86
+
+template <int kNumCoeffs>
+__attribute__((target("avx2,fma")))
+void HornerAvx2(const double* poly, int num_coeff, const double* x, size_t num_points, double* y)
+{
+    num_coeff = kNumCoeffs > 0 ? kNumCoeffs : num_coeff;
+    size_t ii = 0;
+    for (; ii + 4 <= num_points; ii += 4)
+    {
+        __m256d x_v = _mm256_loadu_pd(x + ii);
+        __m256d y_v = _mm256_set1_pd(poly[0]);
+        for (int kk = 1; kk < num_coeff; kk++)
+        {
+            y_v = _mm256_add_pd(_mm256_mul_pd(y_v, x_v), _mm256_set1_pd(poly[kk]));
+        }
+        _mm256_storeu_pd(y + ii, y_v);
+    }
+    HornerScalar<kNumCoeffs>(poly, num_coeff, x + ii, num_points - ii, y + ii);
+}
+
+// kSoA selects the coefficient layout: one polynomial for all points, or
+// one polynomial per point in structure-of-arrays layout with the given stride
+template <bool kSoA, int kNumCoeffs>
+__attribute__((target("avx2,fma")))
+void CompensatedHornerAvx2(
+    const double* poly, size_t stride, int num_coeff, const double* x, size_t num_points, double* y_hi, double* y_lo)
+{
+    num_coeff = kNumCoeffs > 0 ? kNumCoeffs : num_coeff;
+    size_t ii = 0;
+    for (; ii + 4 <= num_points; ii += 4)
+    {
+        __m256d x_v = _mm256_loadu_pd(x + ii);
+        __m256d s = kSoA ? _mm256_loadu_pd(poly + ii) : _mm256_set1_pd(poly[0]);
+        __m256d c = _mm256_setzero_pd();
+        for (int kk = 1; kk < num_coeff; kk++)
+        {
+            // TwoProd(s, x)
+            __m256d prod_hi = _mm256_mul_pd(s, x_v);
+            __m256d prod_lo = _mm256_fmsub_pd(s, x_v, prod_hi);
+            // TwoSum(prod_hi, poly[kk])
+            __m256d b = kSoA ? _mm256_loadu_pd(poly + kk * stride + ii) : _mm256_set1_pd(poly[kk]);
+            __m256d sum_hi = _mm256_add_pd(prod_hi, b);
+            __m256d b_virtual = _mm256_sub_pd(sum_hi, prod_hi);
+            __m256d a_virtual = _mm256_sub_pd(sum_hi, b_virtual);
+            __m256d sum_lo = _mm256_add_pd(_mm256_sub_pd(prod_hi, a_virtual), _mm256_sub_pd(b, b_virtual));
+            s = sum_hi;
+            c = _mm256_add_pd(_mm256_mul_pd(c, x_v), _mm256_add_pd(prod_lo, sum_lo));
+        }
+        _mm256_storeu_pd(y_hi + ii, s);
+        _mm256_storeu_pd(y_lo + ii, c);
+    }
+    CompensatedHornerTail<kSoA, kNumCoeffs>(poly, stride, num_coeff, x, ii, num_points, y_hi, y_lo);
+}
+
+template <int kNumCoeffs>
+__attribute__((target("avx512f")))
+void HornerAvx512(const double* poly, int num_coeff, const double* x, size_t num_points, double* y)
+{
+    num_coeff = kNumCoeffs > 0 ? kNumCoeffs : num_coeff;
+    size_t ii = 0;
+    for (; ii + 8 <= num_points; ii += 8)
+    {
+        __m512d x_v = _mm512_loadu_pd(x + ii);
+        __m512d y_v = _mm512_set1_pd(poly[0]);
+        for (int kk = 1; kk < num_coeff; kk++)
+        {
+            y_v = _mm512_add_pd(_mm512_mul_pd(y_v, x_v), _mm512_set1_pd(poly[kk]));
+        }
+        _mm512_storeu_pd(y + ii, y_v);
+    }
+    HornerScalar<kNumCoeffs>(poly, num_coeff, x + ii, num_points - ii, y + ii);
+}
+
+template <bool kSoA, int kNumCoeffs>
+__attribute__((target("avx512f")))
+void CompensatedHornerAvx512(
+    const double* poly, size_t stride, int num_coeff, const double* x, size_t num_points, double* y_hi, double* y_lo)
+{
+    num_coeff = kNumCoeffs > 0 ? kNumCoeffs : num_coeff;
+    size_t ii = 0;
+    for (; ii + 8 <= num_points; ii += 8)
+    {
+        __m512d x_v = _mm512_loadu_pd(x + ii);
+        __m512d s = kSoA ? _mm512_loadu_pd(poly + ii) : _mm512_set1_pd(poly[0]);
+        __m512d c = _mm512_setzero_pd();
+        for (int kk = 1; kk < num_coeff; kk++)
+        {
+            // TwoProd(s, x)
+            __m512d prod_hi = _mm512_mul_pd(s, x_v);
+            __m512d prod_lo = _mm512_fmsub_pd(s, x_v, prod_hi);
+            // TwoSum(prod_hi, poly[kk])
+            __m512d b = kSoA ? _mm512_loadu_pd(poly + kk * stride + ii) : _mm512_set1_pd(poly[kk]);
+            __m512d sum_hi = _mm512_add_pd(prod_hi, b);
+            __m512d b_virtual = _mm512_sub_pd(sum_hi, prod_hi);
+            __m512d a_virtual = _mm512_sub_pd(sum_hi, b_virtual);
+            __m512d sum_lo = _mm512_add_pd(_mm512_sub_pd(prod_hi, a_virtual), _mm512_sub_pd(b, b_virtual));
+            s = sum_hi;
+            c = _mm512_add_pd(_mm512_mul_pd(c, x_v), _mm512_add_pd(prod_lo, sum_lo));
+        }
+        _mm512_storeu_pd(y_hi + ii, s);
+        _mm512_storeu_pd(y_lo + ii, c);
+    }
+    CompensatedHornerTail<kSoA, kNumCoeffs>(poly, stride, num_coeff, x, ii, num_points, y_hi, y_lo);
+}
+
+#endif // MULTI_POINT_HORNER_X86
+
+#ifdef MULTI_POINT_HORNER_NEON
+
+template <int kNumCoeffs>
+void HornerNeon(const double* poly, int num_coeff, const double* x, size_t num_points, double* y)
+{
+    num_coeff = kNumCoeffs > 0 ? kNumCoeffs : num_coeff;
+    size_t ii = 0;
+    for (; ii + 2 <= num_points; ii += 2)
+    {
+        float64x2_t x_v = vld1q_f64(x + ii);
+        float64x2_t y_v = vdupq_n_f64(poly[0]);
+        for (int kk = 1; kk < num_coeff; kk++)
+        {
+            y_v = vaddq_f64(vmulq_f64(y_v, x_v), vdupq_n_f64(poly[kk]));
+        }
+        vst1q_f64(y + ii, y_v);
+    }
+    HornerScalar<kNumCoeffs>(poly, num_coeff, x + ii, num_points - ii, y + ii);
+}
+
+template <bool kSoA, int kNumCoeffs>
+void CompensatedHornerNeon(
+    const double* poly, size_t stride, int num_coeff, const double* x, size_t num_points, double* y_hi, double* y_lo)
+{
+    num_coeff = kNumCoeffs > 0 ? kNumCoeffs : num_coeff;
+    size_t ii = 0;
+    for (; ii + 2 <= num_points; ii += 2)
+    {
+        float64x2_t x_v = vld1q_f64(x + ii);
+        float64x2_t s = kSoA ? vld1q_f64(poly + ii) : vdupq_n_f64(poly[0]);
+        float64x2_t c = vdupq_n_f64(0.0);
+        for (int kk = 1; kk < num_coeff; kk++)
+        {
+            // TwoProd(s, x)
+            float64x2_t prod_hi = vmulq_f64(s, x_v);
+            float64x2_t prod_lo = vfmaq_f64(vnegq_f64(prod_hi), s, x_v);
+            // TwoSum(prod_hi, poly[kk])
+            float64x2_t b = kSoA ? vld1q_f64(poly + kk * stride + ii) : vdupq_n_f64(poly[kk]);
+            float64x2_t sum_hi = vaddq_f64(prod_hi, b);
+            float64x2_t b_virtual = vsubq_f64(sum_hi, prod_hi);
+            float64x2_t a_virtual = vsubq_f64(sum_hi, b_virtual);
+            float64x2_t sum_lo = vaddq_f64(vsubq_f64(prod_hi, a_virtual), vsubq_f64(b, b_virtual));
+            s = sum_hi;
+            c = vaddq_f64(vmulq_f64(c, x_v), vaddq_f64(prod_lo, sum_lo));
+        }
+        vst1q_f64(y_hi + ii, s);
+        vst1q_f64(y_lo + ii, c);
+    }
+    CompensatedHornerTail<kSoA, kNumCoeffs>(poly, stride, num_coeff, x, ii, num_points, y_hi, y_lo);
+}
+
+#endif // MULTI_POINT_HORNER_NEON
+
+// The widest kernel supported by the CPU
+HornerKernel DetectHornerKernel()
+{
+#if defined(MULTI_POINT_HORNER_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        return HornerKernel::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+        return HornerKernel::Avx2;
+    }
+#elif defined(MULTI_POINT_HORNER_NEON)
+    return HornerKernel::Neon;
+#endif
+    return HornerKernel::Scalar;
+}
+
+}; // namespace
+
+/**
+* Resolves the kernel used for the requested one.
+*
+* Input params:
+*       kernel: the requested kernel
+*
+* Returns:
+*       Auto resolved to the widest supported kernel, unsupported kernels
+*       resolved to Scalar.
+*/
+HornerKernel ResolveHornerKernel(HornerKernel kernel)
+{
+    static const HornerKernel detected = DetectHornerKernel();
+    if (kernel == HornerKernel::Auto)
+    {
+        return detected;
+    }
+    switch (kernel)
+    {
+    case HornerKernel::Avx512:
+        return detected == HornerKernel::Avx512 ? kernel : HornerKernel::Scalar;
+    case HornerKernel::Avx2:
+        return detected == HornerKernel::Avx512 || detected == HornerKernel::Avx2 ? kernel : HornerKernel::Scalar;
+    case HornerKernel::Neon:
+        return detected == HornerKernel::Neon ? kernel : HornerKernel::Scalar;
+    default:
+        return HornerKernel::Scalar;
+    }
+}
+
+namespace
+{
+
+/**
+* Evaluates the polynomial at num_points points with Horner's method, with
+* the kernel unrolled for kNumCoeffs coefficients, or the loop for
+* num_coeff if kNumCoeffs is 0.
+*
+* Input params:
+*       poly: polynomial to evaluate. Highest degree coefficient first.
+*       num_coeff: number of coefficients in the polynomial
+*       x: the num_points points to evaluate the polynomial at
+*       num_points: number of points
+*       kernel: the SIMD kernel to use
+*
+* Output params:
+*       y: the num_points evaluated values
+*/
+template <int kNumCoeffs>
+void HornerDispatch(
+    const double* poly,
+    int num_coeff,
+    const double* x,
+    size_t num_points,
+    double* y,
+    HornerKernel kernel)
+{
+    switch (ResolveHornerKernel(kernel))
+    {
+#ifdef MULTI_POINT_HORNER_X86
+    case HornerKernel::Avx512:
+        HornerAvx512<kNumCoeffs>(poly, num_coeff, x, num_points, y);
+        return;
+    case HornerKernel::Avx2:
+        HornerAvx2<kNumCoeffs>(poly, num_coeff, x, num_points, y);
+        return;
+#endif
+#ifdef MULTI_POINT_HORNER_NEON
+    case HornerKernel::Neon:
+        HornerNeon<kNumCoeffs>(poly, num_coeff, x, num_points, y);
+        return;
+#endif
+    default:
+        HornerScalar<kNumCoeffs>(poly, num_coeff, x, num_points, y);
+        return;
+    }
+}
+
+/**
+* Evaluates the polynomial at num_points points with the compensated
+* Horner scheme, with the kernel unrolled for kNumCoeffs coefficients, or
+* the loop for num_coeff if kNumCoeffs is 0.
+*
+* Input params:
+*       poly: polynomial to evaluate. Highest degree coefficient first.
+*       num_coeff: number of coefficients in the polynomial
+*       x: the num_points points to evaluate the polynomial at
+*       num_points: number of points
+*       kernel: the SIMD kernel to use
+*
+* Output params:
+*       y_hi, y_lo: the num_points evaluated values, as y_hi + y_lo
+*/
+template <int kNumCoeffs>
+void CompensatedHornerDispatch(
+    const double* poly,
+    int num_coeff,
+    const double* x,
+    size_t num_points,
+    double* y_hi,
+    double* y_lo,
+    HornerKernel kernel)
+{
+    switch (ResolveHornerKernel(kernel))
+    {
+#ifdef MULTI_POINT_HORNER_X86
+    case HornerKernel::Avx512:
+        CompensatedHornerAvx512<false, kNumCoeffs>(poly, 0, num_coeff, x, num_points, y_hi, y_lo);
+        return;
+    case HornerKernel::Avx2:
+        CompensatedHornerAvx2<false, kNumCoeffs>(poly, 0, num_coeff, x, num_points, y_hi, y_lo);
+        return;
+#endif
+#ifdef MULTI_POINT_HORNER_NEON
+    case HornerKernel::Neon:
+        CompensatedHornerNeon<false, kNumCoeffs>(poly, 0, num_coeff, x, num_points, y_hi, y_lo);
+        return;
+#endif
+    default:
+        CompensatedHornerScalar<kNumCoeffs>(poly, num_coeff, x, num_points, y_hi, y_lo);
+        return;
+    }
+}
+
+}; // namespace
+
+/**
+* Evaluates the polynomial at num_points points with Horner's method, with
+* the kernel unrolled for num_coeff up to MAX_UNROLLED_NUM_COEFF.
+*
+* Input params:
+*       poly: polynomial to evaluate. Highest degree coefficient first.
+*       num_coeff: number of coefficients in the polynomial
+*       x: the num_points points to evaluate the polynomial at
+*       num_points: number of points
+*       kernel: the SIMD kernel to use
+*
+* Output params:
+*       y: the num_points evaluated values
+*/
+void HornerMultiPoint(
+    const double* poly,
+    int num_coeff,
+    const double* x,
+    size_t num_points,
+    double* y,
+    HornerKernel kernel)
+{
+    DispatchNumCoeff(num_coeff, [&](auto num_coeffs)
+    {
+        HornerDispatch<decltype(num_coeffs)::value>(poly, num_coeff, x, num_points, y, kernel);
+    });
+}
+
+template <int NumCoeffs>
+void HornerMultiPoint(
+    const double* poly,
+    const double* x,
+    size_t num_points,
+    double* y,
+    HornerKernel kernel)
+{
+    HornerDispatch<NumCoeffs>(poly, NumCoeffs, x, num_points, y, kernel);
+}
+
+/**
+* Evaluates the polynomial at num_points points with the compensated
+* Horner scheme, with the kernel unrolled for num_coeff up to
+* MAX_UNROLLED_NUM_COEFF.
+*
+* Input params:
+*       poly: polynomial to evaluate. Highest degree coefficient first.
+*       num_coeff: number of coefficients in the polynomial
+*       x: the num_points points to evaluate the polynomial at
+*       num_points: number of points
+*       kernel: the SIMD kernel to use
+*
+* Output params:
+*       y_hi, y_lo: the num_points evaluated values, as y_hi + y_lo
+*/
+void CompensatedHornerMultiPoint(
+    const double* poly,
+    int num_coeff,
+    const double* x,
+    size_t num_points,
+    double* y_hi,
+    double* y_lo,
+    HornerKernel kernel)
+{
+    DispatchNumCoeff(num_coeff, [&](auto num_coeffs)
+    {
+        CompensatedHornerDispatch<decltype(num_coeffs)::value>(poly, num_coeff, x, num_points, y_hi, y_lo, kernel);
+    });
+}
+
+template <int NumCoeffs>
+void CompensatedHornerMultiPoint(
+    const double* poly,
+    const double* x,
+    size_t num_points,
+    double* y_hi,
+    double* y_lo,
+    HornerKernel kernel)
+{
+    CompensatedHornerDispatch<NumCoeffs>(poly, NumCoeffs, x, num_points, y_hi, y_lo, kernel);
+}
+
+template void HornerMultiPoint<2>(const double*, const double*, size_t, double*, HornerKernel);
+template void HornerMultiPoint<3>(const double*, const double*, size_t, double*, HornerKernel);
+template void HornerMultiPoint<4>(const double*, const double*, size_t, double*, HornerKernel);
+template void HornerMultiPoint<5>(const double*, const double*, size_t, double*, HornerKernel);
+template void HornerMultiPoint<6>(const double*, const double*, size_t, double*, HornerKernel);
+template void HornerMultiPoint<7>(const double*, const double*, size_t, double*, HornerKernel);
+template void HornerMultiPoint<8>(const double*, const double*, size_t, double*, HornerKernel);
+template void HornerMultiPoint<9>(const double*, const double*, size_t, double*, HornerKernel);
+
+template void CompensatedHornerMultiPoint<2>(const double*, const double*, size_t, double*, double*, HornerKernel);
+template void CompensatedHornerMultiPoint<3>(const double*, const double*, size_t, double*, double*, HornerKernel);
+template void CompensatedHornerMultiPoint<4>(const double*, const double*, size_t, double*, double*, HornerKernel);
+template void CompensatedHornerMultiPoint<5>(const double*, const double*, size_t, double*, double*, HornerKernel);
+template void CompensatedHornerMultiPoint<6>(const double*, const double*, size_t, double*, double*, HornerKernel);
+template void CompensatedHornerMultiPoint<7>(const double*, const double*, size_t, double*, double*, HornerKernel);
+template void CompensatedHornerMultiPoint<8>(const double*, const double*, size_t, double*, double*, HornerKernel);
+template void CompensatedHornerMultiPoint<9>(const double*, const double*, size_t, double*, double*, HornerKernel);
+
+/**
+* Evaluates num_polys polynomials in structure-of-arrays layout, each at
+* its own point, with the compensated Horner scheme.
+*
+* Input params:
+*       poly: the polynomials, coefficient kk of polynomial ii at
+*             poly[kk * num_polys + ii]. Highest degree coefficient first.
+*       num_coeff: number of coefficients in each polynomial
+*       num_polys: number of polynomials
+*       x: the num_polys points, polynomial ii is evaluated at x[ii]
+*       kernel: the SIMD kernel to use
+*
+* Output params:
+*       y_hi, y_lo: the num_polys evaluated values, as y_hi + y_lo
+*/
+void CompensatedHornerSoA(
+    const double* poly,
+    int num_coeff,
+    size_t num_polys,
+    const double* x,
+    double* y_hi,
+    double* y_lo,
+    HornerKernel kernel)
+{
+    CompensatedHornerSoA(poly, num_coeff, num_polys, num_polys, x, y_hi, y_lo, kernel);
+}
+
+/**
+* Evaluates num_polys polynomials in structure-of-arrays layout with the
+* given stride, each at its own point, with the compensated Horner scheme.
+*
+* Input params:
+*       poly: the polynomials, coefficient kk of polynomial ii at
+*             poly[kk * stride + ii]. Highest degree coefficient first.
+*       num_coeff: number of coefficients in each polynomial
+*       num_polys: number of polynomials
+*       stride: distance between consecutive coefficients of a polynomial
+*       x: the num_polys points, polynomial ii is evaluated at x[ii]
+*       kernel: the SIMD kernel to use
+*
+* Output params:
+*       y_hi, y_lo: the num_polys evaluated values, as y_hi + y_lo
+*/
+void CompensatedHornerSoA(
+    const double* poly,
+    int num_coeff,
+    size_t num_polys,
+    size_t stride,
+    const double* x,
+    double* y_hi,
+    double* y_lo,
+    HornerKernel kernel)
+{
+    switch (ResolveHornerKernel(kernel))
+    {
+#ifdef MULTI_POINT_HORNER_X86
+    case HornerKernel::Avx512:
+        CompensatedHornerAvx512<true, 0>(poly, stride, num_coeff, x, num_polys, y_hi, y_lo);
+        return;
+    case HornerKernel::Avx2:
+        CompensatedHornerAvx2<true, 0>(poly, stride, num_coeff, x, num_polys, y_hi, y_lo);
+        return;
+#endif
+#ifdef MULTI_POINT_HORNER_NEON
+    case HornerKernel::Neon:
+        CompensatedHornerNeon<true, 0>(poly, stride, num_coeff, x, num_polys, y_hi, y_lo);
+        return;
+#endif
+    default:
+        CompensatedHornerSoAScalar(poly, stride, num_coeff, x, num_polys, y_hi, y_lo);
+        return;
+    }
+}
+
+}; // namespace ska_mid_cbf_fodm_gen
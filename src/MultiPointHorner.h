@@ -0,0 +1,145 @@
+#ifndef MULTI_POINT_HORNER_H
+#define MULTI_POINT_HORNER_H
+
+#include <cstddef>
+#include <type_traits>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// The SIMD instruction set used to evaluate a polynomial at many points
+enum class HornerKernel
+{
+    // The widest kernel supported by the CPU, detected at run time
+    Auto,
+    // One point at a time
+    Scalar,
+    // 4 points at a time with AVX2 and FMA, x86-64 only
+    Avx2,
+    // 8 points at a time with AVX-512F, x86-64 only
+    Avx512,
+    // 2 points at a time with NEON, armv8 only
+    Neon
+};
+
+// Returns the kernel that is used for the requested one: Auto resolves to
+// the widest kernel supported by the CPU, and kernels that are not
+// supported by the CPU or the build resolve to Scalar.
+HornerKernel ResolveHornerKernel(HornerKernel kernel);
+
+// The number of coefficients of a degree 8 polynomial, the largest one
+// with kernels unrolled for the number of coefficients
+const int MAX_UNROLLED_NUM_COEFF = 9;
+
+// Calls f(std::integral_constant<int, N>()) for num_coeff N from 2 to
+// MAX_UNROLLED_NUM_COEFF, and f(std::integral_constant<int, 0>()) for any
+// other num_coeff, so that f can select the code for N coefficients at
+// compile time and fall back to the loop over num_coeff for 0.
+//
+// Example:
+//   DispatchNumCoeff(num_coeff, [&](auto num_coeffs)
+//   {
+//       Evaluate<decltype(num_coeffs)::value>(poly, num_coeff, x);
+//   });
+template <typename F>
+auto DispatchNumCoeff(int num_coeff, F&& f) -> decltype(f(std::integral_constant<int, 0>()))
+{
+    switch (num_coeff)
+    {
+    case 2: return f(std::integral_constant<int, 2>());
+    case 3: return f(std::integral_constant<int, 3>());
+    case 4: return f(std::integral_constant<int, 4>());
+    case 5: return f(std::integral_constant<int, 5>());
+    case 6: return f(std::integral_constant<int, 6>());
+    case 7: return f(std::integral_constant<int, 7>());
+    case 8: return f(std::integral_constant<int, 8>());
+    case 9: return f(std::integral_constant<int, 9>());
+    default: return f(std::integral_constant<int, 0>());
+    }
+}
+static_assert(MAX_UNROLLED_NUM_COEFF == 9, "DispatchNumCoeff has a case per number of coefficients");
+
+// Evaluates the polynomial at num_points points with Horner's method in
+// double, y[i] = poly(x[i]). Every kernel gives the same results as the
+// scalar Horner loop without fused multiply-adds. Polynomials of up to
+// MAX_UNROLLED_NUM_COEFF coefficients use the kernels below.
+//
+// poly: polynomial to evaluate. Highest degree coefficient first.
+// num_coeff: number of coefficients in the polynomial
+void HornerMultiPoint(
+    const double* poly,
+    int num_coeff,
+    const double* x,
+    size_t num_points,
+    double* y,
+    HornerKernel kernel = HornerKernel::Auto);
+
+// HornerMultiPoint for a polynomial of NumCoeffs coefficients, with the
+// loop over the coefficients fully unrolled, so that each step of a point
+// is issued without the loop overhead. The results are the same as those
+// of HornerMultiPoint. Defined for NumCoeffs from 2 to
+// MAX_UNROLLED_NUM_COEFF.
+template <int NumCoeffs>
+void HornerMultiPoint(
+    const double* poly,
+    const double* x,
+    size_t num_points,
+    double* y,
+    HornerKernel kernel = HornerKernel::Auto);
+
+// Evaluates the polynomial at num_points points with the compensated Horner
+// scheme, poly(x[i]) = y_hi[i] + y_lo[i]. Every kernel gives the same
+// results as CompensatedHorner() in DoubleDouble.h, see there for the
+// error bound. Polynomials of up to MAX_UNROLLED_NUM_COEFF coefficients
+// use the unrolled kernels.
+void CompensatedHornerMultiPoint(
+    const double* poly,
+    int num_coeff,
+    const double* x,
+    size_t num_points,
+    double* y_hi,
+    double* y_lo,
+    HornerKernel kernel = HornerKernel::Auto);
+
+// CompensatedHornerMultiPoint for a polynomial of NumCoeffs coefficients,
+// unrolled as HornerMultiPoint<NumCoeffs>. The results are the same as
+// those of CompensatedHornerMultiPoint.
+template <int NumCoeffs>
+void CompensatedHornerMultiPoint(
+    const double* poly,
+    const double* x,
+    size_t num_points,
+    double* y_hi,
+    double* y_lo,
+    HornerKernel kernel = HornerKernel::Auto);
+
+// Evaluates num_polys polynomials, each at its own point, with the
+// compensated Horner scheme, poly_i(x[i]) = y_hi[i] + y_lo[i]. The
+// polynomials are in structure-of-arrays layout, so that the SIMD lanes
+// run over the polynomials: coefficient k of polynomial i is
+// poly[k * num_polys + i], highest degree first. Every kernel gives the
+// same results as CompensatedHorner() on each polynomial.
+void CompensatedHornerSoA(
+    const double* poly,
+    int num_coeff,
+    size_t num_polys,
+    const double* x,
+    double* y_hi,
+    double* y_lo,
+    HornerKernel kernel = HornerKernel::Auto);
+
+// Same as above for num_polys polynomials out of a larger set: coefficient
+// k of polynomial i is poly[k * stride + i].
+void CompensatedHornerSoA(
+    const double* poly,
+    int num_coeff,
+    size_t num_polys,
+    size_t stride,
+    const double* x,
+    double* y_hi,
+    double* y_lo,
+    HornerKernel kernel = HornerKernel::Auto);
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
@@ -0,0 +1,135 @@
+#include "RegisterBankWriter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <endian.h>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+/** RegisterBankWriter CONSTRUCTOR
+*
+* Input params:
+*       window: the mapped register window, at least RegionSize(bank_capacity, format) bytes
+*       bank_capacity: maximum number of FODMs per bank
+*       format: FODM_REGISTER_FORMAT or FODM_REGISTER_FORMAT_V1, the register version
+*/
+RegisterBankWriter::RegisterBankWriter(MappedRegisterWindow& window,
+                                       size_t bank_capacity,
+                                       const FodmRegisterFormat& format)
+    : window_(window),
+      bank_capacity_(bank_capacity),
+      format_(format),
+      staging_(bank_capacity * format.image_size),
+      num_staged_(0),
+      active_bank_(0),
+      generation_(0)
+{
+    assert (window_.is_open() && window_.size() >= RegionSize(bank_capacity_, format_));
+    WriteControl(REGISTER_BANK_NUM_FODMS, 0);
+    WriteControl(REGISTER_BANK_NUM_FODMS + 4, 0);
+    WriteControl(REGISTER_BANK_GENERATION, generation_);
+    WriteControl(REGISTER_BANK_ACTIVE_BANK, active_bank_);
+}
+
+size_t RegisterBankWriter::RegionSize(size_t bank_capacity, const FodmRegisterFormat& format)
+{
+    return REGISTER_BANK_BANKS + 2 * bank_capacity * format.image_size;
+}
+
+size_t RegisterBankWriter::Reserve(size_t num_reg_values) const
+{
+    return std::min(num_reg_values, bank_capacity_ - num_staged_);
+}
+
+size_t RegisterBankWriter::Stage(const FirstOrderDelayModelRegisterValues* reg_values, size_t num_reg_values)
+{
+    assert (format_.image_size == FODM_REGISTER_FORMAT.image_size);
+    size_t num_added = Reserve(num_reg_values);
+    EncodeFodmRegisterImage(reg_values, num_added, staging_.data() + num_staged_ * format_.image_size);
+    num_staged_ += num_added;
+    return num_added;
+}
+
+size_t RegisterBankWriter::Stage(const FirstOrderDelayModelRegisterValuesVer1* reg_values, size_t num_reg_values)
+{
+    assert (format_.image_size == FODM_REGISTER_FORMAT_V1.image_size);
+    size_t num_added = Reserve(num_reg_values);
+    EncodeFodmRegisterImageV1(reg_values, num_added, staging_.data() + num_staged_ * format_.image_size);
+    num_staged_ += num_added;
+    return num_added;
+}
+
+namespace
+{
+
+/**
+* Orders the preceding stores to the register window before the following
+* ones, as seen by the FPGA. A std::atomic_thread_fence only orders them
+* for the other CPUs (dmb ish on armv8), not for a device.
+*/
+void DeviceWriteBarrier()
+{
+#if defined(__aarch64__) || (defined(__arm__) && __ARM_ARCH >= 7)
+    asm volatile("dmb oshst" ::: "memory");
+#elif defined(__x86_64__) || defined(__i386__)
+    asm volatile("sfence" ::: "memory");
+#else
+    __sync_synchronize();
+#endif
+}
+
+}; // namespace
+
+/**
+* Copies the staging image to the inactive bank and sets its FODM count,
+* then, after a device write barrier, makes it the active bank. The FPGA
+* reads the FODM count after the active bank register, so it sees the new
+* bank complete.
+*/
+void RegisterBankWriter::Commit()
+{
+    if (num_staged_ == 0)
+    {
+        return;
+    }
+    const int bank = 1 - active_bank_;
+    WriteBank(bank_offset(bank), staging_.data(), num_staged_ * format_.image_size);
+    WriteControl(REGISTER_BANK_NUM_FODMS + 4 * bank, static_cast<uint32_t>(num_staged_));
+    WriteControl(REGISTER_BANK_GENERATION, ++generation_);
+
+    DeviceWriteBarrier();
+    WriteControl(REGISTER_BANK_ACTIVE_BANK, bank);
+    active_bank_ = bank;
+    num_staged_ = 0;
+}
+
+/**
+* A single 32 bit store, as the FPGA may act on each write of a control
+* register, so it must not be split or merged by the compiler.
+*/
+void RegisterBankWriter::WriteControl(size_t offset, uint32_t value)
+{
+    volatile uint32_t* reg = reinterpret_cast<volatile uint32_t*>(window_.at(offset));
+    *reg = htole32(value);
+}
+
+/**
+* Aligned 32 bit stores of an image already in register byte order. A
+* memcpy may use unaligned or overlapping stores for the tail, which fault
+* on the Device memory of a UIO or /dev/mem window on armv8.
+*/
+void RegisterBankWriter::WriteBank(size_t offset, const uint8_t* image, size_t size)
+{
+    assert (offset % 4 == 0 && size % 4 == 0);
+    volatile uint32_t* regs = reinterpret_cast<volatile uint32_t*>(window_.at(offset));
+    for (size_t ii = 0; ii < size / 4; ii++)
+    {
+        uint32_t word;
+        std::memcpy(&word, image + 4 * ii, 4);
+        regs[ii] = word;
+    }
+}
+
+}; // namespace ska_mid_cbf_fodm_gen
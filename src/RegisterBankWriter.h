@@ -0,0 +1,110 @@
+#ifndef REGISTER_BANK_WRITER_H
+#define REGISTER_BANK_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "CalcFodmRegisterValues.h"
+#include "FodmRegisterImage.h"
+#include "MappedRegisterWindow.h"
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// Byte offsets in a register bank region. The control registers are 32 bit
+// little-endian registers.
+
+// The bank the FPGA reads, 0 or 1
+const size_t REGISTER_BANK_ACTIVE_BANK = 0;
+// Incremented by every Commit()
+const size_t REGISTER_BANK_GENERATION = 4;
+// Number of FODMs in bank 0, followed by the number in bank 1
+const size_t REGISTER_BANK_NUM_FODMS = 8;
+// Bank 0, followed by bank 1
+const size_t REGISTER_BANK_BANKS = 64;
+
+// Writes FODM register images to two alternating banks of a register
+// window. The FPGA reads the active bank while the writer fills the other
+// one, and Commit() swaps them by writing the active bank register last,
+// after a barrier that orders the writes for the device (dmb oshst on
+// armv8, sfence on x86), so the FPGA never sees a partly written bank.
+//
+// Stage() only encodes the FODMs into a staging image in memory. Commit()
+// copies all of them to the inactive bank with aligned 32 bit stores,
+// which Device memory requires, sets its FODM count and publishes it. The
+// window is never read, so there are no read-modify-write cycles on the
+// bus.
+//
+// The region starts with the control registers above, and each bank holds
+// up to bank_capacity FODM images of the register version, see
+// FodmRegisterImage.h. One thread at a time may use a writer.
+//
+// Example:
+//   MappedRegisterWindow window;
+//   window.Open("/dev/uio0", RegisterBankWriter::RegionSize(bank_capacity));
+//   RegisterBankWriter writer(window, bank_capacity);
+//   FodmPipeline pipeline(ctx, [&](const RegisterRecord* records, size_t num_records)
+//   {
+//       for (size_t ii = 0; ii < num_records; ii++)
+//       {
+//           writer.Stage(&records[ii].reg_values, 1);
+//       }
+//       writer.Commit();
+//   });
+class RegisterBankWriter
+{
+public:
+    // The region of window must be at least RegionSize(bank_capacity, format).
+    // The window must outlive the writer. Resets the control registers to
+    // bank 0 active and empty.
+    RegisterBankWriter(MappedRegisterWindow& window,
+                       size_t bank_capacity,
+                       const FodmRegisterFormat& format = FODM_REGISTER_FORMAT);
+
+    RegisterBankWriter(const RegisterBankWriter&) = delete;
+    RegisterBankWriter& operator=(const RegisterBankWriter&) = delete;
+
+    // Size of the control registers and the two banks [bytes]
+    static size_t RegionSize(size_t bank_capacity, const FodmRegisterFormat& format = FODM_REGISTER_FORMAT);
+
+    // Offset of a bank in the region [bytes]
+    size_t bank_offset(int bank) const { return REGISTER_BANK_BANKS + bank * bank_capacity_ * format_.image_size; }
+
+    // Adds up to num_reg_values FODMs to the next bank, as many as fit.
+    // Returns the number added. The register version must match the format.
+    size_t Stage(const FirstOrderDelayModelRegisterValues* reg_values, size_t num_reg_values);
+    size_t Stage(const FirstOrderDelayModelRegisterValuesVer1* reg_values, size_t num_reg_values);
+
+    // Writes the staged FODMs to the inactive bank and makes it the active
+    // one. Does nothing if no FODM is staged.
+    void Commit();
+
+    size_t bank_capacity() const { return bank_capacity_; }
+    size_t num_staged() const { return num_staged_; }
+    int active_bank() const { return active_bank_; }
+    uint32_t generation() const { return generation_; }
+
+private:
+    // Reserves room for up to num_reg_values FODMs in the staging image,
+    // returns the number that fit
+    size_t Reserve(size_t num_reg_values) const;
+
+    // Writes a control register
+    void WriteControl(size_t offset, uint32_t value);
+
+    // Writes size bytes of a register image to the window, both multiples of 4
+    void WriteBank(size_t offset, const uint8_t* image, size_t size);
+
+    MappedRegisterWindow& window_;
+    const size_t bank_capacity_;
+    const FodmRegisterFormat format_;
+    std::vector<uint8_t> staging_;
+    size_t num_staged_;
+    int active_bank_;
+    uint32_t generation_;
+};
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
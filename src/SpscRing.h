@@ -0,0 +1,142 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// A bounded lock-free queue of trivially copyable records between one
+// producer thread and one consumer thread, see FodmPipeline.
+//
+// The producer only writes tail_ and the consumer only writes head_, each
+// with release ordering after copying the records, so neither side takes a
+// lock or allocates after construction. Each side keeps a copy of the other
+// side's index and only reloads it when the ring looks full or empty. A
+// full ring is the backpressure: TryPush() returns false, and the producer
+// decides whether to wait.
+//
+// Example:
+//   SpscRing<Record> ring(1024);
+//   // producer thread
+//   while (!ring.TryPush(record)) { std::this_thread::yield(); }
+//   // consumer thread
+//   Record records[64];
+//   size_t num_records = ring.TryPopBatch(records, 64);
+template <typename T>
+class SpscRing
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SpscRing records must be trivially copyable");
+
+public:
+    // capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity)
+        : head_(0),
+          cached_tail_(0),
+          tail_(0),
+          cached_head_(0)
+    {
+        size_t size = 1;
+        while (size < capacity)
+        {
+            size *= 2;
+        }
+        buffer_.resize(size);
+        mask_ = size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // Number of records in the ring. Exact only when called from the
+    // producer or the consumer while the other side is idle.
+    size_t size() const
+    {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    // Producer: appends item, returns false if the ring is full
+    bool TryPush(const T& item)
+    {
+        return TryPushBatch(&item, 1) == 1;
+    }
+
+    // Producer: appends up to num_items items, returns the number appended
+    size_t TryPushBatch(const T* items, size_t num_items)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail + num_items - cached_head_ > capacity())
+        {
+            cached_head_ = head_.load(std::memory_order_acquire);
+        }
+        num_items = std::min(num_items, capacity() - (tail - cached_head_));
+        CopyIn(tail, items, num_items);
+        tail_.store(tail + num_items, std::memory_order_release);
+        return num_items;
+    }
+
+    // Consumer: removes the oldest record into item, returns false if the
+    // ring is empty
+    bool TryPop(T& item)
+    {
+        return TryPopBatch(&item, 1) == 1;
+    }
+
+    // Consumer: removes up to max_items of the oldest records into items,
+    // returns the number removed
+    size_t TryPopBatch(T* items, size_t max_items)
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (cached_tail_ - head < max_items)
+        {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        }
+        const size_t num_items = std::min(max_items, cached_tail_ - head);
+        CopyOut(head, items, num_items);
+        head_.store(head + num_items, std::memory_order_release);
+        return num_items;
+    }
+
+private:
+    // The indices increase without wrapping, the slot is index & mask_
+    void CopyIn(size_t index, const T* items, size_t num_items)
+    {
+        const size_t first = std::min(num_items, capacity() - (index & mask_));
+        std::copy(items, items + first, buffer_.begin() + (index & mask_));
+        std::copy(items + first, items + num_items, buffer_.begin());
+    }
+
+    void CopyOut(size_t index, T* items, size_t num_items) const
+    {
+        const size_t first = std::min(num_items, capacity() - (index & mask_));
+        std::copy(buffer_.begin() + (index & mask_), buffer_.begin() + (index & mask_) + first, items);
+        std::copy(buffer_.begin(), buffer_.begin() + (num_items - first), items + first);
+    }
+
+    // Padding keeps the consumer and producer fields on separate cache lines
+    static const size_t CACHE_LINE_SIZE = 64;
+
+    std::vector<T> buffer_;
+    size_t mask_;
+    char pad0_[CACHE_LINE_SIZE];
+
+    // Consumer side: read index, and the last tail_ seen
+    std::atomic<size_t> head_;
+    size_t cached_tail_;
+    char pad1_[CACHE_LINE_SIZE];
+
+    // Producer side: write index, and the last head_ seen
+    std::atomic<size_t> tail_;
+    size_t cached_head_;
+    char pad2_[CACHE_LINE_SIZE];
+};
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef TAYLOR_SHIFT_H
+#define TAYLOR_SHIFT_H
+
+#include "DoubleDouble.h"
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// The coefficient c as a T, with the low part of a DoubleDouble set to 0
+template <typename T>
+inline T TaylorShiftCoeff(double c)
+{
+    return T(c);
+}
+
+template <>
+inline DoubleDouble TaylorShiftCoeff<DoubleDouble>(double c)
+{
+    return DoubleDouble{c, 0.0};
+}
+
+/**
+ * Re-centers the polynomial at x0: computes the coefficients of
+ * q(x) = p(x0 + x), i.e. the Taylor coefficients p^(k)(x0) / k!, with
+ * repeated synthetic division in O(num_coeff^2) operations of type T,
+ * e.g. long double or DoubleDouble with X = double.
+ *
+ * Input Params:
+ *   poly - polynomial to shift. Highest degree coefficient first.
+ *   num_coeff - number of coefficients in the polynomial
+ *   x0 - the new origin
+ *
+ * Output Params:
+ *   shifted - num_coeff coefficients of q. Lowest degree coefficient first,
+ *             so shifted[0] = p(x0) and shifted[1] = p'(x0).
+ */
+template <typename T, typename X>
+void TaylorShift(const double* poly, int num_coeff, const X& x0, T* shifted)
+{
+    for (int kk = 0; kk < num_coeff; kk++)
+    {
+        shifted[kk] = TaylorShiftCoeff<T>(poly[num_coeff - 1 - kk]);
+    }
+    for (int ii = 0; ii < num_coeff - 1; ii++)
+    {
+        for (int kk = num_coeff - 2; kk >= ii; kk--)
+        {
+            shifted[kk] += x0 * shifted[kk + 1];
+        }
+    }
+}
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
@@ -0,0 +1,147 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+/** ThreadPool CONSTRUCTOR
+*
+* Input params:
+*       num_threads: number of threads running the loops, including the
+*                    calling thread. 0 for std::thread::hardware_concurrency().
+*/
+ThreadPool::ThreadPool(unsigned num_threads)
+    : generation_(0),
+      stop_(false),
+      num_busy_(0),
+      fn_(nullptr),
+      num_items_(0),
+      grain_size_(1),
+      next_item_(0)
+{
+    if (num_threads == 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(num_threads - 1);
+    for (unsigned ii = 1; ii < num_threads; ii++)
+    {
+        workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+/** ThreadPool DESTRUCTOR
+*
+* Stops and joins the worker threads.
+*/
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (std::thread& worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+/**
+* Runs fn over [0, num_items) on all threads of the pool.
+*
+* Input params:
+*       num_items: number of items of the loop
+*       grain_size: maximum number of items passed to one call of fn
+*       fn: called with the first and one past the last item of a range
+*/
+void ThreadPool::ParallelFor(size_t num_items, size_t grain_size, const std::function<void(size_t, size_t)>& fn)
+{
+    grain_size = std::max<size_t>(grain_size, 1);
+    if (workers_.empty() || num_items <= grain_size)
+    {
+        for (size_t begin = 0; begin < num_items; begin += grain_size)
+        {
+            fn(begin, std::min(begin + grain_size, num_items));
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> loop_lock(loop_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fn_ = &fn;
+        num_items_ = num_items;
+        grain_size_ = grain_size;
+        next_item_.store(0);
+        num_busy_ = workers_.size();
+        error_ = nullptr;
+        generation_++;
+    }
+    start_cv_.notify_all();
+
+    RunRanges();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return num_busy_ == 0; });
+    fn_ = nullptr;
+    if (error_)
+    {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::WorkerLoop()
+{
+    uint64_t generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [&] { return stop_ || generation_ != generation; });
+            if (stop_)
+            {
+                return;
+            }
+            generation = generation_;
+        }
+
+        RunRanges();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--num_busy_ == 0)
+        {
+            done_cv_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::RunRanges()
+{
+    while (true)
+    {
+        size_t begin = next_item_.fetch_add(grain_size_);
+        if (begin >= num_items_)
+        {
+            return;
+        }
+        size_t end = std::min(begin + grain_size_, num_items_);
+        try
+        {
+            (*fn_)(begin, end);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_)
+            {
+                error_ = std::current_exception();
+            }
+        }
+    }
+}
+
+}; // namespace ska_mid_cbf_fodm_gen
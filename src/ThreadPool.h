@@ -0,0 +1,81 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ska_mid_cbf_fodm_gen
+{
+
+// A fixed set of threads running parallel loops, for the parallel
+// overloads of FirstOrderDelayModel::process, FodmBatchProcessor::process
+// and the batch CalcFodmRegisterValues.
+//
+// A loop is split into ranges of at most grain_size items, which the
+// threads claim from a shared counter, so threads that finish early take
+// more of the work. The calling thread runs ranges as well, so a pool of
+// one thread runs everything on the calling thread.
+//
+// Example:
+//   ThreadPool pool;
+//   pool.ParallelFor(num_receptors, 1, [&](size_t begin, size_t end)
+//   {
+//       for (size_t rr = begin; rr < end; rr++) { ... }
+//   });
+class ThreadPool
+{
+public:
+    // num_threads is the number of threads running the loops, including
+    // the calling thread. 0 uses std::thread::hardware_concurrency().
+    explicit ThreadPool(unsigned num_threads = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned num_threads() const { return workers_.size() + 1; }
+
+    // Calls fn(begin, end) for ranges covering [0, num_items) and returns
+    // when all of them have returned. The first exception thrown by fn is
+    // rethrown once all ranges are done. Calls from several threads run one
+    // after the other, and fn must not call ParallelFor on the same pool.
+    void ParallelFor(size_t num_items, size_t grain_size, const std::function<void(size_t, size_t)>& fn);
+
+private:
+    void WorkerLoop();
+
+    // Claims and runs ranges of the current loop until there are none left
+    void RunRanges();
+
+    std::vector<std::thread> workers_;
+
+    // Serializes ParallelFor
+    std::mutex loop_mutex_;
+
+    // Guards the fields below, except next_item_
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_;
+    bool stop_;
+    unsigned num_busy_;
+    std::exception_ptr error_;
+
+    // The current loop
+    const std::function<void(size_t, size_t)>* fn_;
+    size_t num_items_;
+    size_t grain_size_;
+    std::atomic<size_t> next_item_;
+};
+
+}; // namespace ska_mid_cbf_fodm_gen
+
+#endif
@@ -0,0 +1,196 @@
+/***
+ * bench_CalcFodmRegisterValues.cpp
+ *
+ * Benchmarks for the CalcFodmRegisterValues free functions. Each benchmark
+ * computes the register values for a set of consecutive 10 ms FODMs that
+ * share the same sample rates and frequency shifts, which is how the RDT
+ * calls the library for one receptor and frequency slice. The reported
+ * items_per_second is the number of FODMs processed per second.
+ *
+ ***/
+#include <vector>
+#include "CalcFodmRegisterValues.h"
+
+#include "benchmark/benchmark.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+const uint32_t INPUT_SAMPLE_RATE = 220029600;
+const uint32_t OUTPUT_SAMPLE_RATE = 220200960;
+const double FREQ_DOWN_SHIFT = -1386186480;
+const double FREQ_ALIGN_SHIFT = 71552;
+const double FREQ_WB_SHIFT = 0;
+const double FREQ_SCFO_SHIFT = -1079568;
+const double FODM_INTERVAL_MS = 10.0;
+
+// Generates num_fo_poly consecutive FODMs starting from a whole second
+std::vector<FoPoly> make_fo_polys(int num_fo_poly)
+{
+    std::vector<FoPoly> fo_polys(num_fo_poly);
+    const double ho_start_time_ms = 950040000000.0;
+    for (int ii = 0; ii < num_fo_poly; ii++)
+    {
+        fo_polys[ii].ho_poly_start_time_ms = ho_start_time_ms;
+        fo_polys[ii].start_time_ms = ho_start_time_ms + ii * FODM_INTERVAL_MS;
+        fo_polys[ii].stop_time_ms = fo_polys[ii].start_time_ms + FODM_INTERVAL_MS;
+        fo_polys[ii].poly[0] = -0.158;
+        fo_polys[ii].poly[1] = -19036.792 + fo_polys[ii].poly[0] * ii * FODM_INTERVAL_MS / 1000.0;
+    }
+    return fo_polys;
+}
+
+}
+
+// Calls the single FODM function once per FODM
+static void BM_CalcFodmRegisterValuesLoop(benchmark::State& state)
+{
+    std::vector<FoPoly> fo_polys = make_fo_polys(state.range(0));
+    std::vector<FirstOrderDelayModelRegisterValues> reg_values(fo_polys.size());
+    for (auto _ : state)
+    {
+        for (size_t ii = 0; ii < fo_polys.size(); ii++)
+        {
+            reg_values[ii] = CalcFodmRegisterValues(fo_polys[ii], INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+                FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT);
+        }
+        benchmark::DoNotOptimize(reg_values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * fo_polys.size());
+}
+BENCHMARK(BM_CalcFodmRegisterValuesLoop)->Arg(1)->Arg(100)->Arg(1000);
+
+// Calls the batch function once for all FODMs
+static void BM_CalcFodmRegisterValuesBatch(benchmark::State& state)
+{
+    std::vector<FoPoly> fo_polys = make_fo_polys(state.range(0));
+    std::vector<FirstOrderDelayModelRegisterValues> reg_values(fo_polys.size());
+    for (auto _ : state)
+    {
+        CalcFodmRegisterValues(fo_polys.data(), fo_polys.size(), INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+            FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT, reg_values.data());
+        benchmark::DoNotOptimize(reg_values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * fo_polys.size());
+}
+BENCHMARK(BM_CalcFodmRegisterValuesBatch)->Arg(1)->Arg(100)->Arg(1000);
+
+// Version 1 register, single FODM function once per FODM
+static void BM_CalcFodmRegisterValuesV1Loop(benchmark::State& state)
+{
+    std::vector<FoPoly> fo_polys = make_fo_polys(state.range(0));
+    std::vector<FirstOrderDelayModelRegisterValuesVer1> reg_values(fo_polys.size());
+    for (auto _ : state)
+    {
+        for (size_t ii = 0; ii < fo_polys.size(); ii++)
+        {
+            reg_values[ii] = CalcFodmRegisterValuesV1(fo_polys[ii], INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+                FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT);
+        }
+        benchmark::DoNotOptimize(reg_values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * fo_polys.size());
+}
+BENCHMARK(BM_CalcFodmRegisterValuesV1Loop)->Arg(1)->Arg(100)->Arg(1000);
+
+// Version 1 register, batch function once for all FODMs
+static void BM_CalcFodmRegisterValuesV1Batch(benchmark::State& state)
+{
+    std::vector<FoPoly> fo_polys = make_fo_polys(state.range(0));
+    std::vector<FirstOrderDelayModelRegisterValuesVer1> reg_values(fo_polys.size());
+    for (auto _ : state)
+    {
+        CalcFodmRegisterValuesV1(fo_polys.data(), fo_polys.size(), INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+            FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT, reg_values.data());
+        benchmark::DoNotOptimize(reg_values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * fo_polys.size());
+}
+BENCHMARK(BM_CalcFodmRegisterValuesV1Batch)->Arg(1)->Arg(100)->Arg(1000);
+
+// Batch function with the multi-precision, fixed point, quad precision or
+// double-double engine
+static void BM_CalcFodmRegisterValuesEngine(benchmark::State& state)
+{
+    std::vector<FoPoly> fo_polys = make_fo_polys(state.range(0));
+    FodmCalcEngine engine = static_cast<FodmCalcEngine>(state.range(1));
+    std::vector<FirstOrderDelayModelRegisterValues> reg_values(fo_polys.size());
+    for (auto _ : state)
+    {
+        CalcFodmRegisterValues(fo_polys.data(), fo_polys.size(), INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+            FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT, reg_values.data(), engine);
+        benchmark::DoNotOptimize(reg_values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * fo_polys.size());
+}
+BENCHMARK(BM_CalcFodmRegisterValuesEngine)
+    ->ArgNames({"fodms", "engine"})
+    ->Args({1000, static_cast<int>(FodmCalcEngine::MultiPrecision)})
+    ->Args({1000, static_cast<int>(FodmCalcEngine::FixedPoint)})
+    ->Args({1000, static_cast<int>(FodmCalcEngine::Float128)})
+    ->Args({1000, static_cast<int>(FodmCalcEngine::DoubleDouble)});
+
+// Single FODM function with the per channel values precomputed in a
+// RdtChannelContext, for each engine
+static void BM_CalcFodmRegisterValuesContext(benchmark::State& state)
+{
+    std::vector<FoPoly> fo_polys = make_fo_polys(state.range(0));
+    const RdtChannelContext ctx(INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+        FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT,
+        static_cast<FodmCalcEngine>(state.range(1)));
+    std::vector<FirstOrderDelayModelRegisterValues> reg_values(fo_polys.size());
+    for (auto _ : state)
+    {
+        for (size_t ii = 0; ii < fo_polys.size(); ii++)
+        {
+            reg_values[ii] = CalcFodmRegisterValues(ctx, fo_polys[ii]);
+        }
+        benchmark::DoNotOptimize(reg_values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * fo_polys.size());
+}
+BENCHMARK(BM_CalcFodmRegisterValuesContext)
+    ->ArgNames({"fodms", "engine"})
+    ->Args({1000, static_cast<int>(FodmCalcEngine::MultiPrecision)})
+    ->Args({1000, static_cast<int>(FodmCalcEngine::FixedPoint)})
+    ->Args({1000, static_cast<int>(FodmCalcEngine::Float128)})
+    ->Args({1000, static_cast<int>(FodmCalcEngine::DoubleDouble)});
+
+// Both register versions of each FODM, with the batch function of each
+// version (versions 0) or with CalcFodmRegisterVersions (versions 1), for
+// each engine
+static void BM_CalcFodmRegisterVersions(benchmark::State& state)
+{
+    std::vector<FoPoly> fo_polys = make_fo_polys(state.range(0));
+    const RdtChannelContext ctx(INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+        FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT,
+        static_cast<FodmCalcEngine>(state.range(1)));
+    std::vector<FirstOrderDelayModelRegisterValues> reg_values(fo_polys.size());
+    std::vector<FirstOrderDelayModelRegisterValuesVer1> reg_values_v1(fo_polys.size());
+    std::vector<FodmRegisterVersionValues> versions(fo_polys.size());
+    for (auto _ : state)
+    {
+        if (state.range(2))
+        {
+            CalcFodmRegisterVersions(ctx, fo_polys.data(), fo_polys.size(), FODM_REGISTER_V1 | FODM_REGISTER_V2,
+                versions.data());
+            benchmark::DoNotOptimize(versions.data());
+        }
+        else
+        {
+            CalcFodmRegisterValues(ctx, fo_polys.data(), fo_polys.size(), reg_values.data());
+            CalcFodmRegisterValuesV1(ctx, fo_polys.data(), fo_polys.size(), reg_values_v1.data());
+            benchmark::DoNotOptimize(reg_values.data());
+            benchmark::DoNotOptimize(reg_values_v1.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * fo_polys.size());
+}
+BENCHMARK(BM_CalcFodmRegisterVersions)
+    ->ArgNames({"fodms", "engine", "versions"})
+    ->ArgsProduct({{1000},
+        {static_cast<int>(FodmCalcEngine::MultiPrecision), static_cast<int>(FodmCalcEngine::FixedPoint),
+         static_cast<int>(FodmCalcEngine::Float128), static_cast<int>(FodmCalcEngine::DoubleDouble)},
+        {0, 1}});
@@ -0,0 +1,137 @@
+/***
+ * bench_DelayModelStore.cpp
+ *
+ * Benchmarks for the DelayModelStore lookups and publishing. The store
+ * holds entries of 1000 FODMs of 10 ms for each receptor. The reported
+ * items_per_second is the number of lookups or entries published per
+ * second.
+ *
+ ***/
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "DelayModelStore.h"
+
+#include "benchmark/benchmark.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+const int NUM_RECEPTORS = 200;
+const int NUM_FO_POLY = 1000;
+const double INTERVAL_MS = 10.0;
+const double ENTRY_LENGTH_MS = NUM_FO_POLY * INTERVAL_MS;
+
+DelayModelEntry make_entry(double start_time_ms)
+{
+    DelayModelEntry entry;
+    entry.ho_start_time_ms = start_time_ms;
+    entry.ho_stop_time_ms = start_time_ms + ENTRY_LENGTH_MS;
+    entry.ho_poly.assign(6, 1.0);
+    entry.fo_polys.resize(NUM_FO_POLY);
+    for (int ii = 0; ii < NUM_FO_POLY; ii++)
+    {
+        entry.fo_polys[ii].ho_poly_start_time_ms = start_time_ms;
+        entry.fo_polys[ii].start_time_ms = start_time_ms + ii * INTERVAL_MS;
+        entry.fo_polys[ii].stop_time_ms = start_time_ms + (ii + 1) * INTERVAL_MS;
+        entry.fo_polys[ii].poly[0] = 0.0;
+        entry.fo_polys[ii].poly[1] = ii;
+    }
+    return entry;
+}
+
+}
+
+// FindFodm of each receptor in turn, the argument is the number of entries
+// per receptor
+static void BM_DelayModelStoreFindFodm(benchmark::State& state)
+{
+    const int num_entries = state.range(0);
+    DelayModelStore store(NUM_RECEPTORS);
+    for (int ee = 0; ee < num_entries; ee++)
+    {
+        for (int rr = 0; rr < NUM_RECEPTORS; rr++)
+        {
+            store.Publish(rr, make_entry(ee * ENTRY_LENGTH_MS));
+        }
+    }
+    DelayModelStore::Reader reader(store);
+    FoPoly fo_poly;
+    int64_t count = 0;
+    for (auto _ : state)
+    {
+        int rr = count % NUM_RECEPTORS;
+        double time_ms = (count * 7919 % (num_entries * NUM_FO_POLY)) * INTERVAL_MS + 1.0;
+        benchmark::DoNotOptimize(reader.FindFodm(rr, time_ms, fo_poly));
+        count++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DelayModelStoreFindFodm)->Arg(1)->Arg(10)->Arg(100);
+
+// FindFodm while another thread keeps publishing entries of the receptors
+static void BM_DelayModelStoreFindFodmWhilePublishing(benchmark::State& state)
+{
+    DelayModelStore store(NUM_RECEPTORS);
+    std::vector<DelayModelEntry> entries(2);
+    for (int ee = 0; ee < 2; ee++)
+    {
+        entries[ee] = make_entry(ee * ENTRY_LENGTH_MS);
+        for (int rr = 0; rr < NUM_RECEPTORS; rr++)
+        {
+            store.Publish(rr, entries[ee]);
+        }
+    }
+    std::atomic<bool> done(false);
+    std::thread writer([&]()
+    {
+        for (int rr = 0; !done; rr = (rr + 1) % NUM_RECEPTORS)
+        {
+            store.Publish(rr, entries[1]);
+        }
+    });
+
+    DelayModelStore::Reader reader(store);
+    FoPoly fo_poly;
+    int64_t count = 0;
+    for (auto _ : state)
+    {
+        int rr = count % NUM_RECEPTORS;
+        double time_ms = (count * 7919 % (2 * NUM_FO_POLY)) * INTERVAL_MS + 1.0;
+        benchmark::DoNotOptimize(reader.FindFodm(rr, time_ms, fo_poly));
+        count++;
+    }
+    done = true;
+    writer.join();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DelayModelStoreFindFodmWhilePublishing);
+
+// Publish a new entry of each receptor in turn and remove the old ones
+static void BM_DelayModelStorePublish(benchmark::State& state)
+{
+    DelayModelStore store(NUM_RECEPTORS);
+    DelayModelEntry entry = make_entry(0.0);
+    int64_t count = 0;
+    for (auto _ : state)
+    {
+        int rr = count % NUM_RECEPTORS;
+        int ee = count / NUM_RECEPTORS;
+        DelayModelEntry copy = entry;
+        for (FoPoly& fo_poly : copy.fo_polys)
+        {
+            fo_poly.start_time_ms += ee * ENTRY_LENGTH_MS;
+            fo_poly.stop_time_ms += ee * ENTRY_LENGTH_MS;
+        }
+        store.Publish(rr, std::move(copy));
+        if (rr == NUM_RECEPTORS - 1)
+        {
+            store.RemoveBefore(ee * ENTRY_LENGTH_MS);
+        }
+        count++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DelayModelStorePublish);
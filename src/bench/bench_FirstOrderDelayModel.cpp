@@ -0,0 +1,130 @@
+/***
+ * bench_FirstOrderDelayModel.cpp
+ *
+ * Benchmarks for FirstOrderDelayModel::process with the different HODM
+ * evaluation precisions. Each benchmark derives the 10 ms FODMs of a 10 s
+ * HODM, which is what the RDT does for one receptor on every HODM update.
+ * The reported items_per_second is the number of HODMs processed per second.
+ *
+ ***/
+#include <vector>
+#include "FirstOrderDelayModel.h"
+#include "FodmWorkspace.h"
+
+#include "benchmark/benchmark.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+const int NUM_HO_COEFF = 6;
+const double HO_POLY[NUM_HO_COEFF] = {
+    3.956738275640760941E-14, -1.885738529952905433E-12, -9.731305625195973794E-09,
+    6.899681529986780764E-04, 1.100300531941965509E+01, -259508.7983 };
+const double HO_T_START = 10.0;
+const double HO_T_STOP = 20.0;
+const int NUM_FO_POLY = 1000;
+const int NUM_LSQ_POINTS = 10;
+
+std::vector<double> make_fo_t_start()
+{
+    std::vector<double> fo_t_start(NUM_FO_POLY + 1);
+    for (int ii = 0; ii < NUM_FO_POLY + 1; ii++)
+    {
+        fo_t_start[ii] = HO_T_START + ii * 0.01;
+    }
+    return fo_t_start;
+}
+
+}
+
+// Two points per FODM, the argument is the PolyvalPrecision
+static void BM_FirstOrderDelayModelProcess(benchmark::State& state)
+{
+    FirstOrderDelayModel model(static_cast<PolyvalPrecision>(state.range(0)));
+    std::vector<double> fo_t_start = make_fo_t_start();
+    std::vector<long double> fo_poly;
+    for (auto _ : state)
+    {
+        model.process(HO_T_START, HO_T_STOP, NUM_HO_COEFF, HO_POLY, NUM_FO_POLY, fo_t_start, fo_poly);
+        benchmark::DoNotOptimize(fo_poly.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FirstOrderDelayModelProcess)
+    ->ArgName("precision")
+    ->Arg(static_cast<int>(PolyvalPrecision::MultiPrecision))
+    ->Arg(static_cast<int>(PolyvalPrecision::DoubleDouble))
+    ->Arg(static_cast<int>(PolyvalPrecision::TaylorShift));
+
+// Least squares fitting, the arguments are the PolyvalPrecision and the LsqFitMethod
+static void BM_FirstOrderDelayModelProcessLsq(benchmark::State& state)
+{
+    FirstOrderDelayModel model(static_cast<PolyvalPrecision>(state.range(0)), static_cast<LsqFitMethod>(state.range(1)));
+    std::vector<double> fo_t_start = make_fo_t_start();
+    std::vector<long double> fo_poly;
+    for (auto _ : state)
+    {
+        model.process(HO_T_START, HO_T_STOP, NUM_HO_COEFF, HO_POLY, NUM_LSQ_POINTS, NUM_FO_POLY, fo_t_start, fo_poly);
+        benchmark::DoNotOptimize(fo_poly.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FirstOrderDelayModelProcessLsq)
+    ->ArgNames({"precision", "fit"})
+    ->Args({static_cast<int>(PolyvalPrecision::Default), static_cast<int>(LsqFitMethod::Sampled)})
+    ->Args({static_cast<int>(PolyvalPrecision::MultiPrecision), static_cast<int>(LsqFitMethod::Sampled)})
+    ->Args({static_cast<int>(PolyvalPrecision::DoubleDouble), static_cast<int>(LsqFitMethod::Sampled)})
+    ->Args({static_cast<int>(PolyvalPrecision::TaylorShift), static_cast<int>(LsqFitMethod::Sampled)})
+    ->Args({static_cast<int>(PolyvalPrecision::Default), static_cast<int>(LsqFitMethod::ClosedForm)})
+    ->Args({static_cast<int>(PolyvalPrecision::Default), static_cast<int>(LsqFitMethod::Continuous)})
+    ->Args({static_cast<int>(PolyvalPrecision::Default), static_cast<int>(LsqFitMethod::Minimax)});
+
+// Least squares fitting on caller-owned buffers with a reused workspace,
+// which does not allocate, the arguments are as above
+static void BM_FirstOrderDelayModelProcessLsqWorkspace(benchmark::State& state)
+{
+    FirstOrderDelayModel model(static_cast<PolyvalPrecision>(state.range(0)), static_cast<LsqFitMethod>(state.range(1)));
+    std::vector<double> fo_t_start = make_fo_t_start();
+    std::vector<long double> fo_poly(NUM_FO_POLY * 2);
+    FodmWorkspace workspace;
+    for (auto _ : state)
+    {
+        workspace.Reset();
+        model.process(HO_T_START, HO_T_STOP, NUM_HO_COEFF, HO_POLY, NUM_LSQ_POINTS, NUM_FO_POLY,
+            fo_t_start.data(), fo_poly.data(), nullptr, workspace);
+        benchmark::DoNotOptimize(fo_poly.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FirstOrderDelayModelProcessLsqWorkspace)
+    ->ArgNames({"precision", "fit"})
+    ->Args({static_cast<int>(PolyvalPrecision::Default), static_cast<int>(LsqFitMethod::Sampled)})
+    ->Args({static_cast<int>(PolyvalPrecision::DoubleDouble), static_cast<int>(LsqFitMethod::Sampled)})
+    ->Args({static_cast<int>(PolyvalPrecision::Default), static_cast<int>(LsqFitMethod::ClosedForm)});
+
+// Adaptive segmentation of the HODM with the minimax fit, for the maximum
+// error in the argument [as, 1e-9 ns], with FODMs from 10 ms to 1 s. The number of
+// FODMs is reported as a counter.
+static void BM_FirstOrderDelayModelProcessAdaptive(benchmark::State& state)
+{
+    FirstOrderDelayModel model(PolyvalPrecision::Default, LsqFitMethod::Minimax);
+    double max_error = state.range(0) * 1.0e-9;
+    std::vector<double> fo_t_start;
+    std::vector<long double> fo_poly;
+    std::vector<long double> fo_max_error;
+    for (auto _ : state)
+    {
+        model.process_adaptive(HO_T_START, HO_T_STOP, NUM_HO_COEFF, HO_POLY, NUM_LSQ_POINTS,
+            HO_T_START, HO_T_STOP, max_error, 0.01, 1.0, fo_t_start, fo_poly, fo_max_error);
+        benchmark::DoNotOptimize(fo_poly.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["num_fodms"] = fo_t_start.size() - 1;
+}
+BENCHMARK(BM_FirstOrderDelayModelProcessAdaptive)
+    ->ArgName("max_error_as")
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000);
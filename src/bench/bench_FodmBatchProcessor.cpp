@@ -0,0 +1,104 @@
+/***
+ * bench_FodmBatchProcessor.cpp
+ *
+ * Benchmarks for FodmBatchProcessor against FirstOrderDelayModel::process
+ * run on each receptor, with the same results. Each benchmark derives the
+ * 1000 FODMs of 10 ms of 200 receptors from their 10 s HODMs. The reported
+ * items_per_second is the number of receptor HODMs processed per second.
+ *
+ ***/
+#include <vector>
+#include "FirstOrderDelayModel.h"
+#include "FodmBatchProcessor.h"
+
+#include "benchmark/benchmark.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+const int NUM_RECEPTORS = 200;
+const int NUM_HO_COEFF = 6;
+const double HO_POLY[NUM_HO_COEFF] = {
+    3.956738275640760941E-14, -1.885738529952905433E-12, -9.731305625195973794E-09,
+    6.899681529986780764E-04, 1.100300531941965509E+01, -259508.7983 };
+const double HO_T_START = 10.0;
+const double HO_T_STOP = 20.0;
+const int NUM_FO_POLY = 1000;
+
+// The same HODM for every receptor, scaled a little so that they differ
+HodmBatch make_hodm_batch()
+{
+    HodmBatch hodms;
+    hodms.num_receptors = NUM_RECEPTORS;
+    hodms.num_ho_coeff = NUM_HO_COEFF;
+    hodms.coeff.resize(NUM_HO_COEFF * NUM_RECEPTORS);
+    hodms.t_start.assign(NUM_RECEPTORS, HO_T_START);
+    hodms.t_stop.assign(NUM_RECEPTORS, HO_T_STOP);
+    for (int rr = 0; rr < NUM_RECEPTORS; rr++)
+    {
+        for (int kk = 0; kk < NUM_HO_COEFF; kk++)
+        {
+            hodms.coeff[kk * NUM_RECEPTORS + rr] = HO_POLY[kk] * (1.0 + rr * 1.0e-3);
+        }
+    }
+    return hodms;
+}
+
+std::vector<double> make_fo_t_start()
+{
+    std::vector<double> fo_t_start(NUM_FO_POLY + 1);
+    for (int ii = 0; ii < NUM_FO_POLY + 1; ii++)
+    {
+        fo_t_start[ii] = HO_T_START + ii * 0.01;
+    }
+    return fo_t_start;
+}
+
+}
+
+// All receptors in one pass, the argument is the HornerKernel
+static void BM_FodmBatchProcessor(benchmark::State& state)
+{
+    HodmBatch hodms = make_hodm_batch();
+    std::vector<double> fo_t_start = make_fo_t_start();
+    FodmBatchProcessor processor(NUM_RECEPTORS, static_cast<HornerKernel>(state.range(0)));
+    FodmBatch fodms;
+    for (auto _ : state)
+    {
+        processor.process(hodms, NUM_FO_POLY, fo_t_start, fodms);
+        benchmark::DoNotOptimize(fodms.delay_const.data());
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_RECEPTORS);
+}
+BENCHMARK(BM_FodmBatchProcessor)
+    ->ArgName("kernel")
+    ->Arg(static_cast<int>(HornerKernel::Scalar))
+    ->Arg(static_cast<int>(HornerKernel::Avx2))
+    ->Arg(static_cast<int>(HornerKernel::Avx512));
+
+// One FirstOrderDelayModel::process call per receptor
+static void BM_FodmBatchPerReceptor(benchmark::State& state)
+{
+    HodmBatch hodms = make_hodm_batch();
+    std::vector<double> fo_t_start = make_fo_t_start();
+    FirstOrderDelayModel model(PolyvalPrecision::DoubleDouble);
+    std::vector<double> ho_poly(NUM_HO_COEFF);
+    std::vector<long double> fo_poly;
+    for (auto _ : state)
+    {
+        for (int rr = 0; rr < NUM_RECEPTORS; rr++)
+        {
+            for (int kk = 0; kk < NUM_HO_COEFF; kk++)
+            {
+                ho_poly[kk] = hodms.coeff[kk * NUM_RECEPTORS + rr];
+            }
+            model.process(hodms.t_start[rr], hodms.t_stop[rr], NUM_HO_COEFF, ho_poly.data(),
+                NUM_FO_POLY, fo_t_start, fo_poly);
+            benchmark::DoNotOptimize(fo_poly.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_RECEPTORS);
+}
+BENCHMARK(BM_FodmBatchPerReceptor);
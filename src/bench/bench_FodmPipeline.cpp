@@ -0,0 +1,132 @@
+/***
+ * bench_FodmPipeline.cpp
+ *
+ * Benchmarks for FodmPipeline against running the same stages one after
+ * the other on one thread. Each benchmark derives the 1000 FODMs of 10 ms
+ * of the 10 s HODMs of 16 receptors and calculates their register values.
+ * The reported items_per_second is the number of FODMs written per second,
+ * against the wall clock time.
+ *
+ ***/
+#include <vector>
+#include "FodmPipeline.h"
+
+#include "benchmark/benchmark.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+const uint32_t INPUT_SAMPLE_RATE = 220029600;
+const uint32_t OUTPUT_SAMPLE_RATE = 220200960;
+const double FREQ_DOWN_SHIFT = -1386186480;
+const double FREQ_ALIGN_SHIFT = 71552;
+const double FREQ_WB_SHIFT = 0;
+const double FREQ_SCFO_SHIFT = -1079568;
+
+const int NUM_RECEPTORS = 16;
+const int NUM_HO_COEFF = 6;
+const double HO_POLY[NUM_HO_COEFF] = {
+    3.956738275640760941E-14, -1.885738529952905433E-12, -9.731305625195973794E-09,
+    6.899681529986780764E-04, 1.100300531941965509E+01, -259508.7983 };
+const double HO_START_TIME_MS = 950040000000.0;
+const int NUM_FO_POLY = 1000;
+
+std::vector<HodmRecord> make_hodms()
+{
+    std::vector<HodmRecord> hodms(NUM_RECEPTORS);
+    for (int rr = 0; rr < NUM_RECEPTORS; rr++)
+    {
+        HodmRecord& hodm = hodms[rr];
+        hodm.receptor = rr;
+        hodm.ho_start_time_ms = HO_START_TIME_MS;
+        hodm.ho_stop_time_ms = HO_START_TIME_MS + NUM_FO_POLY * 10.0;
+        hodm.num_ho_coeff = NUM_HO_COEFF;
+        for (int kk = 0; kk < NUM_HO_COEFF; kk++)
+        {
+            hodm.ho_poly[kk] = HO_POLY[kk] * (1.0 + rr * 1.0e-3);
+        }
+        hodm.fo_start_time_ms = HO_START_TIME_MS;
+        hodm.fo_interval_ms = 10.0;
+        hodm.num_fo_poly = NUM_FO_POLY;
+    }
+    return hodms;
+}
+
+RdtChannelContext make_context()
+{
+    return RdtChannelContext(INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+        FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT, FodmCalcEngine::FixedPoint);
+}
+
+}
+
+// The HODMs of all receptors through one pipeline, including starting and
+// stopping its threads
+static void BM_FodmPipeline(benchmark::State& state)
+{
+    std::vector<HodmRecord> hodms = make_hodms();
+    const RdtChannelContext ctx = make_context();
+    const FirstOrderDelayModel model(PolyvalPrecision::DoubleDouble);
+    uint64_t checksum = 0;
+    for (auto _ : state)
+    {
+        FodmPipeline pipeline(ctx, [&](const RegisterRecord* records, size_t num_records)
+        {
+            for (size_t ii = 0; ii < num_records; ii++)
+            {
+                checksum += records[ii].reg_values.delay_constant;
+            }
+        }, model);
+        for (const HodmRecord& hodm : hodms)
+        {
+            pipeline.Push(hodm);
+        }
+        pipeline.Close();
+    }
+    benchmark::DoNotOptimize(checksum);
+    state.SetItemsProcessed(state.iterations() * NUM_RECEPTORS * NUM_FO_POLY);
+}
+BENCHMARK(BM_FodmPipeline)->UseRealTime();
+
+// The same stages one after the other, one HODM at a time
+static void BM_FodmPipelineSequential(benchmark::State& state)
+{
+    std::vector<HodmRecord> hodms = make_hodms();
+    const RdtChannelContext ctx = make_context();
+    const FirstOrderDelayModel model(PolyvalPrecision::DoubleDouble);
+    std::vector<double> fo_t_start(NUM_FO_POLY + 1);
+    std::vector<long double> fo_poly;
+    std::vector<FoPoly> fo_polys(NUM_FO_POLY);
+    std::vector<FirstOrderDelayModelRegisterValues> reg_values(NUM_FO_POLY);
+    uint64_t checksum = 0;
+    for (auto _ : state)
+    {
+        for (const HodmRecord& hodm : hodms)
+        {
+            for (int ii = 0; ii <= NUM_FO_POLY; ii++)
+            {
+                fo_t_start[ii] = ii * hodm.fo_interval_ms / 1000.0;
+            }
+            model.process(0.0, (hodm.ho_stop_time_ms - hodm.ho_start_time_ms) / 1000.0, hodm.num_ho_coeff,
+                hodm.ho_poly, NUM_FO_POLY, fo_t_start, fo_poly);
+            for (int ii = 0; ii < NUM_FO_POLY; ii++)
+            {
+                fo_polys[ii].ho_poly_start_time_ms = hodm.ho_start_time_ms;
+                fo_polys[ii].start_time_ms = hodm.fo_start_time_ms + ii * hodm.fo_interval_ms;
+                fo_polys[ii].stop_time_ms = hodm.fo_start_time_ms + (ii + 1) * hodm.fo_interval_ms;
+                fo_polys[ii].poly[0] = fo_poly[ii * 2];
+                fo_polys[ii].poly[1] = fo_poly[ii * 2 + 1];
+            }
+            CalcFodmRegisterValues(ctx, fo_polys.data(), NUM_FO_POLY, reg_values.data());
+            for (int ii = 0; ii < NUM_FO_POLY; ii++)
+            {
+                checksum += reg_values[ii].delay_constant;
+            }
+        }
+    }
+    benchmark::DoNotOptimize(checksum);
+    state.SetItemsProcessed(state.iterations() * NUM_RECEPTORS * NUM_FO_POLY);
+}
+BENCHMARK(BM_FodmPipelineSequential)->UseRealTime();
@@ -0,0 +1,102 @@
+/***
+ * bench_LookaheadScheduler.cpp
+ *
+ * Benchmarks for getting the register values of the FODM due next: a
+ * lookup of the values LookaheadScheduler calculated ahead, against
+ * calculating them on the spot. The reported items_per_second is the number
+ * of FODMs per second.
+ *
+ ***/
+#include <vector>
+#include "LookaheadScheduler.h"
+
+#include "benchmark/benchmark.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+const uint32_t INPUT_SAMPLE_RATE = 220029600;
+const uint32_t OUTPUT_SAMPLE_RATE = 220200960;
+const double FREQ_DOWN_SHIFT = -1386186480;
+const double FREQ_ALIGN_SHIFT = 71552;
+const double FREQ_WB_SHIFT = 0;
+const double FREQ_SCFO_SHIFT = -1079568;
+
+const int NUM_RECEPTORS = 16;
+const int NUM_FO_POLY = 1000;
+const size_t LOOKAHEAD = 100;
+const double START_TIME_MS = 950040000000.0;
+const double INTERVAL_MS = 10.0;
+
+DelayModelEntry make_entry()
+{
+    DelayModelEntry entry;
+    entry.ho_start_time_ms = START_TIME_MS;
+    entry.ho_stop_time_ms = START_TIME_MS + NUM_FO_POLY * INTERVAL_MS;
+    entry.fo_polys.resize(NUM_FO_POLY);
+    for (int ii = 0; ii < NUM_FO_POLY; ii++)
+    {
+        FoPoly& fo_poly = entry.fo_polys[ii];
+        fo_poly.ho_poly_start_time_ms = START_TIME_MS;
+        fo_poly.start_time_ms = START_TIME_MS + ii * INTERVAL_MS;
+        fo_poly.stop_time_ms = START_TIME_MS + (ii + 1) * INTERVAL_MS;
+        fo_poly.poly[0] = -0.158;
+        fo_poly.poly[1] = -19036.792 + fo_poly.poly[0] * ii * INTERVAL_MS / 1000.0;
+    }
+    return entry;
+}
+
+RdtChannelContext make_context()
+{
+    return RdtChannelContext(INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+        FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT);
+}
+
+}
+
+// The register values of the FODMs in the windows, calculated ahead
+static void BM_LookaheadSchedulerLookup(benchmark::State& state)
+{
+    LookaheadScheduler scheduler(make_context(), NUM_RECEPTORS, LOOKAHEAD);
+    for (int rr = 0; rr < NUM_RECEPTORS; rr++)
+    {
+        scheduler.Publish(rr, make_entry());
+    }
+    scheduler.Advance(START_TIME_MS);
+    scheduler.WaitIdle();
+
+    FirstOrderDelayModelRegisterValues reg_values;
+    int64_t count = 0;
+    for (auto _ : state)
+    {
+        int rr = count % NUM_RECEPTORS;
+        double time_ms = START_TIME_MS + (count / NUM_RECEPTORS % LOOKAHEAD) * INTERVAL_MS;
+        benchmark::DoNotOptimize(scheduler.Lookup(rr, time_ms, reg_values));
+        count++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LookaheadSchedulerLookup);
+
+// The same register values calculated when they are needed, the argument
+// is the FodmCalcEngine
+static void BM_LookaheadSchedulerOnDemand(benchmark::State& state)
+{
+    const RdtChannelContext ctx(INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+        FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT,
+        static_cast<FodmCalcEngine>(state.range(0)));
+    DelayModelEntry entry = make_entry();
+    int64_t count = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(CalcFodmRegisterValues(ctx, entry.fo_polys[count / NUM_RECEPTORS % LOOKAHEAD]));
+        count++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LookaheadSchedulerOnDemand)
+    ->ArgName("engine")
+    ->Arg(static_cast<int>(FodmCalcEngine::MultiPrecision))
+    ->Arg(static_cast<int>(FodmCalcEngine::FixedPoint));
@@ -0,0 +1,163 @@
+/***
+ * bench_MultiPointHorner.cpp
+ *
+ * Benchmarks for the multi-point Horner kernels, comparing the scalar loop
+ * with the SIMD kernels for a 5th order HODM. The points are the FODM
+ * boundaries of a 1000 FODM grid (2 per FODM, as evaluated by the two
+ * point FirstOrderDelayModel::process) or its least squares fitting points
+ * (11 per FODM). The reported items_per_second is the number of points
+ * evaluated per second. The scalar kernels unrolled for the number of
+ * coefficients are compared with the loop over the coefficients they
+ * replace, for the HODM degrees 1 to 8.
+ *
+ ***/
+#include <vector>
+#include "MultiPointHorner.h"
+
+#include "benchmark/benchmark.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+const int NUM_HO_COEFF = 6;
+const double HO_POLY[NUM_HO_COEFF] = {
+    3.956738275640760941E-14, -1.885738529952905433E-12, -9.731305625195973794E-09,
+    6.899681529986780764E-04, 1.100300531941965509E+01, -259508.7983 };
+const int NUM_FO_POLY = 1000;
+
+// num_points points spread over the 10 s of the HODM
+std::vector<double> make_points(int num_points)
+{
+    std::vector<double> x(num_points);
+    for (int ii = 0; ii < num_points; ii++)
+    {
+        x[ii] = 10.0 * ii / num_points;
+    }
+    return x;
+}
+
+// The scalar Horner loop over a number of coefficients only known at run
+// time, as HornerMultiPoint runs it for more than MAX_UNROLLED_NUM_COEFF
+// coefficients
+void horner_loop(const double* poly, int num_coeff, const double* x, size_t num_points, double* y)
+{
+    for (size_t ii = 0; ii < num_points; ii++)
+    {
+        double y_i = poly[0];
+        for (int kk = 1; kk < num_coeff; kk++)
+        {
+            y_i = y_i * x[ii] + poly[kk];
+        }
+        y[ii] = y_i;
+    }
+}
+
+// A polynomial of num_coeff coefficients from those of HO_POLY
+std::vector<double> make_poly(int num_coeff)
+{
+    std::vector<double> poly(num_coeff);
+    for (int ii = 0; ii < num_coeff; ii++)
+    {
+        poly[ii] = HO_POLY[(ii + NUM_HO_COEFF - num_coeff % NUM_HO_COEFF) % NUM_HO_COEFF];
+    }
+    return poly;
+}
+
+void set_kernel_label(benchmark::State& state, HornerKernel kernel)
+{
+    const char* names[] = { "auto", "scalar", "avx2", "avx512", "neon" };
+    state.SetLabel(names[static_cast<int>(ResolveHornerKernel(kernel))]);
+}
+
+}
+
+// Horner's method in double, the arguments are the number of points and the HornerKernel
+static void BM_HornerMultiPoint(benchmark::State& state)
+{
+    std::vector<double> x = make_points(state.range(0));
+    HornerKernel kernel = static_cast<HornerKernel>(state.range(1));
+    std::vector<double> y(x.size());
+    for (auto _ : state)
+    {
+        HornerMultiPoint(HO_POLY, NUM_HO_COEFF, x.data(), x.size(), y.data(), kernel);
+        benchmark::DoNotOptimize(y.data());
+    }
+    state.SetItemsProcessed(state.iterations() * x.size());
+    set_kernel_label(state, kernel);
+}
+
+// Compensated Horner in double-double, the arguments are the number of points and the HornerKernel
+static void BM_CompensatedHornerMultiPoint(benchmark::State& state)
+{
+    std::vector<double> x = make_points(state.range(0));
+    HornerKernel kernel = static_cast<HornerKernel>(state.range(1));
+    std::vector<double> y_hi(x.size()), y_lo(x.size());
+    for (auto _ : state)
+    {
+        CompensatedHornerMultiPoint(HO_POLY, NUM_HO_COEFF, x.data(), x.size(), y_hi.data(), y_lo.data(), kernel);
+        benchmark::DoNotOptimize(y_hi.data());
+        benchmark::DoNotOptimize(y_lo.data());
+    }
+    state.SetItemsProcessed(state.iterations() * x.size());
+    set_kernel_label(state, kernel);
+}
+
+static void MultiPointHornerArgs(benchmark::internal::Benchmark* bench)
+{
+    bench->ArgNames({"points", "kernel"});
+    for (int num_points : { 2 * NUM_FO_POLY, 11 * NUM_FO_POLY })
+    {
+        for (HornerKernel kernel : { HornerKernel::Scalar, HornerKernel::Avx2, HornerKernel::Avx512, HornerKernel::Neon })
+        {
+            if (ResolveHornerKernel(kernel) == kernel)
+            {
+                bench->Args({num_points, static_cast<int>(kernel)});
+            }
+        }
+    }
+}
+BENCHMARK(BM_HornerMultiPoint)->Apply(MultiPointHornerArgs);
+BENCHMARK(BM_CompensatedHornerMultiPoint)->Apply(MultiPointHornerArgs);
+
+// The scalar loop over the coefficients, the argument is the number of coefficients
+static void BM_HornerLoop(benchmark::State& state)
+{
+    std::vector<double> x = make_points(11 * NUM_FO_POLY);
+    std::vector<double> poly = make_poly(state.range(0));
+    int num_coeff = state.range(0);
+    std::vector<double> y(x.size());
+    for (auto _ : state)
+    {
+        // not a compile time constant for the loop
+        benchmark::DoNotOptimize(num_coeff);
+        horner_loop(poly.data(), num_coeff, x.data(), x.size(), y.data());
+        benchmark::DoNotOptimize(y.data());
+    }
+    state.SetItemsProcessed(state.iterations() * x.size());
+}
+BENCHMARK(BM_HornerLoop)->ArgName("coeffs")->DenseRange(2, MAX_UNROLLED_NUM_COEFF);
+
+// The scalar kernel unrolled for NumCoeffs coefficients
+template <int NumCoeffs>
+static void BM_HornerUnrolled(benchmark::State& state)
+{
+    std::vector<double> x = make_points(11 * NUM_FO_POLY);
+    std::vector<double> poly = make_poly(NumCoeffs);
+    std::vector<double> y(x.size());
+    for (auto _ : state)
+    {
+        HornerMultiPoint<NumCoeffs>(poly.data(), x.data(), x.size(), y.data(), HornerKernel::Scalar);
+        benchmark::DoNotOptimize(y.data());
+    }
+    state.SetItemsProcessed(state.iterations() * x.size());
+}
+BENCHMARK_TEMPLATE(BM_HornerUnrolled, 2);
+BENCHMARK_TEMPLATE(BM_HornerUnrolled, 3);
+BENCHMARK_TEMPLATE(BM_HornerUnrolled, 4);
+BENCHMARK_TEMPLATE(BM_HornerUnrolled, 5);
+BENCHMARK_TEMPLATE(BM_HornerUnrolled, 6);
+BENCHMARK_TEMPLATE(BM_HornerUnrolled, 7);
+BENCHMARK_TEMPLATE(BM_HornerUnrolled, 8);
+BENCHMARK_TEMPLATE(BM_HornerUnrolled, 9);
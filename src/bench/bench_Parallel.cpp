@@ -0,0 +1,177 @@
+/***
+ * bench_Parallel.cpp
+ *
+ * Benchmarks for the parallel FODM generation on a ThreadPool, for 1 up to
+ * std::thread::hardware_concurrency() threads. The workload is the 1000
+ * FODMs of 10 ms of 200 receptors, derived from their 10 s HODMs, and their
+ * register values. The reported items_per_second is the number of receptors
+ * processed per second, against the wall clock time.
+ *
+ ***/
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "CalcFodmRegisterValues.h"
+#include "FirstOrderDelayModel.h"
+#include "FodmBatchProcessor.h"
+#include "ThreadPool.h"
+
+#include "benchmark/benchmark.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+const int NUM_RECEPTORS = 200;
+const int NUM_HO_COEFF = 6;
+const double HO_POLY[NUM_HO_COEFF] = {
+    3.956738275640760941E-14, -1.885738529952905433E-12, -9.731305625195973794E-09,
+    6.899681529986780764E-04, 1.100300531941965509E+01, -259508.7983 };
+const double HO_T_START = 10.0;
+const double HO_T_STOP = 20.0;
+const int NUM_FO_POLY = 1000;
+
+const uint32_t INPUT_SAMPLE_RATE = 220029600;
+const uint32_t OUTPUT_SAMPLE_RATE = 220200960;
+const double FREQ_DOWN_SHIFT = -1386186480;
+const double FREQ_ALIGN_SHIFT = 71552;
+const double FREQ_WB_SHIFT = 0;
+const double FREQ_SCFO_SHIFT = -1079568;
+
+// The same HODM for every receptor, scaled a little so that they differ
+std::vector<double> make_ho_poly(int receptor)
+{
+    std::vector<double> ho_poly(HO_POLY, HO_POLY + NUM_HO_COEFF);
+    for (double& coeff : ho_poly)
+    {
+        coeff *= 1.0 + receptor * 1.0e-3;
+    }
+    return ho_poly;
+}
+
+std::vector<double> make_fo_t_start()
+{
+    std::vector<double> fo_t_start(NUM_FO_POLY + 1);
+    for (int ii = 0; ii < NUM_FO_POLY + 1; ii++)
+    {
+        fo_t_start[ii] = HO_T_START + ii * 0.01;
+    }
+    return fo_t_start;
+}
+
+// Powers of two up to the number of hardware threads, and that number
+void ThreadArgs(benchmark::internal::Benchmark* bench)
+{
+    const unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    bench->ArgName("threads");
+    for (unsigned num_threads = 1; num_threads < max_threads; num_threads *= 2)
+    {
+        bench->Arg(num_threads);
+    }
+    bench->Arg(max_threads);
+}
+
+}
+
+// FodmBatchProcessor on blocks of receptors and ranges of FOs
+static void BM_ParallelFodmBatchProcessor(benchmark::State& state)
+{
+    HodmBatch hodms;
+    hodms.num_receptors = NUM_RECEPTORS;
+    hodms.num_ho_coeff = NUM_HO_COEFF;
+    hodms.coeff.resize(NUM_HO_COEFF * NUM_RECEPTORS);
+    hodms.t_start.assign(NUM_RECEPTORS, HO_T_START);
+    hodms.t_stop.assign(NUM_RECEPTORS, HO_T_STOP);
+    for (int rr = 0; rr < NUM_RECEPTORS; rr++)
+    {
+        std::vector<double> ho_poly = make_ho_poly(rr);
+        for (int kk = 0; kk < NUM_HO_COEFF; kk++)
+        {
+            hodms.coeff[kk * NUM_RECEPTORS + rr] = ho_poly[kk];
+        }
+    }
+    std::vector<double> fo_t_start = make_fo_t_start();
+    const FodmBatchProcessor processor(NUM_RECEPTORS);
+    ThreadPool pool(state.range(0));
+    FodmBatch fodms;
+    for (auto _ : state)
+    {
+        processor.process(hodms, NUM_FO_POLY, fo_t_start, fodms, pool);
+        benchmark::DoNotOptimize(fodms.delay_const.data());
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_RECEPTORS);
+}
+BENCHMARK(BM_ParallelFodmBatchProcessor)->Apply(ThreadArgs)->UseRealTime();
+
+// One FirstOrderDelayModel shared by the threads, a receptor per range.
+// The argument is the PolyvalPrecision.
+static void BM_ParallelFirstOrderDelayModel(benchmark::State& state)
+{
+    std::vector<std::vector<double>> ho_polys;
+    for (int rr = 0; rr < NUM_RECEPTORS; rr++)
+    {
+        ho_polys.push_back(make_ho_poly(rr));
+    }
+    std::vector<double> fo_t_start = make_fo_t_start();
+    const FirstOrderDelayModel model(static_cast<PolyvalPrecision>(state.range(1)));
+    ThreadPool pool(state.range(0));
+    std::vector<std::vector<long double>> fo_polys(NUM_RECEPTORS);
+    for (auto _ : state)
+    {
+        pool.ParallelFor(NUM_RECEPTORS, 1, [&](size_t begin, size_t end)
+        {
+            for (size_t rr = begin; rr < end; rr++)
+            {
+                model.process(HO_T_START, HO_T_STOP, NUM_HO_COEFF, ho_polys[rr].data(),
+                    NUM_FO_POLY, fo_t_start, fo_polys[rr]);
+            }
+        });
+        benchmark::DoNotOptimize(fo_polys.data());
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_RECEPTORS);
+}
+BENCHMARK(BM_ParallelFirstOrderDelayModel)
+    ->Apply([](benchmark::internal::Benchmark* bench)
+    {
+        const unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+        bench->ArgNames({ "threads", "precision" });
+        for (int precision : { static_cast<int>(PolyvalPrecision::DoubleDouble),
+                               static_cast<int>(PolyvalPrecision::MultiPrecision) })
+        {
+            for (unsigned num_threads = 1; num_threads < max_threads; num_threads *= 2)
+            {
+                bench->Args({ static_cast<int>(num_threads), precision });
+            }
+            bench->Args({ static_cast<int>(max_threads), precision });
+        }
+    })
+    ->UseRealTime();
+
+// The register values of the FODMs of all receptors, in ranges of FODMs
+static void BM_ParallelCalcFodmRegisterValues(benchmark::State& state)
+{
+    const size_t num_fo_poly = NUM_RECEPTORS * NUM_FO_POLY;
+    std::vector<FoPoly> fo_polys(num_fo_poly);
+    const double ho_start_time_ms = 950040000000.0;
+    for (size_t ii = 0; ii < num_fo_poly; ii++)
+    {
+        size_t fo = ii % NUM_FO_POLY;
+        fo_polys[ii].ho_poly_start_time_ms = ho_start_time_ms;
+        fo_polys[ii].start_time_ms = ho_start_time_ms + fo * 10.0;
+        fo_polys[ii].stop_time_ms = fo_polys[ii].start_time_ms + 10.0;
+        fo_polys[ii].poly[0] = -0.158;
+        fo_polys[ii].poly[1] = -19036.792 + fo_polys[ii].poly[0] * fo * 0.01;
+    }
+    const RdtChannelContext ctx(INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+        FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT);
+    ThreadPool pool(state.range(0));
+    std::vector<FirstOrderDelayModelRegisterValues> reg_values(num_fo_poly);
+    for (auto _ : state)
+    {
+        CalcFodmRegisterValues(ctx, fo_polys.data(), num_fo_poly, reg_values.data(), pool);
+        benchmark::DoNotOptimize(reg_values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_RECEPTORS);
+}
+BENCHMARK(BM_ParallelCalcFodmRegisterValues)->Apply(ThreadArgs)->UseRealTime();
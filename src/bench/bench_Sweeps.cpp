@@ -0,0 +1,181 @@
+/***
+ * bench_Sweeps.cpp
+ *
+ * Parameter sweeps of the FODM generation hot paths, for tracking their
+ * performance across releases and comparing the x86 and armv8 builds, see
+ * make cpp-bench-json. The HODM degree, the number of FODMs and the FODM
+ * interval are swept over the range the RDT uses. The reported
+ * items_per_second is the number of FODMs (or points, for polyval)
+ * processed per second, so that results with different sweep arguments
+ * can be compared directly.
+ *
+ ***/
+#include <cmath>
+#include <vector>
+#include "CalcFodmRegisterValues.h"
+#include "DoubleDouble.h"
+#include "FirstOrderDelayModel.h"
+
+#include "benchmark/benchmark.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+// The 5th order HODM of the other benchmarks, lowest degree coefficient last
+const int NUM_BASE_COEFF = 6;
+const double BASE_POLY[NUM_BASE_COEFF] = {
+    3.956738275640760941E-14, -1.885738529952905433E-12, -9.731305625195973794E-09,
+    6.899681529986780764E-04, 1.100300531941965509E+01, -259508.7983 };
+const double HO_T_START = 10.0;
+const int NUM_LSQ_POINTS = 10;
+
+const uint32_t INPUT_SAMPLE_RATE = 220029600;
+const uint32_t OUTPUT_SAMPLE_RATE = 220200960;
+const double FREQ_DOWN_SHIFT = -1386186480;
+const double FREQ_ALIGN_SHIFT = 71552;
+const double FREQ_WB_SHIFT = 0;
+const double FREQ_SCFO_SHIFT = -1079568;
+
+const std::vector<int64_t> DEGREES = { 1, 2, 3, 5, 8 };
+const std::vector<int64_t> NUM_FODMS = { 1, 100, 1000 };
+const std::vector<int64_t> INTERVALS_MS = { 10, 100, 1000 };
+
+// A HODM of the given degree, highest degree coefficient first. The low
+// degree coefficients are those of BASE_POLY, and the coefficients above
+// degree 5 shrink by 1e-2 per degree, like those of a fitted HODM.
+std::vector<double> make_ho_poly(int degree)
+{
+    std::vector<double> ho_poly(degree + 1);
+    for (int ii = 0; ii <= degree; ii++)
+    {
+        int base_index = NUM_BASE_COEFF - 1 - ii;
+        ho_poly[degree - ii] = base_index >= 0 ? BASE_POLY[base_index] : BASE_POLY[0] * std::pow(1.0e-2, -base_index);
+    }
+    return ho_poly;
+}
+
+// num_fo_poly consecutive FODMs of interval_ms from HO_T_START, plus the end of the last one [s]
+std::vector<double> make_fo_t_start(int num_fo_poly, int interval_ms)
+{
+    std::vector<double> fo_t_start(num_fo_poly + 1);
+    for (int ii = 0; ii < num_fo_poly + 1; ii++)
+    {
+        fo_t_start[ii] = HO_T_START + ii * interval_ms / 1000.0;
+    }
+    return fo_t_start;
+}
+
+// num_fo_poly consecutive FODMs of interval_ms starting from a whole second
+std::vector<FoPoly> make_fo_polys(int num_fo_poly, int interval_ms)
+{
+    std::vector<FoPoly> fo_polys(num_fo_poly);
+    const double ho_start_time_ms = 950040000000.0;
+    for (int ii = 0; ii < num_fo_poly; ii++)
+    {
+        fo_polys[ii].ho_poly_start_time_ms = ho_start_time_ms;
+        fo_polys[ii].start_time_ms = ho_start_time_ms + static_cast<double>(ii) * interval_ms;
+        fo_polys[ii].stop_time_ms = fo_polys[ii].start_time_ms + interval_ms;
+        fo_polys[ii].poly[0] = -0.158;
+        fo_polys[ii].poly[1] = -19036.792 + fo_polys[ii].poly[0] * ii * interval_ms / 1000.0;
+    }
+    return fo_polys;
+}
+
+}
+
+// Two points per FODM, the arguments are the HODM degree, the number of
+// FODMs, the FODM interval and the PolyvalPrecision
+static void BM_SweepProcess(benchmark::State& state)
+{
+    FirstOrderDelayModel model(static_cast<PolyvalPrecision>(state.range(3)));
+    std::vector<double> ho_poly = make_ho_poly(state.range(0));
+    std::vector<double> fo_t_start = make_fo_t_start(state.range(1), state.range(2));
+    std::vector<long double> fo_poly;
+    for (auto _ : state)
+    {
+        model.process(fo_t_start.front(), fo_t_start.back(), ho_poly.size(), ho_poly.data(),
+            state.range(1), fo_t_start, fo_poly);
+        benchmark::DoNotOptimize(fo_poly.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_SweepProcess)
+    ->ArgNames({"degree", "fodms", "interval_ms", "precision"})
+    ->ArgsProduct({DEGREES, NUM_FODMS, INTERVALS_MS,
+        {static_cast<int>(PolyvalPrecision::MultiPrecision), static_cast<int>(PolyvalPrecision::DoubleDouble)}});
+
+// Least squares fitting, the arguments are the HODM degree, the number of
+// FODMs, the FODM interval and the LsqFitMethod
+static void BM_SweepProcessLsq(benchmark::State& state)
+{
+    FirstOrderDelayModel model(PolyvalPrecision::Default, static_cast<LsqFitMethod>(state.range(3)));
+    std::vector<double> ho_poly = make_ho_poly(state.range(0));
+    std::vector<double> fo_t_start = make_fo_t_start(state.range(1), state.range(2));
+    std::vector<long double> fo_poly;
+    for (auto _ : state)
+    {
+        model.process(fo_t_start.front(), fo_t_start.back(), ho_poly.size(), ho_poly.data(),
+            NUM_LSQ_POINTS, state.range(1), fo_t_start, fo_poly);
+        benchmark::DoNotOptimize(fo_poly.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_SweepProcessLsq)
+    ->ArgNames({"degree", "fodms", "interval_ms", "fit"})
+    ->ArgsProduct({DEGREES, NUM_FODMS, INTERVALS_MS,
+        {static_cast<int>(LsqFitMethod::Sampled), static_cast<int>(LsqFitMethod::ClosedForm)}});
+
+// The double-double polyval of FirstOrderDelayModel at a single point, the
+// argument is the HODM degree. The multi-precision polyval is what
+// BM_SweepProcess measures with precision 1, as it dominates that path.
+static void BM_SweepPolyval(benchmark::State& state)
+{
+    std::vector<double> ho_poly = make_ho_poly(state.range(0));
+    std::vector<double> x = make_fo_t_start(1000, 10);
+    for (auto _ : state)
+    {
+        for (double xx : x)
+        {
+            DoubleDouble y = CompensatedHorner(ho_poly.data(), ho_poly.size(), xx);
+            benchmark::DoNotOptimize(y);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * x.size());
+}
+BENCHMARK(BM_SweepPolyval)->ArgName("degree")->DenseRange(1, 8);
+
+// Batch function, the arguments are the number of FODMs and the FODM interval
+static void BM_SweepCalcFodmRegisterValues(benchmark::State& state)
+{
+    std::vector<FoPoly> fo_polys = make_fo_polys(state.range(0), state.range(1));
+    std::vector<FirstOrderDelayModelRegisterValues> reg_values(fo_polys.size());
+    for (auto _ : state)
+    {
+        CalcFodmRegisterValues(fo_polys.data(), fo_polys.size(), INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+            FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT, reg_values.data());
+        benchmark::DoNotOptimize(reg_values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * fo_polys.size());
+}
+BENCHMARK(BM_SweepCalcFodmRegisterValues)
+    ->ArgNames({"fodms", "interval_ms"})
+    ->ArgsProduct({NUM_FODMS, INTERVALS_MS});
+
+// Version 1 register, batch function, the arguments are as above
+static void BM_SweepCalcFodmRegisterValuesV1(benchmark::State& state)
+{
+    std::vector<FoPoly> fo_polys = make_fo_polys(state.range(0), state.range(1));
+    std::vector<FirstOrderDelayModelRegisterValuesVer1> reg_values(fo_polys.size());
+    for (auto _ : state)
+    {
+        CalcFodmRegisterValuesV1(fo_polys.data(), fo_polys.size(), INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+            FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT, reg_values.data());
+        benchmark::DoNotOptimize(reg_values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * fo_polys.size());
+}
+BENCHMARK(BM_SweepCalcFodmRegisterValuesV1)
+    ->ArgNames({"fodms", "interval_ms"})
+    ->ArgsProduct({NUM_FODMS, INTERVALS_MS});
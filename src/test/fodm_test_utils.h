@@ -0,0 +1,370 @@
+/***
+ * fodm_test_utils.h
+ *
+ * Helpers shared by the CalcFodmRegisterValues test drivers: parsing the
+ * input CSV, generating random inputs, the RDT channel of the tests,
+ * comparing register values, and the FodmEngineTest suite that compares a
+ * calculation engine against the multi-precision calculation.
+ *
+ ***/
+#ifndef FODM_TEST_UTILS_H
+#define FODM_TEST_UTILS_H
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include "CalcFodmRegisterValues.h"
+#include "csv.h"
+
+#include "gtest/gtest.h"
+
+constexpr int INPUT_CSV_NUM_COL = 11;
+
+// The sample rates and frequency shifts of the RDT channel of the tests
+// that don't read them from the input CSV
+constexpr uint32_t INPUT_SAMPLE_RATE = 220029600;
+constexpr uint32_t OUTPUT_SAMPLE_RATE = 220200960;
+constexpr double FREQ_DOWN_SHIFT = -1386186480;
+constexpr double FREQ_ALIGN_SHIFT = 71552;
+constexpr double FREQ_WB_SHIFT = 0;
+constexpr double FREQ_SCFO_SHIFT = -1079568;
+
+struct CsvInputs
+{
+    ska_mid_cbf_fodm_gen::FoPoly fo_poly;
+    uint32_t input_sample_rate;
+    uint32_t output_sample_rate;
+    double f_wb;
+    double f_as;
+    double f_ds;
+    double f_scfo;
+};
+
+inline void parse_input_csv(
+    const std::string& csv_file, 
+    std::vector<CsvInputs>& inputs)
+{
+    io::CSVReader<INPUT_CSV_NUM_COL> in(csv_file);
+    in.read_header(io::ignore_extra_column, "fo_delay_const", "fo_delay_linear",
+        "fodm_start_t", "fodm_stop_t", "hodm_start_t", "input_sample_rate", 
+        "output_sample_rate", "f_wb", "f_as", "f_ds", "f_scfo");
+    inputs.clear();
+    CsvInputs data;
+    while(in.read_row(
+        data.fo_poly.poly[1],
+        data.fo_poly.poly[0],
+        data.fo_poly.start_time_ms,
+        data.fo_poly.stop_time_ms,
+        data.fo_poly.ho_poly_start_time_ms,
+        data.input_sample_rate,
+        data.output_sample_rate,
+        data.f_wb,
+        data.f_as,
+        data.f_ds,
+        data.f_scfo)) 
+    {
+        inputs.push_back(data);
+    }
+
+}
+
+// Generates num_rows random inputs covering the range of parameters seen
+// in operation: receptor input sample rates around 220 MHz, 10 ms FODMs
+// within the first 10 s of a HODM, and delays up to +-400 us. The
+// frequency shifts are derived from a random frequency slice index.
+// The generator is seeded so failures can be reproduced.
+inline void generate_random_inputs(int num_rows, unsigned int seed, std::vector<CsvInputs>& inputs)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> k_val_distr(1, 2222);
+    std::uniform_real_distribution<> delay_const_distr(-400000.0, 400000.0); // ns
+    std::uniform_real_distribution<> delay_linear_distr(-10.0, 10.0); // ns / s
+    std::uniform_int_distribution<> freq_slice_idx_distr(1, 9);
+    std::uniform_int_distribution<> ho_poly_start_time_s_distr(720000000, 990000000);
+    std::uniform_int_distribution<> nth_fodm_distr(0, 999);
+    std::uniform_real_distribution<> f_as_distr(-200000.0, 200000.0); // Hz
+    const uint32_t output_sample_rate = 220200960;
+    const double fodm_interval_ms = 10.0;
+
+    inputs.clear();
+    for (int ii = 0; ii < num_rows; ii++)
+    {
+        CsvInputs input;
+        int fsi = freq_slice_idx_distr(gen);
+        input.fo_poly.poly[1] = delay_const_distr(gen);
+        input.fo_poly.poly[0] = delay_linear_distr(gen);
+        input.fo_poly.ho_poly_start_time_ms = ho_poly_start_time_s_distr(gen) * 1000.0;
+        input.fo_poly.start_time_ms = input.fo_poly.ho_poly_start_time_ms + fodm_interval_ms * nth_fodm_distr(gen);
+        input.fo_poly.stop_time_ms = input.fo_poly.start_time_ms + fodm_interval_ms;
+        input.input_sample_rate = 220000000 + k_val_distr(gen) * 100;
+        input.output_sample_rate = output_sample_rate;
+        input.f_wb = 0;
+        input.f_as = std::round(f_as_distr(gen));
+        input.f_ds = std::round(-9.0 * fsi * double(input.input_sample_rate) / 10);
+        input.f_scfo = std::round(9.0 * fsi * (double(input.input_sample_rate) - double(output_sample_rate)) / 10);
+        inputs.push_back(input);
+    }
+}
+
+// Compares all fields of two sets of register values of the same version
+template <typename RegValues>
+inline void expect_reg_values_eq(const RegValues& expected, const RegValues& actual)
+{
+    EXPECT_EQ(actual.first_input_timestamp, expected.first_input_timestamp);
+    EXPECT_EQ(actual.delay_constant, expected.delay_constant);
+    EXPECT_EQ(actual.phase_constant, expected.phase_constant);
+    EXPECT_EQ(actual.delay_linear, expected.delay_linear);
+    EXPECT_EQ(actual.phase_linear, expected.phase_linear);
+    EXPECT_EQ(actual.validity_period, expected.validity_period);
+    EXPECT_EQ(actual.output_PPS, expected.output_PPS);
+    EXPECT_EQ(actual.first_output_timestamp, expected.first_output_timestamp);
+}
+
+// Runs the input through Engine and the multi-precision calculation for both
+// register versions, and expects the same results whenever Engine accepts
+// the input. Through the dispatcher, which falls back to the
+// multi-precision calculation, the results must always match. Returns
+// whether Engine accepted both versions.
+template <typename Engine>
+inline bool expect_engine_matches(const CsvInputs& input)
+{
+    using namespace ska_mid_cbf_fodm_gen;
+
+    FirstOrderDelayModelRegisterValues mp_values = CalcFodmRegisterValues(input.fo_poly,
+        input.input_sample_rate, input.output_sample_rate, input.f_ds, input.f_as, input.f_wb, input.f_scfo,
+        FodmCalcEngine::MultiPrecision);
+    FirstOrderDelayModelRegisterValuesVer1 mp_values_v1 = CalcFodmRegisterValuesV1(input.fo_poly,
+        input.input_sample_rate, input.output_sample_rate, input.f_ds, input.f_as, input.f_wb, input.f_scfo,
+        FodmCalcEngine::MultiPrecision);
+
+    FirstOrderDelayModelRegisterValues values;
+    FirstOrderDelayModelRegisterValuesVer1 values_v1;
+    bool accepted = Engine::Calc(input, values);
+    bool accepted_v1 = Engine::CalcV1(input, values_v1);
+
+    if (accepted)
+    {
+        expect_reg_values_eq(mp_values, values);
+    }
+    if (accepted_v1)
+    {
+        expect_reg_values_eq(mp_values_v1, values_v1);
+    }
+
+    expect_reg_values_eq(mp_values, CalcFodmRegisterValues(input.fo_poly,
+        input.input_sample_rate, input.output_sample_rate, input.f_ds, input.f_as, input.f_wb, input.f_scfo,
+        Engine::ENGINE));
+    expect_reg_values_eq(mp_values_v1, CalcFodmRegisterValuesV1(input.fo_poly,
+        input.input_sample_rate, input.output_sample_rate, input.f_ds, input.f_as, input.f_wb, input.f_scfo,
+        Engine::ENGINE));
+
+    return accepted && accepted_v1;
+}
+
+// Compares a calculation engine against the multi-precision calculation.
+// The register values are expected to be bit-exact. Engine provides:
+//   ENGINE: the FodmCalcEngine of the dispatcher
+//   SEED: the seed of the random inputs
+//   Calc(input, reg_values), CalcV1(input, reg_values): the calculation of
+//     the engine for both register versions, false if it falls back
+// Instantiate it with INSTANTIATE_TYPED_TEST_SUITE_P(<name>, FodmEngineTest, Engine).
+template <typename Engine>
+class FodmEngineTest : public ::testing::Test
+{
+};
+
+TYPED_TEST_SUITE_P(FodmEngineTest);
+
+TYPED_TEST_P(FodmEngineTest, CsvRows)
+{
+    std::vector<CsvInputs> test_input;
+    parse_input_csv("fodm_test_input.csv", test_input);
+    ASSERT_FALSE(test_input.empty());
+
+    size_t num_accepted = 0;
+    for (const CsvInputs& input : test_input)
+    {
+        num_accepted += expect_engine_matches<TypeParam>(input);
+    }
+    // Only the row without any delay is on a boundary
+    EXPECT_GE(num_accepted, test_input.size() - 1);
+}
+
+TYPED_TEST_P(FodmEngineTest, RandomInputs)
+{
+    const int NUM_ROWS = 50000;
+    std::vector<CsvInputs> test_input;
+    generate_random_inputs(NUM_ROWS, TypeParam::SEED, test_input);
+
+    for (const CsvInputs& input : test_input)
+    {
+        // random delays are never close enough to a boundary to fall back
+        EXPECT_TRUE(expect_engine_matches<TypeParam>(input));
+        if (::testing::Test::HasFailure())
+        {
+            break;
+        }
+    }
+}
+
+// Frequency shifts with a fractional part, for the phase constant of
+// shifts that are not a whole number of Hz
+TYPED_TEST_P(FodmEngineTest, FractionalFrequencyShifts)
+{
+    const int NUM_ROWS = 5000;
+    std::vector<CsvInputs> test_input;
+    generate_random_inputs(NUM_ROWS, TypeParam::SEED + 1, test_input);
+
+    const double fractions[] = { 0.5, 0.37, 1.0 / 3.0, 1.0e-6 };
+    for (int ii = 0; ii < NUM_ROWS; ii++)
+    {
+        CsvInputs input = test_input[ii];
+        input.f_as += fractions[ii % 4];
+        input.f_wb = fractions[(ii + 1) % 4] * 1000.0;
+        EXPECT_TRUE(expect_engine_matches<TypeParam>(input));
+        if (::testing::Test::HasFailure())
+        {
+            break;
+        }
+    }
+}
+
+// Inputs where the exact values land on a floor or rounding boundary,
+// e.g. no delay, timestamps on whole output samples and equal sample rates.
+TYPED_TEST_P(FodmEngineTest, BoundaryInputs)
+{
+    std::vector<CsvInputs> test_input;
+    parse_input_csv("fodm_test_input.csv", test_input);
+    ASSERT_FALSE(test_input.empty());
+
+    const double start_times_ms[] = { 720000000000.0, 720000000025.0, 720000000100.0, 950040000000.0, 1000.0, 0.0 };
+    const long double delay_consts[] = { 0.0L, 1.0L, -1.0L, 0.5L, 2000.0L };
+    const long double delay_linears[] = { 0.0L, 1.0L, -0.125L };
+
+    for (const CsvInputs& row : test_input)
+    {
+        for (double start_time_ms : start_times_ms)
+        {
+            for (long double delay_const : delay_consts)
+            {
+                for (long double delay_linear : delay_linears)
+                {
+                    CsvInputs input = row;
+                    input.fo_poly.start_time_ms = start_time_ms;
+                    input.fo_poly.stop_time_ms = start_time_ms + 10.0;
+                    input.fo_poly.poly[1] = delay_const;
+                    input.fo_poly.poly[0] = delay_linear;
+                    expect_engine_matches<TypeParam>(input);
+
+                    // Same input and output sample rates
+                    input.input_sample_rate = input.output_sample_rate;
+                    expect_engine_matches<TypeParam>(input);
+                }
+            }
+        }
+    }
+}
+
+// Inputs where the phase_linear fraction is just off the -0.5 wrap, closer
+// than the rounding error of the multi-precision calculation, which may then
+// wrap the other way. The engine must leave them to it.
+TYPED_TEST_P(FodmEngineTest, NearTieInputs)
+{
+    const uint32_t sample_rate = OUTPUT_SAMPLE_RATE;
+    const long double delay_linears[] = { 1.0e-31L, -1.0e-31L, -1.0e-37L, 1.0e-38L, -1.0e-38L };
+
+    for (long double delay_linear : delay_linears)
+    {
+        CsvInputs input = {};
+        input.fo_poly.start_time_ms = 720000000000.0;
+        input.fo_poly.stop_time_ms = input.fo_poly.start_time_ms + 10.0;
+        input.fo_poly.poly[0] = delay_linear;
+        input.fo_poly.poly[1] = -19036.792L;
+        input.input_sample_rate = sample_rate;
+        input.output_sample_rate = sample_rate;
+        input.f_ds = 0.0;
+        input.f_as = 0.0;
+        input.f_wb = 1000.0;
+        input.f_scfo = sample_rate / 2.0;
+
+        ska_mid_cbf_fodm_gen::FirstOrderDelayModelRegisterValues values;
+        EXPECT_FALSE(TypeParam::Calc(input, values)) << "delay_linear " << static_cast<double>(delay_linear);
+        EXPECT_FALSE(expect_engine_matches<TypeParam>(input));
+    }
+}
+
+// Inputs that the engine can't certify or does not handle should fall back
+// to the multi-precision calculation when selected through
+// CalcFodmRegisterValues.
+TYPED_TEST_P(FodmEngineTest, Fallback)
+{
+    std::vector<CsvInputs> test_input;
+    parse_input_csv("fodm_test_input.csv", test_input);
+    ASSERT_FALSE(test_input.empty());
+
+    std::vector<CsvInputs> fallback(4, test_input[0]);
+    // negative first input timestamp
+    fallback[0].fo_poly.start_time_ms = 0.0;
+    fallback[0].fo_poly.stop_time_ms = 10.0;
+    fallback[0].fo_poly.poly[1] = -2000.0;
+    // stop time before the start time
+    fallback[1].fo_poly.stop_time_ms = fallback[1].fo_poly.start_time_ms - 10.0;
+    // a delay of a whole number of input samples, from a whole second
+    fallback[2].fo_poly.start_time_ms = 950040000000.0;
+    fallback[2].fo_poly.stop_time_ms = fallback[2].fo_poly.start_time_ms + 10.0;
+    fallback[2].fo_poly.poly[1] = 0.0;
+    fallback[2].fo_poly.poly[0] = 0.0;
+    // a delay just above a whole input sample, within the error bound
+    fallback[3] = fallback[2];
+    fallback[3].fo_poly.poly[1] = 1.0e-30L;
+
+    for (const CsvInputs& input : fallback)
+    {
+        ska_mid_cbf_fodm_gen::FirstOrderDelayModelRegisterValues values;
+        EXPECT_FALSE(TypeParam::Calc(input, values));
+        expect_engine_matches<TypeParam>(input);
+    }
+}
+
+// The batch functions with the engine should give the same results as the
+// multi-precision engine.
+TYPED_TEST_P(FodmEngineTest, Batch)
+{
+    using namespace ska_mid_cbf_fodm_gen;
+
+    std::vector<CsvInputs> test_input;
+    parse_input_csv("fodm_test_input.csv", test_input);
+    ASSERT_FALSE(test_input.empty());
+    const CsvInputs& row = test_input[2];
+
+    const int NUM_FODMS = 1000;
+    std::vector<FoPoly> fo_polys(NUM_FODMS, row.fo_poly);
+    for (int ii = 0; ii < NUM_FODMS; ii++)
+    {
+        fo_polys[ii].start_time_ms = row.fo_poly.start_time_ms + ii * 10.0;
+        fo_polys[ii].stop_time_ms = fo_polys[ii].start_time_ms + 10.0;
+    }
+
+    std::vector<FirstOrderDelayModelRegisterValues> mp_values(NUM_FODMS), values(NUM_FODMS);
+    std::vector<FirstOrderDelayModelRegisterValuesVer1> mp_values_v1(NUM_FODMS), values_v1(NUM_FODMS);
+    CalcFodmRegisterValues(fo_polys.data(), fo_polys.size(), row.input_sample_rate, row.output_sample_rate,
+        row.f_ds, row.f_as, row.f_wb, row.f_scfo, mp_values.data(), FodmCalcEngine::MultiPrecision);
+    CalcFodmRegisterValues(fo_polys.data(), fo_polys.size(), row.input_sample_rate, row.output_sample_rate,
+        row.f_ds, row.f_as, row.f_wb, row.f_scfo, values.data(), TypeParam::ENGINE);
+    CalcFodmRegisterValuesV1(fo_polys.data(), fo_polys.size(), row.input_sample_rate, row.output_sample_rate,
+        row.f_ds, row.f_as, row.f_wb, row.f_scfo, mp_values_v1.data(), FodmCalcEngine::MultiPrecision);
+    CalcFodmRegisterValuesV1(fo_polys.data(), fo_polys.size(), row.input_sample_rate, row.output_sample_rate,
+        row.f_ds, row.f_as, row.f_wb, row.f_scfo, values_v1.data(), TypeParam::ENGINE);
+
+    for (int ii = 0; ii < NUM_FODMS; ii++)
+    {
+        expect_reg_values_eq(mp_values[ii], values[ii]);
+        expect_reg_values_eq(mp_values_v1[ii], values_v1[ii]);
+    }
+}
+
+REGISTER_TYPED_TEST_SUITE_P(FodmEngineTest, CsvRows, RandomInputs, FractionalFrequencyShifts,
+    BoundaryInputs, NearTieInputs, Fallback, Batch);
+
+#endif
@@ -0,0 +1,39 @@
+/***
+ * test_CalcFodmRegisterValuesDoubleDouble.cpp
+ *
+ * The unit test driver for the double-double FODM register calculation.
+ * Runs the FodmEngineTest suite of fodm_test_utils.h, which compares the
+ * double-double results against the multi-precision calculation, and
+ * checks that values too close to a rounding or floor boundary to certify
+ * are left to the multi-precision one.
+ *
+ ***/
+#include "CalcFodmRegisterValues.h"
+#include "CalcFodmRegisterValuesDoubleDouble.h"
+#include "fodm_test_utils.h"
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+struct DoubleDoubleEngine
+{
+    static constexpr FodmCalcEngine ENGINE = FodmCalcEngine::DoubleDouble;
+    static constexpr unsigned int SEED = 2025;
+
+    static bool Calc(const CsvInputs& input, FirstOrderDelayModelRegisterValues& reg_values)
+    {
+        return CalcFodmRegisterValuesDoubleDouble(input.fo_poly,
+            input.input_sample_rate, input.output_sample_rate, input.f_ds, input.f_as, input.f_wb, input.f_scfo,
+            reg_values);
+    }
+
+    static bool CalcV1(const CsvInputs& input, FirstOrderDelayModelRegisterValuesVer1& reg_values)
+    {
+        return CalcFodmRegisterValuesV1DoubleDouble(input.fo_poly,
+            input.input_sample_rate, input.output_sample_rate, input.f_ds, input.f_as, input.f_wb, input.f_scfo,
+            reg_values);
+    }
+};
+
+INSTANTIATE_TYPED_TEST_SUITE_P(DoubleDouble, FodmEngineTest, DoubleDoubleEngine);
@@ -0,0 +1,55 @@
+/***
+ * test_CalcFodmRegisterValuesFixedPoint.cpp
+ *
+ * The unit test driver for the fixed point FODM register calculation.
+ * Runs the FodmEngineTest suite of fodm_test_utils.h, which compares the
+ * fixed point results against the multi-precision calculation, and the
+ * inputs out of range of the fixed point calculation only.
+ *
+ ***/
+#include <vector>
+#include "CalcFodmRegisterValues.h"
+#include "CalcFodmRegisterValuesFixedPoint.h"
+#include "fodm_test_utils.h"
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+struct FixedPointEngine
+{
+    static constexpr FodmCalcEngine ENGINE = FodmCalcEngine::FixedPoint;
+    static constexpr unsigned int SEED = 2002;
+
+    static bool Calc(const CsvInputs& input, FirstOrderDelayModelRegisterValues& reg_values)
+    {
+        return CalcFodmRegisterValuesFixedPoint(input.fo_poly,
+            input.input_sample_rate, input.output_sample_rate, input.f_ds, input.f_as, input.f_wb, input.f_scfo,
+            reg_values);
+    }
+
+    static bool CalcV1(const CsvInputs& input, FirstOrderDelayModelRegisterValuesVer1& reg_values)
+    {
+        return CalcFodmRegisterValuesV1FixedPoint(input.fo_poly,
+            input.input_sample_rate, input.output_sample_rate, input.f_ds, input.f_as, input.f_wb, input.f_scfo,
+            reg_values);
+    }
+};
+
+INSTANTIATE_TYPED_TEST_SUITE_P(FixedPoint, FodmEngineTest, FixedPointEngine);
+
+// A delay with more fractional bits than the fixed point inputs hold
+// should fall back to the multi-precision calculation.
+TEST(CalcFodmRegisterValuesFixedPointTest, OutOfRangeFallback)
+{
+    std::vector<CsvInputs> test_input;
+    parse_input_csv("fodm_test_input.csv", test_input);
+    ASSERT_FALSE(test_input.empty());
+
+    CsvInputs input = test_input[0];
+    input.fo_poly.poly[1] = 1.0e-200L;
+
+    FirstOrderDelayModelRegisterValues fp_values;
+    EXPECT_FALSE(FixedPointEngine::Calc(input, fp_values));
+    expect_engine_matches<FixedPointEngine>(input);
+}
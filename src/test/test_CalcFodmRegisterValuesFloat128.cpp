@@ -0,0 +1,171 @@
+/***
+ * test_CalcFodmRegisterValuesFloat128.cpp
+ *
+ * The unit test driver for the quad precision (FodmCalcEngine::Float128)
+ * FODM register calculation. The register values are compared against the
+ * fixed point calculation, which is bit-exact with the multi-precision
+ * calculation and falls back to it for inputs outside of its range, for
+ * the rows of the input CSV file and for millions of random inputs.
+ *
+ ***/
+#include <limits>
+#include <vector>
+#include "CalcFodmRegisterValues.h"
+#include "FodmNumericPolicy.h"
+#include "fodm_test_utils.h"
+
+#include <boost/multiprecision/cpp_bin_float.hpp>
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+TEST(CalcFodmRegisterValuesFloat128Test, CsvInputs)
+{
+    std::vector<CsvInputs> test_input;
+    parse_input_csv("fodm_test_input.csv", test_input);
+    ASSERT_FALSE(test_input.empty());
+
+    for (const CsvInputs& input : test_input)
+    {
+        expect_reg_values_eq(
+            CalcFodmRegisterValues(input.fo_poly, input.input_sample_rate, input.output_sample_rate,
+                input.f_ds, input.f_as, input.f_wb, input.f_scfo, FodmCalcEngine::MultiPrecision),
+            CalcFodmRegisterValues(input.fo_poly, input.input_sample_rate, input.output_sample_rate,
+                input.f_ds, input.f_as, input.f_wb, input.f_scfo, FodmCalcEngine::Float128));
+        expect_reg_values_eq(
+            CalcFodmRegisterValuesV1(input.fo_poly, input.input_sample_rate, input.output_sample_rate,
+                input.f_ds, input.f_as, input.f_wb, input.f_scfo, FodmCalcEngine::MultiPrecision),
+            CalcFodmRegisterValuesV1(input.fo_poly, input.input_sample_rate, input.output_sample_rate,
+                input.f_ds, input.f_as, input.f_wb, input.f_scfo, FodmCalcEngine::Float128));
+    }
+}
+
+// Each random input is a whole batch of consecutive FODMs, so that the
+// batch functions are covered as well.
+TEST(CalcFodmRegisterValuesFloat128Test, RandomInputs)
+{
+    const int NUM_ROWS = 20000;
+    const int NUM_FODMS_PER_ROW = 100;
+    std::vector<CsvInputs> test_input;
+    generate_random_inputs(NUM_ROWS, 4004, test_input);
+
+    std::vector<FoPoly> fo_polys(NUM_FODMS_PER_ROW);
+    std::vector<FirstOrderDelayModelRegisterValues> expected(NUM_FODMS_PER_ROW), actual(NUM_FODMS_PER_ROW);
+    std::vector<FirstOrderDelayModelRegisterValuesVer1> expected_v1(NUM_FODMS_PER_ROW), actual_v1(NUM_FODMS_PER_ROW);
+    for (int ii = 0; ii < NUM_ROWS; ii++)
+    {
+        const CsvInputs& row = test_input[ii];
+        for (int jj = 0; jj < NUM_FODMS_PER_ROW; jj++)
+        {
+            fo_polys[jj] = row.fo_poly;
+            fo_polys[jj].start_time_ms = row.fo_poly.start_time_ms + jj * 10.0;
+            fo_polys[jj].stop_time_ms = fo_polys[jj].start_time_ms + 10.0;
+            fo_polys[jj].poly[1] = row.fo_poly.poly[1] + row.fo_poly.poly[0] * jj * 0.01;
+        }
+
+        CalcFodmRegisterValues(fo_polys.data(), fo_polys.size(), row.input_sample_rate, row.output_sample_rate,
+            row.f_ds, row.f_as, row.f_wb, row.f_scfo, expected.data(), FodmCalcEngine::FixedPoint);
+        CalcFodmRegisterValues(fo_polys.data(), fo_polys.size(), row.input_sample_rate, row.output_sample_rate,
+            row.f_ds, row.f_as, row.f_wb, row.f_scfo, actual.data(), FodmCalcEngine::Float128);
+        for (int jj = 0; jj < NUM_FODMS_PER_ROW; jj++)
+        {
+            expect_reg_values_eq(expected[jj], actual[jj]);
+        }
+
+        // The version 1 registers are derived from the same values,
+        // check a subset of them
+        if (ii % 100 == 0)
+        {
+            CalcFodmRegisterValuesV1(fo_polys.data(), fo_polys.size(), row.input_sample_rate, row.output_sample_rate,
+                row.f_ds, row.f_as, row.f_wb, row.f_scfo, expected_v1.data(), FodmCalcEngine::FixedPoint);
+            CalcFodmRegisterValuesV1(fo_polys.data(), fo_polys.size(), row.input_sample_rate, row.output_sample_rate,
+                row.f_ds, row.f_as, row.f_wb, row.f_scfo, actual_v1.data(), FodmCalcEngine::Float128);
+            for (int jj = 0; jj < NUM_FODMS_PER_ROW; jj++)
+            {
+                expect_reg_values_eq(expected_v1[jj], actual_v1[jj]);
+            }
+        }
+
+        if (::testing::Test::HasFailure())
+        {
+            FAIL() << "random input row " << ii;
+        }
+    }
+}
+
+// The conversion of the rounded register values of both quad precision
+// types, long double on armv8 and __float128 elsewhere, should match the
+// cpp_bin_float_50 conversion on the edges of the register fields.
+template <typename Real>
+class FodmNumericPolicyTest : public ::testing::Test
+{
+};
+
+#if LDBL_MANT_DIG != 113 && defined(__SIZEOF_FLOAT128__)
+typedef ::testing::Types<long double, __float128> QuadFloatTypes;
+#else
+typedef ::testing::Types<long double> QuadFloatTypes;
+#endif
+TYPED_TEST_SUITE(FodmNumericPolicyTest, QuadFloatTypes);
+
+TYPED_TEST(FodmNumericPolicyTest, RegisterFieldBoundaries)
+{
+    typedef boost::multiprecision::cpp_bin_float_50 Mp;
+    typedef FodmNumericPolicy<TypeParam> Policy;
+    typedef FodmNumericPolicy<Mp> MpPolicy;
+
+    // Exactly representable in both types
+    const double two_pow_m34 = 1.0 / TwoPow(34);
+    const double values[] = { 0.0, 0.25, 1.0 - two_pow_m34, 0.5 - two_pow_m34, -0.5, 1.0, 2.0 - two_pow_m34 };
+    for (double value : values)
+    {
+        const TypeParam val = static_cast<TypeParam>(value);
+        const Mp mp_val(value);
+        EXPECT_EQ((MpPolicy::template ToInt<uint32_t, 32>(mp_val)), (Policy::template ToInt<uint32_t, 32>(val)))
+            << value;
+        EXPECT_EQ((MpPolicy::template ToInt<int32_t, 31>(mp_val)), (Policy::template ToInt<int32_t, 31>(val)))
+            << value;
+        EXPECT_EQ((MpPolicy::template ToInt<uint32_t, 31>(mp_val)), (Policy::template ToInt<uint32_t, 31>(val)))
+            << value;
+        EXPECT_EQ((MpPolicy::template ToInt<uint64_t, 63>(mp_val)), (Policy::template ToInt<uint64_t, 63>(val)))
+            << value;
+        EXPECT_EQ((MpPolicy::template ToInt<int64_t, 63>(mp_val)), (Policy::template ToInt<int64_t, 63>(val)))
+            << value;
+    }
+
+    // A delay constant that rounds up to 2^32 wraps around to 0, and a
+    // signed value that rounds up to 2^31 saturates
+    EXPECT_EQ(0u, (Policy::template ToInt<uint32_t, 32>(static_cast<TypeParam>(1.0 - two_pow_m34))));
+    EXPECT_EQ(std::numeric_limits<int32_t>::max(),
+        (Policy::template ToInt<int32_t, 31>(static_cast<TypeParam>(1.0 - two_pow_m34))));
+}
+
+// A delay that makes the delay constant round up to 2^32 through the
+// public functions, for the quad precision type of this platform
+TEST(CalcFodmRegisterValuesFloat128Test, DelayConstantWrapsAround)
+{
+    std::vector<CsvInputs> test_input;
+    parse_input_csv("fodm_test_input.csv", test_input);
+    ASSERT_FALSE(test_input.empty());
+
+    CsvInputs input = test_input[0];
+    input.fo_poly.start_time_ms = 1000.0;
+    input.fo_poly.stop_time_ms = 1010.0;
+    input.fo_poly.poly[0] = 0.0L;
+    input.fo_poly.poly[1] = -1.0e-12L;
+    input.input_sample_rate = input.output_sample_rate;
+
+    FirstOrderDelayModelRegisterValues expected = CalcFodmRegisterValues(input.fo_poly,
+        input.input_sample_rate, input.output_sample_rate, input.f_ds, input.f_as, input.f_wb, input.f_scfo,
+        FodmCalcEngine::MultiPrecision);
+    ASSERT_EQ(0u, expected.delay_constant);
+    expect_reg_values_eq(expected, CalcFodmRegisterValues(input.fo_poly,
+        input.input_sample_rate, input.output_sample_rate, input.f_ds, input.f_as, input.f_wb, input.f_scfo,
+        FodmCalcEngine::Float128));
+    expect_reg_values_eq(
+        CalcFodmRegisterValuesV1(input.fo_poly, input.input_sample_rate, input.output_sample_rate,
+            input.f_ds, input.f_as, input.f_wb, input.f_scfo, FodmCalcEngine::MultiPrecision),
+        CalcFodmRegisterValuesV1(input.fo_poly, input.input_sample_rate, input.output_sample_rate,
+            input.f_ds, input.f_as, input.f_wb, input.f_scfo, FodmCalcEngine::Float128));
+}
@@ -14,55 +14,17 @@
 #include <iomanip>
 #include <cstdlib>
 #include <random>
+#include <array>
 #include "CalcFodmRegisterValues.h"
 #include "csv.h"
+#include "fodm_test_utils.h"
 
 #include "gtest/gtest.h"
 
 using namespace ska_mid_cbf_fodm_gen;
 
-constexpr int INPUT_CSV_NUM_COL = 11;
 constexpr int OUTPUT_CSV_NUM_COL = 8;
 
-struct CsvInputs
-{
-    FoPoly fo_poly;
-    uint32_t input_sample_rate;
-    uint32_t output_sample_rate;
-    double f_wb;
-    double f_as;
-    double f_ds;
-    double f_scfo;
-};
-
-void parse_input_csv(
-    const std::string& csv_file, 
-    std::vector<CsvInputs>& inputs)
-{
-    io::CSVReader<INPUT_CSV_NUM_COL> in(csv_file);
-    in.read_header(io::ignore_extra_column, "fo_delay_const", "fo_delay_linear",
-        "fodm_start_t", "fodm_stop_t", "hodm_start_t", "input_sample_rate", 
-        "output_sample_rate", "f_wb", "f_as", "f_ds", "f_scfo");
-    inputs.clear();
-    CsvInputs data;
-    while(in.read_row(
-        data.fo_poly.poly[1],
-        data.fo_poly.poly[0],
-        data.fo_poly.start_time_ms,
-        data.fo_poly.stop_time_ms,
-        data.fo_poly.ho_poly_start_time_ms,
-        data.input_sample_rate,
-        data.output_sample_rate,
-        data.f_wb,
-        data.f_as,
-        data.f_ds,
-        data.f_scfo)) 
-    {
-        inputs.push_back(data);
-    }
-
-}
-
 void parse_output_csv(
     const std::string& csv_file, 
     std::vector<FirstOrderDelayModelRegisterValues>& func_output)
@@ -207,4 +169,45 @@ TEST(CalcFodmRegisterValuesTest, PythonCompare)
         EXPECT_EQ(func_output.output_PPS, python_output[ii].output_PPS);
         EXPECT_EQ(func_output.first_output_timestamp, python_output[ii].first_output_timestamp);
     }
-}
\ No newline at end of file
+}
+
+// The batch functions should give the same results as calling the
+// single FODM functions in a loop.
+TEST(CalcFodmRegisterValuesTest, BatchMatchesScalar)
+{
+    std::vector<CsvInputs> test_input;
+    parse_input_csv("fodm_test_input.csv", test_input);
+    ASSERT_FALSE(test_input.empty());
+
+    const int NUM_FODMS = 200;
+    const double FODM_INTERVAL_MS = 10.0;
+
+    for (const CsvInputs& row : test_input)
+    {
+        // Consecutive FODMs sharing the sample rates and frequency shifts of the row
+        std::vector<FoPoly> fo_polys(NUM_FODMS, row.fo_poly);
+        for (int ii = 0; ii < NUM_FODMS; ii++)
+        {
+            fo_polys[ii].start_time_ms = row.fo_poly.start_time_ms + ii * FODM_INTERVAL_MS;
+            fo_polys[ii].stop_time_ms = fo_polys[ii].start_time_ms + FODM_INTERVAL_MS;
+            fo_polys[ii].poly[1] = row.fo_poly.poly[1] + row.fo_poly.poly[0] * ii * FODM_INTERVAL_MS / 1000.0;
+        }
+
+        std::vector<FirstOrderDelayModelRegisterValues> batch_output(NUM_FODMS);
+        std::vector<FirstOrderDelayModelRegisterValuesVer1> batch_output_v1(NUM_FODMS);
+        CalcFodmRegisterValues(fo_polys.data(), fo_polys.size(), row.input_sample_rate, row.output_sample_rate,
+            row.f_ds, row.f_as, row.f_wb, row.f_scfo, batch_output.data());
+        CalcFodmRegisterValuesV1(fo_polys.data(), fo_polys.size(), row.input_sample_rate, row.output_sample_rate,
+            row.f_ds, row.f_as, row.f_wb, row.f_scfo, batch_output_v1.data());
+
+        for (int ii = 0; ii < NUM_FODMS; ii++)
+        {
+            FirstOrderDelayModelRegisterValues expected = CalcFodmRegisterValues(fo_polys[ii], 
+                row.input_sample_rate, row.output_sample_rate, row.f_ds, row.f_as, row.f_wb, row.f_scfo);
+            FirstOrderDelayModelRegisterValuesVer1 expected_v1 = CalcFodmRegisterValuesV1(fo_polys[ii], 
+                row.input_sample_rate, row.output_sample_rate, row.f_ds, row.f_as, row.f_wb, row.f_scfo);
+            expect_reg_values_eq(expected, batch_output[ii]);
+            expect_reg_values_eq(expected_v1, batch_output_v1[ii]);
+        }
+    }
+}
@@ -0,0 +1,236 @@
+/***
+ * test_DelayModelStore.cpp
+ *
+ * The unit test driver for DelayModelStore. Lookups are expected to find
+ * the FODM covering a timestamp and its HODM, with newer entries replacing
+ * the later part of older ones, and to see consistent entries while a
+ * writer thread publishes and removes them.
+ *
+ ***/
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "DelayModelStore.h"
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+// num_fo_poly FODMs of interval_ms from start_time_ms. The HODM has one
+// coefficient, id, which is also the slope of its FODMs, and the intercept
+// of each FODM is its start time.
+DelayModelEntry make_entry(double start_time_ms, int num_fo_poly, double interval_ms, double id)
+{
+    DelayModelEntry entry;
+    entry.ho_start_time_ms = start_time_ms;
+    entry.ho_stop_time_ms = start_time_ms + num_fo_poly * interval_ms;
+    entry.ho_poly.assign(1, id);
+    entry.fo_polys.resize(num_fo_poly);
+    for (int ii = 0; ii < num_fo_poly; ii++)
+    {
+        FoPoly& fo_poly = entry.fo_polys[ii];
+        fo_poly.ho_poly_start_time_ms = start_time_ms;
+        fo_poly.start_time_ms = start_time_ms + ii * interval_ms;
+        fo_poly.stop_time_ms = start_time_ms + (ii + 1) * interval_ms;
+        fo_poly.poly[0] = id;
+        fo_poly.poly[1] = fo_poly.start_time_ms;
+    }
+    return entry;
+}
+
+}; // namespace
+
+TEST(DelayModelStoreTest, FindFodm)
+{
+    DelayModelStore store(2);
+    DelayModelStore::Reader reader(store);
+    FoPoly fo_poly;
+    EXPECT_FALSE(reader.FindFodm(0, 1000.0, fo_poly));
+
+    EXPECT_FALSE(store.Publish(0, DelayModelEntry()));
+    EXPECT_TRUE(store.Publish(0, make_entry(1000.0, 100, 10.0, 1.0)));
+    // a gap between the entries
+    EXPECT_TRUE(store.Publish(0, make_entry(3000.0, 100, 10.0, 2.0)));
+
+    EXPECT_FALSE(reader.FindFodm(0, 999.0, fo_poly));
+    ASSERT_TRUE(reader.FindFodm(0, 1000.0, fo_poly));
+    EXPECT_EQ(1000.0, fo_poly.start_time_ms);
+    EXPECT_EQ(1.0, fo_poly.poly[0]);
+    ASSERT_TRUE(reader.FindFodm(0, 1555.5, fo_poly));
+    EXPECT_EQ(1550.0, fo_poly.start_time_ms);
+    ASSERT_TRUE(reader.FindFodm(0, 1999.9, fo_poly));
+    EXPECT_EQ(1990.0, fo_poly.start_time_ms);
+    EXPECT_FALSE(reader.FindFodm(0, 2000.0, fo_poly));
+    EXPECT_FALSE(reader.FindFodm(0, 2500.0, fo_poly));
+    ASSERT_TRUE(reader.FindFodm(0, 3010.0, fo_poly));
+    EXPECT_EQ(3010.0, fo_poly.start_time_ms);
+    EXPECT_EQ(2.0, fo_poly.poly[0]);
+    EXPECT_FALSE(reader.FindFodm(0, 4000.0, fo_poly));
+
+    // the other receptor is empty
+    EXPECT_FALSE(reader.FindFodm(1, 1000.0, fo_poly));
+
+    double ho_start_time_ms = 0.0;
+    std::vector<double> ho_poly;
+    ASSERT_TRUE(reader.FindHodm(0, 3500.0, ho_start_time_ms, ho_poly));
+    EXPECT_EQ(3000.0, ho_start_time_ms);
+    EXPECT_EQ(std::vector<double>(1, 2.0), ho_poly);
+    EXPECT_FALSE(reader.FindHodm(0, 2500.0, ho_start_time_ms, ho_poly));
+}
+
+// A new entry ends the older entries at its first FODM, and replaces the
+// ones starting at or after it
+TEST(DelayModelStoreTest, NewerEntriesSupersede)
+{
+    DelayModelStore store(1);
+    DelayModelStore::Reader reader(store);
+    EXPECT_TRUE(store.Publish(0, make_entry(1000.0, 100, 10.0, 1.0)));
+    EXPECT_TRUE(store.Publish(0, make_entry(1500.0, 100, 10.0, 2.0)));
+
+    FoPoly fo_poly;
+    ASSERT_TRUE(reader.FindFodm(0, 1490.0, fo_poly));
+    EXPECT_EQ(1.0, fo_poly.poly[0]);
+    ASSERT_TRUE(reader.FindFodm(0, 1500.0, fo_poly));
+    EXPECT_EQ(2.0, fo_poly.poly[0]);
+    ASSERT_TRUE(reader.FindFodm(0, 2490.0, fo_poly));
+    EXPECT_EQ(2.0, fo_poly.poly[0]);
+
+    // replaces the previous entry, and the end of the first one
+    EXPECT_TRUE(store.Publish(0, make_entry(1200.0, 10, 10.0, 3.0)));
+    ASSERT_TRUE(reader.FindFodm(0, 1190.0, fo_poly));
+    EXPECT_EQ(1.0, fo_poly.poly[0]);
+    ASSERT_TRUE(reader.FindFodm(0, 1250.0, fo_poly));
+    EXPECT_EQ(3.0, fo_poly.poly[0]);
+    EXPECT_FALSE(reader.FindFodm(0, 1300.0, fo_poly));
+    EXPECT_FALSE(reader.FindFodm(0, 1500.0, fo_poly));
+}
+
+TEST(DelayModelStoreTest, RemoveBefore)
+{
+    DelayModelStore store(2);
+    DelayModelStore::Reader reader(store);
+    for (int rr = 0; rr < 2; rr++)
+    {
+        EXPECT_TRUE(store.Publish(rr, make_entry(1000.0, 100, 10.0, 1.0)));
+        EXPECT_TRUE(store.Publish(rr, make_entry(1500.0, 100, 10.0, 2.0)));
+    }
+
+    FoPoly fo_poly;
+    // the first entry ends at 1500 ms, where the second starts
+    store.RemoveBefore(1499.0);
+    EXPECT_TRUE(reader.FindFodm(0, 1000.0, fo_poly));
+    store.RemoveBefore(1500.0);
+    EXPECT_FALSE(reader.FindFodm(0, 1490.0, fo_poly));
+    EXPECT_FALSE(reader.FindFodm(1, 1490.0, fo_poly));
+    EXPECT_TRUE(reader.FindFodm(1, 1500.0, fo_poly));
+    store.RemoveBefore(2500.0);
+    EXPECT_FALSE(reader.FindFodm(1, 2490.0, fo_poly));
+
+    // the replaced snapshots are not marked by a Reader
+    EXPECT_EQ(0u, store.num_retired());
+}
+
+// Several Readers use the hazard pointers, and destroyed Readers leave
+// them to new ones
+TEST(DelayModelStoreTest, SeveralReaders)
+{
+    DelayModelStore store(1);
+    EXPECT_TRUE(store.Publish(0, make_entry(1000.0, 100, 10.0, 1.0)));
+    for (int ii = 0; ii < 3; ii++)
+    {
+        std::vector<std::unique_ptr<DelayModelStore::Reader>> readers;
+        for (int rr = 0; rr < 5; rr++)
+        {
+            readers.emplace_back(new DelayModelStore::Reader(store));
+        }
+        for (const std::unique_ptr<DelayModelStore::Reader>& reader : readers)
+        {
+            FoPoly fo_poly;
+            EXPECT_TRUE(reader->FindFodm(0, 1000.0, fo_poly));
+        }
+    }
+}
+
+// Readers looking up FODMs while a writer publishes new entries and removes
+// the old ones. Every FODM found must cover the timestamp and be consistent
+// with its entry.
+TEST(DelayModelStoreTest, ConcurrentReadersAndWriter)
+{
+    const int NUM_RECEPTORS = 4;
+    const int NUM_ENTRIES = 2000;
+    const int NUM_FO_POLY = 50;
+    const double INTERVAL_MS = 10.0;
+    const double ENTRY_LENGTH_MS = NUM_FO_POLY * INTERVAL_MS;
+    DelayModelStore store(NUM_RECEPTORS);
+    for (int rr = 0; rr < NUM_RECEPTORS; rr++)
+    {
+        EXPECT_TRUE(store.Publish(rr, make_entry(0.0, NUM_FO_POLY, INTERVAL_MS, 0.0)));
+    }
+
+    std::atomic<int> latest(0);
+    std::atomic<bool> done(false);
+    std::atomic<long> num_found(0);
+    std::atomic<long> num_errors(0);
+    std::vector<std::thread> readers;
+    for (int tt = 0; tt < 3; tt++)
+    {
+        readers.emplace_back([&, tt]()
+        {
+            DelayModelStore::Reader reader(store);
+            FoPoly fo_poly;
+            int count = 0;
+            while (!done)
+            {
+                int rr = count++ % NUM_RECEPTORS;
+                // within the latest entry, which the writer only removes
+                // after publishing two more
+                int entry = latest;
+                double time_ms = entry * ENTRY_LENGTH_MS + (count * 7 + tt) % NUM_FO_POLY * INTERVAL_MS + 1.0;
+                if (reader.FindFodm(rr, time_ms, fo_poly))
+                {
+                    num_found++;
+                    double id = static_cast<double>(fo_poly.poly[0]);
+                    if (fo_poly.start_time_ms > time_ms || fo_poly.stop_time_ms <= time_ms ||
+                        fo_poly.ho_poly_start_time_ms != id * ENTRY_LENGTH_MS ||
+                        fo_poly.poly[1] != fo_poly.start_time_ms)
+                    {
+                        num_errors++;
+                    }
+                }
+                else if (latest - entry < 2)
+                {
+                    num_errors++;
+                }
+            }
+        });
+    }
+
+    for (int ee = 1; ee < NUM_ENTRIES; ee++)
+    {
+        for (int rr = 0; rr < NUM_RECEPTORS; rr++)
+        {
+            store.Publish(rr, make_entry(ee * ENTRY_LENGTH_MS, NUM_FO_POLY, INTERVAL_MS, ee));
+        }
+        latest = ee;
+        store.RemoveBefore((ee - 1) * ENTRY_LENGTH_MS);
+        if (ee % 64 == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+    done = true;
+    for (std::thread& reader : readers)
+    {
+        reader.join();
+    }
+    EXPECT_EQ(0, num_errors);
+    EXPECT_GT(num_found, 0);
+
+    // nothing is marked once the readers are done
+    store.RemoveBefore(0.0);
+    store.Publish(0, make_entry(NUM_ENTRIES * ENTRY_LENGTH_MS, NUM_FO_POLY, INTERVAL_MS, NUM_ENTRIES));
+    EXPECT_EQ(0u, store.num_retired());
+}
@@ -9,8 +9,11 @@
  ***/
 #include <random>
 #include <fstream>
+#include <cfloat>
 #include <boost/multiprecision/cpp_bin_float.hpp> 
 #include "FirstOrderDelayModel.h"
+#include "DoubleDouble.h"
+#include "ThreadPool.h"
 
 #include "gtest/gtest.h"
 
@@ -92,7 +95,8 @@ protected:
         return int( (t - t_fo_poly_[0]) / fo_poly_interval);
     }
 
-    void lsq_fit_max_error_test_common(const double* ho_poly, double fo_poly_interval, int num_fodms, bool dump_csv, PolyvalStats& stats) 
+    void lsq_fit_max_error_test_common(const double* ho_poly, double fo_poly_interval, int num_fodms, bool dump_csv, PolyvalStats& stats,
+        PolyvalPrecision precision = PolyvalPrecision::Default, LsqFitMethod lsq_fit_method = LsqFitMethod::Sampled) 
     {
         std::cout << std::setprecision(12) << "HO Poly = { " << ho_poly[2] << ", " << ho_poly[3] << ", " 
             << ho_poly[4] << ", " << ho_poly[5] << ", " 
@@ -125,7 +129,7 @@ protected:
         }
         
         // LSQ fit
-        FirstOrderDelayModel test_model;
+        FirstOrderDelayModel test_model(precision, lsq_fit_method);
         bool result = test_model.process(hodm_t_start, hodm_t_stop, NUM_HO_COEFF, (ho_poly+2), NUM_LSQ_POINTS, num_fodms, t_fo_poly_, fo_polys_);
         EXPECT_TRUE(result);
 
@@ -382,4 +386,578 @@ TEST_F(FirstOrderDelayModelTest, DumpToFileTest)
     PolyvalStats stats;
 
     lsq_fit_max_error_test_common(ho_poly, fo_poly_interval, MAX_NUM_FODMS, true, stats);
-}
\ No newline at end of file
+}
+
+// Same as LsqFitMaxErrorTest2, with the HODM evaluated by the compensated Horner scheme
+TEST_F(FirstOrderDelayModelTest, DoubleDoubleLsqFitMaxErrorTest)
+{
+    double ho_poly[HO_POLY_LEN] = {
+        1.0000000000000E+01,3.0000000000000E+01,3.956738275640760941E-14,-1.885738529952905433E-12,
+        -9.731305625195973794E-09,6.899681529986780764E-04,1.100300531941965509E+01,-259508.7983 };
+    double fo_poly_interval = 0.01;
+    PolyvalStats stats;
+
+    lsq_fit_max_error_test_common(ho_poly, fo_poly_interval, MAX_NUM_FODMS, false, stats, PolyvalPrecision::DoubleDouble);
+}
+
+// The compensated Horner result should be within the documented error bound
+// of the polynomial evaluated in cpp_bin_float_50, for random polynomials
+// of degree 1 to 7 including some with a root close to the evaluation point.
+TEST(CompensatedHornerTest, ErrorBoundTest)
+{
+    using namespace boost::multiprecision;
+    const int MAX_NUM_COEFF = 8;
+    const int NUM_TESTS = 20000;
+    const double u = std::ldexp(1.0, -53);
+
+    std::mt19937 gen(3003);
+    std::uniform_real_distribution<> mantissa(-1.0, 1.0);
+    std::uniform_int_distribution<> exponent(-60, 20);
+    std::uniform_int_distribution<> num_coeff_dis(2, MAX_NUM_COEFF);
+    std::uniform_real_distribution<> x_dis(0.0, 30.0);
+
+    double poly[MAX_NUM_COEFF];
+    for (int ii = 0; ii < NUM_TESTS; ii++)
+    {
+        int num_coeff = num_coeff_dis(gen);
+        double x = x_dis(gen);
+        for (int jj = 0; jj < num_coeff; jj++)
+        {
+            poly[jj] = std::ldexp(mantissa(gen), exponent(gen));
+        }
+        if (ii % 2 == 1)
+        {
+            // make x nearly a root, so that p(x) cancels out
+            cpp_bin_float_50 y = poly[0];
+            for (int jj = 1; jj < num_coeff - 1; jj++)
+            {
+                y = y * x + poly[jj];
+            }
+            poly[num_coeff - 1] = -static_cast<double>(y * x);
+        }
+
+        cpp_bin_float_50 exact = poly[0];
+        cpp_bin_float_50 abs_poly = std::abs(poly[0]);
+        for (int jj = 1; jj < num_coeff; jj++)
+        {
+            exact = exact * x + poly[jj];
+            abs_poly = abs_poly * x + std::abs(poly[jj]);
+        }
+
+        int degree = num_coeff - 1;
+        double gamma = 2 * degree * u / (1 - 2 * degree * u);
+        // the cpp_bin_float_50 reference has its own rounding errors
+        cpp_bin_float_50 bound = gamma * gamma * abs_poly + abs_poly * std::ldexp(1.0, -150);
+
+        DoubleDouble y = CompensatedHorner(poly, num_coeff, x);
+        cpp_bin_float_50 err = abs(cpp_bin_float_50(y.hi) + y.lo - exact);
+        ASSERT_LE(err, bound) << "test " << ii << ", degree " << degree << ", x = " << x;
+    }
+}
+
+// The FODMs from both process() methods should agree with the cpp_bin_float_50
+// results to within long double precision when the HODM is evaluated with
+// the compensated Horner scheme.
+TEST_F(FirstOrderDelayModelTest, DoubleDoubleMatchesMultiPrecisionTest)
+{
+    double ho_poly[HO_POLY_LEN] = {
+        1.0000000000000E+01,3.0000000000000E+01,3.956738275640760941E-14,-1.885738529952905433E-12,
+        -9.731305625195973794E-09,6.899681529986780764E-04,1.100300531941965509E+01,-259508.7983 };
+    double fo_poly_interval = 0.01;
+    double hodm_t_start = ho_poly[0];
+    double hodm_t_stop = ho_poly[1];
+    for (int ii = 0 ; ii < MAX_NUM_FODMS+1; ii++) 
+    {
+        t_fo_poly_[ii] = hodm_t_start + fo_poly_interval * ii;
+    }
+
+    FirstOrderDelayModel default_model;
+    FirstOrderDelayModel mp_model(PolyvalPrecision::MultiPrecision);
+    FirstOrderDelayModel dd_model(PolyvalPrecision::DoubleDouble);
+    std::vector<long double> default_fo_polys, mp_fo_polys, dd_fo_polys;
+
+    // Two points per FODM. The default is cpp_bin_float_50.
+    EXPECT_TRUE(default_model.process(hodm_t_start, hodm_t_stop, NUM_HO_COEFF, (ho_poly+2), MAX_NUM_FODMS, t_fo_poly_, default_fo_polys));
+    EXPECT_TRUE(mp_model.process(hodm_t_start, hodm_t_stop, NUM_HO_COEFF, (ho_poly+2), MAX_NUM_FODMS, t_fo_poly_, mp_fo_polys));
+    EXPECT_TRUE(dd_model.process(hodm_t_start, hodm_t_stop, NUM_HO_COEFF, (ho_poly+2), MAX_NUM_FODMS, t_fo_poly_, dd_fo_polys));
+    EXPECT_EQ(default_fo_polys, mp_fo_polys);
+    for (int ii = 0; ii < MAX_NUM_FODMS; ii++)
+    {
+        // the delay constant is the HODM value rounded to long double, within an ulp;
+        // the delay linear is the difference of two of those over the FODM interval
+        long double ulp = std::abs(mp_fo_polys[ii*2+1]) * LDBL_EPSILON;
+        double interval = t_fo_poly_[ii+1] - t_fo_poly_[ii];
+        EXPECT_LE(std::abs(dd_fo_polys[ii*2+1] - mp_fo_polys[ii*2+1]), ulp) << "FODM " << ii;
+        EXPECT_LE(std::abs(dd_fo_polys[ii*2] - mp_fo_polys[ii*2]), 2 * ulp / interval + std::abs(mp_fo_polys[ii*2]) * LDBL_EPSILON) << "FODM " << ii;
+    }
+
+    // Least squares fitting, which sums up NUM_LSQ_POINTS+1 HODM values per FODM.
+    // Fewer FODMs since the cpp_bin_float_50 evaluation of all the points is slow.
+    const int num_lsq_fodms = 100;
+    EXPECT_TRUE(mp_model.process(hodm_t_start, hodm_t_stop, NUM_HO_COEFF, (ho_poly+2), NUM_LSQ_POINTS, num_lsq_fodms, t_fo_poly_, mp_fo_polys));
+    EXPECT_TRUE(dd_model.process(hodm_t_start, hodm_t_stop, NUM_HO_COEFF, (ho_poly+2), NUM_LSQ_POINTS, num_lsq_fodms, t_fo_poly_, dd_fo_polys));
+    for (int ii = 0; ii < num_lsq_fodms; ii++)
+    {
+        long double ulp = std::abs(mp_fo_polys[ii*2+1]) * LDBL_EPSILON;
+        double interval = t_fo_poly_[ii+1] - t_fo_poly_[ii];
+        EXPECT_LE(std::abs(dd_fo_polys[ii*2+1] - mp_fo_polys[ii*2+1]), 4 * ulp) << "FODM " << ii;
+        EXPECT_LE(std::abs(dd_fo_polys[ii*2] - mp_fo_polys[ii*2]), 16 * ulp / interval) << "FODM " << ii;
+    }
+}
+
+// The two point process() evaluates each FODM boundary once. The FODMs
+// should be bit-identical to evaluating the HODM at the start and stop
+// time of every FODM, and the returned boundary delays the HODM values.
+TEST_F(FirstOrderDelayModelTest, SharedBoundaryTest)
+{
+    double ho_poly[HO_POLY_LEN] = {
+        1.0000000000000E+01,3.0000000000000E+01,3.956738275640760941E-14,-1.885738529952905433E-12,
+        -9.731305625195973794E-09,6.899681529986780764E-04,1.100300531941965509E+01,-259508.7983 };
+    double fo_poly_interval = 0.01;
+    double hodm_t_start = ho_poly[0];
+    double hodm_t_stop = ho_poly[1];
+    for (int ii = 0 ; ii < MAX_NUM_FODMS+1; ii++) 
+    {
+        t_fo_poly_[ii] = hodm_t_start + fo_poly_interval * ii;
+    }
+
+    const PolyvalPrecision precisions[] = { PolyvalPrecision::MultiPrecision, PolyvalPrecision::DoubleDouble };
+    std::vector<long double> fo_t_delay;
+    for (PolyvalPrecision precision : precisions)
+    {
+        FirstOrderDelayModel test_model(precision);
+        EXPECT_TRUE(test_model.process(hodm_t_start, hodm_t_stop, NUM_HO_COEFF, (ho_poly+2), MAX_NUM_FODMS, t_fo_poly_, fo_polys_, fo_t_delay));
+        ASSERT_EQ(static_cast<size_t>(MAX_NUM_FODMS + 1), fo_t_delay.size());
+
+        for (int ii = 0; ii < MAX_NUM_FODMS; ii++)
+        {
+            double t1 = t_fo_poly_[ii] - hodm_t_start;
+            double t2 = t_fo_poly_[ii+1] - hodm_t_start;
+            long double y1, y2;
+            if (precision == PolyvalPrecision::MultiPrecision)
+            {
+                y1 = polyval(ho_poly+2, NUM_HO_COEFF, t1);
+                y2 = polyval(ho_poly+2, NUM_HO_COEFF, t2);
+            }
+            else
+            {
+                DoubleDouble y1_dd = CompensatedHorner(ho_poly+2, NUM_HO_COEFF, t1);
+                DoubleDouble y2_dd = CompensatedHorner(ho_poly+2, NUM_HO_COEFF, t2);
+                y1 = static_cast<long double>(y1_dd.hi) + y1_dd.lo;
+                y2 = static_cast<long double>(y2_dd.hi) + y2_dd.lo;
+            }
+            EXPECT_EQ(y1, fo_t_delay[ii]) << "FODM " << ii;
+            EXPECT_EQ(y1, fo_polys_[ii*2+1]) << "FODM " << ii;
+            EXPECT_EQ((y2 - y1) / (t2 - t1), fo_polys_[ii*2]) << "FODM " << ii;
+        }
+    }
+}
+
+// The closed form least squares fit should agree with the sampled fit over
+// the same points, with the HODM evaluated in cpp_bin_float_50. The fit
+// over the continuous interval is the limit of many fitting points.
+TEST_F(FirstOrderDelayModelTest, ClosedFormLsqTest)
+{
+    double ho_poly[HO_POLY_LEN] = {
+        1.0000000000000E+01,3.0000000000000E+01,3.956738275640760941E-14,-1.885738529952905433E-12,
+        -9.731305625195973794E-09,6.899681529986780764E-04,1.100300531941965509E+01,-259508.7983 };
+    double fo_poly_interval = 0.01;
+    double hodm_t_start = ho_poly[0];
+    double hodm_t_stop = ho_poly[1];
+    for (int ii = 0 ; ii < MAX_NUM_FODMS+1; ii++) 
+    {
+        t_fo_poly_[ii] = hodm_t_start + fo_poly_interval * ii;
+    }
+
+    FirstOrderDelayModel sampled_model(PolyvalPrecision::MultiPrecision, LsqFitMethod::Sampled);
+    FirstOrderDelayModel closed_form_model(PolyvalPrecision::MultiPrecision, LsqFitMethod::ClosedForm);
+    FirstOrderDelayModel continuous_model(PolyvalPrecision::Default, LsqFitMethod::Continuous);
+    std::vector<long double> sampled_fo_polys, closed_form_fo_polys, continuous_fo_polys;
+
+    const int num_lsq_fodms = 100;
+    const int num_lsq_points[] = { 1, 2, 10, NUM_LSQ_POINTS };
+    long double max_delta_const = 0;
+    long double max_delta_linear = 0;
+    for (int num_points : num_lsq_points)
+    {
+        EXPECT_TRUE(sampled_model.process(hodm_t_start, hodm_t_stop, NUM_HO_COEFF, (ho_poly+2), num_points, num_lsq_fodms, t_fo_poly_, sampled_fo_polys));
+        EXPECT_TRUE(closed_form_model.process(hodm_t_start, hodm_t_stop, NUM_HO_COEFF, (ho_poly+2), num_points, num_lsq_fodms, t_fo_poly_, closed_form_fo_polys));
+        for (int ii = 0; ii < num_lsq_fodms; ii++)
+        {
+            max_delta_const = std::max(max_delta_const, std::abs(closed_form_fo_polys[ii*2+1] - sampled_fo_polys[ii*2+1]));
+            max_delta_linear = std::max(max_delta_linear, std::abs(closed_form_fo_polys[ii*2] - sampled_fo_polys[ii*2]));
+        }
+    }
+    std::cout << "max(abs(delta)) delay constant = " << max_delta_const << " ns, delay linear = " << max_delta_linear << " ns/s" << std::endl;
+    EXPECT_LT(max_delta_const, 1.0e-10);
+    EXPECT_LT(max_delta_linear, 1.0e-8);
+
+    // Continuous interval against many fitting points
+    EXPECT_TRUE(continuous_model.process(hodm_t_start, hodm_t_stop, NUM_HO_COEFF, (ho_poly+2), NUM_LSQ_POINTS, MAX_NUM_FODMS, t_fo_poly_, continuous_fo_polys));
+    EXPECT_TRUE(closed_form_model.process(hodm_t_start, hodm_t_stop, NUM_HO_COEFF, (ho_poly+2), 100000, MAX_NUM_FODMS, t_fo_poly_, closed_form_fo_polys));
+    for (int ii = 0; ii < MAX_NUM_FODMS; ii++)
+    {
+        EXPECT_NEAR(closed_form_fo_polys[ii*2+1], continuous_fo_polys[ii*2+1], 1.0e-6) << "FODM " << ii;
+        EXPECT_NEAR(closed_form_fo_polys[ii*2], continuous_fo_polys[ii*2], 1.0e-4) << "FODM " << ii;
+    }
+
+    // The usual error checks against the HODM
+    PolyvalStats stats;
+    lsq_fit_max_error_test_common(ho_poly, fo_poly_interval, MAX_NUM_FODMS, false, stats,
+        PolyvalPrecision::Default, LsqFitMethod::ClosedForm);
+    lsq_fit_max_error_test_common(ho_poly, fo_poly_interval, MAX_NUM_FODMS, false, stats,
+        PolyvalPrecision::Default, LsqFitMethod::Continuous);
+}
+
+// The Taylor shift re-centering should give the delay constants of the
+// cpp_bin_float_50 two point process() to within an ulp of long double, and
+// the exact slope between the two points, without the cancellation of the
+// delays at the start and stop times.
+TEST_F(FirstOrderDelayModelTest, TaylorShiftMatchesMultiPrecisionTest)
+{
+    using namespace boost::multiprecision;
+    double ho_poly[HO_POLY_LEN] = {
+        1.0000000000000E+01,3.0000000000000E+01,3.956738275640760941E-14,-1.885738529952905433E-12,
+        -9.731305625195973794E-09,6.899681529986780764E-04,1.100300531941965509E+01,-259508.7983 };
+    double fo_poly_interval = 0.01;
+    double hodm_t_start = ho_poly[0];
+    double hodm_t_stop = ho_poly[1];
+    for (int ii = 0 ; ii < MAX_NUM_FODMS+1; ii++) 
+    {
+        t_fo_poly_[ii] = hodm_t_start + fo_poly_interval * ii;
+    }
+
+    FirstOrderDelayModel mp_model(PolyvalPrecision::MultiPrecision);
+    FirstOrderDelayModel ts_model(PolyvalPrecision::TaylorShift);
+    std::vector<long double> mp_fo_polys, ts_fo_polys, ts_fo_t_delay;
+
+    EXPECT_TRUE(mp_model.process(hodm_t_start, hodm_t_stop, NUM_HO_COEFF, (ho_poly+2), MAX_NUM_FODMS, t_fo_poly_, mp_fo_polys));
+    EXPECT_TRUE(ts_model.process(hodm_t_start, hodm_t_stop, NUM_HO_COEFF, (ho_poly+2), MAX_NUM_FODMS, t_fo_poly_, ts_fo_polys, ts_fo_t_delay));
+    long double max_mp_slope_error = 0;
+    long double max_ts_slope_error = 0;
+    for (int ii = 0; ii < MAX_NUM_FODMS; ii++)
+    {
+        double t1 = t_fo_poly_[ii] - hodm_t_start;
+        double t2 = t_fo_poly_[ii+1] - hodm_t_start;
+        cpp_bin_float_50 y1 = ho_poly[2];
+        cpp_bin_float_50 y2 = ho_poly[2];
+        for (int k = 1; k < NUM_HO_COEFF; k++)
+        {
+            y1 = y1 * t1 + ho_poly[k+2];
+            y2 = y2 * t2 + ho_poly[k+2];
+        }
+        long double exact_slope = static_cast<long double>((y2 - y1) / (t2 - t1));
+
+        long double ulp = std::abs(mp_fo_polys[ii*2+1]) * LDBL_EPSILON;
+        EXPECT_LE(std::abs(ts_fo_polys[ii*2+1] - mp_fo_polys[ii*2+1]), ulp) << "FODM " << ii;
+        EXPECT_EQ(ts_fo_polys[ii*2+1], ts_fo_t_delay[ii]) << "FODM " << ii;
+        EXPECT_LE(std::abs(ts_fo_polys[ii*2] - exact_slope), 2 * std::abs(exact_slope) * LDBL_EPSILON) << "FODM " << ii;
+        max_mp_slope_error = std::max(max_mp_slope_error, std::abs(mp_fo_polys[ii*2] - exact_slope));
+        max_ts_slope_error = std::max(max_ts_slope_error, std::abs(ts_fo_polys[ii*2] - exact_slope));
+    }
+    long double last_delay = static_cast<long double>(polyval(ho_poly+2, NUM_HO_COEFF, t_fo_poly_[MAX_NUM_FODMS] - hodm_t_start));
+    EXPECT_LE(std::abs(ts_fo_t_delay[MAX_NUM_FODMS] - last_delay), std::abs(last_delay) * LDBL_EPSILON);
+    std::cout << "max slope error: cpp_bin_float_50 = " << max_mp_slope_error
+        << " ns/s, Taylor shift = " << max_ts_slope_error << " ns/s" << std::endl;
+
+    // Least squares fitting. The fitting points are not rounded to double
+    // relative to the HODM start, so the sums of the normal equations round
+    // differently from the cpp_bin_float_50 fit.
+    const int num_lsq_fodms = 100;
+    EXPECT_TRUE(mp_model.process(hodm_t_start, hodm_t_stop, NUM_HO_COEFF, (ho_poly+2), NUM_LSQ_POINTS, num_lsq_fodms, t_fo_poly_, mp_fo_polys));
+    EXPECT_TRUE(ts_model.process(hodm_t_start, hodm_t_stop, NUM_HO_COEFF, (ho_poly+2), NUM_LSQ_POINTS, num_lsq_fodms, t_fo_poly_, ts_fo_polys));
+    for (int ii = 0; ii < num_lsq_fodms; ii++)
+    {
+        long double ulp = std::abs(mp_fo_polys[ii*2+1]) * LDBL_EPSILON;
+        double interval = t_fo_poly_[ii+1] - t_fo_poly_[ii];
+        EXPECT_LE(std::abs(ts_fo_polys[ii*2+1] - mp_fo_polys[ii*2+1]), 16 * ulp) << "FODM " << ii;
+        EXPECT_LE(std::abs(ts_fo_polys[ii*2] - mp_fo_polys[ii*2]), 16 * ulp / interval) << "FODM " << ii;
+    }
+
+    PolyvalStats stats;
+    lsq_fit_max_error_test_common(ho_poly, fo_poly_interval, MAX_NUM_FODMS, false, stats, PolyvalPrecision::TaylorShift);
+}
+
+// The minimax fit should halve the maximum error of the two point fit for a
+// quadratic delay, and report the maximum error found by sampling each FODM
+// densely, also when the curvature changes sign within the FODM.
+TEST_F(FirstOrderDelayModelTest, MinimaxFitTest)
+{
+    const int num_fodms = 20;
+    const int num_samples = 400;
+
+    // maximum of |HODM - FODM| over num_samples + 1 points of each FODM
+    auto sampled_max_error = [&](const double* ho_poly, int ii)
+    {
+        long double max_error = 0;
+        double fo_t_start = t_fo_poly_[ii];
+        double fo_t_stop = t_fo_poly_[ii+1];
+        for (int j = 0; j <= num_samples; j++)
+        {
+            double t = fo_t_start + (fo_t_stop - fo_t_start) * j / num_samples;
+            long double val_from_ho = polyval((ho_poly+2), NUM_HO_COEFF, t - ho_poly[0]);
+            long double val_from_fo = fo_polys_[ii*2+1] + fo_polys_[ii*2] * (t - fo_t_start);
+            max_error = std::max(max_error, std::abs(val_from_ho - val_from_fo));
+        }
+        return max_error;
+    };
+
+    // Quadratic delay: the maximum errors over an interval L are
+    // a2 * L^2 / 8 for minimax, / 6 for continuous least squares and
+    // / 4 for the two point fit.
+    {
+        double ho_poly[HO_POLY_LEN] = {
+            0.0000000000000E+00,3.0000000000000E+01,0.0000000000000E+00,0.0000000000000E+00,
+            0.0000000000000E+00,6.899681529986780764E-04,1.100300531941965509E+01,-259508.7983 };
+        double fo_poly_interval = 0.1;
+        for (int ii = 0 ; ii < num_fodms+1; ii++) 
+        {
+            t_fo_poly_[ii] = ho_poly[0] + fo_poly_interval * ii;
+        }
+        const double a2_l2 = ho_poly[5] * fo_poly_interval * fo_poly_interval;
+        const LsqFitMethod methods[] = { LsqFitMethod::Minimax, LsqFitMethod::Continuous, LsqFitMethod::Sampled };
+        const double expected_error[] = { a2_l2 / 8, a2_l2 / 6, a2_l2 / 4 };
+        for (int mm = 0; mm < 3; mm++)
+        {
+            FirstOrderDelayModel test_model(PolyvalPrecision::MultiPrecision, methods[mm]);
+            std::vector<long double> fo_max_error;
+            // least squares over two points is the two point fit
+            EXPECT_TRUE(test_model.process(ho_poly[0], ho_poly[1], NUM_HO_COEFF, (ho_poly+2), 1, num_fodms, t_fo_poly_, fo_polys_, fo_max_error));
+            ASSERT_EQ(num_fodms, fo_max_error.size());
+            for (int ii = 0; ii < num_fodms; ii++)
+            {
+                EXPECT_NEAR(expected_error[mm], fo_max_error[ii], 1.0e-12) << "method " << mm << ", FODM " << ii;
+                EXPECT_NEAR(expected_error[mm], sampled_max_error(ho_poly, ii), 1.0e-12) << "method " << mm << ", FODM " << ii;
+            }
+        }
+    }
+
+    // HODM generated from MATLAB, in double and in long double
+    {
+        double ho_poly[HO_POLY_LEN] = {
+            1.0000000000000E+01,3.0000000000000E+01,3.956738275640760941E-14,-1.885738529952905433E-12,
+            -9.731305625195973794E-09,6.899681529986780764E-04,1.100300531941965509E+01,-259508.7983 };
+        double fo_poly_interval = 0.5;
+        for (int ii = 0 ; ii < num_fodms+1; ii++) 
+        {
+            t_fo_poly_[ii] = ho_poly[0] + fo_poly_interval * ii;
+        }
+        FirstOrderDelayModel lsq_model(PolyvalPrecision::MultiPrecision, LsqFitMethod::Continuous);
+        std::vector<long double> lsq_fo_polys, lsq_max_error;
+        EXPECT_TRUE(lsq_model.process(ho_poly[0], ho_poly[1], NUM_HO_COEFF, (ho_poly+2), NUM_LSQ_POINTS, num_fodms, t_fo_poly_, lsq_fo_polys, lsq_max_error));
+
+        const PolyvalPrecision precisions[] = { PolyvalPrecision::Default, PolyvalPrecision::MultiPrecision };
+        for (PolyvalPrecision precision : precisions)
+        {
+            FirstOrderDelayModel test_model(precision, LsqFitMethod::Minimax);
+            std::vector<long double> fo_max_error;
+            EXPECT_TRUE(test_model.process(ho_poly[0], ho_poly[1], NUM_HO_COEFF, (ho_poly+2), NUM_LSQ_POINTS, num_fodms, t_fo_poly_, fo_polys_, fo_max_error));
+            // the arithmetic of the fit
+            const long double tolerance = precision == PolyvalPrecision::Default ? 1.0e-10 : 1.0e-12;
+            for (int ii = 0; ii < num_fodms; ii++)
+            {
+                long double sampled = sampled_max_error(ho_poly, ii);
+                EXPECT_LE(sampled, fo_max_error[ii] + tolerance) << "FODM " << ii;
+                EXPECT_GE(sampled, fo_max_error[ii] * (1 - 1.0e-4) - tolerance) << "FODM " << ii;
+                EXPECT_LT(fo_max_error[ii], lsq_max_error[ii]) << "FODM " << ii;
+            }
+        }
+    }
+
+    // Cubic delay with the inflection point at the center of the FODM, where
+    // the minimax line is the Chebyshev series truncated after T_1
+    {
+        double ho_poly[HO_POLY_LEN] = {
+            0.0000000000000E+00,3.0000000000000E+01,0.0000000000000E+00,0.0000000000000E+00,
+            1.0000000000000E+00,-1.5000000000000E+00,7.5000000000000E-01,1.0000000000000E+03 };
+        t_fo_poly_[0] = 0.0;
+        t_fo_poly_[1] = 1.0;
+        FirstOrderDelayModel test_model(PolyvalPrecision::Default, LsqFitMethod::Minimax);
+        std::vector<long double> fo_max_error;
+        EXPECT_TRUE(test_model.process(ho_poly[0], ho_poly[1], NUM_HO_COEFF, (ho_poly+2), NUM_LSQ_POINTS, 1, t_fo_poly_, fo_polys_, fo_max_error));
+        // (t - 0.5)^3 = u^3 / 8 = (3 * T_1(u) + T_3(u)) / 32 with u = 2 * t - 1
+        EXPECT_NEAR(1.0 / 32, fo_max_error[0], 1.0e-12);
+        EXPECT_NEAR(1.0 / 32, sampled_max_error(ho_poly, 0), 1.0e-12);
+        EXPECT_NEAR(3.0 / 16, fo_polys_[0], 1.0e-12);
+    }
+
+    PolyvalStats stats;
+    double ho_poly[HO_POLY_LEN] = {
+        1.0000000000000E+01,3.0000000000000E+01,3.956738275640760941E-14,-1.885738529952905433E-12,
+        -9.731305625195973794E-09,6.899681529986780764E-04,1.100300531941965509E+01,-259508.7983 };
+    lsq_fit_max_error_test_common(ho_poly, 0.01, MAX_NUM_FODMS, false, stats,
+        PolyvalPrecision::Default, LsqFitMethod::Minimax);
+}
+
+// The adaptive segmentation should cover the span with FODMs that meet the
+// tolerance and the length limits, each as long as the tolerance allows, so
+// that a delay curving faster over time needs fewer FODMs than a uniform
+// grid sized for the largest curvature.
+TEST_F(FirstOrderDelayModelTest, AdaptiveSegmentationTest)
+{
+    // cubic delay, the curvature grows from 0 at the HODM start
+    double ho_poly[HO_POLY_LEN] = {
+        0.0000000000000E+00,3.0000000000000E+01,0.0000000000000E+00,0.0000000000000E+00,
+        1.0000000000000E-05,0.0000000000000E+00,1.100300531941965509E+01,-259508.7983 };
+    const double t_start = 0.0;
+    const double t_stop = 20.0;
+    const double max_error = 1.0e-8;
+    const double min_length = 1.0e-3;
+    const double max_length = 1.0;
+
+    // the least squares fit in long double, so that its rounding does not
+    // show in the errors of the FODM extensions below
+    const LsqFitMethod methods[] = { LsqFitMethod::Minimax, LsqFitMethod::Continuous };
+    const PolyvalPrecision precisions[] = { PolyvalPrecision::Default, PolyvalPrecision::MultiPrecision };
+    for (int mm = 0; mm < 2; mm++)
+    {
+        FirstOrderDelayModel test_model(precisions[mm], methods[mm]);
+        std::vector<double> fo_t_start;
+        std::vector<long double> fo_max_error;
+        EXPECT_TRUE(test_model.process_adaptive(ho_poly[0], ho_poly[1], NUM_HO_COEFF, (ho_poly+2), NUM_LSQ_POINTS,
+            t_start, t_stop, max_error, min_length, max_length, fo_t_start, fo_polys_, fo_max_error));
+
+        int num_fodms = fo_t_start.size() - 1;
+        ASSERT_GE(num_fodms, 1);
+        ASSERT_EQ(num_fodms * 2, fo_polys_.size());
+        ASSERT_EQ(num_fodms, fo_max_error.size());
+        EXPECT_EQ(t_start, fo_t_start.front());
+        EXPECT_EQ(t_stop, fo_t_start.back());
+
+        std::vector<double> t_fo(2);
+        std::vector<long double> fo_poly, extended_error;
+        for (int ii = 0; ii < num_fodms; ii++)
+        {
+            double length = fo_t_start[ii+1] - fo_t_start[ii];
+            EXPECT_LE(fo_max_error[ii], max_error) << "FODM " << ii;
+            EXPECT_GE(length, min_length * (1 - 1.0e-12)) << "FODM " << ii;
+            EXPECT_LE(length, max_length * (1 + 1.0e-12)) << "FODM " << ii;
+
+            // all but the last two FODMs cannot be extended
+            if (ii < num_fodms - 2 && length < max_length * (1 - 1.0e-12))
+            {
+                t_fo[0] = fo_t_start[ii];
+                t_fo[1] = fo_t_start[ii] + length * (1 + 1.0e-5);
+                test_model.process(ho_poly[0], ho_poly[1], NUM_HO_COEFF, (ho_poly+2), NUM_LSQ_POINTS, 1, t_fo, fo_poly, extended_error);
+                EXPECT_GT(extended_error[0], max_error) << "FODM " << ii;
+            }
+        }
+
+        // uniform FODMs need the length allowed at the largest curvature,
+        // and the adaptive FODMs get longer where the curvature is smaller
+        EXPECT_LT(fo_t_start[num_fodms / 2 + 1] - fo_t_start[num_fodms / 2], fo_t_start[1] - fo_t_start[0]);
+        double uniform_length = fo_t_start[num_fodms - 1] - fo_t_start[num_fodms - 2];
+        int num_uniform_fodms = std::ceil((t_stop - t_start) / uniform_length);
+        std::cout << "adaptive FODMs = " << num_fodms << ", uniform FODMs = " << num_uniform_fodms << std::endl;
+        EXPECT_LT(num_fodms, num_uniform_fodms);
+    }
+
+    // A linear delay is fitted exactly with FODMs of max_length
+    {
+        double linear_poly[HO_POLY_LEN] = {
+            0.0000000000000E+00,3.0000000000000E+01,0.0000000000000E+00,0.0000000000000E+00,
+            0.0000000000000E+00,0.0000000000000E+00,1.8070000000000E+00,-55910.224908};
+        FirstOrderDelayModel test_model(PolyvalPrecision::Default, LsqFitMethod::Minimax);
+        std::vector<double> fo_t_start;
+        std::vector<long double> fo_max_error;
+        EXPECT_TRUE(test_model.process_adaptive(linear_poly[0], linear_poly[1], NUM_HO_COEFF, (linear_poly+2), NUM_LSQ_POINTS,
+            0.0, 10.0, max_error, min_length, 2.5, fo_t_start, fo_polys_, fo_max_error));
+        ASSERT_EQ(5u, fo_t_start.size());
+        for (int ii = 0; ii < 5; ii++)
+        {
+            EXPECT_EQ(2.5 * ii, fo_t_start[ii]);
+        }
+
+        // The 9 s span is split into three FODMs of min_length rather than
+        // leaving 5 s after a first FODM of max_length
+        const double long_min_length = 3.0;
+        EXPECT_TRUE(test_model.process_adaptive(linear_poly[0], linear_poly[1], NUM_HO_COEFF, (linear_poly+2), NUM_LSQ_POINTS,
+            0.0, 9.0, max_error, long_min_length, 4.0, fo_t_start, fo_polys_, fo_max_error));
+        ASSERT_EQ(4u, fo_t_start.size());
+        EXPECT_EQ(3.0, fo_t_start[1]);
+        EXPECT_EQ(6.0, fo_t_start[2]);
+        EXPECT_EQ(9.0, fo_t_start[3]);
+
+        // Spans of 3 to 4, 6 to 8 or 9 to 12 s can be split into FODMs of 3
+        // to 4 s, the others only with the last FODM past max_length
+        for (double t_stop_short = 7.25; t_stop_short < 10.0; t_stop_short += 0.25)
+        {
+            bool can_split = t_stop_short <= 8.0 || t_stop_short >= 9.0;
+            EXPECT_EQ(can_split, test_model.process_adaptive(linear_poly[0], linear_poly[1], NUM_HO_COEFF,
+                (linear_poly+2), NUM_LSQ_POINTS, 0.0, t_stop_short, max_error, long_min_length, 4.0, fo_t_start,
+                fo_polys_, fo_max_error)) << "t_stop " << t_stop_short;
+            EXPECT_EQ(t_stop_short, fo_t_start.back());
+            for (size_t ii = 0; ii + 1 < fo_t_start.size(); ii++)
+            {
+                double length = fo_t_start[ii+1] - fo_t_start[ii];
+                EXPECT_GE(length, long_min_length) << "t_stop " << t_stop_short << " FODM " << ii;
+                if (can_split || ii + 2 < fo_t_start.size())
+                {
+                    EXPECT_LE(length, 4.0) << "t_stop " << t_stop_short << " FODM " << ii;
+                }
+            }
+        }
+
+        // A span shorter than min_length
+        EXPECT_FALSE(test_model.process_adaptive(linear_poly[0], linear_poly[1], NUM_HO_COEFF, (linear_poly+2),
+            NUM_LSQ_POINTS, 0.0, 2.0, max_error, long_min_length, 4.0, fo_t_start, fo_polys_, fo_max_error));
+        ASSERT_EQ(2u, fo_t_start.size());
+        EXPECT_EQ(2.0, fo_t_start[1]);
+    }
+
+    // A tolerance that min_length cannot meet, and FODMs beyond the HODM
+    {
+        FirstOrderDelayModel test_model(PolyvalPrecision::Default, LsqFitMethod::Minimax);
+        std::vector<double> fo_t_start;
+        std::vector<long double> fo_max_error;
+        EXPECT_FALSE(test_model.process_adaptive(ho_poly[0], ho_poly[1], NUM_HO_COEFF, (ho_poly+2), NUM_LSQ_POINTS,
+            19.0, 20.0, 1.0e-15, 0.1, max_length, fo_t_start, fo_polys_, fo_max_error));
+        // FODMs of min_length, the last one also taking the rounding
+        // remainder of the span rather than leaving a FODM just short of it
+        EXPECT_EQ(10u, fo_t_start.size());
+        for (size_t ii = 0; ii + 1 < fo_t_start.size(); ii++)
+        {
+            EXPECT_GE(fo_t_start[ii+1] - fo_t_start[ii], 0.1) << "FODM " << ii;
+        }
+        EXPECT_FALSE(test_model.process_adaptive(ho_poly[0], ho_poly[1], NUM_HO_COEFF, (ho_poly+2), NUM_LSQ_POINTS,
+            29.0, 31.0, max_error, min_length, max_length, fo_t_start, fo_polys_, fo_max_error));
+    }
+}
+
+// The parallel process() should give the same FODMs as the serial one for
+// every precision and fit method, with one const model shared by the threads
+TEST_F(FirstOrderDelayModelTest, ParallelMatchesSerialTest)
+{
+    double ho_poly[HO_POLY_LEN] = {
+        1.0000000000000E+01,3.0000000000000E+01,3.956738275640760941E-14,-1.885738529952905433E-12,
+        -9.731305625195973794E-09,6.899681529986780764E-04,1.100300531941965509E+01,-259508.7983 };
+    for (int ii = 0 ; ii < MAX_NUM_FODMS+1; ii++) 
+    {
+        t_fo_poly_[ii] = ho_poly[0] + 0.01 * ii;
+    }
+    // the last FODM beyond the HODM
+    t_fo_poly_[MAX_NUM_FODMS] = ho_poly[1] + 1.0;
+
+    ThreadPool pool(4);
+    std::vector<long double> expected, fo_polys;
+    const PolyvalPrecision precisions[] = {
+        PolyvalPrecision::MultiPrecision, PolyvalPrecision::DoubleDouble, PolyvalPrecision::TaylorShift };
+    for (PolyvalPrecision precision : precisions)
+    {
+        const FirstOrderDelayModel model(precision);
+        EXPECT_FALSE(model.process(ho_poly[0], ho_poly[1], NUM_HO_COEFF, (ho_poly+2), MAX_NUM_FODMS, t_fo_poly_, expected));
+        EXPECT_FALSE(model.process(ho_poly[0], ho_poly[1], NUM_HO_COEFF, (ho_poly+2), MAX_NUM_FODMS, t_fo_poly_, fo_polys, pool));
+        EXPECT_EQ(expected, fo_polys) << "precision " << static_cast<int>(precision);
+        EXPECT_TRUE(model.process(ho_poly[0], ho_poly[1], NUM_HO_COEFF, (ho_poly+2), MAX_NUM_FODMS - 1, t_fo_poly_, fo_polys, pool));
+    }
+
+    const LsqFitMethod methods[] = {
+        LsqFitMethod::Sampled, LsqFitMethod::ClosedForm, LsqFitMethod::Continuous, LsqFitMethod::Minimax };
+    for (LsqFitMethod method : methods)
+    {
+        const FirstOrderDelayModel model(PolyvalPrecision::Default, method);
+        EXPECT_FALSE(model.process(ho_poly[0], ho_poly[1], NUM_HO_COEFF, (ho_poly+2), NUM_LSQ_POINTS, MAX_NUM_FODMS, t_fo_poly_, expected));
+        EXPECT_FALSE(model.process(ho_poly[0], ho_poly[1], NUM_HO_COEFF, (ho_poly+2), NUM_LSQ_POINTS, MAX_NUM_FODMS, t_fo_poly_, fo_polys, pool));
+        EXPECT_EQ(expected, fo_polys) << "method " << static_cast<int>(method);
+    }
+}
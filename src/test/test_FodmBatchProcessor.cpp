@@ -0,0 +1,159 @@
+/***
+ * test_FodmBatchProcessor.cpp
+ *
+ * The unit test driver for FodmBatchProcessor. The FODMs generated for a
+ * batch of receptors are expected to be bit-identical to the ones of the
+ * two point FirstOrderDelayModel::process with the double-double precision,
+ * run on each receptor, for every SIMD kernel, and serially or in parallel.
+ *
+ ***/
+#include <random>
+#include <vector>
+#include "FirstOrderDelayModel.h"
+#include "FodmBatchProcessor.h"
+#include "ThreadPool.h"
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+const int NUM_HO_COEFF = 6;
+
+// num_receptors random HODMs like the MATLAB generated ones, starting
+// within 1 s of 10 s and valid for 20 s
+HodmBatch make_hodm_batch(int num_receptors, std::mt19937& gen)
+{
+    std::uniform_real_distribution<> distr(-1.0, 1.0);
+    const double scale[NUM_HO_COEFF] = { 4.0e-14, 2.0e-12, 1.0e-8, 7.0e-4, 11.0, 2.6e5 };
+
+    HodmBatch hodms;
+    hodms.num_receptors = num_receptors;
+    hodms.num_ho_coeff = NUM_HO_COEFF;
+    hodms.coeff.resize(NUM_HO_COEFF * num_receptors);
+    hodms.t_start.resize(num_receptors);
+    hodms.t_stop.resize(num_receptors);
+    for (int rr = 0; rr < num_receptors; rr++)
+    {
+        for (int kk = 0; kk < NUM_HO_COEFF; kk++)
+        {
+            hodms.coeff[kk * num_receptors + rr] = distr(gen) * scale[kk];
+        }
+        hodms.t_start[rr] = 9.0 + 0.5 * (distr(gen) + 1.0);
+        hodms.t_stop[rr] = hodms.t_start[rr] + 20.0;
+    }
+    return hodms;
+}
+
+TEST(FodmBatchProcessorTest, MatchesFirstOrderDelayModel)
+{
+    std::mt19937 gen(2013);
+    const int num_fo_poly = 500;
+    std::vector<double> fo_t_start(num_fo_poly + 1);
+    for (int ii = 0; ii <= num_fo_poly; ii++)
+    {
+        fo_t_start[ii] = 10.0 + ii * 0.01;
+    }
+
+    const HornerKernel kernels[] = {
+        HornerKernel::Auto, HornerKernel::Scalar, HornerKernel::Avx2, HornerKernel::Avx512, HornerKernel::Neon };
+    for (int num_receptors : { 1, 7, 200 })
+    {
+        HodmBatch hodms = make_hodm_batch(num_receptors, gen);
+
+        // the reference, one receptor at a time
+        FirstOrderDelayModel model(PolyvalPrecision::DoubleDouble);
+        std::vector<std::vector<long double>> expected(num_receptors);
+        std::vector<double> ho_poly(NUM_HO_COEFF);
+        for (int rr = 0; rr < num_receptors; rr++)
+        {
+            for (int kk = 0; kk < NUM_HO_COEFF; kk++)
+            {
+                ho_poly[kk] = hodms.coeff[kk * num_receptors + rr];
+            }
+            EXPECT_TRUE(model.process(hodms.t_start[rr], hodms.t_stop[rr], NUM_HO_COEFF, ho_poly.data(),
+                num_fo_poly, fo_t_start, expected[rr]));
+        }
+
+        for (HornerKernel kernel : kernels)
+        {
+            FodmBatchProcessor processor(num_receptors, kernel);
+            FodmBatch fodms;
+            EXPECT_TRUE(processor.process(hodms, num_fo_poly, fo_t_start, fodms));
+            ASSERT_EQ(num_receptors, fodms.num_receptors);
+            ASSERT_EQ(num_fo_poly, fodms.num_fo_poly);
+            ASSERT_EQ(num_fo_poly * num_receptors, fodms.delay_linear.size());
+            ASSERT_EQ(num_fo_poly * num_receptors, fodms.delay_const.size());
+            for (int ii = 0; ii < num_fo_poly; ii++)
+            {
+                for (int rr = 0; rr < num_receptors; rr++)
+                {
+                    ASSERT_EQ(expected[rr][ii*2], fodms.delay_linear[ii * num_receptors + rr])
+                        << "kernel " << static_cast<int>(kernel) << ", receptor " << rr << ", FODM " << ii;
+                    ASSERT_EQ(expected[rr][ii*2+1], fodms.delay_const[ii * num_receptors + rr])
+                        << "kernel " << static_cast<int>(kernel) << ", receptor " << rr << ", FODM " << ii;
+                }
+            }
+
+            // processing again reuses the output
+            const long double* delay_linear = fodms.delay_linear.data();
+            EXPECT_TRUE(processor.process(hodms, num_fo_poly, fo_t_start, fodms));
+            EXPECT_EQ(delay_linear, fodms.delay_linear.data());
+        }
+    }
+}
+
+TEST(FodmBatchProcessorTest, TimeInputs)
+{
+    std::mt19937 gen(2014);
+    const int num_receptors = 9;
+    HodmBatch hodms = make_hodm_batch(num_receptors, gen);
+    FodmBatchProcessor processor(num_receptors);
+    FodmBatch fodms;
+
+    std::vector<double> fo_t_start = { 10.0, 10.5, 11.0 };
+    EXPECT_TRUE(processor.process(hodms, 2, fo_t_start, fodms));
+
+    // before the start of one HODM
+    hodms.t_start[4] = 10.25;
+    EXPECT_FALSE(processor.process(hodms, 2, fo_t_start, fodms));
+    hodms.t_start[4] = 10.0;
+
+    // beyond the stop of one HODM
+    hodms.t_stop[8] = 10.75;
+    EXPECT_FALSE(processor.process(hodms, 2, fo_t_start, fodms));
+    hodms.t_stop[8] = 30.0;
+
+    // FO times going backwards
+    fo_t_start = { 10.0, 11.0, 10.5 };
+    EXPECT_FALSE(processor.process(hodms, 2, fo_t_start, fodms));
+}
+
+// The parallel process splits the receptors into blocks and the FOs into
+// ranges, with the same results, also for a processor shared by threads
+TEST(FodmBatchProcessorTest, ParallelMatchesSerial)
+{
+    std::mt19937 gen(2015);
+    const int num_fo_poly = 333;
+    std::vector<double> fo_t_start(num_fo_poly + 1);
+    for (int ii = 0; ii <= num_fo_poly; ii++)
+    {
+        fo_t_start[ii] = 10.0 + ii * 0.01;
+    }
+
+    for (int num_receptors : { 1, 63, 200 })
+    {
+        HodmBatch hodms = make_hodm_batch(num_receptors, gen);
+        const FodmBatchProcessor processor(num_receptors);
+        FodmBatch expected;
+        EXPECT_TRUE(processor.process(hodms, num_fo_poly, fo_t_start, expected));
+
+        for (unsigned num_threads : { 1u, 3u, 8u })
+        {
+            ThreadPool pool(num_threads);
+            FodmBatch fodms;
+            EXPECT_TRUE(processor.process(hodms, num_fo_poly, fo_t_start, fodms, pool));
+            EXPECT_EQ(expected.delay_linear, fodms.delay_linear) << num_threads << " threads";
+            EXPECT_EQ(expected.delay_const, fodms.delay_const) << num_threads << " threads";
+        }
+    }
+}
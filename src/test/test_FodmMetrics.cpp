@@ -0,0 +1,236 @@
+/***
+ * test_FodmMetrics.cpp
+ *
+ * The unit test driver for the FODM generation metrics. The metrics are
+ * process wide and only grow, so each test compares the snapshots taken
+ * before and after the calls it makes. The tests are skipped if the
+ * library is built without FODM_METRICS.
+ *
+ ***/
+#include <string>
+#include <thread>
+#include <vector>
+#include "CalcFodmRegisterValues.h"
+#include "FirstOrderDelayModel.h"
+#include "FodmMetrics.h"
+#include "fodm_test_utils.h"
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+const int NUM_HO_COEFF = 6;
+const double HO_POLY[NUM_HO_COEFF] = {
+    3.956738275640760941E-14, -1.885738529952905433E-12, -9.731305625195973794E-09,
+    6.899681529986780764E-04, 1.100300531941965509E+01, -259508.7983 };
+const int NUM_FO_POLY = 100;
+
+std::vector<double> make_fo_t_start()
+{
+    std::vector<double> fo_t_start(NUM_FO_POLY + 1);
+    for (int ii = 0; ii < NUM_FO_POLY + 1; ii++)
+    {
+        fo_t_start[ii] = 10.0 + ii * 0.01;
+    }
+    return fo_t_start;
+}
+
+FoPoly make_fo_poly()
+{
+    FoPoly fo_poly;
+    fo_poly.ho_poly_start_time_ms = 950040000000.0;
+    fo_poly.start_time_ms = fo_poly.ho_poly_start_time_ms;
+    fo_poly.stop_time_ms = fo_poly.start_time_ms + 10.0;
+    fo_poly.poly[0] = -0.158;
+    fo_poly.poly[1] = -19036.792;
+    return fo_poly;
+}
+
+FirstOrderDelayModelRegisterValues calc_reg_values(const FoPoly& fo_poly, FodmCalcEngine engine)
+{
+    return CalcFodmRegisterValues(fo_poly, INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE, FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT,
+        FREQ_WB_SHIFT, FREQ_SCFO_SHIFT, engine);
+}
+
+uint64_t sum_buckets(const FodmStageMetrics& stage)
+{
+    uint64_t sum = 0;
+    for (int bb = 0; bb < FODM_NUM_LATENCY_BUCKETS; bb++)
+    {
+        sum += stage.latency_buckets[bb];
+    }
+    return sum;
+}
+
+uint64_t stage_calls(const FodmMetricsSnapshot& before, const FodmMetricsSnapshot& after, FodmStage stage)
+{
+    EXPECT_EQ(after.stage(stage).calls - before.stage(stage).calls,
+              sum_buckets(after.stage(stage)) - sum_buckets(before.stage(stage)));
+    return after.stage(stage).calls - before.stage(stage).calls;
+}
+
+uint64_t counter(const FodmMetricsSnapshot& before, const FodmMetricsSnapshot& after, FodmCounter c)
+{
+    return after.counter(c) - before.counter(c);
+}
+
+}; // namespace
+
+TEST(FodmMetricsTest, Process)
+{
+    FodmMetricsSnapshot before = GetFodmMetrics();
+    if (!before.enabled)
+    {
+        GTEST_SKIP() << "built without FODM_METRICS";
+    }
+
+    FirstOrderDelayModel model;
+    std::vector<double> fo_t_start = make_fo_t_start();
+    std::vector<long double> fo_poly;
+    EXPECT_TRUE(model.process(10.0, 20.0, NUM_HO_COEFF, HO_POLY, NUM_FO_POLY, fo_t_start, fo_poly));
+    EXPECT_TRUE(model.process(10.0, 20.0, NUM_HO_COEFF, HO_POLY, 10, NUM_FO_POLY, fo_t_start, fo_poly));
+    // the FOs end after the HO
+    EXPECT_FALSE(model.process(10.0, 10.5, NUM_HO_COEFF, HO_POLY, NUM_FO_POLY, fo_t_start, fo_poly));
+
+    FodmMetricsSnapshot after = GetFodmMetrics();
+    EXPECT_EQ(3u, stage_calls(before, after, FodmStage::Process));
+    EXPECT_GT(after.stage(FodmStage::Process).total_ns, before.stage(FodmStage::Process).total_ns);
+    EXPECT_EQ(3u * NUM_FO_POLY, counter(before, after, FodmCounter::FodmsProduced));
+    EXPECT_EQ(1u, counter(before, after, FodmCounter::TimeInputFailures));
+}
+
+TEST(FodmMetricsTest, CalcFodmRegisterValues)
+{
+    FodmMetricsSnapshot before = GetFodmMetrics();
+    if (!before.enabled)
+    {
+        GTEST_SKIP() << "built without FODM_METRICS";
+    }
+
+    FoPoly fo_poly = make_fo_poly();
+    calc_reg_values(fo_poly, FodmCalcEngine::MultiPrecision);
+    calc_reg_values(fo_poly, FodmCalcEngine::FixedPoint);
+    FodmMetricsSnapshot after = GetFodmMetrics();
+    EXPECT_EQ(1u, stage_calls(before, after, FodmStage::RawValues));
+    EXPECT_EQ(1u, stage_calls(before, after, FodmStage::RegisterValues));
+    EXPECT_EQ(1u, counter(before, after, FodmCounter::FastPathCalls));
+    EXPECT_EQ(0u, counter(before, after, FodmCounter::FastPathFallbacks));
+
+    // a delay with too many fractional bits for the fixed point calculation
+    fo_poly.poly[1] = 1.0e-200L;
+    calc_reg_values(fo_poly, FodmCalcEngine::FixedPoint);
+    FodmMetricsSnapshot fallback = GetFodmMetrics();
+    EXPECT_EQ(1u, stage_calls(after, fallback, FodmStage::RawValues));
+    EXPECT_EQ(1u, counter(after, fallback, FodmCounter::FastPathCalls));
+    EXPECT_EQ(1u, counter(after, fallback, FodmCounter::FastPathFallbacks));
+}
+
+// The double-double engine should fall back to multi-precision for well
+// under 1% of the FODMs of a scan, and for a delay on a whole input sample
+TEST(FodmMetricsTest, DoubleDoubleFallbackRate)
+{
+    FodmMetricsSnapshot before = GetFodmMetrics();
+    if (!before.enabled)
+    {
+        GTEST_SKIP() << "built without FODM_METRICS";
+    }
+
+    std::vector<FoPoly> fo_polys(NUM_FO_POLY, make_fo_poly());
+    for (int ii = 0; ii < NUM_FO_POLY; ii++)
+    {
+        fo_polys[ii].start_time_ms += ii * 10.0;
+        fo_polys[ii].stop_time_ms += ii * 10.0;
+        fo_polys[ii].poly[1] += fo_polys[ii].poly[0] * ii * 0.01;
+    }
+    std::vector<FirstOrderDelayModelRegisterValues> reg_values(NUM_FO_POLY);
+    CalcFodmRegisterValues(fo_polys.data(), fo_polys.size(), INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE, FREQ_DOWN_SHIFT,
+        FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT, reg_values.data(), FodmCalcEngine::DoubleDouble);
+    FodmMetricsSnapshot after = GetFodmMetrics();
+    EXPECT_EQ(static_cast<uint64_t>(NUM_FO_POLY), counter(before, after, FodmCounter::FastPathCalls));
+    EXPECT_LT(counter(before, after, FodmCounter::FastPathFallbacks) * 100, static_cast<uint64_t>(NUM_FO_POLY));
+
+    // no delay from a whole second, the first input timestamp is a whole sample
+    FoPoly fo_poly = make_fo_poly();
+    fo_poly.poly[0] = 0.0;
+    fo_poly.poly[1] = 0.0;
+    calc_reg_values(fo_poly, FodmCalcEngine::DoubleDouble);
+    FodmMetricsSnapshot fallback = GetFodmMetrics();
+    EXPECT_EQ(1u, stage_calls(after, fallback, FodmStage::RawValues));
+    EXPECT_EQ(1u, counter(after, fallback, FodmCounter::FastPathFallbacks));
+}
+
+// The metrics of a thread are kept after it exits
+TEST(FodmMetricsTest, Threads)
+{
+    FodmMetricsSnapshot before = GetFodmMetrics();
+    if (!before.enabled)
+    {
+        GTEST_SKIP() << "built without FODM_METRICS";
+    }
+
+    const int NUM_THREADS = 4;
+    std::vector<std::thread> threads;
+    for (int ii = 0; ii < NUM_THREADS; ii++)
+    {
+        threads.emplace_back([]()
+        {
+            FirstOrderDelayModel model;
+            std::vector<double> fo_t_start = make_fo_t_start();
+            std::vector<long double> fo_poly;
+            model.process(10.0, 20.0, NUM_HO_COEFF, HO_POLY, NUM_FO_POLY, fo_t_start, fo_poly);
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    FodmMetricsSnapshot after = GetFodmMetrics();
+    EXPECT_EQ(static_cast<uint64_t>(NUM_THREADS), stage_calls(before, after, FodmStage::Process));
+    EXPECT_EQ(static_cast<uint64_t>(NUM_THREADS) * NUM_FO_POLY, counter(before, after, FodmCounter::FodmsProduced));
+}
+
+// The "le" bound 2^b ns of bucket b is inclusive
+TEST(FodmMetricsTest, LatencyBuckets)
+{
+    EXPECT_EQ(0, FodmLatencyBucket(0));
+    EXPECT_EQ(0, FodmLatencyBucket(1));
+    EXPECT_EQ(1, FodmLatencyBucket(2));
+    EXPECT_EQ(2, FodmLatencyBucket(3));
+    EXPECT_EQ(2, FodmLatencyBucket(4));
+    EXPECT_EQ(10, FodmLatencyBucket(1023));
+    EXPECT_EQ(10, FodmLatencyBucket(1024));
+    EXPECT_EQ(11, FodmLatencyBucket(1025));
+    EXPECT_EQ(FODM_NUM_LATENCY_BUCKETS - 2, FodmLatencyBucket(uint64_t(1) << (FODM_NUM_LATENCY_BUCKETS - 2)));
+    EXPECT_EQ(FODM_NUM_LATENCY_BUCKETS - 1, FodmLatencyBucket((uint64_t(1) << (FODM_NUM_LATENCY_BUCKETS - 2)) + 1));
+    EXPECT_EQ(FODM_NUM_LATENCY_BUCKETS - 1, FodmLatencyBucket(~uint64_t(0)));
+}
+
+TEST(FodmMetricsTest, Prometheus)
+{
+    FodmMetricsSnapshot snapshot = {};
+    snapshot.enabled = true;
+    FodmStageMetrics& process = snapshot.stages[static_cast<int>(FodmStage::Process)];
+    process.calls = 3;
+    process.total_ns = 1500;
+    process.latency_buckets[0] = 1;
+    process.latency_buckets[10] = 2;
+    snapshot.counters[static_cast<int>(FodmCounter::FodmsProduced)] = 300;
+
+    std::string text = FodmMetricsToPrometheus(snapshot);
+    EXPECT_NE(std::string::npos, text.find("# TYPE fodm_stage_latency_seconds histogram\n"));
+    EXPECT_NE(std::string::npos, text.find("fodm_stage_latency_seconds_bucket{stage=\"process\",le=\"1e-09\"} 1\n"));
+    EXPECT_NE(std::string::npos, text.find("fodm_stage_latency_seconds_bucket{stage=\"process\",le=\"5.12e-07\"} 1\n"));
+    EXPECT_NE(std::string::npos, text.find("fodm_stage_latency_seconds_bucket{stage=\"process\",le=\"1.024e-06\"} 3\n"));
+    EXPECT_NE(std::string::npos, text.find("fodm_stage_latency_seconds_bucket{stage=\"process\",le=\"+Inf\"} 3\n"));
+    EXPECT_NE(std::string::npos, text.find("fodm_stage_latency_seconds_sum{stage=\"process\"} 1.5e-06\n"));
+    EXPECT_NE(std::string::npos, text.find("fodm_stage_latency_seconds_count{stage=\"process\"} 3\n"));
+    EXPECT_NE(std::string::npos, text.find("fodm_stage_latency_seconds_count{stage=\"raw_values\"} 0\n"));
+    EXPECT_NE(std::string::npos, text.find("# TYPE fodm_fodms_produced_total counter\n"));
+    EXPECT_NE(std::string::npos, text.find("fodm_fodms_produced_total 300\n"));
+    EXPECT_NE(std::string::npos, text.find("fodm_fast_path_fallbacks_total 0\n"));
+    EXPECT_NE(std::string::npos, text.find("fodm_fast_path_calls_total 0\n"));
+}
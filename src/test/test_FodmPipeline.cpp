@@ -0,0 +1,178 @@
+/***
+ * test_FodmPipeline.cpp
+ *
+ * The unit test driver for FodmPipeline. The registers written by the
+ * pipeline are expected to be the ones of FirstOrderDelayModel::process
+ * followed by CalcFodmRegisterValues, in the order of the HODMs, and the
+ * pipeline to stop taking HODMs while the writer is blocked.
+ *
+ ***/
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "FodmPipeline.h"
+#include "fodm_test_utils.h"
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+const int NUM_HO_COEFF = 6;
+const double HO_POLY[NUM_HO_COEFF] = {
+    3.956738275640760941E-14, -1.885738529952905433E-12, -9.731305625195973794E-09,
+    6.899681529986780764E-04, 1.100300531941965509E+01, -259508.7983 };
+const double HO_START_TIME_MS = 950040000000.0;
+const double HO_LENGTH_MS = 10000.0;
+const double FO_INTERVAL_MS = 10.0;
+
+// The consecutive 10 s HODMs of a few receptors, each covered by 10 ms FODMs
+std::vector<HodmRecord> make_hodms(int num_receptors, int num_hodms_per_receptor)
+{
+    std::vector<HodmRecord> hodms;
+    for (int hh = 0; hh < num_hodms_per_receptor; hh++)
+    {
+        for (int rr = 0; rr < num_receptors; rr++)
+        {
+            HodmRecord hodm;
+            hodm.receptor = rr;
+            hodm.ho_start_time_ms = HO_START_TIME_MS + hh * HO_LENGTH_MS;
+            hodm.ho_stop_time_ms = hodm.ho_start_time_ms + HO_LENGTH_MS;
+            hodm.num_ho_coeff = NUM_HO_COEFF;
+            for (int kk = 0; kk < NUM_HO_COEFF; kk++)
+            {
+                hodm.ho_poly[kk] = HO_POLY[kk] * (1.0 + rr * 1.0e-3 + hh * 1.0e-4);
+            }
+            hodm.fo_start_time_ms = hodm.ho_start_time_ms;
+            hodm.fo_interval_ms = FO_INTERVAL_MS;
+            hodm.num_fo_poly = HO_LENGTH_MS / FO_INTERVAL_MS;
+            hodms.push_back(hodm);
+        }
+    }
+    return hodms;
+}
+
+// The registers of the HODMs calculated one after the other
+std::vector<RegisterRecord> expected_registers(const std::vector<HodmRecord>& hodms,
+                                               const RdtChannelContext& ctx,
+                                               const FirstOrderDelayModel& model,
+                                               int num_lsq_points)
+{
+    std::vector<RegisterRecord> registers;
+    for (const HodmRecord& hodm : hodms)
+    {
+        std::vector<double> fo_t_start(hodm.num_fo_poly + 1);
+        for (int ii = 0; ii <= hodm.num_fo_poly; ii++)
+        {
+            fo_t_start[ii] = (hodm.fo_start_time_ms - hodm.ho_start_time_ms + ii * hodm.fo_interval_ms) / 1000.0;
+        }
+        const double ho_t_stop = (hodm.ho_stop_time_ms - hodm.ho_start_time_ms) / 1000.0;
+        std::vector<long double> fo_poly;
+        bool time_inputs_ok = num_lsq_points > 0
+            ? model.process(0.0, ho_t_stop, hodm.num_ho_coeff, hodm.ho_poly, num_lsq_points,
+                  hodm.num_fo_poly, fo_t_start, fo_poly)
+            : model.process(0.0, ho_t_stop, hodm.num_ho_coeff, hodm.ho_poly,
+                  hodm.num_fo_poly, fo_t_start, fo_poly);
+        for (int ii = 0; ii < hodm.num_fo_poly; ii++)
+        {
+            FoPoly fo;
+            fo.ho_poly_start_time_ms = hodm.ho_start_time_ms;
+            fo.start_time_ms = hodm.fo_start_time_ms + ii * hodm.fo_interval_ms;
+            fo.stop_time_ms = hodm.fo_start_time_ms + (ii + 1) * hodm.fo_interval_ms;
+            fo.poly[0] = fo_poly[ii * 2];
+            fo.poly[1] = fo_poly[ii * 2 + 1];
+            RegisterRecord record;
+            record.receptor = hodm.receptor;
+            record.time_inputs_ok = time_inputs_ok;
+            record.reg_values = CalcFodmRegisterValues(ctx, fo);
+            registers.push_back(record);
+        }
+    }
+    return registers;
+}
+
+void expect_registers_eq(const std::vector<RegisterRecord>& expected, const std::vector<RegisterRecord>& registers)
+{
+    ASSERT_EQ(expected.size(), registers.size());
+    for (size_t ii = 0; ii < expected.size(); ii++)
+    {
+        ASSERT_EQ(expected[ii].receptor, registers[ii].receptor) << "register " << ii;
+        EXPECT_EQ(expected[ii].time_inputs_ok, registers[ii].time_inputs_ok) << "register " << ii;
+        expect_reg_values_eq(expected[ii].reg_values, registers[ii].reg_values);
+    }
+}
+
+}; // namespace
+
+TEST(FodmPipelineTest, MatchesSequential)
+{
+    const RdtChannelContext ctx(INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+        FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT, FodmCalcEngine::FixedPoint);
+    std::vector<HodmRecord> hodms = make_hodms(4, 3);
+    // the last HODM ends before its FODMs
+    hodms.back().ho_stop_time_ms -= 1000.0;
+
+    for (int num_lsq_points : { 0, 4 })
+    {
+        const FirstOrderDelayModel model(PolyvalPrecision::DoubleDouble);
+        std::vector<RegisterRecord> registers;
+        {
+            FodmPipeline pipeline(ctx, [&](const RegisterRecord* records, size_t num_records)
+            {
+                EXPECT_LE(num_records, FodmPipeline::BATCH_SIZE);
+                registers.insert(registers.end(), records, records + num_records);
+            }, model, num_lsq_points, 16);
+            for (const HodmRecord& hodm : hodms)
+            {
+                pipeline.Push(hodm);
+            }
+            pipeline.Close();
+            EXPECT_EQ(hodms.size(), pipeline.num_hodms());
+            EXPECT_EQ(registers.size(), pipeline.num_fodms());
+            EXPECT_EQ(registers.size(), pipeline.num_registers());
+        }
+        expect_registers_eq(expected_registers(hodms, ctx, model, num_lsq_points), registers);
+        EXPECT_FALSE(registers.back().time_inputs_ok);
+    }
+}
+
+// While the writer is blocked, the rings fill up and TryPush() fails. The
+// HODMs are all written once the writer continues.
+TEST(FodmPipelineTest, Backpressure)
+{
+    const RdtChannelContext ctx(INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+        FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT, FodmCalcEngine::FixedPoint);
+    std::vector<HodmRecord> hodms = make_hodms(1, 1);
+    hodms[0].num_fo_poly = 10;
+
+    std::atomic<bool> blocked(true);
+    std::atomic<size_t> num_written(0);
+    FodmPipeline pipeline(ctx, [&](const RegisterRecord*, size_t num_records)
+    {
+        while (blocked)
+        {
+            std::this_thread::yield();
+        }
+        num_written += num_records;
+    }, FirstOrderDelayModel(), 0, 4);
+
+    size_t num_pushed = 0;
+    while (pipeline.TryPush(hodms[0]))
+    {
+        num_pushed++;
+        // the stages need a moment to take the HODM from the ring
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ASSERT_LT(num_pushed, 1000u);
+    }
+    EXPECT_GT(num_pushed, 0u);
+    EXPECT_EQ(0u, num_written);
+
+    blocked = false;
+    pipeline.Push(hodms[0]);
+    num_pushed++;
+    pipeline.Close();
+    EXPECT_EQ(num_pushed * 10, num_written);
+    EXPECT_EQ(num_pushed, pipeline.num_hodms());
+}
@@ -0,0 +1,123 @@
+/***
+ * test_FodmRegisterImage.cpp
+ *
+ * The unit test driver for the packed FPGA register image. The image
+ * of a FODM is compared byte by byte to the documented layout, and the
+ * images of calculated register values are expected to decode to the
+ * same register values.
+ *
+ ***/
+#include <vector>
+#include "FodmRegisterImage.h"
+#include "fodm_test_utils.h"
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+const size_t NUM_FODMS = 100;
+
+std::vector<FoPoly> make_fo_polys()
+{
+    std::vector<FoPoly> fo_polys(NUM_FODMS);
+    for (size_t ii = 0; ii < NUM_FODMS; ii++)
+    {
+        fo_polys[ii].ho_poly_start_time_ms = 950040000000.0;
+        fo_polys[ii].start_time_ms = 950040000000.0 + ii * 10.0;
+        fo_polys[ii].stop_time_ms = fo_polys[ii].start_time_ms + 10.0;
+        fo_polys[ii].poly[0] = 11.003 - ii * 1.0e-4;
+        fo_polys[ii].poly[1] = -259508.7983 + ii * 0.11;
+    }
+    return fo_polys;
+}
+
+}; // namespace
+
+TEST(FodmRegisterImageTest, Layout)
+{
+    FirstOrderDelayModelRegisterValues reg_values;
+    reg_values.first_input_timestamp = 0x0102030405060708;
+    reg_values.delay_constant = 0x11121314;
+    reg_values.phase_constant = -2;
+    reg_values.delay_linear = 0x2122232425262728;
+    reg_values.phase_linear = -3;
+    reg_values.validity_period = 0x31323334;
+    reg_values.output_PPS = 0x41424344;
+    reg_values.first_output_timestamp = 0x5152535455565758;
+
+    const uint8_t expected[] = {
+        0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01,
+        0x14, 0x13, 0x12, 0x11,
+        0xfe, 0xff, 0xff, 0xff,
+        0x28, 0x27, 0x26, 0x25, 0x24, 0x23, 0x22, 0x21,
+        0xfd, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0x34, 0x33, 0x32, 0x31,
+        0x44, 0x43, 0x42, 0x41,
+        0x58, 0x57, 0x56, 0x55, 0x54, 0x53, 0x52, 0x51 };
+    ASSERT_EQ(sizeof(expected), FODM_REGISTER_FORMAT.image_size);
+
+    // the second image starts right after the first one
+    uint8_t image[2 * sizeof(expected)];
+    const FirstOrderDelayModelRegisterValues two[2] = { reg_values, reg_values };
+    EncodeFodmRegisterImage(two, 2, image);
+    EXPECT_EQ(std::vector<uint8_t>(expected, expected + sizeof(expected)),
+              std::vector<uint8_t>(image, image + sizeof(expected)));
+    EXPECT_EQ(std::vector<uint8_t>(expected, expected + sizeof(expected)),
+              std::vector<uint8_t>(image + sizeof(expected), image + sizeof(image)));
+}
+
+TEST(FodmRegisterImageTest, LayoutV1)
+{
+    FirstOrderDelayModelRegisterValuesVer1 reg_values;
+    reg_values.first_input_timestamp = 0x0102030405060708;
+    reg_values.delay_constant = 0x11121314;
+    reg_values.phase_constant = -2;
+    reg_values.delay_linear = 0x21222324;
+    reg_values.phase_linear = -3;
+    reg_values.validity_period = 0x31323334;
+    reg_values.output_PPS = 0x41424344;
+    reg_values.first_output_timestamp = 0x5152535455565758;
+
+    const uint8_t expected[] = {
+        0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01,
+        0x14, 0x13, 0x12, 0x11,
+        0xfe, 0xff, 0xff, 0xff,
+        0x24, 0x23, 0x22, 0x21,
+        0xfd, 0xff, 0xff, 0xff,
+        0x34, 0x33, 0x32, 0x31,
+        0x44, 0x43, 0x42, 0x41,
+        0x58, 0x57, 0x56, 0x55, 0x54, 0x53, 0x52, 0x51 };
+    ASSERT_EQ(sizeof(expected), FODM_REGISTER_FORMAT_V1.image_size);
+
+    uint8_t image[sizeof(expected)];
+    EncodeFodmRegisterImageV1(&reg_values, 1, image);
+    EXPECT_EQ(std::vector<uint8_t>(expected, expected + sizeof(expected)),
+              std::vector<uint8_t>(image, image + sizeof(image)));
+}
+
+TEST(FodmRegisterImageTest, RoundTrip)
+{
+    const RdtChannelContext ctx(INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+        FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT);
+    const std::vector<FoPoly> fo_polys = make_fo_polys();
+
+    std::vector<FirstOrderDelayModelRegisterValues> reg_values(NUM_FODMS), decoded(NUM_FODMS);
+    std::vector<FirstOrderDelayModelRegisterValuesVer1> reg_values_v1(NUM_FODMS), decoded_v1(NUM_FODMS);
+    CalcFodmRegisterValues(ctx, fo_polys.data(), NUM_FODMS, reg_values.data());
+    CalcFodmRegisterValuesV1(ctx, fo_polys.data(), NUM_FODMS, reg_values_v1.data());
+
+    // the image needs no alignment
+    std::vector<uint8_t> image(1 + NUM_FODMS * FODM_REGISTER_FORMAT.image_size);
+    EncodeFodmRegisterImage(reg_values.data(), NUM_FODMS, image.data() + 1);
+    DecodeFodmRegisterImage(image.data() + 1, NUM_FODMS, decoded.data());
+    EncodeFodmRegisterImageV1(reg_values_v1.data(), NUM_FODMS, image.data() + 1);
+    DecodeFodmRegisterImageV1(image.data() + 1, NUM_FODMS, decoded_v1.data());
+    for (size_t ii = 0; ii < NUM_FODMS; ii++)
+    {
+        expect_reg_values_eq(reg_values[ii], decoded[ii]);
+        expect_reg_values_eq(reg_values_v1[ii], decoded_v1[ii]);
+    }
+}
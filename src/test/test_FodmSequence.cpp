@@ -0,0 +1,162 @@
+/***
+ * test_FodmSequence.cpp
+ *
+ * The unit test driver for FodmSequence. The timestamps generated for
+ * consecutive FODMs are compared against the ones calculated from the FODM
+ * start and stop times, including times on whole output samples, and the
+ * register values calculated with them against the single FODM calculation.
+ *
+ ***/
+#include <vector>
+#include "CalcFodmRegisterValues.h"
+#include "CalcFodmRegisterValuesFixedPoint.h"
+#include "FodmSequence.h"
+#include "fodm_test_utils.h"
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+// Runs num_fodms consecutive FODMs of interval_ms through a FodmSequence
+// and expects the timestamps calculated from the start and stop times.
+void expect_sequence_matches(double start_time_ms, double interval_ms, int num_fodms, uint32_t output_sample_rate)
+{
+    FodmSequence sequence(output_sample_rate);
+    FoPoly fo_poly = {};
+    for (int ii = 0; ii < num_fodms; ii++)
+    {
+        fo_poly.start_time_ms = start_time_ms + ii * interval_ms;
+        fo_poly.stop_time_ms = start_time_ms + (ii + 1) * interval_ms;
+
+        FodmOutputTimestamps timestamps;
+        ASSERT_TRUE(sequence.Next(fo_poly, timestamps));
+        uint64_t current, next;
+        ASSERT_TRUE(CalcFodmOutputTimestampFixedPoint(fo_poly.start_time_ms, output_sample_rate, current));
+        ASSERT_TRUE(CalcFodmOutputTimestampFixedPoint(fo_poly.stop_time_ms, output_sample_rate, next));
+        ASSERT_EQ(current, timestamps.current) << "FODM " << ii << " start " << fo_poly.start_time_ms;
+        ASSERT_EQ(next, timestamps.next) << "FODM " << ii << " stop " << fo_poly.stop_time_ms;
+    }
+    EXPECT_EQ(1u, sequence.num_anchors());
+}
+
+TEST(FodmSequenceTest, ConsecutiveFodms)
+{
+    const uint32_t output_sample_rates[] = { 220200960, 218999808, 3963617280u, 1 };
+    // Whole seconds and times where ms / 1000 is not exact
+    const double start_times_ms[] = { 720000000000.0, 720000000025.0, 950040000000.0, 1000.0, 0.0 };
+    for (uint32_t output_sample_rate : output_sample_rates)
+    {
+        for (double start_time_ms : start_times_ms)
+        {
+            expect_sequence_matches(start_time_ms, 10.0, 2000, output_sample_rate);
+            expect_sequence_matches(start_time_ms, 1000.0 / 128, 2000, output_sample_rate);
+        }
+    }
+}
+
+// Intervals that are not a whole number of time units are calculated from
+// the stop times without re-anchoring
+TEST(FodmSequenceTest, InexactInterval)
+{
+    expect_sequence_matches(720000000000.0, 0.1, 2000, 220200960);
+    expect_sequence_matches(720000000000.3, 10.0, 2000, 220200960);
+}
+
+TEST(FodmSequenceTest, Discontinuities)
+{
+    const uint32_t output_sample_rate = 220200960;
+    FodmSequence sequence(output_sample_rate);
+    FodmOutputTimestamps timestamps;
+    FoPoly fo_poly = {};
+
+    // gap between FODMs
+    const double start_times_ms[] = { 1000.0, 1010.0, 1030.0, 1040.0, 1040.0, 1030.0 };
+    const uint64_t expected_anchors[] = { 1, 1, 2, 2, 3, 4 };
+    for (size_t ii = 0; ii < sizeof(start_times_ms) / sizeof(start_times_ms[0]); ii++)
+    {
+        fo_poly.start_time_ms = start_times_ms[ii];
+        fo_poly.stop_time_ms = start_times_ms[ii] + 10.0;
+        ASSERT_TRUE(sequence.Next(fo_poly, timestamps));
+        EXPECT_EQ(expected_anchors[ii], sequence.num_anchors());
+        EXPECT_EQ(static_cast<uint64_t>(start_times_ms[ii]) * output_sample_rate / 1000, timestamps.current);
+    }
+
+    sequence.Reset();
+    fo_poly.start_time_ms = fo_poly.stop_time_ms;
+    fo_poly.stop_time_ms += 10.0;
+    ASSERT_TRUE(sequence.Next(fo_poly, timestamps));
+    EXPECT_EQ(5u, sequence.num_anchors());
+
+    // negative times can't be represented, and reset the sequence
+    fo_poly.start_time_ms = fo_poly.stop_time_ms;
+    fo_poly.stop_time_ms = -10.0;
+    EXPECT_FALSE(sequence.Next(fo_poly, timestamps));
+    fo_poly.start_time_ms = -10.0;
+    fo_poly.stop_time_ms = 0.0;
+    EXPECT_FALSE(sequence.Next(fo_poly, timestamps));
+    fo_poly.start_time_ms = 0.0;
+    fo_poly.stop_time_ms = 10.0;
+    EXPECT_TRUE(sequence.Next(fo_poly, timestamps));
+    EXPECT_EQ(6u, sequence.num_anchors());
+}
+
+// The register values calculated with the sequence timestamps should be
+// identical to the ones calculated from the start and stop times
+TEST(FodmSequenceTest, RegisterValues)
+{
+    std::vector<CsvInputs> test_input;
+    parse_input_csv("fodm_test_input.csv", test_input);
+    ASSERT_FALSE(test_input.empty());
+
+    const FodmCalcEngine engines[] = {
+        FodmCalcEngine::MultiPrecision, FodmCalcEngine::FixedPoint, FodmCalcEngine::Float128, FodmCalcEngine::DoubleDouble };
+    for (const CsvInputs& row : test_input)
+    {
+        for (FodmCalcEngine engine : engines)
+        {
+            FodmSequence sequence(row.output_sample_rate);
+            FoPoly fo_poly = row.fo_poly;
+            for (int ii = 0; ii < 20; ii++)
+            {
+                fo_poly.start_time_ms = row.fo_poly.start_time_ms + ii * 10.0;
+                fo_poly.stop_time_ms = fo_poly.start_time_ms + 10.0;
+                FodmOutputTimestamps timestamps;
+                ASSERT_TRUE(sequence.Next(fo_poly, timestamps));
+
+                expect_reg_values_eq(
+                    CalcFodmRegisterValues(fo_poly, row.input_sample_rate, row.output_sample_rate,
+                        row.f_ds, row.f_as, row.f_wb, row.f_scfo, FodmCalcEngine::MultiPrecision),
+                    CalcFodmRegisterValues(fo_poly, timestamps, row.input_sample_rate, row.output_sample_rate,
+                        row.f_ds, row.f_as, row.f_wb, row.f_scfo, engine));
+                expect_reg_values_eq(
+                    CalcFodmRegisterValuesV1(fo_poly, row.input_sample_rate, row.output_sample_rate,
+                        row.f_ds, row.f_as, row.f_wb, row.f_scfo, FodmCalcEngine::MultiPrecision),
+                    CalcFodmRegisterValuesV1(fo_poly, timestamps, row.input_sample_rate, row.output_sample_rate,
+                        row.f_ds, row.f_as, row.f_wb, row.f_scfo, engine));
+            }
+        }
+    }
+}
+
+// output_PPS is the next whole second in output samples, modulo 2^32
+TEST(FodmSequenceTest, OutputPps)
+{
+    const uint32_t rate = OUTPUT_SAMPLE_RATE;
+    const uint64_t second = uint64_t(950040000) * rate;
+    uint32_t output_pps = 0;
+
+    ASSERT_TRUE(CalcFodmOutputPps(0, rate, output_pps));
+    EXPECT_EQ(0u, output_pps);
+    ASSERT_TRUE(CalcFodmOutputPps(second, rate, output_pps));
+    EXPECT_EQ(static_cast<uint32_t>(second), output_pps);
+    ASSERT_TRUE(CalcFodmOutputPps(second + 1, rate, output_pps));
+    EXPECT_EQ(static_cast<uint32_t>(second + rate), output_pps);
+    ASSERT_TRUE(CalcFodmOutputPps(second - 1, rate, output_pps));
+    EXPECT_EQ(static_cast<uint32_t>(second), output_pps);
+
+    // the next whole second does not fit in 64 bits
+    const uint64_t last_second = UINT64_MAX / rate * rate;
+    ASSERT_TRUE(CalcFodmOutputPps(last_second, rate, output_pps));
+    EXPECT_EQ(static_cast<uint32_t>(last_second), output_pps);
+    EXPECT_FALSE(CalcFodmOutputPps(last_second + 1, rate, output_pps));
+}
@@ -0,0 +1,341 @@
+/***
+ * test_FodmWorkspace.cpp
+ *
+ * The unit test driver for the FodmWorkspace class and the
+ * FirstOrderDelayModel process() on caller-owned buffers. The
+ * global operator new and delete are replaced to count the heap
+ * allocations of the steady state calls, which must be none.
+ *
+ ***/
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <numeric>
+#include <vector>
+#include "FirstOrderDelayModel.h"
+#include "FodmWorkspace.h"
+#include "MultiPointHorner.h"
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+// Only the allocations of a thread inside an AllocationCounter are counted,
+// so that the threads of other tests do not interfere
+thread_local bool t_count_allocations = false;
+std::atomic<size_t> g_num_allocations(0);
+std::atomic<size_t> g_num_deallocations(0);
+
+class AllocationCounter
+{
+public:
+    AllocationCounter()
+        : num_allocations_(g_num_allocations.load()),
+          num_deallocations_(g_num_deallocations.load())
+    {
+        t_count_allocations = true;
+    }
+
+    ~AllocationCounter() { t_count_allocations = false; }
+
+    size_t num_allocations() const { return g_num_allocations.load() - num_allocations_; }
+    size_t num_deallocations() const { return g_num_deallocations.load() - num_deallocations_; }
+
+private:
+    const size_t num_allocations_;
+    const size_t num_deallocations_;
+};
+
+}; // namespace
+
+void* operator new(size_t size)
+{
+    if (t_count_allocations)
+    {
+        g_num_allocations++;
+    }
+    void* ptr = malloc(size > 0 ? size : 1);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (t_count_allocations && ptr != nullptr)
+    {
+        g_num_deallocations++;
+    }
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+namespace
+{
+
+const int NUM_HO_COEFF = 6;
+const double HO_POLY[NUM_HO_COEFF] = { -1.2e-9, 3.4e-7, -5.6e-5, 7.8e-3, 123.4, 4.5e6 };
+const double HO_T_START = 0.0;
+const double HO_T_STOP = 10.0;
+const int NUM_FO_POLY = 1000;
+const int NUM_LSQ_POINTS = 10;
+
+const PolyvalPrecision PRECISIONS[] = {
+    PolyvalPrecision::Default, PolyvalPrecision::MultiPrecision, PolyvalPrecision::DoubleDouble, PolyvalPrecision::TaylorShift };
+const LsqFitMethod METHODS[] = {
+    LsqFitMethod::Sampled, LsqFitMethod::ClosedForm, LsqFitMethod::Continuous, LsqFitMethod::Minimax };
+
+std::vector<double> FoTimes()
+{
+    std::vector<double> fo_t_start(NUM_FO_POLY + 1);
+    for (int ii = 0; ii <= NUM_FO_POLY; ii++)
+    {
+        fo_t_start[ii] = HO_T_START + ii * (HO_T_STOP - HO_T_START) / NUM_FO_POLY;
+    }
+    return fo_t_start;
+}
+
+}; // namespace
+
+TEST(FodmWorkspaceTest, AllocateFromCallerBuffer)
+{
+    char buffer[256];
+    FodmWorkspace workspace(buffer, sizeof(buffer));
+
+    char* c = workspace.Allocate<char>(3);
+    long double* ld = workspace.Allocate<long double>(4);
+    double* d = workspace.Allocate<double>(2);
+    EXPECT_EQ(buffer, c);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(ld) % alignof(long double));
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(d) % alignof(double));
+    EXPECT_TRUE(reinterpret_cast<char*>(d + 2) <= buffer + sizeof(buffer));
+    EXPECT_EQ(3 + 4 * sizeof(long double) + 2 * sizeof(double), workspace.size());
+    EXPECT_EQ(nullptr, workspace.Allocate<double>(0));
+    EXPECT_EQ(0u, workspace.num_heap_allocations());
+    EXPECT_EQ(sizeof(buffer), workspace.capacity());
+
+    workspace.Reset();
+    EXPECT_EQ(0u, workspace.size());
+    EXPECT_EQ(c, workspace.Allocate<char>(1));
+}
+
+TEST(FodmWorkspaceTest, ResetMergesHeapBlocks)
+{
+    char buffer[256];
+    FodmWorkspace workspace(buffer, sizeof(buffer));
+    auto round = [&]()
+    {
+        workspace.Reset();
+        for (int ii = 1; ii <= 64; ii++)
+        {
+            double* d = workspace.Allocate<double>(ii * 10);
+            d[0] = d[ii * 10 - 1] = ii;
+        }
+    };
+
+    round();
+    size_t num_heap_allocations = workspace.num_heap_allocations();
+    EXPECT_GT(num_heap_allocations, 1u);
+
+    // merged into one block, then no more allocations
+    round();
+    EXPECT_EQ(num_heap_allocations + 1, workspace.num_heap_allocations());
+    for (int rr = 0; rr < 10; rr++)
+    {
+        round();
+    }
+    EXPECT_EQ(num_heap_allocations + 1, workspace.num_heap_allocations());
+    EXPECT_EQ(64u * 65 / 2 * 10 * sizeof(double), workspace.size());
+}
+
+TEST(FodmWorkspaceTest, ArenaVector)
+{
+    FodmWorkspace workspace;
+    FodmArenaVector<long double> v((FodmArenaAllocator<long double>(workspace)));
+    v.resize(100, 1.0L);
+    EXPECT_EQ(100u * sizeof(long double), workspace.size());
+    EXPECT_EQ(100.0L, std::accumulate(v.begin(), v.end(), 0.0L));
+}
+
+TEST(FodmWorkspaceTest, SpanProcessMatchesVectorProcess)
+{
+    const std::vector<double> fo_t_start = FoTimes();
+    std::vector<long double> expected_poly, expected_extra;
+    std::vector<long double> fo_poly(NUM_FO_POLY * 2), extra(NUM_FO_POLY + 1);
+    FodmWorkspace workspace;
+
+    for (PolyvalPrecision precision : PRECISIONS)
+    {
+        const FirstOrderDelayModel model(precision);
+        EXPECT_TRUE(model.process(HO_T_START, HO_T_STOP, NUM_HO_COEFF, HO_POLY, NUM_FO_POLY, fo_t_start,
+            expected_poly, expected_extra));
+
+        workspace.Reset();
+        EXPECT_TRUE(model.process(HO_T_START, HO_T_STOP, NUM_HO_COEFF, HO_POLY, NUM_FO_POLY, fo_t_start.data(),
+            fo_poly.data(), extra.data(), workspace));
+        EXPECT_EQ(expected_poly, fo_poly) << "precision " << static_cast<int>(precision);
+        EXPECT_EQ(expected_extra, extra) << "precision " << static_cast<int>(precision);
+
+        workspace.Reset();
+        EXPECT_TRUE(model.process(HO_T_START, HO_T_STOP, NUM_HO_COEFF, HO_POLY, NUM_FO_POLY, fo_t_start.data(),
+            fo_poly.data(), nullptr, workspace));
+        EXPECT_EQ(expected_poly, fo_poly) << "precision " << static_cast<int>(precision);
+    }
+
+    extra.resize(NUM_FO_POLY);
+    for (PolyvalPrecision precision : PRECISIONS)
+    {
+        for (LsqFitMethod method : METHODS)
+        {
+            const FirstOrderDelayModel model(precision, method);
+            EXPECT_TRUE(model.process(HO_T_START, HO_T_STOP, NUM_HO_COEFF, HO_POLY, NUM_LSQ_POINTS, NUM_FO_POLY,
+                fo_t_start, expected_poly, expected_extra));
+
+            workspace.Reset();
+            EXPECT_TRUE(model.process(HO_T_START, HO_T_STOP, NUM_HO_COEFF, HO_POLY, NUM_LSQ_POINTS, NUM_FO_POLY,
+                fo_t_start.data(), fo_poly.data(), extra.data(), workspace));
+            EXPECT_EQ(expected_poly, fo_poly) << "precision " << static_cast<int>(precision) << " method " << static_cast<int>(method);
+            EXPECT_EQ(expected_extra, extra) << "precision " << static_cast<int>(precision) << " method " << static_cast<int>(method);
+        }
+    }
+}
+
+TEST(FodmWorkspaceTest, SteadyStateDoesNotAllocate)
+{
+    const std::vector<double> fo_t_start = FoTimes();
+    std::vector<long double> fo_poly(NUM_FO_POLY * 2), extra(NUM_FO_POLY + 1);
+    // heap only: the first round of calls allocates the blocks, the Reset()
+    // of the second merges them, and the rounds after that must not allocate
+    FodmWorkspace workspace;
+
+    for (PolyvalPrecision precision : PRECISIONS)
+    {
+        const FirstOrderDelayModel two_point_model(precision);
+        for (int rr = 0; rr < 4; rr++)
+        {
+            AllocationCounter counter;
+            workspace.Reset();
+            two_point_model.process(HO_T_START, HO_T_STOP, NUM_HO_COEFF, HO_POLY, NUM_FO_POLY, fo_t_start.data(),
+                fo_poly.data(), extra.data(), workspace);
+            workspace.Reset();
+            two_point_model.process(HO_T_START, HO_T_STOP, NUM_HO_COEFF, HO_POLY, NUM_FO_POLY, fo_t_start.data(),
+                fo_poly.data(), nullptr, workspace);
+            if (rr > 1)
+            {
+                EXPECT_EQ(0u, counter.num_allocations()) << "precision " << static_cast<int>(precision);
+                EXPECT_EQ(0u, counter.num_deallocations()) << "precision " << static_cast<int>(precision);
+            }
+        }
+
+        for (LsqFitMethod method : METHODS)
+        {
+            const FirstOrderDelayModel lsq_model(precision, method);
+            for (int rr = 0; rr < 4; rr++)
+            {
+                AllocationCounter counter;
+                workspace.Reset();
+                lsq_model.process(HO_T_START, HO_T_STOP, NUM_HO_COEFF, HO_POLY, NUM_LSQ_POINTS, NUM_FO_POLY,
+                    fo_t_start.data(), fo_poly.data(), extra.data(), workspace);
+                workspace.Reset();
+                lsq_model.process(HO_T_START, HO_T_STOP, NUM_HO_COEFF, HO_POLY, NUM_LSQ_POINTS, NUM_FO_POLY,
+                    fo_t_start.data(), fo_poly.data(), nullptr, workspace);
+                if (rr > 1)
+                {
+                    EXPECT_EQ(0u, counter.num_allocations()) << "precision " << static_cast<int>(precision) << " method " << static_cast<int>(method);
+                    EXPECT_EQ(0u, counter.num_deallocations()) << "precision " << static_cast<int>(precision) << " method " << static_cast<int>(method);
+                }
+            }
+        }
+    }
+}
+
+TEST(FodmWorkspaceTest, ArenaOutputsDoNotAllocate)
+{
+    const std::vector<double> fo_t_start = FoTimes();
+    const FirstOrderDelayModel model(PolyvalPrecision::DoubleDouble, LsqFitMethod::ClosedForm);
+    FodmWorkspace workspace;
+    std::vector<long double> expected_poly;
+    model.process(HO_T_START, HO_T_STOP, NUM_HO_COEFF, HO_POLY, NUM_LSQ_POINTS, NUM_FO_POLY, fo_t_start, expected_poly);
+
+    // the outputs and the scratch buffers come from the same workspace,
+    // which reaches its steady state on the third round
+    for (int rr = 0; rr < 4; rr++)
+    {
+        AllocationCounter counter;
+        workspace.Reset();
+        FodmArenaVector<long double> fo_poly((FodmArenaAllocator<long double>(workspace)));
+        FodmArenaVector<long double> fo_max_error((FodmArenaAllocator<long double>(workspace)));
+        fo_poly.resize(NUM_FO_POLY * 2);
+        fo_max_error.resize(NUM_FO_POLY);
+        EXPECT_TRUE(model.process(HO_T_START, HO_T_STOP, NUM_HO_COEFF, HO_POLY, NUM_LSQ_POINTS, NUM_FO_POLY,
+            fo_t_start.data(), fo_poly.data(), fo_max_error.data(), workspace));
+        EXPECT_TRUE(std::equal(expected_poly.begin(), expected_poly.end(), fo_poly.begin()));
+        if (rr > 1)
+        {
+            EXPECT_EQ(0u, counter.num_allocations());
+            EXPECT_EQ(0u, counter.num_deallocations());
+        }
+    }
+}
+
+// process<NumCoeffs>() against the loops over the coefficients, which the
+// process() methods run for more than MAX_UNROLLED_NUM_COEFF coefficients.
+// Leading zero coefficients do not change the Horner evaluation, so the
+// HO polynomial padded with them must give the same FOs.
+TEST(FodmWorkspaceTest, UnrolledProcessMatchesLoop)
+{
+    const std::vector<double> fo_t_start = FoTimes();
+    std::vector<double> padded_poly(MAX_UNROLLED_NUM_COEFF + 1 - NUM_HO_COEFF, 0.0);
+    padded_poly.insert(padded_poly.end(), HO_POLY, HO_POLY + NUM_HO_COEFF);
+    std::vector<long double> expected_poly(NUM_FO_POLY * 2), expected_extra(NUM_FO_POLY + 1);
+    std::vector<long double> fo_poly(NUM_FO_POLY * 2), extra(NUM_FO_POLY + 1);
+    FodmWorkspace workspace;
+
+    for (PolyvalPrecision precision : PRECISIONS)
+    {
+        const FirstOrderDelayModel model(precision);
+        workspace.Reset();
+        EXPECT_TRUE(model.process(HO_T_START, HO_T_STOP, padded_poly.size(), padded_poly.data(), NUM_FO_POLY,
+            fo_t_start.data(), expected_poly.data(), expected_extra.data(), workspace));
+        workspace.Reset();
+        EXPECT_TRUE(model.process<NUM_HO_COEFF>(HO_T_START, HO_T_STOP, HO_POLY, NUM_FO_POLY,
+            fo_t_start.data(), fo_poly.data(), extra.data(), workspace));
+        EXPECT_EQ(expected_poly, fo_poly) << "precision " << static_cast<int>(precision);
+        EXPECT_EQ(expected_extra, extra) << "precision " << static_cast<int>(precision);
+
+        const FirstOrderDelayModel lsq_model(precision, LsqFitMethod::Sampled);
+        workspace.Reset();
+        EXPECT_TRUE(lsq_model.process(HO_T_START, HO_T_STOP, padded_poly.size(), padded_poly.data(), NUM_LSQ_POINTS,
+            NUM_FO_POLY, fo_t_start.data(), expected_poly.data(), nullptr, workspace));
+        workspace.Reset();
+        EXPECT_TRUE(lsq_model.process<NUM_HO_COEFF>(HO_T_START, HO_T_STOP, HO_POLY, NUM_LSQ_POINTS,
+            NUM_FO_POLY, fo_t_start.data(), fo_poly.data(), nullptr, workspace));
+        EXPECT_EQ(expected_poly, fo_poly) << "precision " << static_cast<int>(precision);
+    }
+}
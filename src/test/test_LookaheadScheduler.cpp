@@ -0,0 +1,136 @@
+/***
+ * test_LookaheadScheduler.cpp
+ *
+ * The unit test driver for LookaheadScheduler. The register values of the
+ * FODMs in the lookahead window are expected to be ready once the
+ * scheduler is idle, to match CalcFodmRegisterValues, and a new HODM to
+ * only cause the FODMs it changes to be calculated again.
+ *
+ ***/
+#include <vector>
+#include "LookaheadScheduler.h"
+#include "fodm_test_utils.h"
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+const double START_TIME_MS = 950040000000.0;
+const double INTERVAL_MS = 10.0;
+
+// num_fo_poly FODMs of 10 ms from FODM first, with delay_linear slope
+DelayModelEntry make_entry(int first, int num_fo_poly, double slope)
+{
+    DelayModelEntry entry;
+    entry.ho_start_time_ms = START_TIME_MS;
+    entry.ho_stop_time_ms = START_TIME_MS + (first + num_fo_poly) * INTERVAL_MS;
+    entry.ho_poly = { slope, -19036.792 };
+    entry.fo_polys.resize(num_fo_poly);
+    for (int ii = 0; ii < num_fo_poly; ii++)
+    {
+        FoPoly& fo_poly = entry.fo_polys[ii];
+        fo_poly.ho_poly_start_time_ms = START_TIME_MS;
+        fo_poly.start_time_ms = START_TIME_MS + (first + ii) * INTERVAL_MS;
+        fo_poly.stop_time_ms = START_TIME_MS + (first + ii + 1) * INTERVAL_MS;
+        fo_poly.poly[0] = slope;
+        fo_poly.poly[1] = -19036.792 + slope * (first + ii) * INTERVAL_MS / 1000.0;
+    }
+    return entry;
+}
+
+double fodm_time(int fodm)
+{
+    return START_TIME_MS + fodm * INTERVAL_MS + 1.0;
+}
+
+}; // namespace
+
+TEST(LookaheadSchedulerTest, WindowAndInvalidation)
+{
+    const RdtChannelContext ctx(INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+        FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT);
+    const int NUM_RECEPTORS = 2;
+    const size_t LOOKAHEAD = 20;
+    LookaheadScheduler scheduler(ctx, NUM_RECEPTORS, LOOKAHEAD);
+    std::vector<DelayModelEntry> entries;
+    for (int rr = 0; rr < NUM_RECEPTORS; rr++)
+    {
+        entries.push_back(make_entry(0, 100, -0.158 - rr * 0.01));
+        EXPECT_TRUE(scheduler.Publish(rr, entries[rr]));
+    }
+    EXPECT_FALSE(scheduler.Publish(0, DelayModelEntry()));
+
+    // nothing before the first Advance()
+    scheduler.WaitIdle();
+    EXPECT_EQ(0u, scheduler.num_calculated());
+
+    scheduler.Advance(fodm_time(0));
+    scheduler.WaitIdle();
+    EXPECT_EQ(NUM_RECEPTORS * LOOKAHEAD, scheduler.num_calculated());
+    FirstOrderDelayModelRegisterValues reg_values;
+    for (int rr = 0; rr < NUM_RECEPTORS; rr++)
+    {
+        for (size_t ii = 0; ii < LOOKAHEAD; ii++)
+        {
+            ASSERT_TRUE(scheduler.Lookup(rr, fodm_time(ii), reg_values)) << "FODM " << ii;
+            expect_reg_values_eq(CalcFodmRegisterValues(ctx, entries[rr].fo_polys[ii]), reg_values);
+        }
+        EXPECT_FALSE(scheduler.Lookup(rr, fodm_time(LOOKAHEAD), reg_values));
+    }
+    EXPECT_EQ(NUM_RECEPTORS, scheduler.num_misses());
+
+    // the window moves on, the FODMs skipped over are not calculated and
+    // the ones before the window are dropped
+    scheduler.Advance(fodm_time(50));
+    scheduler.WaitIdle();
+    EXPECT_EQ(NUM_RECEPTORS * 2 * LOOKAHEAD, scheduler.num_calculated());
+    EXPECT_FALSE(scheduler.Lookup(0, fodm_time(49), reg_values));
+    EXPECT_TRUE(scheduler.Lookup(0, fodm_time(50), reg_values));
+    EXPECT_TRUE(scheduler.Lookup(0, fodm_time(50 + LOOKAHEAD - 1), reg_values));
+    EXPECT_FALSE(scheduler.Lookup(0, fodm_time(50 + LOOKAHEAD), reg_values));
+
+    // a new HODM from FODM 60, with the same FODMs up to 64. Only FODMs 65
+    // to 69 of the window are calculated again.
+    const uint64_t num_calculated = scheduler.num_calculated();
+    DelayModelEntry entry = make_entry(60, 100, -0.2);
+    for (int ii = 0; ii < 5; ii++)
+    {
+        entry.fo_polys[ii] = entries[0].fo_polys[60 + ii];
+    }
+    EXPECT_TRUE(scheduler.Publish(0, entry));
+    scheduler.WaitIdle();
+    EXPECT_EQ(5u, scheduler.num_invalidated());
+    EXPECT_EQ(num_calculated + 5, scheduler.num_calculated());
+    for (int ii = 50; ii < 50 + static_cast<int>(LOOKAHEAD); ii++)
+    {
+        const FoPoly& fo_poly = ii < 60 ? entries[0].fo_polys[ii] : entry.fo_polys[ii - 60];
+        ASSERT_TRUE(scheduler.Lookup(0, fodm_time(ii), reg_values)) << "FODM " << ii;
+        expect_reg_values_eq(CalcFodmRegisterValues(ctx, fo_poly), reg_values);
+    }
+}
+
+// A gap between the entries ends the window
+TEST(LookaheadSchedulerTest, WindowEndsAtGap)
+{
+    const RdtChannelContext ctx(INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE,
+        FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT, FREQ_SCFO_SHIFT, FodmCalcEngine::FixedPoint);
+    LookaheadScheduler scheduler(ctx, 1, 100);
+    EXPECT_TRUE(scheduler.Publish(0, make_entry(0, 10, -0.158)));
+    EXPECT_TRUE(scheduler.Publish(0, make_entry(20, 10, -0.158)));
+    scheduler.Advance(fodm_time(0));
+    scheduler.WaitIdle();
+    EXPECT_EQ(10u, scheduler.num_calculated());
+
+    // once the gap is filled, the rest of the window is calculated
+    FirstOrderDelayModelRegisterValues reg_values;
+    EXPECT_FALSE(scheduler.Lookup(0, fodm_time(25), reg_values));
+    DelayModelEntry entry = make_entry(10, 20, -0.158);
+    EXPECT_TRUE(scheduler.Publish(0, entry));
+    scheduler.WaitIdle();
+    EXPECT_EQ(30u, scheduler.num_calculated());
+    EXPECT_TRUE(scheduler.Lookup(0, fodm_time(25), reg_values));
+    EXPECT_EQ(0u, scheduler.num_invalidated());
+}
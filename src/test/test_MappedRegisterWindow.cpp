@@ -0,0 +1,83 @@
+/***
+ * test_MappedRegisterWindow.cpp
+ *
+ * The unit test driver for MappedRegisterWindow, with a regular file
+ * standing in for the FPGA register window. The register images written
+ * to the window are expected in the file.
+ *
+ ***/
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "FodmRegisterImage.h"
+#include "MappedRegisterWindow.h"
+#include "fodm_test_utils.h"
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+const char* WINDOW_FILE = "test_MappedRegisterWindow.bin";
+
+std::vector<uint8_t> read_file(const char* path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+}; // namespace
+
+TEST(MappedRegisterWindowTest, WritesReachTheFile)
+{
+    const size_t NUM_FODMS = 64;
+    std::remove(WINDOW_FILE);
+
+    std::vector<FirstOrderDelayModelRegisterValues> reg_values(NUM_FODMS);
+    for (size_t ii = 0; ii < NUM_FODMS; ii++)
+    {
+        reg_values[ii].first_input_timestamp = 209210800000000000 + ii * 2200296;
+        reg_values[ii].delay_constant = 0x80000000u + ii;
+        reg_values[ii].phase_constant = -static_cast<int32_t>(ii);
+        reg_values[ii].delay_linear = 0x123456789abcdefull * ii;
+        reg_values[ii].phase_linear = -0x123456789abcdefll * static_cast<int64_t>(ii);
+        reg_values[ii].validity_period = 2202009;
+        reg_values[ii].output_PPS = 1;
+        reg_values[ii].first_output_timestamp = 209210800000000000 + ii * 2202009;
+    }
+
+    MappedRegisterWindow window;
+    EXPECT_FALSE(window.is_open());
+    ASSERT_TRUE(window.Open(WINDOW_FILE, NUM_FODMS * FODM_REGISTER_FORMAT.image_size));
+    EXPECT_EQ(NUM_FODMS * FODM_REGISTER_FORMAT.image_size, window.size());
+    EncodeFodmRegisterImage(reg_values.data(), NUM_FODMS, window.at(0));
+    EXPECT_TRUE(window.Sync());
+
+    std::vector<uint8_t> image(NUM_FODMS * FODM_REGISTER_FORMAT.image_size);
+    EncodeFodmRegisterImage(reg_values.data(), NUM_FODMS, image.data());
+    EXPECT_EQ(image, read_file(WINDOW_FILE));
+
+    // a larger window extends the file and keeps what was written
+    ASSERT_TRUE(window.Open(WINDOW_FILE, 2 * NUM_FODMS * FODM_REGISTER_FORMAT.image_size));
+    std::vector<FirstOrderDelayModelRegisterValues> decoded(NUM_FODMS);
+    DecodeFodmRegisterImage(window.at(0), NUM_FODMS, decoded.data());
+    for (size_t ii = 0; ii < NUM_FODMS; ii++)
+    {
+        expect_reg_values_eq(reg_values[ii], decoded[ii]);
+    }
+    window.Close();
+    EXPECT_FALSE(window.is_open());
+    EXPECT_EQ(2 * NUM_FODMS * FODM_REGISTER_FORMAT.image_size, read_file(WINDOW_FILE).size());
+
+    std::remove(WINDOW_FILE);
+}
+
+TEST(MappedRegisterWindowTest, OpenFails)
+{
+    MappedRegisterWindow window;
+    EXPECT_FALSE(window.Open("no_such_directory/registers.bin", 4096));
+    EXPECT_FALSE(window.is_open());
+}
@@ -0,0 +1,154 @@
+/***
+ * test_MultiPointHorner.cpp
+ *
+ * The unit test driver for the multi-point Horner kernels. Every SIMD
+ * kernel supported by the CPU is expected to give bit-identical results
+ * to the scalar Horner loop and to CompensatedHorner, for polynomials of
+ * degree 0 to 8 and numbers of points that exercise the remainder loops.
+ * The same holds for the polynomials in structure-of-arrays layout, and
+ * for the kernels unrolled for the number of coefficients.
+ *
+ ***/
+#include <random>
+#include <vector>
+#include "DoubleDouble.h"
+#include "MultiPointHorner.h"
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+const HornerKernel KERNELS[] = {
+    HornerKernel::Auto, HornerKernel::Scalar, HornerKernel::Avx2, HornerKernel::Avx512, HornerKernel::Neon };
+
+// The kernels unrolled for NumCoeffs coefficients, see DispatchNumCoeff
+template <int NumCoeffs>
+void unrolled_horner(const double* poly, const double* x, size_t num_points, double* y, double* y_hi, double* y_lo,
+                     HornerKernel kernel)
+{
+    HornerMultiPoint<NumCoeffs>(poly, x, num_points, y, kernel);
+    CompensatedHornerMultiPoint<NumCoeffs>(poly, x, num_points, y_hi, y_lo, kernel);
+}
+
+template <>
+void unrolled_horner<0>(const double*, const double*, size_t, double*, double*, double*, HornerKernel)
+{
+    FAIL() << "no unrolled kernels";
+}
+
+TEST(MultiPointHornerTest, ResolveKernel)
+{
+    EXPECT_NE(HornerKernel::Auto, ResolveHornerKernel(HornerKernel::Auto));
+    EXPECT_EQ(HornerKernel::Scalar, ResolveHornerKernel(HornerKernel::Scalar));
+    for (HornerKernel kernel : KERNELS)
+    {
+        HornerKernel resolved = ResolveHornerKernel(kernel);
+        if (kernel != HornerKernel::Auto)
+        {
+            EXPECT_TRUE(resolved == kernel || resolved == HornerKernel::Scalar);
+        }
+    }
+    std::cout << "Auto kernel = " << static_cast<int>(ResolveHornerKernel(HornerKernel::Auto)) << std::endl;
+}
+
+TEST(MultiPointHornerTest, MatchesScalar)
+{
+    std::mt19937 gen(2007);
+    std::uniform_real_distribution<> coeff_distr(-1.0, 1.0);
+    std::uniform_real_distribution<> x_distr(0.0, 600.0);
+
+    for (int num_coeff = 1; num_coeff <= 9; num_coeff++)
+    {
+        for (size_t num_points = 0; num_points <= 37; num_points++)
+        {
+            std::vector<double> poly(num_coeff);
+            for (int kk = 0; kk < num_coeff; kk++)
+            {
+                // decreasing coefficients like a delay model, ns/s^k
+                poly[kk] = coeff_distr(gen) * std::pow(10.0, 5 - 3 * (num_coeff - 1 - kk));
+            }
+            std::vector<double> x(num_points);
+            for (double& x_i : x)
+            {
+                x_i = x_distr(gen);
+            }
+
+            for (HornerKernel kernel : KERNELS)
+            {
+                std::vector<double> y(num_points), y_hi(num_points), y_lo(num_points);
+                HornerMultiPoint(poly.data(), num_coeff, x.data(), num_points, y.data(), kernel);
+                CompensatedHornerMultiPoint(poly.data(), num_coeff, x.data(), num_points,
+                    y_hi.data(), y_lo.data(), kernel);
+
+                for (size_t ii = 0; ii < num_points; ii++)
+                {
+                    double expected = poly[0];
+                    for (int kk = 1; kk < num_coeff; kk++)
+                    {
+                        expected = expected * x[ii] + poly[kk];
+                    }
+                    ASSERT_EQ(expected, y[ii]) << "kernel " << static_cast<int>(kernel);
+
+                    DoubleDouble expected_dd = CompensatedHorner(poly.data(), num_coeff, x[ii]);
+                    ASSERT_EQ(expected_dd.hi, y_hi[ii]) << "kernel " << static_cast<int>(kernel);
+                    ASSERT_EQ(expected_dd.lo, y_lo[ii]) << "kernel " << static_cast<int>(kernel);
+                }
+
+                if (num_coeff >= 2)
+                {
+                    std::vector<double> y_unrolled(num_points), y_hi_unrolled(num_points), y_lo_unrolled(num_points);
+                    DispatchNumCoeff(num_coeff, [&](auto num_coeffs)
+                    {
+                        unrolled_horner<decltype(num_coeffs)::value>(poly.data(), x.data(), num_points,
+                            y_unrolled.data(), y_hi_unrolled.data(), y_lo_unrolled.data(), kernel);
+                    });
+                    ASSERT_EQ(y, y_unrolled) << "kernel " << static_cast<int>(kernel);
+                    ASSERT_EQ(y_hi, y_hi_unrolled) << "kernel " << static_cast<int>(kernel);
+                    ASSERT_EQ(y_lo, y_lo_unrolled) << "kernel " << static_cast<int>(kernel);
+                }
+            }
+        }
+    }
+}
+
+TEST(MultiPointHornerTest, SoAMatchesScalar)
+{
+    std::mt19937 gen(2013);
+    std::uniform_real_distribution<> coeff_distr(-1.0, 1.0);
+    std::uniform_real_distribution<> x_distr(0.0, 600.0);
+
+    for (int num_coeff = 1; num_coeff <= 9; num_coeff++)
+    {
+        for (size_t num_polys = 0; num_polys <= 37; num_polys++)
+        {
+            std::vector<double> poly(num_coeff * num_polys);
+            std::vector<double> x(num_polys);
+            for (size_t ii = 0; ii < num_polys; ii++)
+            {
+                for (int kk = 0; kk < num_coeff; kk++)
+                {
+                    poly[kk * num_polys + ii] = coeff_distr(gen) * std::pow(10.0, 5 - 3 * (num_coeff - 1 - kk));
+                }
+                x[ii] = x_distr(gen);
+            }
+
+            for (HornerKernel kernel : KERNELS)
+            {
+                std::vector<double> y_hi(num_polys), y_lo(num_polys);
+                CompensatedHornerSoA(poly.data(), num_coeff, num_polys, x.data(), y_hi.data(), y_lo.data(), kernel);
+
+                for (size_t ii = 0; ii < num_polys; ii++)
+                {
+                    std::vector<double> poly_ii(num_coeff);
+                    for (int kk = 0; kk < num_coeff; kk++)
+                    {
+                        poly_ii[kk] = poly[kk * num_polys + ii];
+                    }
+                    DoubleDouble expected_dd = CompensatedHorner(poly_ii.data(), num_coeff, x[ii]);
+                    ASSERT_EQ(expected_dd.hi, y_hi[ii]) << "kernel " << static_cast<int>(kernel);
+                    ASSERT_EQ(expected_dd.lo, y_lo[ii]) << "kernel " << static_cast<int>(kernel);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,232 @@
+/***
+ * test_RdtChannelContext.cpp
+ *
+ * The unit test driver for the CalcFodmRegisterValues overloads taking a
+ * RdtChannelContext. The results are compared against the overloads taking
+ * the sample rates and frequency shifts for every engine, including when
+ * the context is copied and shared between threads, and for the parallel
+ * batch functions. CalcFodmRegisterVersions is compared against the
+ * functions of each register version.
+ *
+ ***/
+#include <thread>
+#include <vector>
+#include "CalcFodmRegisterValues.h"
+#include "ThreadPool.h"
+#include "fodm_test_utils.h"
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+const FodmCalcEngine ENGINES[] = {
+    FodmCalcEngine::MultiPrecision, FodmCalcEngine::FixedPoint, FodmCalcEngine::Float128, FodmCalcEngine::DoubleDouble };
+
+void expect_context_matches(const CsvInputs& input, FodmCalcEngine engine)
+{
+    RdtChannelContext ctx(input.input_sample_rate, input.output_sample_rate,
+        input.f_ds, input.f_as, input.f_wb, input.f_scfo, engine);
+    expect_reg_values_eq(
+        CalcFodmRegisterValues(input.fo_poly, input.input_sample_rate, input.output_sample_rate,
+            input.f_ds, input.f_as, input.f_wb, input.f_scfo, engine),
+        CalcFodmRegisterValues(ctx, input.fo_poly));
+    expect_reg_values_eq(
+        CalcFodmRegisterValuesV1(input.fo_poly, input.input_sample_rate, input.output_sample_rate,
+            input.f_ds, input.f_as, input.f_wb, input.f_scfo, engine),
+        CalcFodmRegisterValuesV1(ctx, input.fo_poly));
+
+    FodmRegisterVersionValues versions;
+    CalcFodmRegisterVersions(ctx, input.fo_poly, FODM_REGISTER_V1 | FODM_REGISTER_V2, versions);
+    expect_reg_values_eq(CalcFodmRegisterValues(ctx, input.fo_poly), versions.v2);
+    expect_reg_values_eq(CalcFodmRegisterValuesV1(ctx, input.fo_poly), versions.v1);
+}
+
+TEST(RdtChannelContextTest, CsvInputs)
+{
+    std::vector<CsvInputs> test_input;
+    parse_input_csv("fodm_test_input.csv", test_input);
+    ASSERT_FALSE(test_input.empty());
+
+    for (const CsvInputs& input : test_input)
+    {
+        for (FodmCalcEngine engine : ENGINES)
+        {
+            expect_context_matches(input, engine);
+        }
+    }
+}
+
+TEST(RdtChannelContextTest, RandomInputs)
+{
+    std::vector<CsvInputs> test_input;
+    generate_random_inputs(2000, 2006, test_input);
+
+    for (const CsvInputs& input : test_input)
+    {
+        for (FodmCalcEngine engine : ENGINES)
+        {
+            expect_context_matches(input, engine);
+        }
+        if (::testing::Test::HasFailure())
+        {
+            break;
+        }
+    }
+}
+
+TEST(RdtChannelContextTest, Accessors)
+{
+    RdtChannelContext ctx(220200960, 3963617280u, 1.0, 2.0, 3.0, 4.0, FodmCalcEngine::FixedPoint);
+    EXPECT_EQ(220200960u, ctx.input_sample_rate());
+    EXPECT_EQ(3963617280u, ctx.output_sample_rate());
+    EXPECT_EQ(1.0, ctx.freq_down_shift());
+    EXPECT_EQ(2.0, ctx.freq_align_shift());
+    EXPECT_EQ(3.0, ctx.freq_wb_shift());
+    EXPECT_EQ(4.0, ctx.freq_scfo_shift());
+    EXPECT_EQ(FodmCalcEngine::FixedPoint, ctx.engine());
+
+    // Default is resolved to the build default
+    RdtChannelContext default_ctx(220200960, 3963617280u, 1.0, 2.0, 3.0, 4.0);
+    EXPECT_NE(FodmCalcEngine::Default, default_ctx.engine());
+
+    // Copies share the precomputed values
+    RdtChannelContext copy = ctx;
+    EXPECT_EQ(&ctx.constants(), &copy.constants());
+}
+
+// A context shared by several threads gives the same results as the batch
+// function taking the sample rates and frequency shifts
+TEST(RdtChannelContextTest, SharedBetweenThreads)
+{
+    std::vector<CsvInputs> test_input;
+    parse_input_csv("fodm_test_input.csv", test_input);
+    ASSERT_FALSE(test_input.empty());
+    const CsvInputs& row = test_input[2];
+
+    const int NUM_FODMS = 200;
+    const int NUM_THREADS = 4;
+    std::vector<FoPoly> fo_polys(NUM_FODMS, row.fo_poly);
+    for (int ii = 0; ii < NUM_FODMS; ii++)
+    {
+        fo_polys[ii].start_time_ms = row.fo_poly.start_time_ms + ii * 10.0;
+        fo_polys[ii].stop_time_ms = fo_polys[ii].start_time_ms + 10.0;
+    }
+
+    for (FodmCalcEngine engine : ENGINES)
+    {
+        std::vector<FirstOrderDelayModelRegisterValues> expected(NUM_FODMS);
+        CalcFodmRegisterValues(fo_polys.data(), fo_polys.size(), row.input_sample_rate, row.output_sample_rate,
+            row.f_ds, row.f_as, row.f_wb, row.f_scfo, expected.data(), engine);
+
+        const RdtChannelContext ctx(row.input_sample_rate, row.output_sample_rate,
+            row.f_ds, row.f_as, row.f_wb, row.f_scfo, engine);
+        std::vector<std::vector<FirstOrderDelayModelRegisterValues>> values(NUM_THREADS,
+            std::vector<FirstOrderDelayModelRegisterValues>(NUM_FODMS));
+        std::vector<std::thread> threads;
+        for (int tt = 0; tt < NUM_THREADS; tt++)
+        {
+            // Every other thread uses its own copy
+            threads.emplace_back([&, tt]() {
+                RdtChannelContext copy = ctx;
+                const RdtChannelContext& thread_ctx = tt % 2 ? copy : ctx;
+                for (int ii = 0; ii < NUM_FODMS; ii++)
+                {
+                    values[tt][ii] = CalcFodmRegisterValues(thread_ctx, fo_polys[ii]);
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (int tt = 0; tt < NUM_THREADS; tt++)
+        {
+            for (int ii = 0; ii < NUM_FODMS; ii++)
+            {
+                expect_reg_values_eq(expected[ii], values[tt][ii]);
+            }
+        }
+    }
+}
+
+// The parallel batch functions give the same results as the serial ones
+TEST(RdtChannelContextTest, ParallelBatch)
+{
+    std::vector<CsvInputs> test_input;
+    parse_input_csv("fodm_test_input.csv", test_input);
+    ASSERT_FALSE(test_input.empty());
+    const CsvInputs& row = test_input[2];
+
+    const int NUM_FODMS = 1000;
+    std::vector<FoPoly> fo_polys(NUM_FODMS, row.fo_poly);
+    for (int ii = 0; ii < NUM_FODMS; ii++)
+    {
+        fo_polys[ii].start_time_ms = row.fo_poly.start_time_ms + ii * 10.0;
+        fo_polys[ii].stop_time_ms = fo_polys[ii].start_time_ms + 10.0;
+    }
+
+    ThreadPool pool(4);
+    for (FodmCalcEngine engine : ENGINES)
+    {
+        const RdtChannelContext ctx(row.input_sample_rate, row.output_sample_rate,
+            row.f_ds, row.f_as, row.f_wb, row.f_scfo, engine);
+        std::vector<FirstOrderDelayModelRegisterValues> expected(NUM_FODMS), values(NUM_FODMS);
+        std::vector<FirstOrderDelayModelRegisterValuesVer1> expected_v1(NUM_FODMS), values_v1(NUM_FODMS);
+        CalcFodmRegisterValues(ctx, fo_polys.data(), fo_polys.size(), expected.data());
+        CalcFodmRegisterValues(ctx, fo_polys.data(), fo_polys.size(), values.data(), pool);
+        CalcFodmRegisterValuesV1(ctx, fo_polys.data(), fo_polys.size(), expected_v1.data());
+        CalcFodmRegisterValuesV1(ctx, fo_polys.data(), fo_polys.size(), values_v1.data(), pool);
+        for (int ii = 0; ii < NUM_FODMS; ii++)
+        {
+            expect_reg_values_eq(expected[ii], values[ii]);
+            expect_reg_values_eq(expected_v1[ii], values_v1[ii]);
+        }
+    }
+}
+
+// Both register versions from one calculation, and only the versions requested
+TEST(RdtChannelContextTest, RegisterVersions)
+{
+    std::vector<CsvInputs> test_input;
+    parse_input_csv("fodm_test_input.csv", test_input);
+    ASSERT_FALSE(test_input.empty());
+    const CsvInputs& row = test_input[2];
+
+    const int NUM_FODMS = 100;
+    std::vector<FoPoly> fo_polys(NUM_FODMS, row.fo_poly);
+    for (int ii = 0; ii < NUM_FODMS; ii++)
+    {
+        fo_polys[ii].start_time_ms = row.fo_poly.start_time_ms + ii * 10.0;
+        fo_polys[ii].stop_time_ms = fo_polys[ii].start_time_ms + 10.0;
+    }
+
+    for (FodmCalcEngine engine : ENGINES)
+    {
+        const RdtChannelContext ctx(row.input_sample_rate, row.output_sample_rate,
+            row.f_ds, row.f_as, row.f_wb, row.f_scfo, engine);
+        std::vector<FirstOrderDelayModelRegisterValues> expected(NUM_FODMS);
+        std::vector<FirstOrderDelayModelRegisterValuesVer1> expected_v1(NUM_FODMS);
+        std::vector<FodmRegisterVersionValues> versions(NUM_FODMS);
+        CalcFodmRegisterValues(ctx, fo_polys.data(), fo_polys.size(), expected.data());
+        CalcFodmRegisterValuesV1(ctx, fo_polys.data(), fo_polys.size(), expected_v1.data());
+        CalcFodmRegisterVersions(ctx, fo_polys.data(), fo_polys.size(), FODM_REGISTER_V1 | FODM_REGISTER_V2, versions.data());
+        for (int ii = 0; ii < NUM_FODMS; ii++)
+        {
+            expect_reg_values_eq(expected[ii], versions[ii].v2);
+            expect_reg_values_eq(expected_v1[ii], versions[ii].v1);
+        }
+
+        FodmOutputTimestamps timestamps = { 2202009600000ull, 2202009600000ull + 2202009 };
+        FodmRegisterVersionValues values;
+        CalcFodmRegisterVersions(ctx, fo_polys[0], timestamps, FODM_REGISTER_V1 | FODM_REGISTER_V2, values);
+        expect_reg_values_eq(CalcFodmRegisterValues(ctx, fo_polys[0], timestamps), values.v2);
+        expect_reg_values_eq(CalcFodmRegisterValuesV1(ctx, fo_polys[0], timestamps), values.v1);
+
+        // the version 2 values are left as they were
+        FodmRegisterVersionValues v1_only = versions[1];
+        CalcFodmRegisterVersions(ctx, fo_polys[0], FODM_REGISTER_V1, v1_only);
+        expect_reg_values_eq(versions[0].v1, v1_only.v1);
+        expect_reg_values_eq(versions[1].v2, v1_only.v2);
+    }
+}
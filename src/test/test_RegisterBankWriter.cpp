@@ -0,0 +1,174 @@
+/***
+ * test_RegisterBankWriter.cpp
+ *
+ * The unit test driver for RegisterBankWriter, with a memfd standing in
+ * for the FPGA register window. A second mapping of the memfd plays the
+ * FPGA: it reads the active bank, which is expected to hold the last
+ * committed FODMs, while the other bank is written.
+ *
+ ***/
+#include <cstring>
+#include <vector>
+#include "FodmPipeline.h"
+#include "RegisterBankWriter.h"
+#include "fodm_test_utils.h"
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+namespace
+{
+
+const size_t BANK_CAPACITY = 32;
+
+uint32_t read_control(const MappedRegisterWindow& window, size_t offset)
+{
+    uint32_t value;
+    std::memcpy(&value, window.at(offset), sizeof(value));
+    return value;
+}
+
+std::vector<FirstOrderDelayModelRegisterValues> make_reg_values(size_t num_reg_values, uint64_t seed)
+{
+    std::vector<FirstOrderDelayModelRegisterValues> reg_values(num_reg_values);
+    for (size_t ii = 0; ii < num_reg_values; ii++)
+    {
+        reg_values[ii].first_input_timestamp = seed + ii * 2200296;
+        reg_values[ii].delay_constant = static_cast<uint32_t>(seed + ii);
+        reg_values[ii].phase_constant = -static_cast<int32_t>(ii);
+        reg_values[ii].delay_linear = seed * 0x10001 + ii;
+        reg_values[ii].phase_linear = -static_cast<int64_t>(seed + ii);
+        reg_values[ii].validity_period = 2202009;
+        reg_values[ii].output_PPS = 1;
+        reg_values[ii].first_output_timestamp = seed + ii * 2202009;
+    }
+    return reg_values;
+}
+
+// The FODMs of the active bank, as the FPGA sees them
+std::vector<FirstOrderDelayModelRegisterValues> read_active_bank(const MappedRegisterWindow& device,
+                                                                 const RegisterBankWriter& writer)
+{
+    uint32_t bank = read_control(device, REGISTER_BANK_ACTIVE_BANK);
+    uint32_t num_fodms = read_control(device, REGISTER_BANK_NUM_FODMS + 4 * bank);
+    std::vector<FirstOrderDelayModelRegisterValues> reg_values(num_fodms);
+    DecodeFodmRegisterImage(device.at(writer.bank_offset(bank)), num_fodms, reg_values.data());
+    return reg_values;
+}
+
+void expect_all_reg_values_eq(const std::vector<FirstOrderDelayModelRegisterValues>& expected,
+                              const std::vector<FirstOrderDelayModelRegisterValues>& actual)
+{
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t ii = 0; ii < expected.size(); ii++)
+    {
+        expect_reg_values_eq(expected[ii], actual[ii]);
+    }
+}
+
+}; // namespace
+
+TEST(RegisterBankWriterTest, DoubleBuffering)
+{
+    MappedRegisterWindow window, device;
+    ASSERT_TRUE(window.OpenMemfd("fodm_registers", RegisterBankWriter::RegionSize(BANK_CAPACITY)));
+    ASSERT_TRUE(device.Open(window.path(), window.size()));
+    RegisterBankWriter writer(window, BANK_CAPACITY);
+    EXPECT_EQ(0u, read_active_bank(device, writer).size());
+
+    const std::vector<FirstOrderDelayModelRegisterValues> first = make_reg_values(20, 1000);
+    const std::vector<FirstOrderDelayModelRegisterValues> second = make_reg_values(BANK_CAPACITY, 2000);
+    const std::vector<FirstOrderDelayModelRegisterValues> third = make_reg_values(5, 3000);
+
+    EXPECT_EQ(first.size(), writer.Stage(first.data(), first.size()));
+    writer.Commit();
+    EXPECT_EQ(1, writer.active_bank());
+    EXPECT_EQ(1u, read_control(device, REGISTER_BANK_GENERATION));
+    expect_all_reg_values_eq(first, read_active_bank(device, writer));
+
+    // staging does not touch the window, and a full bank takes no more
+    EXPECT_EQ(10u, writer.Stage(second.data(), 10));
+    EXPECT_EQ(BANK_CAPACITY - 10, writer.Stage(second.data() + 10, second.size()));
+    EXPECT_EQ(0u, writer.Stage(third.data(), third.size()));
+    EXPECT_EQ(BANK_CAPACITY, writer.num_staged());
+    expect_all_reg_values_eq(first, read_active_bank(device, writer));
+
+    // the FPGA switches to bank 0, and bank 1 is left as it was
+    writer.Commit();
+    EXPECT_EQ(0, writer.active_bank());
+    EXPECT_EQ(0u, writer.num_staged());
+    expect_all_reg_values_eq(second, read_active_bank(device, writer));
+    std::vector<FirstOrderDelayModelRegisterValues> bank_1(first.size());
+    DecodeFodmRegisterImage(device.at(writer.bank_offset(1)), first.size(), bank_1.data());
+    expect_all_reg_values_eq(first, bank_1);
+
+    // nothing staged, nothing written
+    writer.Commit();
+    EXPECT_EQ(2u, read_control(device, REGISTER_BANK_GENERATION));
+
+    EXPECT_EQ(third.size(), writer.Stage(third.data(), third.size()));
+    writer.Commit();
+    EXPECT_EQ(1, writer.active_bank());
+    expect_all_reg_values_eq(third, read_active_bank(device, writer));
+}
+
+TEST(RegisterBankWriterTest, Version1)
+{
+    MappedRegisterWindow window;
+    ASSERT_TRUE(window.OpenMemfd("fodm_registers", RegisterBankWriter::RegionSize(BANK_CAPACITY, FODM_REGISTER_FORMAT_V1)));
+    RegisterBankWriter writer(window, BANK_CAPACITY, FODM_REGISTER_FORMAT_V1);
+
+    std::vector<FirstOrderDelayModelRegisterValuesVer1> reg_values(3), decoded(3);
+    for (size_t ii = 0; ii < reg_values.size(); ii++)
+    {
+        reg_values[ii] = FirstOrderDelayModelRegisterValuesVer1{ ii, 1, -1, 2, -2, 3, 4, ii + 5 };
+    }
+    writer.Stage(reg_values.data(), reg_values.size());
+    writer.Commit();
+    EXPECT_EQ(3u, read_control(window, REGISTER_BANK_NUM_FODMS + 4));
+    DecodeFodmRegisterImageV1(window.at(writer.bank_offset(1)), reg_values.size(), decoded.data());
+    for (size_t ii = 0; ii < reg_values.size(); ii++)
+    {
+        expect_reg_values_eq(reg_values[ii], decoded[ii]);
+    }
+}
+
+TEST(RegisterBankWriterTest, PipelineWriter)
+{
+    const RdtChannelContext ctx(INPUT_SAMPLE_RATE, OUTPUT_SAMPLE_RATE, FREQ_DOWN_SHIFT, FREQ_ALIGN_SHIFT, FREQ_WB_SHIFT,
+        FREQ_SCFO_SHIFT);
+    MappedRegisterWindow window;
+    ASSERT_TRUE(window.OpenMemfd("fodm_registers", RegisterBankWriter::RegionSize(FodmPipeline::BATCH_SIZE)));
+    RegisterBankWriter writer(window, FodmPipeline::BATCH_SIZE);
+
+    // one bank per batch of the pipeline
+    std::vector<FirstOrderDelayModelRegisterValues> last_batch;
+    {
+        FodmPipeline pipeline(ctx, [&](const RegisterRecord* records, size_t num_records)
+        {
+            last_batch.clear();
+            for (size_t ii = 0; ii < num_records; ii++)
+            {
+                writer.Stage(&records[ii].reg_values, 1);
+                last_batch.push_back(records[ii].reg_values);
+            }
+            writer.Commit();
+        });
+
+        HodmRecord hodm = {};
+        hodm.ho_start_time_ms = 950040000000.0;
+        hodm.ho_stop_time_ms = hodm.ho_start_time_ms + 10000.0;
+        hodm.num_ho_coeff = 2;
+        hodm.ho_poly[0] = 11.003;
+        hodm.ho_poly[1] = -259508.7983;
+        hodm.fo_start_time_ms = hodm.ho_start_time_ms;
+        hodm.fo_interval_ms = 10.0;
+        hodm.num_fo_poly = 1000;
+        pipeline.Push(hodm);
+        pipeline.Close();
+    }
+
+    EXPECT_GE(writer.generation(), (1000 + FodmPipeline::BATCH_SIZE - 1) / FodmPipeline::BATCH_SIZE);
+    expect_all_reg_values_eq(last_batch, read_active_bank(window, writer));
+}
@@ -0,0 +1,143 @@
+/***
+ * test_SpscRing.cpp
+ *
+ * The unit test driver for SpscRing. The records are expected to come out
+ * in the order they went in, also across the wrap-around of the buffer and
+ * with a producer and a consumer thread, and pushes to a full ring to fail.
+ *
+ ***/
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "SpscRing.h"
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+TEST(SpscRingTest, Capacity)
+{
+    EXPECT_EQ(1u, SpscRing<int>(0).capacity());
+    EXPECT_EQ(1u, SpscRing<int>(1).capacity());
+    EXPECT_EQ(8u, SpscRing<int>(5).capacity());
+    EXPECT_EQ(1024u, SpscRing<int>(1024).capacity());
+}
+
+TEST(SpscRingTest, FullAndEmpty)
+{
+    SpscRing<int> ring(4);
+    int item = -1;
+    EXPECT_FALSE(ring.TryPop(item));
+    for (int ii = 0; ii < 4; ii++)
+    {
+        EXPECT_TRUE(ring.TryPush(ii));
+    }
+    EXPECT_FALSE(ring.TryPush(4));
+    EXPECT_EQ(4u, ring.size());
+
+    EXPECT_TRUE(ring.TryPop(item));
+    EXPECT_EQ(0, item);
+    EXPECT_TRUE(ring.TryPush(4));
+
+    int items[8];
+    EXPECT_EQ(4u, ring.TryPopBatch(items, 8));
+    for (int ii = 0; ii < 4; ii++)
+    {
+        EXPECT_EQ(ii + 1, items[ii]);
+    }
+    EXPECT_EQ(0u, ring.TryPopBatch(items, 8));
+    EXPECT_EQ(0u, ring.size());
+}
+
+// Batches of every size, so that they wrap around the end of the buffer at
+// every position
+TEST(SpscRingTest, BatchWrapAround)
+{
+    SpscRing<int> ring(8);
+    int next_in = 0;
+    int next_out = 0;
+    for (size_t push_size = 1; push_size <= 9; push_size++)
+    {
+        for (size_t pop_size = 1; pop_size <= 9; pop_size++)
+        {
+            std::vector<int> items(push_size);
+            for (int& item : items)
+            {
+                item = next_in++;
+            }
+            size_t num_free = ring.capacity() - ring.size();
+            size_t num_pushed = ring.TryPushBatch(items.data(), push_size);
+            EXPECT_EQ(std::min(push_size, num_free), num_pushed);
+            next_in -= push_size - num_pushed;
+
+            std::vector<int> popped(pop_size);
+            size_t num_popped = ring.TryPopBatch(popped.data(), pop_size);
+            for (size_t ii = 0; ii < num_popped; ii++)
+            {
+                ASSERT_EQ(next_out++, popped[ii]);
+            }
+        }
+    }
+    int item;
+    while (ring.TryPop(item))
+    {
+        ASSERT_EQ(next_out++, item);
+    }
+    EXPECT_EQ(next_in, next_out);
+}
+
+struct Record
+{
+    uint64_t sequence;
+    double value;
+};
+
+// A producer and a consumer thread on a small ring, so that both wait on
+// each other often
+TEST(SpscRingTest, TwoThreads)
+{
+    const uint64_t NUM_RECORDS = 1000000;
+    SpscRing<Record> ring(64);
+
+    std::thread producer([&]()
+    {
+        Record records[7];
+        uint64_t sequence = 0;
+        while (sequence < NUM_RECORDS)
+        {
+            size_t num_records = std::min<uint64_t>(7, NUM_RECORDS - sequence);
+            for (size_t ii = 0; ii < num_records; ii++)
+            {
+                records[ii].sequence = sequence + ii;
+                records[ii].value = 0.5 * (sequence + ii);
+            }
+            size_t num_pushed = 0;
+            while (num_pushed < num_records)
+            {
+                num_pushed += ring.TryPushBatch(records + num_pushed, num_records - num_pushed);
+                std::this_thread::yield();
+            }
+            sequence += num_records;
+        }
+    });
+
+    Record records[16];
+    uint64_t expected = 0;
+    bool in_order = true;
+    while (expected < NUM_RECORDS)
+    {
+        size_t num_records = ring.TryPopBatch(records, 16);
+        for (size_t ii = 0; ii < num_records; ii++)
+        {
+            in_order &= records[ii].sequence == expected && records[ii].value == 0.5 * expected;
+            expected++;
+        }
+        if (num_records == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(in_order);
+    EXPECT_EQ(0u, ring.size());
+}
@@ -0,0 +1,111 @@
+/***
+ * test_ThreadPool.cpp
+ *
+ * The unit test driver for ThreadPool. The ranges passed to the loop body
+ * are expected to cover every item exactly once for any number of threads
+ * and grain size, and exceptions thrown by the body to reach the caller.
+ *
+ ***/
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "ThreadPool.h"
+
+#include "gtest/gtest.h"
+
+using namespace ska_mid_cbf_fodm_gen;
+
+TEST(ThreadPoolTest, CoversEveryItemOnce)
+{
+    for (unsigned num_threads : { 1u, 2u, 4u, 7u })
+    {
+        ThreadPool pool(num_threads);
+        EXPECT_EQ(num_threads, pool.num_threads());
+        for (size_t num_items : { 0u, 1u, 5u, 64u, 1000u })
+        {
+            for (size_t grain_size : { 0u, 1u, 3u, 64u, 2000u })
+            {
+                std::vector<std::atomic<int>> counts(num_items);
+                for (std::atomic<int>& count : counts)
+                {
+                    count = 0;
+                }
+                pool.ParallelFor(num_items, grain_size, [&](size_t begin, size_t end)
+                {
+                    EXPECT_LT(begin, end);
+                    EXPECT_LE(end - begin, std::max<size_t>(grain_size, 1));
+                    for (size_t ii = begin; ii < end; ii++)
+                    {
+                        counts[ii]++;
+                    }
+                });
+                for (size_t ii = 0; ii < num_items; ii++)
+                {
+                    ASSERT_EQ(1, counts[ii]) << num_threads << " threads, " << num_items
+                        << " items, grain " << grain_size << ", item " << ii;
+                }
+            }
+        }
+    }
+}
+
+TEST(ThreadPoolTest, DefaultNumThreads)
+{
+    ThreadPool pool;
+    EXPECT_EQ(std::max(1u, std::thread::hardware_concurrency()), pool.num_threads());
+}
+
+TEST(ThreadPoolTest, RethrowsException)
+{
+    ThreadPool pool(4);
+    std::atomic<int> num_ranges(0);
+    EXPECT_THROW(pool.ParallelFor(100, 1, [&](size_t begin, size_t)
+    {
+        num_ranges++;
+        if (begin == 37)
+        {
+            throw std::runtime_error("range 37");
+        }
+    }), std::runtime_error);
+    // the other ranges still run, and the pool can be used again
+    EXPECT_EQ(100, num_ranges);
+    num_ranges = 0;
+    pool.ParallelFor(100, 1, [&](size_t, size_t) { num_ranges++; });
+    EXPECT_EQ(100, num_ranges);
+}
+
+// Loops from several threads on the same pool run one after the other
+TEST(ThreadPoolTest, SeveralCallers)
+{
+    ThreadPool pool(3);
+    const int NUM_CALLERS = 4;
+    const size_t NUM_ITEMS = 10000;
+    std::vector<std::atomic<size_t>> sums(NUM_CALLERS);
+    std::vector<std::thread> callers;
+    for (int cc = 0; cc < NUM_CALLERS; cc++)
+    {
+        sums[cc] = 0;
+        callers.emplace_back([&, cc]()
+        {
+            for (int rep = 0; rep < 20; rep++)
+            {
+                pool.ParallelFor(NUM_ITEMS, 16, [&](size_t begin, size_t end)
+                {
+                    for (size_t ii = begin; ii < end; ii++)
+                    {
+                        sums[cc] += ii;
+                    }
+                });
+            }
+        });
+    }
+    for (std::thread& caller : callers)
+    {
+        caller.join();
+    }
+    for (int cc = 0; cc < NUM_CALLERS; cc++)
+    {
+        EXPECT_EQ(20 * NUM_ITEMS * (NUM_ITEMS - 1) / 2, sums[cc]);
+    }
+}